@@ -6,10 +6,18 @@ OPTION(ENABLE_COVERAGE "Enable coverage reporting for gcc/clang" OFF)
 OPTION(ENABLE_FMT "Enable fmt formatting" OFF)
 OPTION(BUILD_SHARED_LIBS "Enable compilation of shared libraries" OFF)
 OPTION(BUILD_EXAMPLES "Build example applications" ON)
+OPTION(BUILD_TOOLS "Build host tools (requires ENABLE_FILE_PERSISTENCE)" ON)
 OPTION(ENABLE_TESTING "Enable Test Builds" ON)
 OPTION(ENABLE_DOCS "Enable Sphinx/Doxygen documentation build" OFF)
 OPTION(DOCS_ONLY "Skip all C++ targets and Conan — build documentation only" OFF)
 OPTION(ENABLE_FILE_PERSISTENCE "Enable binary file persistence (serialization)" OFF)
+OPTION(ENABLE_STORAGE_PERSISTENCE "Enable sector based storage persistence (flash/EEPROM backends)" OFF)
+OPTION(ENABLE_TRACE "Record datapoint writes to an attached trace sink" OFF)
+OPTION(ENABLE_SHARED_MEMORY "Publish datapoint writes to a POSIX shared memory segment" OFF)
+OPTION(ENABLE_REPLICATION "Record datapoint writes for leader/follower replication" OFF)
+OPTION(ENABLE_CAN "Generate the CAN acceptance filters of the model" OFF)
+OPTION(ENABLE_MQTT "Generate the MQTT topics and topic router of the model" OFF)
+OPTION(ENABLE_PROTOCOL "Generate the protocol ID table of the model" OFF)
 OPTION(ENABLE_FUZZING "Enable Fuzzing Builds" OFF)
 OPTION(ENABLE_PYBIND11 "Enable pybind11 binding generation" OFF)
 OPTION(PYBIND11_DISABLE_EXTRAS "Disable pybind11 LTO and strip extras for faster development builds" OFF)
@@ -23,10 +23,24 @@ class DataLayerGeneratorConan(ConanFile):
     options = {
         'with_fmt': [True, False],
         'with_file_persistence': [True, False],
+        'with_storage_persistence': [True, False],
+        'with_trace': [True, False],
+        'with_shared_memory': [True, False],
+        'with_replication': [True, False],
+        'with_can': [True, False],
+        'with_mqtt': [True, False],
+        'with_protocol': [True, False],
     }
     default_options = {
         'with_fmt': True,
         'with_file_persistence': True,
+        'with_storage_persistence': False,
+        'with_trace': False,
+        'with_shared_memory': False,
+        'with_replication': False,
+        'with_can': False,
+        'with_mqtt': False,
+        'with_protocol': False,
         'fmt/*:header_only': True,
     }
 
@@ -68,6 +82,13 @@ class DataLayerGeneratorConan(ConanFile):
         tc.variables['ENABLE_PYBIND11'] = False
         tc.variables['ENABLE_FMT'] = self.options.with_fmt
         tc.variables['ENABLE_FILE_PERSISTENCE'] = self.options.with_file_persistence
+        tc.variables['ENABLE_STORAGE_PERSISTENCE'] = self.options.with_storage_persistence
+        tc.variables['ENABLE_TRACE'] = self.options.with_trace
+        tc.variables['ENABLE_SHARED_MEMORY'] = self.options.with_shared_memory
+        tc.variables['ENABLE_REPLICATION'] = self.options.with_replication
+        tc.variables['ENABLE_CAN'] = self.options.with_can
+        tc.variables['ENABLE_MQTT'] = self.options.with_mqtt
+        tc.variables['ENABLE_PROTOCOL'] = self.options.with_protocol
         tc.generate()
         deps = CMakeDeps(self)
         deps.generate()
@@ -100,3 +121,17 @@ class DataLayerGeneratorConan(ConanFile):
             self.cpp_info.defines.append('USE_FMT')
         if self.options.with_file_persistence:
             self.cpp_info.defines.append('USE_FILE_PERSISTENCE')
+        if self.options.with_storage_persistence:
+            self.cpp_info.defines.append('USE_STORAGE_PERSISTENCE')
+        if self.options.with_trace:
+            self.cpp_info.defines.append('USE_TRACE')
+        if self.options.with_shared_memory:
+            self.cpp_info.defines.append('USE_SHARED_MEMORY')
+        if self.options.with_replication:
+            self.cpp_info.defines.append('USE_REPLICATION')
+        if self.options.with_can:
+            self.cpp_info.defines.append('USE_CAN')
+        if self.options.with_mqtt:
+            self.cpp_info.defines.append('USE_MQTT')
+        if self.options.with_protocol:
+            self.cpp_info.defines.append('USE_PROTOCOL')
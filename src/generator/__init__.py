@@ -5,5 +5,5 @@ import sys
 
 sys.path.append(os.path.dirname(os.path.realpath(__file__)))
 from constants import BASE_TYPES, BASE_ACCESS, SUPPORTED_PERSISTENCE  # noqa
-from validators import enum_validator, group_validator, struct_validator, data_point_validator, type_validator  # noqa
-from validatorException import EnumException, GroupException, StructException, DatapointException, TypeException  # noqa
+from validators import enum_validator, group_validator, struct_validator, data_point_validator, type_validator, packed_validator, can_message_validator  # noqa
+from validatorException import EnumException, GroupException, StructException, DatapointException, TypeException, CanMessageException  # noqa
@@ -3,5 +3,13 @@
 BASE_TYPES = ['uint8_t', 'uint16_t', 'uint32_t', 'int8_t', 'int16_t', 'int32_t', 'float', 'double', 'bool', 'uint64_t', 'int64_t', 'std::string_view']
 PREFIX_MAP = {'uint8_t': '', 'uint16_t': '', 'uint32_t': '', 'int8_t': '', 'int16_t': '', 'int32_t': '', 'float': 'F',
               'double': '', 'uint64_t': '', 'int64_t': '', 'bool': '', 'std::string_view': 'sv'}
+BASE_TYPE_SIZES = {'uint8_t': 1, 'int8_t': 1, 'uint16_t': 2, 'int16_t': 2, 'uint32_t': 4, 'int32_t': 4, 'float': 4,
+                   'double': 8, 'uint64_t': 8, 'int64_t': 8}
+STRING_TYPE = 'string'
+MAX_STRING_CAPACITY = 65535
+CAN_MESSAGE_LENGTHS = [0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64]
+MAX_CAN_IDENTIFIER = 0x1FFFFFFF
+FLOW_CONTROL_FLAG = 0x10000000
+CAN_FRAME_PAYLOAD = 8
 SUPPORTED_PERSISTENCE = ['None', 'Cyclic', 'OnWrite']
 BASE_ACCESS = ['READ_ONLY', 'WRITE_ONLY', 'READ_WRITE']
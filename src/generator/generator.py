@@ -7,8 +7,9 @@ import argparse
 import yaml
 from yaml.loader import SafeLoader
 from jinja2 import Environment, FileSystemLoader
-from constants import PREFIX_MAP
-from validators import enum_validator, struct_validator, group_validator, data_point_validator, type_validator
+from constants import PREFIX_MAP, BASE_TYPE_SIZES, FLOW_CONTROL_FLAG, CAN_FRAME_PAYLOAD
+from validators import enum_validator, struct_validator, group_validator, data_point_validator, type_validator, packed_validator, \
+    can_message_validator
 from umlGenerator import generate_uml
 from overviewGenerator import generate_overview
 
@@ -42,11 +43,12 @@ def validate_json(model_data, schema):
     jsonschema.validate(instance=model_data, schema=schema)
 
 
-def create_group_data_point_dict(dps):
+def create_group_data_point_dict(dps, groups=()):
     """
     Create a dictionary which will have group and data points belong to this group.
 
     :param dps: list of all data points
+    :param groups: list of validated groups, the packed store of a group is added to its mapping
     :return: group data point mapping.
     """
     temp = dict()
@@ -58,6 +60,9 @@ def create_group_data_point_dict(dps):
         if 'namespace' in dp and len(dp['namespace']) > 0:
             name = '{}::{}'.format(dp['namespace'], name)
         temp[group].append(name)
+    for group in groups:
+        if group.get('packed') and group['name'] in temp:
+            temp[group['name']].append(group['packed']['name'])
     return temp
 
 
@@ -80,6 +85,243 @@ def create_rtt_datapoints(data_points, groups, enums, types):
     return rtt_datapoints
 
 
+def acceptance_filters(identifiers, width=29):
+    """
+    Cover exactly the given identifiers with identifier/mask pairs, a set mask bit must match.
+
+    Prime implicants are found by merging pairs that differ in one bit (Quine-McCluskey), essential and then
+    the widest remaining implicants are picked until every identifier is covered.
+
+    :param identifiers: identifiers to admit
+    :param width: identifier width in bits
+    :return: sorted list of (identifier, mask) tuples
+    """
+    full_mask = (1 << width) - 1
+    cubes = {(identifier, full_mask) for identifier in identifiers}
+    primes = set()
+    while cubes:
+        merged = set()
+        used = set()
+        for value, mask in cubes:
+            for bit in range(width):
+                flag = 1 << bit
+                if mask & flag and not value & flag and (value | flag, mask) in cubes:
+                    merged.add((value, mask & ~flag))
+                    used.update({(value, mask), (value | flag, mask)})
+        primes |= cubes - used
+        cubes = merged
+
+    def covered(cube):
+        value, mask = cube
+        free = [1 << bit for bit in range(width) if not mask & (1 << bit)]
+        result = {value}
+        for flag in free:
+            result |= {item | flag for item in result}
+        return result
+
+    covers = {prime: covered(prime) for prime in sorted(primes)}
+    remaining = set(identifiers)
+    chosen = []
+    for identifier in sorted(remaining):
+        owners = [prime for prime, members in covers.items() if identifier in members]
+        if len(owners) == 1 and owners[0] not in chosen:
+            chosen.append(owners[0])
+    for prime in chosen:
+        remaining -= covers[prime]
+    while remaining:
+        best = max(covers, key=lambda prime: (len(covers[prime] & remaining), -prime[0]))
+        chosen.append(best)
+        remaining -= covers[best]
+    return sorted(chosen)
+
+
+def maximum_payload(data_point, structs, enums, types):
+    """
+    Return the largest wire payload of a datapoint value in bytes, as Wire::MaximumPayload computes it.
+
+    :param data_point: validated datapoint definition
+    :param structs: list of validated struct definitions
+    :param enums: list of validated enum definitions
+    :param types: list of validated type definitions
+    :return: payload size in bytes, the capacity for strings
+    """
+    if data_point.get('capacity', 0) > 0:
+        return data_point['capacity']
+    struct_fields = {struct['name']: struct['parameter'] for struct in structs}
+    enum_types = {enum['name']: enum['type'] for enum in enums}
+    aliases = {data_type['name']: data_type for data_type in types}
+
+    def size(type_name):
+        if type_name in struct_fields:
+            return sum(size(field.value) for field in struct_fields[type_name])
+        if type_name in enum_types:
+            return BASE_TYPE_SIZES[enum_types[type_name]]
+        if type_name in aliases:
+            alias = aliases[type_name]
+            return (alias['bits'] + 7) // 8 if alias.get('bits') is not None else size(alias['type'])
+        return BASE_TYPE_SIZES.get(type_name, 1)
+
+    return size(data_point['type']) * max(data_point.get('arraySize', 0), 1)
+
+
+def create_can_filters(data_points, groups, can_messages, structs, enums, types):
+    """
+    Return acceptance filters and the software bitmap for the frame identifiers a node has to receive.
+
+    Writable datapoints are admitted with their current and legacy IDs, messages when one signal is writable.
+    Readable datapoints whose value may exceed a classic CAN frame are published segmented, their flow control
+    identifier is admitted as well.
+
+    :param data_points: list of validated data points definitions
+    :param groups: list of validated group definitions
+    :param can_messages: list of validated CAN message definitions
+    :param structs: list of validated struct definitions
+    :param enums: list of validated enum definitions
+    :param types: list of validated type definitions
+    :return: dictionary with filters, bitmap segments and words, and messages
+    """
+    base_ids = {group['name']: int(group['baseId'], 0) for group in groups}
+    writable = {f"{dp['namespace']}::{dp['name']}" if dp['namespace'] else dp['name']: dp
+                for dp in data_points if dp['access'] != 'READ_ONLY'}
+    flow_control = {FLOW_CONTROL_FLAG | (base_ids[dp['group']] + dp['id']) for dp in data_points
+                    if dp['access'] != 'WRITE_ONLY' and maximum_payload(dp, structs, enums, types) > CAN_FRAME_PAYLOAD}
+    identifiers = sorted({base_ids[dp['group']] + dp_id for dp in writable.values() for dp_id in [dp['id']] + dp['renamedFrom']}
+                         | flow_control)
+    messages = sorted(message['identifier'] for message in can_messages
+                      if any(signal['datapoint'] in writable for signal in message['signals']))
+    segments = []
+    words = []
+    for identifier in identifiers:
+        # a gap of more than eight empty words starts a new segment, so distant group base IDs stay cheap
+        if not segments or identifier - segments[-1]['first'] >= 32 * (segments[-1]['words'] + 8):
+            segments.append({'first': identifier & ~31, 'offset': len(words), 'words': 0})
+        segment = segments[-1]
+        index = (identifier - segment['first']) // 32
+        while segment['words'] <= index:
+            words.append(0)
+            segment['words'] += 1
+        words[segment['offset'] + index] |= 1 << ((identifier - segment['first']) % 32)
+    return {'filters': acceptance_filters(identifiers + messages), 'segments': segments, 'words': words, 'messages': messages}
+
+
+def topic_hash(topic, seed):
+    """Return the seeded 32 bit FNV-1a hash with murmur3 finalizer used by DataLayer::Mqtt::topicHash."""
+    value = (2166136261 ^ seed) & 0xFFFFFFFF
+    for byte in topic.encode():
+        value = ((value ^ byte) * 16777619) & 0xFFFFFFFF
+    value = ((value ^ (value >> 16)) * 0x85EBCA6B) & 0xFFFFFFFF
+    value = ((value ^ (value >> 13)) * 0xC2B2AE35) & 0xFFFFFFFF
+    return value ^ (value >> 16)
+
+
+def perfect_hash(topics):
+    """
+    Return bucket seeds and the slot of every topic for a minimal perfect hash (hash and displace).
+
+    The largest buckets are placed first, each bucket gets the smallest seed that moves all its topics to free slots.
+
+    :param topics: list of unique topics
+    :return: tuple of seeds per bucket, slot count and dictionary topic to slot
+    """
+    if len(set(topics)) != len(topics):
+        raise ValueError('MQTT topics must be unique')
+    bucket_count = max(1, len(topics))
+    slot_count = max(1, len(topics) + len(topics) // 4)
+    buckets = [[] for _ in range(bucket_count)]
+    for topic in topics:
+        buckets[topic_hash(topic, 0) % bucket_count].append(topic)
+    seeds = [0] * bucket_count
+    slots = {}
+    occupied = set()
+    for index in sorted(range(bucket_count), key=lambda bucket: -len(buckets[bucket])):
+        if not buckets[index]:
+            break
+        for seed in range(1, 1 << 24):
+            candidate = {topic: topic_hash(topic, seed) % slot_count for topic in buckets[index]}
+            if len(set(candidate.values())) == len(candidate) and not occupied & set(candidate.values()):
+                seeds[index] = seed
+                slots.update(candidate)
+                occupied.update(candidate.values())
+                break
+        else:
+            raise ValueError(f'no perfect hash seed found for {buckets[index]}')
+    return seeds, slot_count, slots
+
+
+def create_mqtt_topics(data_points):
+    """
+    Return the canonical MQTT topic of every datapoint and the router slots of the writable ones.
+
+    A topic is the group name, the namespace with '::' replaced by '/' and the datapoint name joined by '/'.
+
+    :param data_points: list of validated data points definitions
+    :return: dictionary with topics, bucket seeds and router slots
+    """
+    topics = []
+    for dp in sorted(data_points, key=lambda item: (item['group'], item['namespace'], item['name'])):
+        parts = [dp['group']] + ([dp['namespace'].replace('::', '/')] if dp['namespace'] else []) + [dp['name']]
+        value_type = f"std::array<{dp['type']}, {dp['arraySize']}>" if dp.get('arraySize', 0) > 0 else dp['type']
+        topics.append({'datapoint': f"{dp['namespace']}::{dp['name']}" if dp['namespace'] else dp['name'],
+                       'topic': '/'.join(parts), 'type': value_type, 'writable': dp['access'] != 'READ_ONLY'})
+    writable = [topic for topic in topics if topic['writable']]
+    seeds, slot_count, slots = perfect_hash([topic['topic'] for topic in writable])
+    routes = [None] * slot_count
+    for topic in writable:
+        routes[slots[topic['topic']]] = topic
+    return {'topics': topics, 'seeds': seeds, 'routes': routes}
+
+
+def create_protocol_table(data_points, groups):
+    """
+    Return the datapoints of the protocol ID table sorted by their full ID, the group base ID plus the ID.
+
+    :param data_points: list of validated data points definitions
+    :param groups: list of validated group definitions
+    :return: list of qualified datapoint names
+    """
+    base_ids = {group['name']: int(group['baseId'], 0) for group in groups}
+    entries = sorted(data_points, key=lambda dp: base_ids[dp['group']] + dp['id'])
+    return [f"{dp['namespace']}::{dp['name']}" if dp['namespace'] else dp['name'] for dp in entries]
+
+
+def create_type_fingerprints(data_points, structs, enums, types):
+    """
+    Return a fingerprint of the value type of every datapoint, the FNV-1a hash of a description with the fields
+    of structs, the underlying type and values of enums and the base type of aliases.
+
+    :param data_points: list of validated data points definitions
+    :param structs: list of validated struct definitions
+    :param enums: list of validated enum definitions
+    :param types: list of validated type definitions
+    :return: list of dictionaries with the qualified datapoint name and its fingerprint
+    """
+    struct_fields = {struct['name']: struct['parameter'] for struct in structs}
+    enum_types = {enum['name']: enum for enum in enums}
+    aliases = {data_type['name']: data_type['type'] for data_type in types}
+
+    def describe(type_name):
+        if type_name in struct_fields:
+            fields = ';'.join(f'{describe(field.value)} {field.name}' for field in struct_fields[type_name])
+            return f'{type_name}{{{fields}}}'
+        if type_name in enum_types:
+            enum = enum_types[type_name]
+            values = ','.join(value if isinstance(value, str) else f'{value.name}={value.value}' for value in enum['values'])
+            return f"{type_name}:{enum['type']}{{{values}}}"
+        if type_name in aliases:
+            return f'{type_name}:{aliases[type_name]}'
+        return type_name
+
+    fingerprints = []
+    for dp in data_points:
+        description = describe(dp['type']) + (f"[{dp['arraySize']}]" if dp.get('arraySize', 0) > 0 else '')
+        fingerprint = 2166136261
+        for byte in description.encode():
+            fingerprint = ((fingerprint ^ byte) * 16777619) & 0xFFFFFFFF
+        fingerprints.append({'datapoint': f"{dp['namespace']}::{dp['name']}" if dp['namespace'] else dp['name'],
+                             'fingerprint': fingerprint})
+    return fingerprints
+
+
 def get_args():
     """
     Parse defined args and check for existence.
@@ -111,7 +353,7 @@ def read_model_files(args):
 
     :return: json_data of all JSON files
     """
-    json_data = {'Enums': [], 'Groups': [], 'Structs': [], 'Datapoints': [], 'Types': []}
+    json_data = {'Enums': [], 'Groups': [], 'Structs': [], 'Datapoints': [], 'Types': [], 'CanMessages': []}
     for root, dirs, files in os.walk(f'{args.model_dir}'):
         for name in files:
             tmp_dict = None
@@ -141,6 +383,8 @@ def read_model_files(args):
                 json_data['Datapoints'].extend(tmp_dict['Datapoints'])
             if 'Types' in tmp_dict:
                 json_data['Types'].extend(tmp_dict['Types'])
+            if 'CanMessages' in tmp_dict:
+                json_data['CanMessages'].extend(tmp_dict['CanMessages'])
     return json_data
 
 
@@ -171,8 +415,10 @@ def main(template_file_name, template_formatter_file_name, python_binding_file_n
     groups = group_validator(json_data['Groups'])
     structs, struct_names = struct_validator(json_data['Structs'])
     data_points = data_point_validator(json_data['Datapoints'], struct_names, enums, types)
+    groups = packed_validator(groups, data_points, enums)
+    can_messages = can_message_validator(json_data['CanMessages'], groups, data_points, enums, types)
 
-    group_data_points_mapping = create_group_data_point_dict(data_points)
+    group_data_points_mapping = create_group_data_point_dict(data_points, groups)
 
     if args.check:
         report = {
@@ -182,6 +428,7 @@ def main(template_file_name, template_formatter_file_name, python_binding_file_n
             'structs': len(structs),
             'enums': len(enums),
             'types': len(types),
+            'canMessages': len(can_messages),
         }
         print(json.dumps(report, sort_keys=True))
         return
@@ -194,7 +441,11 @@ def main(template_file_name, template_formatter_file_name, python_binding_file_n
 
     template = env.get_template(template_file_name)
     output = template.render(enums=enums, groups=groups, structs=structs, data_points=data_points,
-                             group_data_points_mapping=group_data_points_mapping, prefix_map=PREFIX_MAP, types=types)
+                             group_data_points_mapping=group_data_points_mapping, prefix_map=PREFIX_MAP, types=types,
+                             can_messages=can_messages, can_filters=create_can_filters(data_points, groups, can_messages, structs, enums, types),
+                             mqtt=create_mqtt_topics(data_points),
+                             protocol_table=create_protocol_table(data_points, groups),
+                             type_fingerprints=create_type_fingerprints(data_points, structs, enums, types))
     with open(f'{args.out_dir}{GENERATED_FOLDER}/datalayer.h', 'w') as f:
         f.write(output)
 
@@ -214,10 +465,16 @@ def main(template_file_name, template_formatter_file_name, python_binding_file_n
         f.write(output)
 
     template = env.get_template('rtt.py.jinja2')
-    output = template.render(rtt_datapoints=create_rtt_datapoints(data_points, groups, enums, types))
+    output = template.render(rtt_datapoints=create_rtt_datapoints(data_points, groups, enums, types),
+                             module_name=args.module_name)
     with open(f'{args.out_dir}{PYTHON_FOLDER}/rtt.py', 'w', encoding='utf-8') as f:
         f.write(output)
 
+    template = env.get_template('dbc.jinja2')
+    output = template.render(can_messages=can_messages)
+    with open(f'{args.out_dir}{DOC_FOLDER}/datalayer.dbc', 'w', encoding='utf-8') as f:
+        f.write(output)
+
     generate_uml(enums=enums, structs=structs, datapoints=data_points, types=types,
                  out_dir=f'{args.out_dir}/{DOC_FOLDER}')
 
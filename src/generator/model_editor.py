@@ -12,13 +12,17 @@ from jsonschema import ValidationError
 if __package__:
     from .constants import BASE_ACCESS, BASE_TYPES, SUPPORTED_PERSISTENCE
     from .generator import read_model_files, validate_json
-    from .validatorException import DatapointException, EnumException, GroupException, StructException, TypeException
-    from .validators import data_point_validator, enum_validator, group_validator, struct_validator, type_validator
+    from .validatorException import CanMessageException, DatapointException, EnumException, GroupException, StructException, \
+        TypeException
+    from .validators import can_message_validator, data_point_validator, enum_validator, group_validator, struct_validator, \
+        type_validator
 else:
     from constants import BASE_ACCESS, BASE_TYPES, SUPPORTED_PERSISTENCE
     from generator import read_model_files, validate_json
-    from validatorException import DatapointException, EnumException, GroupException, StructException, TypeException
-    from validators import data_point_validator, enum_validator, group_validator, struct_validator, type_validator
+    from validatorException import CanMessageException, DatapointException, EnumException, GroupException, StructException, \
+        TypeException
+    from validators import can_message_validator, data_point_validator, enum_validator, group_validator, struct_validator, \
+        type_validator
 
 SECTION_FILENAMES = {
     'Enums': 'enums.json',
@@ -26,6 +30,7 @@ SECTION_FILENAMES = {
     'Structs': 'structs.json',
     'Datapoints': 'datapoints.json',
     'Types': 'types.json',
+    'CanMessages': 'canMessages.json',
 }
 SECTIONS = tuple(SECTION_FILENAMES)
 
@@ -61,8 +66,9 @@ def validate_model(model, schema):
         types = type_validator(candidate['Types'])
         groups = group_validator(candidate['Groups'])
         _, struct_names = struct_validator(candidate['Structs'])
-        data_point_validator(candidate['Datapoints'], struct_names, enums, types)
-    except (DatapointException, EnumException, GroupException, StructException, TypeException, ValidationError, ValueError) as error:
+        data_points = data_point_validator(candidate['Datapoints'], struct_names, enums, types)
+        can_message_validator(candidate['CanMessages'], groups, data_points, enums, types)
+    except (CanMessageException, DatapointException, EnumException, GroupException, StructException, TypeException, ValidationError, ValueError) as error:
         return {'valid': False, 'error': str(error)}
     return {
         'valid': True,
@@ -72,6 +78,7 @@ def validate_model(model, schema):
             'structs': len(candidate['Structs']),
             'enums': len(enums),
             'types': len(types),
+            'canMessages': len(candidate['CanMessages']),
         },
     }
 
@@ -29,3 +29,9 @@ class TypeException(Exception):
     """User defined exception for faulty type definitions."""
 
     pass
+
+
+class CanMessageException(Exception):
+    """User defined exception for faulty CAN message definitions."""
+
+    pass
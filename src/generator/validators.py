@@ -1,6 +1,10 @@
 """This module whols all defined validators for enum, group, struct and data points."""
-from constants import BASE_ACCESS, BASE_TYPES, SUPPORTED_PERSISTENCE, PREFIX_MAP
-from validatorException import EnumException, StructException, GroupException, DatapointException, TypeException
+import math
+
+from constants import BASE_ACCESS, BASE_TYPES, BASE_TYPE_SIZES, SUPPORTED_PERSISTENCE, PREFIX_MAP, STRING_TYPE, MAX_STRING_CAPACITY, \
+    CAN_MESSAGE_LENGTHS, MAX_CAN_IDENTIFIER, FLOW_CONTROL_FLAG
+from validatorException import EnumException, StructException, GroupException, DatapointException, TypeException, \
+    CanMessageException
 
 
 class ParameterList:
@@ -175,6 +179,52 @@ def validate_data_default_struct(default=None):
     default['string'] = str(ParameterList(default))
 
 
+def validate_string_capacity(name, data_point):
+    """
+    Check the capacity of a string datapoint and map it to the inline string type.
+
+    :param name: qualified datapoint name used in error messages
+    :param data_point: datapoint definition with type 'string'
+    """
+    capacity = data_point.get('capacity', 0)
+    if isinstance(capacity, bool) or not isinstance(capacity, int) or not 0 < capacity <= MAX_STRING_CAPACITY:
+        raise DatapointException(f"String datapoint '{name}' needs a capacity between 1 and {MAX_STRING_CAPACITY}")
+    if 'default' in data_point:
+        default = data_point['default']
+        if not isinstance(default, str) or len(default.encode()) > capacity:
+            raise DatapointException(f"Default of string datapoint '{name}' does not fit its capacity of {capacity}")
+    data_point['type'] = f'DataLayer::InlineString<{capacity}>'
+
+
+def validate_publish_policy(name, data_point, custom_type):
+    """
+    Check the publish scheduling fields of a datapoint and collect them in data_point['publish'].
+
+    Intervals are milliseconds, 0 disables them. Deadbands need a numeric scalar or custom type.
+
+    :param name: qualified datapoint name used in error messages
+    :param data_point: datapoint definition
+    :param custom_type: dictionary of available custom-made types
+    """
+    fields = {'minInterval': 0, 'maxInterval': 0, 'deadband': 0, 'relativeDeadband': 0}
+    if not any(field in data_point for field in fields):
+        data_point['publish'] = None
+        return
+    for field in fields:
+        value = data_point.get(field, 0)
+        integral = field.endswith('Interval')
+        if isinstance(value, bool) or not isinstance(value, int if integral else (int, float)) or value < 0 \
+                or (integral and value > 0xFFFFFFFF) or (not integral and not math.isfinite(value)):
+            raise DatapointException(f"Datapoint '{name}' needs a non-negative {'integer ' if integral else ''}{field}")
+        fields[field] = value
+    if 0 < fields['maxInterval'] < fields['minInterval']:
+        raise DatapointException(f"Datapoint '{name}' has a maxInterval below its minInterval")
+    numeric = data_point['type'] in BASE_TYPE_SIZES or data_point['type'] in [i['name'] for i in custom_type]
+    if (fields['deadband'] or fields['relativeDeadband']) and (not numeric or data_point['arraySize'] > 0):
+        raise DatapointException(f"Datapoint '{name}' has a deadband but is not a numeric scalar")
+    data_point['publish'] = fields
+
+
 def data_point_validator(data_point_data, struct_list, enum_list, custom_type):
     """
     Check the given data point for consistency and if given struct is defined.
@@ -204,9 +254,13 @@ def data_point_validator(data_point_data, struct_list, enum_list, custom_type):
         check_names[name] = None
         if access not in BASE_ACCESS:
             raise DatapointException(f"Datapoint access type '{access}' is not supported")
-        if (dp_type not in BASE_TYPES and dp_type not in struct_list and dp_type not in [i['name'] for i in enum_list]
+        if (dp_type != STRING_TYPE and dp_type not in BASE_TYPES and dp_type not in struct_list and dp_type not in [i['name'] for i in enum_list]
                 and dp_type not in [i['name'] for i in custom_type]):
             raise DatapointException(f"Datapoint type '{dp_type}' is not supported")
+        if dp_type == STRING_TYPE:
+            validate_string_capacity(name, temp_dp)
+        else:
+            temp_dp['capacity'] = 0
         if 'default' in temp_dp:
             validate_data_default_struct(temp_dp['default'])
         if group not in group_id:
@@ -233,10 +287,107 @@ def data_point_validator(data_point_data, struct_list, enum_list, custom_type):
             temp_dp['allowUpgrade'] = 'true'
         else:
             temp_dp['allowUpgrade'] = 'false'
+        validate_publish_policy(name, temp_dp, custom_type)
         group_id[group].append(dp_id)
     return data_point_data
 
 
+def enum_bit_width(enum):
+    """
+    Return the number of bits needed for the values of an enumeration.
+
+    :param enum: validated enum definition
+    :return: bit width or None if the enum has negative values or needs more than 8 bits
+    """
+    if 'autoId' in enum and enum['autoId']:
+        values = list(range(len(enum['values'])))
+    else:
+        values = [value.value for value in enum['values']]
+    if len(values) == 0 or any(not isinstance(value, int) or value < 0 for value in values):
+        return None
+    width = max(max(values).bit_length(), 1)
+    return width if width <= 8 else None
+
+
+def packed_validator(group_data, data_point_data, enum_data):
+    """
+    Place the bool and small enum datapoints of groups with a packedId into one bitfield store per group.
+
+    Fields are allocated in datapoint id order and never cross a 32 bit word. Arrays and datapoints with a
+    migration keep their own storage.
+
+    :param group_data: list of validated group definitions
+    :param data_point_data: list of validated data points definitions
+    :param enum_data: list of validated enum definitions
+    :return: given group_data
+    """
+    enum_widths = {enum['name']: enum_bit_width(enum) for enum in enum_data}
+    for temp_dp in data_point_data:
+        temp_dp['packed'] = None
+    for temp_group in group_data:
+        temp_group['packed'] = None
+        if 'packedId' not in temp_group:
+            continue
+        name = temp_group['name']
+        packed_id = temp_group['packedId']
+        members = [dp for dp in data_point_data if dp['group'] == name]
+        used_ids = {dp['id'] for dp in members} | {legacy for dp in members for legacy in dp['renamedFrom']}
+        if packed_id in used_ids:
+            raise GroupException(f"Group '{name}' packedId '{packed_id}' is already used by a datapoint")
+        offset = 0
+        fields = []
+        for temp_dp in sorted(members, key=lambda dp: dp['id']):
+            width = 1 if temp_dp['type'] == 'bool' else enum_widths.get(temp_dp['type'])
+            if width is None or temp_dp['arraySize'] > 0 or temp_dp['migration']:
+                continue
+            if offset % 32 + width > 32:
+                offset += 32 - offset % 32
+            if 'default' not in temp_dp:
+                initial = '0'
+            elif temp_dp['type'] == 'bool':
+                initial = '1' if temp_dp['default'] else '0'
+            else:
+                initial = f"static_cast<uint32_t>({temp_dp['type']}::{temp_dp['default']})"
+            temp_dp['packed'] = {'store': f'{name}Packed', 'offset': offset, 'width': width}
+            fields.append({'id': temp_dp['id'], 'offset': offset, 'width': width, 'initial': initial})
+            offset += width
+        if len(fields) == 0:
+            raise GroupException(f"Group '{name}' has a packedId but no bool or small enum datapoints")
+        temp_group['packed'] = {'id': packed_id, 'name': f'{name}Packed', 'bits': offset, 'fields': fields}
+    return group_data
+
+
+def validate_quantization(type_definition):
+    """
+    Check scale, offset and bits of a quantized type and derive missing range bounds from them.
+
+    :param type_definition: type definition with at least one of scale, offset or bits
+    """
+    name = type_definition['name']
+    if 'scale' not in type_definition or 'bits' not in type_definition:
+        raise TypeException(f"Quantized type '{name}' needs scale and bits")
+    base_size = BASE_TYPE_SIZES.get(type_definition['type'])
+    bits = type_definition['bits']
+    if base_size is None or bits > 8 * (base_size - 1):
+        raise TypeException(f"Quantized type '{name}' needs fewer whole bytes than '{type_definition['type']}'")
+    scale = type_definition['scale']
+    if not scale > 0:
+        raise TypeException(f"Quantized type '{name}' needs a positive scale")
+    offset = type_definition.setdefault('offset', 0)
+    lowest = offset
+    highest = offset + scale * ((1 << bits) - 1)
+    if type_definition['type'] not in ('float', 'double'):
+        lowest = math.ceil(lowest)
+        highest = math.floor(highest)
+    if type_definition['min'] is None:
+        type_definition['min'] = lowest
+    if type_definition['max'] is None:
+        type_definition['max'] = highest
+    tolerance = scale / 2
+    if type_definition['min'] < lowest - tolerance or type_definition['max'] > highest + tolerance:
+        raise TypeException(f"Range of quantized type '{name}' exceeds {lowest} to {highest}")
+
+
 def type_validator(type_data):
     """
     Check the given type data for consistency and duplication.
@@ -262,4 +413,115 @@ def type_validator(type_data):
                 raise TypeException(f"Min and Max are equal! max({temp_group['max']}) and min({temp_group['min']})")
             elif temp_group['min'] > temp_group['max']:
                 raise TypeException(f"For min and max wrong: max({temp_group['max']}) and min({temp_group['min']})")
+        if 'scale' in temp_group or 'offset' in temp_group or 'bits' in temp_group:
+            validate_quantization(temp_group)
+        else:
+            temp_group['bits'] = None
     return type_data
+
+
+def can_signal_encoding(data_point, enums, types):
+    """
+    Return the natural bit width, signedness, scaling and value names of a datapoint used as CAN signal.
+
+    :param data_point: validated datapoint definition
+    :param enums: validated enum definitions by name
+    :param types: validated type definitions by name
+    :return: dictionary with width, signed, factor, offset and values or None if the type can not be a signal
+    """
+    encoding = {'signed': False, 'factor': 1, 'offset': 0, 'values': []}
+    dp_type = data_point['type']
+    if data_point['arraySize'] > 0 or data_point['capacity'] > 0:
+        return None
+    if dp_type == 'bool':
+        return dict(encoding, width=1)
+    if dp_type in enums:
+        enum = enums[dp_type]
+        if enum['autoId']:
+            encoding['values'] = list(enumerate(enum['values']))
+        else:
+            encoding['values'] = [(value.value, value.name) for value in enum['values']]
+        # enums with non-negative values up to 8 bits are unsigned signals of their bit width
+        compact_width = enum_bit_width(enum)
+        if compact_width is not None:
+            return dict(encoding, width=compact_width)
+        return dict(encoding, width=8 * BASE_TYPE_SIZES[enum['type']], signed=enum['type'].startswith('int'))
+    if dp_type in types:
+        alias = types[dp_type]
+        if alias['bits'] is not None:
+            return dict(encoding, width=alias['bits'], factor=alias['scale'], offset=alias['offset'])
+        dp_type = alias['type']
+    if dp_type in ('float', 'double') or dp_type not in BASE_TYPE_SIZES:
+        return None
+    return dict(encoding, width=8 * BASE_TYPE_SIZES[dp_type], signed=dp_type.startswith('int'))
+
+
+def can_message_validator(message_data, group_data, data_point_data, enum_data, type_data):
+    """
+    Check the CAN messages and resolve the datapoint, bit position and encoding of every signal.
+
+    Signals use little endian bit numbering. Only bool, integer, enum and integer or quantized alias datapoints
+    can be signals, a signal length below the natural width of the type truncates the value.
+
+    :param message_data: list of all CAN message definitions
+    :param group_data: list of validated group definitions
+    :param data_point_data: list of validated data points definitions
+    :param enum_data: list of validated enum definitions
+    :param type_data: list of validated type definitions
+    :return: given message_data
+    """
+    enums = {enum['name']: enum for enum in enum_data}
+    types = {data_type['name']: data_type for data_type in type_data}
+    base_ids = {group['name']: int(group['baseId'], 0) for group in group_data}
+    data_points = dict()
+    data_point_ids = set()
+    for temp_dp in data_point_data:
+        name = f"{temp_dp['namespace']}::{temp_dp['name']}" if temp_dp['namespace'] else temp_dp['name']
+        data_points[name] = temp_dp
+        data_point_ids.update(base_ids[temp_dp['group']] + dp_id for dp_id in [temp_dp['id']] + temp_dp['renamedFrom'])
+    check_names = dict()
+    check_identifiers = dict()
+    for temp_message in message_data:
+        name = temp_message['name']
+        if name in check_names:
+            raise CanMessageException(f"CAN message name '{name}' already defined, please check your model")
+        check_names[name] = None
+        identifier = int(temp_message['identifier'], 0)
+        if not 0 <= identifier <= MAX_CAN_IDENTIFIER:
+            raise CanMessageException(f"CAN message '{name}' identifier '{temp_message['identifier']}' is out of range")
+        if identifier in check_identifiers or identifier in data_point_ids:
+            raise CanMessageException(f"CAN message '{name}' identifier '{temp_message['identifier']}' is already used")
+        if identifier & FLOW_CONTROL_FLAG and identifier & ~FLOW_CONTROL_FLAG in data_point_ids:
+            raise CanMessageException(f"CAN message '{name}' identifier '{temp_message['identifier']}' is the flow control "
+                                      f"identifier of a datapoint")
+        check_identifiers[identifier] = None
+        temp_message['identifier'] = identifier
+        temp_message['extended'] = identifier > 0x7FF
+        if temp_message['length'] not in CAN_MESSAGE_LENGTHS:
+            raise CanMessageException(f"CAN message '{name}' length '{temp_message['length']}' is not a CAN or CAN FD length")
+        if 'description' not in temp_message:
+            temp_message['description'] = None
+        used_bits = set()
+        for temp_signal in temp_message['signals']:
+            dp_name = temp_signal['datapoint']
+            if dp_name not in data_points:
+                raise CanMessageException(f"CAN message '{name}' signal datapoint '{dp_name}' is not defined")
+            encoding = can_signal_encoding(data_points[dp_name], enums, types)
+            if encoding is None:
+                raise CanMessageException(f"Datapoint '{dp_name}' of type '{data_points[dp_name]['type']}' can not be a CAN signal")
+            length = temp_signal.setdefault('length', encoding['width'])
+            if not 0 < length <= encoding['width']:
+                raise CanMessageException(f"CAN signal '{dp_name}' length '{length}' exceeds its type width {encoding['width']}")
+            bits = set(range(temp_signal['startBit'], temp_signal['startBit'] + length))
+            if max(bits) >= 8 * temp_message['length']:
+                raise CanMessageException(f"CAN signal '{dp_name}' does not fit message '{name}'")
+            if bits & used_bits:
+                raise CanMessageException(f"CAN signal '{dp_name}' overlaps another signal of message '{name}'")
+            used_bits |= bits
+            raw_minimum = -(1 << (length - 1)) if encoding['signed'] else 0
+            raw_maximum = (1 << (length - 1)) - 1 if encoding['signed'] else (1 << length) - 1
+            temp_signal.update(encoding)
+            temp_signal['name'] = data_points[dp_name]['name']
+            temp_signal['minimum'] = raw_minimum * encoding['factor'] + encoding['offset']
+            temp_signal['maximum'] = raw_maximum * encoding['factor'] + encoding['offset']
+    return message_data
@@ -1,80 +1,248 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <canBus.h>
+#include <canSignal.h>
 #include <cstddef>
 #include <cstdint>
-#include <cstring>
 #include <dispatcher.h>
+#include <isoTp.h>
 #include <span>
 #include <type_traits>
+#include <wireCodec.h>
 
 namespace DataLayer::Can
 {
-    inline constexpr size_t StandardPayloadSize = 8;
-    inline constexpr size_t MaximumPayloadSize = 64;
-
     enum class Result : uint8_t
     {
         ok,
         sendFailed,
         payloadTooLarge,
         invalidPayload,
-        rejected
-    };
-
-    struct Frame
-    {
-        uint32_t identifier{};
-        uint8_t length{};
-        std::array<std::byte, MaximumPayloadSize> payload{};
-    };
-
-    class Bus
-    {
-      public:
-        virtual ~Bus() = default;
-        virtual bool send(const Frame &frame) noexcept = 0;
+        rejected,
+        pending,
+        busy
     };
 
-    template<typename DispatcherType, size_t PayloadCapacity = StandardPayloadSize>
+    // Values larger than one frame are segmented with ISO-TP framing once MessageCapacity exceeds the frame
+    // payload, Sessions bounds the messages in flight per direction. The defaults keep single frame transport.
+    template<typename DispatcherType, size_t PayloadCapacity = StandardPayloadSize, size_t MessageCapacity = PayloadCapacity, size_t Sessions = 1>
     class Adapter
     {
         static_assert(PayloadCapacity > 0 && PayloadCapacity <= MaximumPayloadSize);
+        static_assert(MessageCapacity >= PayloadCapacity && MessageCapacity <= IsoTp::MaximumMessageSize);
+
+        static constexpr bool Segmentation = MessageCapacity > PayloadCapacity;
+
+        // always sent with ISO-TP framing, even when the current value would fit a single frame
+        template<typename T>
+        static constexpr bool Segmented = Segmentation && Wire::MaximumPayload<T> > PayloadCapacity && Wire::MaximumPayload<T> <= MessageCapacity;
+
+        struct Disabled
+        {};
 
       public:
         constexpr Adapter(Bus &bus, DispatcherType &dispatcher) noexcept : m_bus(bus), m_dispatcher(dispatcher)
         {}
 
+        // pending once the first frame of a segmented value is sent, busy while no send session is free
         template<typename T>
         [[nodiscard]] Result publish(uint32_t identifier, const T &value) noexcept
         {
             static_assert(std::is_trivially_copyable_v<T>, "CAN transport requires a trivially copyable value");
-            if constexpr (sizeof(T) > PayloadCapacity)
+            if constexpr (Segmented<T>)
+            {
+                if constexpr (VariableSize<T>)
+                {
+                    return result(m_sender.start(m_bus, identifier, value.bytes(), IsoTp::flowControlIdentifier(identifier)));
+                }
+                else
+                {
+                    std::array<std::byte, Wire::PayloadSize<T>> message{};
+                    Wire::encode(value, std::span{ message });
+                    return result(m_sender.start(m_bus, identifier, message, IsoTp::flowControlIdentifier(identifier)));
+                }
+            }
+            else if constexpr (VariableSize<T>)
+            {
+                // the frame length carries the used size
+                const auto bytes = value.bytes();
+                if (bytes.size() > PayloadCapacity)
+                {
+                    return Result::payloadTooLarge;
+                }
+                Frame frame{ .identifier = identifier, .length = static_cast<uint8_t>(bytes.size()) };
+                std::ranges::copy(bytes, frame.payload.begin());
+                return m_bus.update(frame) ? Result::ok : Result::sendFailed;
+            }
+            else if constexpr (Wire::PayloadSize<T> > PayloadCapacity)
             {
                 return Result::payloadTooLarge;
             }
-
-            Frame frame{ .identifier = identifier, .length = static_cast<uint8_t>(sizeof(T)) };
-            std::memcpy(frame.payload.data(), &value, sizeof(T));
-            return m_bus.send(frame) ? Result::ok : Result::sendFailed;
+            else
+            {
+                Frame frame{ .identifier = identifier, .length = static_cast<uint8_t>(Wire::PayloadSize<T>) };
+                Wire::encode(value, std::span{ frame.payload }.template first<Wire::PayloadSize<T>>());
+                return m_bus.update(frame) ? Result::ok : Result::sendFailed;
+            }
         }
 
+        // frames of segmented values are reassembled first and flow control frames, received on
+        // IsoTp::flowControlIdentifier() of the datapoint, continue a publish; both report pending until the
+        // value is complete
         template<typename T>
-        [[nodiscard]] Result applySet(const Frame &frame) const noexcept
+        [[nodiscard]] Result applySet(const Frame &frame) noexcept
         {
             static_assert(std::is_trivially_copyable_v<T>, "CAN transport requires a trivially copyable value");
-            if (frame.length != sizeof(T) || frame.length > PayloadCapacity)
+            if constexpr (Segmented<T>)
+            {
+                if (frame.length > 0 && IsoTp::typeOf(frame) == IsoTp::FrameType::flowControl)
+                {
+                    return result(m_sender.onFlowControl(m_bus, frame));
+                }
+                const auto outcome = m_receiver.receive(m_bus, frame, IsoTp::flowControlIdentifier(frame.identifier));
+                if (outcome.status != IsoTp::Status::complete)
+                {
+                    return result(outcome.status);
+                }
+                return apply<T>(frame.identifier, outcome.message);
+            }
+            else
+            {
+                if (frame.length > PayloadCapacity)
+                {
+                    return Result::invalidPayload;
+                }
+                return apply<T>(frame.identifier, std::span<const std::byte>{ frame.payload }.first(frame.length));
+            }
+        }
+
+        // Answers a protocol request with the ID table, e.g. ProtocolTable::Table, on responseIdentifier.
+        // With segmentation requests and answers up to MessageCapacity use ISO-TP framing with the request and
+        // response identifiers as the pair: flow control for the request is sent on responseIdentifier, flow
+        // control for the answer arrives on the request identifier. Every frame of the request identifier is
+        // passed here and reports pending until the answer is complete. Without, both are single frames.
+        template<typename TableType>
+        [[nodiscard]] Result serve(const TableType &table, uint32_t responseIdentifier, const Frame &frame) noexcept
+        {
+            std::array<std::byte, MessageCapacity> answer{};
+            if constexpr (Segmentation)
+            {
+                if (frame.length > 0 && IsoTp::typeOf(frame) == IsoTp::FrameType::flowControl)
+                {
+                    return result(m_sender.onFlowControl(m_bus, frame));
+                }
+                const auto outcome = m_receiver.receive(m_bus, frame, responseIdentifier);
+                if (outcome.status != IsoTp::Status::complete)
+                {
+                    return result(outcome.status);
+                }
+                const auto size = table.respond(outcome.message, answer);
+                return size == 0 ? Result::payloadTooLarge : result(m_sender.start(m_bus, responseIdentifier, std::span{ answer }.first(size), frame.identifier));
+            }
+            else
+            {
+                if (frame.length > PayloadCapacity)
+                {
+                    return Result::invalidPayload;
+                }
+                const auto size = table.respond(std::span<const std::byte>{ frame.payload }.first(frame.length), answer);
+                if (size == 0)
+                {
+                    return Result::payloadTooLarge;
+                }
+                Frame reply{ .identifier = responseIdentifier, .length = static_cast<uint8_t>(size) };
+                std::ranges::copy(std::span{ answer }.first(size), reply.payload.begin());
+                return m_bus.send(reply) ? Result::ok : Result::sendFailed;
+            }
+        }
+
+        // Advances the time in milliseconds. Sends waiting longer than IsoTp::FlowControlTimeout for flow
+        // control are dropped so their identifier can publish again, and partial messages waiting longer than
+        // IsoTp::ConsecutiveFrameTimeout for a consecutive frame free their session. Returns the number of
+        // dropped sends and messages.
+        size_t poll(uint32_t now) noexcept
+        {
+            if constexpr (Segmentation)
+            {
+                return m_sender.poll(now) + m_receiver.poll(now);
+            }
+            else
+            {
+                std::ignore = now;
+                return 0;
+            }
+        }
+
+        // one frame with every signal of a generated message
+        template<typename MessageType>
+        [[nodiscard]] Result publishMessage() noexcept
+        {
+            return m_bus.update(MessageType::pack()) ? Result::ok : Result::sendFailed;
+        }
+
+        // writes all signals of a generated message directly to their datapoints, signals of datapoints
+        // without write access are skipped
+        template<typename MessageType>
+        [[nodiscard]] Result applyMessage(const Frame &frame) const noexcept
+        {
+            if (!MessageType::matches(frame))
             {
                 return Result::invalidPayload;
             }
+            return MessageType::apply(frame) ? Result::ok : Result::rejected;
+        }
 
+      private:
+        template<typename T>
+        [[nodiscard]] Result apply(uint32_t identifier, std::span<const std::byte> payload) const noexcept
+        {
             T value{};
-            std::memcpy(&value, frame.payload.data(), sizeof(T));
-            return m_dispatcher.setDatapoint(frame.identifier, value).success ? Result::ok : Result::rejected;
+            if constexpr (VariableSize<T>)
+            {
+                if (!value.assign(payload))
+                {
+                    return Result::invalidPayload;
+                }
+            }
+            else if constexpr (!Segmented<T> && Wire::PayloadSize<T> > PayloadCapacity)
+            {
+                return Result::invalidPayload;
+            }
+            else
+            {
+                if (payload.size() != Wire::PayloadSize<T>)
+                {
+                    return Result::invalidPayload;
+                }
+                value = Wire::decode<T>(payload.template first<Wire::PayloadSize<T>>());
+            }
+            return m_dispatcher.setDatapoint(identifier, value).success ? Result::ok : Result::rejected;
+        }
+
+        [[nodiscard]] static constexpr Result result(IsoTp::Status status) noexcept
+        {
+            switch (status)
+            {
+                case IsoTp::Status::complete:
+                    return Result::ok;
+                case IsoTp::Status::pending:
+                    return Result::pending;
+                case IsoTp::Status::sendFailed:
+                    return Result::sendFailed;
+                case IsoTp::Status::overflow:
+                    return Result::payloadTooLarge;
+                case IsoTp::Status::busy:
+                    return Result::busy;
+                default:
+                    return Result::invalidPayload;
+            }
         }
 
-      private:
         Bus &m_bus;
         DispatcherType &m_dispatcher;
+        [[no_unique_address]] std::conditional_t<Segmentation, IsoTp::Sender<PayloadCapacity, MessageCapacity, Sessions>, Disabled> m_sender{};
+        [[no_unique_address]] std::conditional_t<Segmentation, IsoTp::Receiver<PayloadCapacity, MessageCapacity, Sessions>, Disabled> m_receiver{};
     };
 }// namespace DataLayer::Can
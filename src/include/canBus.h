@@ -0,0 +1,31 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace DataLayer::Can
+{
+    inline constexpr size_t StandardPayloadSize = 8;
+    inline constexpr size_t MaximumPayloadSize = 64;
+
+    struct Frame
+    {
+        uint32_t identifier{};
+        uint8_t length{};
+        std::array<std::byte, MaximumPayloadSize> payload{};
+    };
+
+    class Bus
+    {
+      public:
+        virtual ~Bus() = default;
+        virtual bool send(const Frame &frame) noexcept = 0;
+
+        // frame carrying a whole value, it may replace a frame of the same identifier that is still pending
+        virtual bool update(const Frame &frame) noexcept
+        {
+            return send(frame);
+        }
+    };
+}// namespace DataLayer::Can
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+namespace DataLayer::Can
+{
+    inline constexpr uint32_t ExtendedIdentifierMask = 0x1FFFFFFF;
+
+    // controller filter bank in identifier/mask form, a frame passes when all bits set in mask match
+    struct AcceptanceFilter
+    {
+        uint32_t identifier{};
+        uint32_t mask{ ExtendedIdentifierMask };
+
+        [[nodiscard]] constexpr bool matches(uint32_t frameIdentifier) const noexcept
+        {
+            return ((frameIdentifier ^ identifier) & mask) == 0U;
+        }
+    };
+
+    // bits of the datapoint IDs from first on, stored at offset in the words of an IdentifierSet
+    struct IdentifierSegment
+    {
+        uint32_t first{};
+        uint16_t offset{};
+        uint16_t words{};
+    };
+
+    // Software fallback behind the controller filters: bitmap segments of the datapoint IDs and a short list of
+    // message identifiers. Generated with the acceptance filters of the model.
+    template<size_t Segments, size_t Words, size_t Messages>
+    struct IdentifierSet
+    {
+        std::array<IdentifierSegment, Segments> segments{};
+        std::array<uint32_t, Words> bits{};
+        std::array<uint32_t, Messages> messages{};
+
+        [[nodiscard]] constexpr bool contains(uint32_t identifier) const noexcept
+        {
+            for (const auto &segment : segments)
+            {
+                // identifiers below first wrap to large offsets
+                const auto offset = identifier - segment.first;
+                if (offset < segment.words * 32U)
+                {
+                    return ((bits[segment.offset + offset / 32U] >> (offset % 32U)) & 1U) != 0U;
+                }
+            }
+            return std::ranges::find(messages, identifier) != messages.end();
+        }
+    };
+
+    // Fits the generated filters into the banks of a controller. The pair whose merge keeps the most mask bits
+    // is merged until the filters fit, so every admitted identifier still passes and the IdentifierSet has to
+    // reject the additional ones.
+    template<size_t Banks, size_t N>
+    [[nodiscard]] consteval auto mergeFilters(const std::array<AcceptanceFilter, N> &filters)
+    {
+        static_assert(Banks > 0);
+        std::array<AcceptanceFilter, N> merged = filters;
+        size_t count = N;
+        while (count > Banks)
+        {
+            size_t left = 0;
+            size_t right = 1;
+            int best = -1;
+            for (size_t first = 0; first < count; ++first)
+            {
+                for (size_t second = first + 1; second < count; ++second)
+                {
+                    const auto mask = merged[first].mask & merged[second].mask & ~(merged[first].identifier ^ merged[second].identifier);
+                    if (std::popcount(mask) > best)
+                    {
+                        best = std::popcount(mask);
+                        left = first;
+                        right = second;
+                    }
+                }
+            }
+            merged[left].mask &= merged[right].mask & ~(merged[left].identifier ^ merged[right].identifier);
+            merged[left].identifier &= merged[left].mask;
+            merged[right] = merged[--count];
+        }
+        std::array<AcceptanceFilter, std::min(Banks, N)> banks{};
+        std::copy_n(merged.begin(), banks.size(), banks.begin());
+        return banks;
+    }
+
+    template<size_t N>
+    [[nodiscard]] constexpr bool accepts(const std::array<AcceptanceFilter, N> &filters, uint32_t identifier) noexcept
+    {
+        return std::ranges::any_of(filters, [identifier](const AcceptanceFilter &filter) { return filter.matches(identifier); });
+    }
+}// namespace DataLayer::Can
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <array>
+#include <canBus.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace DataLayer::Can
+{
+    // Host-side bus pair for tests and benchmarks. Frames sent on one end are queued in the fixed ring of the
+    // connected end until they are received, a full ring drops the frame and fails the send like a full
+    // driver mailbox would.
+    template<size_t Depth = 64>
+    class LoopbackBus final : public Bus
+    {
+        static_assert(Depth > 0);
+
+      public:
+        void connect(LoopbackBus &peer) noexcept
+        {
+            m_peer = &peer;
+            peer.m_peer = this;
+        }
+
+        bool send(const Frame &frame) noexcept override
+        {
+            if (m_peer == nullptr || m_peer->m_count == Depth)
+            {
+                ++m_dropped;
+                return false;
+            }
+            m_peer->m_frames[(m_peer->m_head + m_peer->m_count) % Depth] = frame;
+            ++m_peer->m_count;
+            ++m_sent;
+            return true;
+        }
+
+        // false while no frame is queued
+        [[nodiscard]] bool receive(Frame &frame) noexcept
+        {
+            if (m_count == 0)
+            {
+                return false;
+            }
+            frame = m_frames[m_head];
+            m_head = (m_head + 1U) % Depth;
+            --m_count;
+            return true;
+        }
+
+        [[nodiscard]] size_t pending() const noexcept
+        {
+            return m_count;
+        }
+
+        [[nodiscard]] uint64_t sent() const noexcept
+        {
+            return m_sent;
+        }
+
+        [[nodiscard]] uint64_t dropped() const noexcept
+        {
+            return m_dropped;
+        }
+
+      private:
+        std::array<Frame, Depth> m_frames{};
+        size_t m_head{ 0 };
+        size_t m_count{ 0 };
+        uint64_t m_sent{ 0 };
+        uint64_t m_dropped{ 0 };
+        LoopbackBus *m_peer{ nullptr };
+    };
+}// namespace DataLayer::Can
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <canBus.h>
+#include <cstddef>
+#include <cstdint>
+#include <helper.h>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <wireCodec.h>
+
+namespace DataLayer::Can
+{
+    namespace Detail
+    {
+        // little endian (Intel) bit numbering as in a DBC signal with byte order 1: bit n is bit n % 8 of byte n / 8
+        constexpr void insertBits(std::span<std::byte> payload, size_t start, size_t length, uint64_t raw) noexcept
+        {
+            while (length > 0)
+            {
+                const auto shift = start % 8U;
+                const auto count = std::min<size_t>(8U - shift, length);
+                const auto mask = static_cast<uint8_t>(((1U << count) - 1U) << shift);
+                auto &byte = payload[start / 8U];
+                byte = (byte & static_cast<std::byte>(~mask)) | static_cast<std::byte>((static_cast<uint8_t>(raw) << shift) & mask);
+                raw >>= count;
+                start += count;
+                length -= count;
+            }
+        }
+
+        [[nodiscard]] constexpr uint64_t extractBits(std::span<const std::byte> payload, size_t start, size_t length) noexcept
+        {
+            uint64_t raw = 0;
+            for (size_t position = 0; position < length;)
+            {
+                const auto shift = (start + position) % 8U;
+                const auto count = std::min<size_t>(8U - shift, length - position);
+                const auto bits = (std::to_integer<uint64_t>(payload[(start + position) / 8U]) >> shift) & ((uint64_t{ 1 } << count) - 1U);
+                raw |= bits << position;
+                position += count;
+            }
+            return raw;
+        }
+
+        // two's complement value of a raw signal whose top bit is the sign
+        [[nodiscard]] constexpr uint64_t signExtend(uint64_t raw, size_t length) noexcept
+        {
+            if (length < 64U && (raw >> (length - 1U)) != 0U)
+            {
+                raw |= ~uint64_t{ 0 } << length;
+            }
+            return raw;
+        }
+
+        // raw signal value of the supported datapoint types, quantized aliases use their wire raw value; fromRaw()
+        // gets the raw value already sign extended for signed signals
+        template<typename T>
+        struct SignalValue;
+
+        template<>
+        struct SignalValue<bool>
+        {
+            [[nodiscard]] static constexpr uint64_t toRaw(bool value) noexcept
+            {
+                return value ? 1U : 0U;
+            }
+
+            [[nodiscard]] static constexpr bool fromRaw(uint64_t raw) noexcept
+            {
+                return raw != 0U;
+            }
+        };
+
+        template<typename T>
+            requires std::is_integral_v<T> && (!std::is_same_v<T, bool>)
+        struct SignalValue<T>
+        {
+            [[nodiscard]] static constexpr uint64_t toRaw(T value) noexcept
+            {
+                return static_cast<uint64_t>(value);
+            }
+
+            [[nodiscard]] static constexpr T fromRaw(uint64_t raw) noexcept
+            {
+                return static_cast<T>(raw);
+            }
+        };
+
+        template<typename T>
+            requires std::is_enum_v<T>
+        struct SignalValue<T>
+        {
+            using Underlying = SignalValue<std::underlying_type_t<T>>;
+
+            [[nodiscard]] static constexpr uint64_t toRaw(T value) noexcept
+            {
+                return Underlying::toRaw(std::to_underlying(value));
+            }
+
+            [[nodiscard]] static constexpr T fromRaw(uint64_t raw) noexcept
+            {
+                return static_cast<T>(Underlying::fromRaw(raw));
+            }
+        };
+
+        template<Wire::Detail::Alias T>
+        struct SignalValue<T>
+        {
+            using Underlying = SignalValue<typename T::Type>;
+
+            [[nodiscard]] static constexpr uint64_t toRaw(const T &value) noexcept
+            {
+                return Underlying::toRaw(value.value);
+            }
+
+            [[nodiscard]] static constexpr T fromRaw(uint64_t raw) noexcept
+            {
+                return T{ Underlying::fromRaw(raw) };
+            }
+        };
+
+        template<Wire::Detail::Quantized T>
+        struct SignalValue<T>
+        {
+            [[nodiscard]] static constexpr uint64_t toRaw(const T &value) noexcept
+            {
+                return Wire::Codec<T>::quantize(value);
+            }
+
+            [[nodiscard]] static constexpr T fromRaw(uint64_t raw) noexcept
+            {
+                return Wire::Codec<T>::dequantize(static_cast<uint32_t>(raw));
+            }
+        };
+    }// namespace Detail
+
+    // One datapoint at a bit position of a message payload. Signed is the signedness the generator exports to
+    // the DBC, the raw value of a signed signal is sign extended from its top bit on receive.
+    template<auto &DataPoint, uint16_t StartBit, uint8_t Length, bool Signed>
+    struct Signal
+    {
+        using Value = std::remove_cvref_t<decltype(DataPoint())>;
+
+        static_assert(Length > 0 && Length <= 64);
+
+        static constexpr uint16_t startBit = StartBit;
+        static constexpr uint8_t length = Length;
+
+        static constexpr void pack(std::span<std::byte> payload) noexcept
+        {
+            Detail::insertBits(payload, StartBit, Length, Detail::SignalValue<Value>::toRaw(DataPoint()));
+        }
+
+        [[nodiscard]] static constexpr Value unpack(std::span<const std::byte> payload) noexcept
+        {
+            const auto raw = Detail::extractBits(payload, StartBit, Length);
+            return Detail::SignalValue<Value>::fromRaw(Signed ? Detail::signExtend(raw, Length) : raw);
+        }
+
+        // signals of datapoints without write access are only sent and skipped on receive
+        [[nodiscard]] static bool apply(std::span<const std::byte> payload) noexcept
+        {
+            if constexpr (requires(const Value &value) { DataPoint.set(value); })
+            {
+                return DataPoint.set(unpack(payload)) == DataLayer::Detail::RangeCheck::ok;
+            }
+            else
+            {
+                return true;
+            }
+        }
+    };
+
+    // Several datapoints packed into one frame, generated from the CanMessages section of the model. Identifiers
+    // above 0x7FF are extended identifiers.
+    template<uint32_t Identifier, uint8_t Length, FixedString Name, typename... Signals>
+    class Message
+    {
+        static_assert(Length <= MaximumPayloadSize);
+        static_assert(((Signals::startBit + Signals::length <= Length * 8U) && ...), "signal exceeds the message length");
+
+      public:
+        static constexpr uint32_t identifier = Identifier;
+        static constexpr uint8_t length = Length;
+        static constexpr std::string_view name{ Name };
+        static constexpr size_t signalCount = sizeof...(Signals);
+
+        // frame with the current value of every signal, unused bits are zero
+        [[nodiscard]] static Frame pack() noexcept
+        {
+            Frame frame{ .identifier = Identifier, .length = Length };
+            const auto payload = std::span{ frame.payload }.first(Length);
+            (Signals::pack(payload), ...);
+            return frame;
+        }
+
+        [[nodiscard]] static constexpr bool matches(const Frame &frame) noexcept
+        {
+            return frame.identifier == Identifier && frame.length == Length;
+        }
+
+        // writes every signal, false if any datapoint rejected its value
+        [[nodiscard]] static bool apply(const Frame &frame) noexcept
+        {
+            const auto payload = std::span<const std::byte>{ frame.payload }.first(Length);
+            return (Signals::apply(payload) & ... & true);
+        }
+    };
+}// namespace DataLayer::Can
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <canBus.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace DataLayer::Can
+{
+    // Bounded transmit queue in front of a driver, used by the adapter as its Bus. Pending frames leave in CAN
+    // arbitration order (lowest identifier first, frames of one identifier in send order), an update replaces
+    // the pending update of its identifier and a full queue rejects the frame. Call onTransmitComplete from the
+    // driver's TX-complete hook; the queue is not synchronised, so send and the hook must not run concurrently.
+    template<size_t Depth>
+    class TransmitQueue final : public Bus
+    {
+        static_assert(Depth > 0 && Depth <= UINT16_MAX);
+
+      public:
+        explicit TransmitQueue(Bus &driver) noexcept : m_driver(driver)
+        {
+            for (size_t slot = 0; slot < Depth; ++slot)
+            {
+                m_free[slot] = static_cast<uint16_t>(slot);
+            }
+        }
+
+        TransmitQueue(const TransmitQueue &) = delete;
+        TransmitQueue &operator=(const TransmitQueue &) = delete;
+
+        bool send(const Frame &frame) noexcept override
+        {
+            return enqueue(frame, false);
+        }
+
+        bool update(const Frame &frame) noexcept override
+        {
+            return enqueue(frame, true);
+        }
+
+        // hands pending frames to the driver until its mailboxes are full
+        void onTransmitComplete() noexcept
+        {
+            while (m_count > 0 && m_driver.send(m_frames[m_entries.front().slot]))
+            {
+                std::ranges::pop_heap(m_entries.begin(), m_entries.begin() + static_cast<ptrdiff_t>(m_count), Later{});
+                // the free slots are a stack in m_free[0, Depth - m_count)
+                m_free[Depth - m_count] = m_entries[m_count - 1U].slot;
+                --m_count;
+                ++m_sent;
+            }
+        }
+
+        [[nodiscard]] size_t occupancy() const noexcept
+        {
+            return m_count;
+        }
+
+        [[nodiscard]] size_t highWatermark() const noexcept
+        {
+            return m_highWatermark;
+        }
+
+        [[nodiscard]] uint64_t dropped() const noexcept
+        {
+            return m_dropped;
+        }
+
+        [[nodiscard]] uint64_t coalesced() const noexcept
+        {
+            return m_coalesced;
+        }
+
+        [[nodiscard]] uint64_t sent() const noexcept
+        {
+            return m_sent;
+        }
+
+        void resetCounters() noexcept
+        {
+            m_highWatermark = m_count;
+            m_dropped = 0;
+            m_coalesced = 0;
+            m_sent = 0;
+        }
+
+      private:
+        struct Entry
+        {
+            uint32_t identifier{};
+            uint32_t sequence{};
+            uint16_t slot{};
+            bool replaceable{ false };
+        };
+
+        // heap comparison, the top is the lowest identifier and within one identifier the oldest frame
+        struct Later
+        {
+            [[nodiscard]] bool operator()(const Entry &lhs, const Entry &rhs) const noexcept
+            {
+                return lhs.identifier != rhs.identifier ? lhs.identifier > rhs.identifier : static_cast<int32_t>(lhs.sequence - rhs.sequence) > 0;
+            }
+        };
+
+        bool enqueue(const Frame &frame, bool replaceable) noexcept
+        {
+            if (replaceable)
+            {
+                const auto pending = std::ranges::find_if(m_entries.begin(), m_entries.begin() + static_cast<ptrdiff_t>(m_count),
+                  [&frame](const Entry &entry) { return entry.replaceable && entry.identifier == frame.identifier; });
+                if (pending != m_entries.begin() + static_cast<ptrdiff_t>(m_count))
+                {
+                    m_frames[pending->slot] = frame;
+                    ++m_coalesced;
+                    return true;
+                }
+            }
+            if (m_count == Depth)
+            {
+                ++m_dropped;
+                return false;
+            }
+            const auto slot = m_free[Depth - 1U - m_count];
+            m_frames[slot] = frame;
+            m_entries[m_count++] = { .identifier = frame.identifier, .sequence = m_sequence++, .slot = slot, .replaceable = replaceable };
+            std::ranges::push_heap(m_entries.begin(), m_entries.begin() + static_cast<ptrdiff_t>(m_count), Later{});
+            m_highWatermark = std::max(m_highWatermark, m_count);
+            onTransmitComplete();
+            return true;
+        }
+
+        Bus &m_driver;
+        std::array<Frame, Depth> m_frames{};
+        std::array<Entry, Depth> m_entries{};
+        std::array<uint16_t, Depth> m_free{};
+        size_t m_count{ 0 };
+        size_t m_highWatermark{ 0 };
+        uint32_t m_sequence{ 0 };
+        uint64_t m_dropped{ 0 };
+        uint64_t m_coalesced{ 0 };
+        uint64_t m_sent{ 0 };
+    };
+}// namespace DataLayer::Can
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <nmmintrin.h>
+#define DATALAYER_HAS_SSE42_CRC 1
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define DATALAYER_HAS_ARM_CRC 1
+#endif
+
+namespace DataLayer::Persistence
+{
+    // stored in the file header, new files use Crc32c
+    enum class ChecksumAlgorithm : uint16_t
+    {
+        Crc32,
+        Crc32c
+    };
+
+    inline constexpr uint32_t Crc32Polynomial = 0xEDB88320U;
+    inline constexpr uint32_t Crc32cPolynomial = 0x82F63B78U;
+
+    // Reflected table driven CRC processing Slices bytes per step (slicing-by-8/16). Table k maps a byte
+    // that is followed by k further bytes, so the Slices lookups of one step are independent.
+    template<uint32_t Polynomial, size_t Slices>
+    struct TableCrc
+    {
+        static_assert(Slices == 1 || Slices == 4 || Slices == 8 || Slices == 16, "unsupported slice count");
+
+        static constexpr auto Tables = [] {
+            std::array<std::array<uint32_t, 256>, Slices> tables{};
+            for (uint32_t value = 0; value < 256U; ++value)
+            {
+                uint32_t crc = value;
+                for (uint8_t bit = 0; bit < 8; ++bit)
+                {
+                    crc = (crc >> 1U) ^ (Polynomial & (0U - (crc & 1U)));
+                }
+                tables[0][value] = crc;
+            }
+            for (size_t slice = 1; slice < Slices; ++slice)
+            {
+                for (size_t value = 0; value < 256U; ++value)
+                {
+                    const auto previous = tables[slice - 1U][value];
+                    tables[slice][value] = (previous >> 8U) ^ tables[0][previous & 0xFFU];
+                }
+            }
+            return tables;
+        }();
+
+        [[nodiscard]] static uint32_t update(uint32_t crc, std::span<const std::byte> data) noexcept
+        {
+            const auto *bytes = data.data();
+            size_t remaining = data.size();
+            while (remaining >= Slices)
+            {
+                std::array<uint8_t, Slices> block{};
+                std::memcpy(block.data(), bytes, Slices);
+                // the running CRC is folded into the first four bytes (little endian byte order)
+                for (size_t index = 0; index < std::min<size_t>(sizeof(crc), Slices); ++index)
+                {
+                    block[index] = static_cast<uint8_t>(block[index] ^ ((crc >> (8U * index)) & 0xFFU));
+                }
+                crc = Slices >= 4U ? 0U : crc >> (8U * Slices);
+                for (size_t index = 0; index < Slices; ++index)
+                {
+                    crc ^= Tables[Slices - 1U - index][block[index]];
+                }
+                bytes += Slices;
+                remaining -= Slices;
+            }
+            for (; remaining > 0; --remaining, ++bytes)
+            {
+                crc = (crc >> 8U) ^ Tables[0][(crc ^ std::to_integer<uint8_t>(*bytes)) & 0xFFU];
+            }
+            return crc;
+        }
+
+        [[nodiscard]] static uint32_t compute(std::span<const std::byte> data) noexcept
+        {
+            return ~update(0xFFFFFFFFU, data);
+        }
+    };
+
+    using SoftwareCrc32 = TableCrc<Crc32Polynomial, 8>;
+    using SoftwareCrc32c = TableCrc<Crc32cPolynomial, 8>;
+
+    // CRC32C instructions of SSE4.2 (detected at runtime) or ARMv8 (selected at compile time)
+    struct HardwareCrc32c
+    {
+        [[nodiscard]] static bool available() noexcept
+        {
+#if defined(DATALAYER_HAS_SSE42_CRC)
+            static const bool supported = __builtin_cpu_supports("sse4.2");
+            return supported;
+#elif defined(DATALAYER_HAS_ARM_CRC)
+            return true;
+#else
+            return false;
+#endif
+        }
+
+#if defined(DATALAYER_HAS_SSE42_CRC)
+        [[nodiscard]] __attribute__((target("sse4.2"))) static uint32_t compute(std::span<const std::byte> data) noexcept
+        {
+            const auto *bytes = data.data();
+            size_t remaining = data.size();
+            uint64_t crc = 0xFFFFFFFFU;
+            for (; remaining >= sizeof(uint64_t); remaining -= sizeof(uint64_t), bytes += sizeof(uint64_t))
+            {
+                uint64_t word{};
+                std::memcpy(&word, bytes, sizeof(word));
+                crc = _mm_crc32_u64(crc, word);
+            }
+            auto crc32 = static_cast<uint32_t>(crc);
+            for (; remaining > 0; --remaining, ++bytes)
+            {
+                crc32 = _mm_crc32_u8(crc32, std::to_integer<uint8_t>(*bytes));
+            }
+            return ~crc32;
+        }
+#elif defined(DATALAYER_HAS_ARM_CRC)
+        [[nodiscard]] static uint32_t compute(std::span<const std::byte> data) noexcept
+        {
+            const auto *bytes = data.data();
+            size_t remaining = data.size();
+            uint32_t crc = 0xFFFFFFFFU;
+            for (; remaining >= sizeof(uint64_t); remaining -= sizeof(uint64_t), bytes += sizeof(uint64_t))
+            {
+                uint64_t word{};
+                std::memcpy(&word, bytes, sizeof(word));
+                crc = __crc32cd(crc, word);
+            }
+            for (; remaining > 0; --remaining, ++bytes)
+            {
+                crc = __crc32cb(crc, std::to_integer<uint8_t>(*bytes));
+            }
+            return ~crc;
+        }
+#else
+        [[nodiscard]] static uint32_t compute(std::span<const std::byte> data) noexcept
+        {
+            return SoftwareCrc32c::compute(data);
+        }
+#endif
+    };
+
+    // IEEE 802.3 CRC32 as written by format version 1
+    [[nodiscard]] inline uint32_t crc32(std::span<const std::byte> data) noexcept
+    {
+        return SoftwareCrc32::compute(data);
+    }
+
+    [[nodiscard]] inline uint32_t crc32c(std::span<const std::byte> data) noexcept
+    {
+        return HardwareCrc32c::available() ? HardwareCrc32c::compute(data) : SoftwareCrc32c::compute(data);
+    }
+
+    [[nodiscard]] inline uint32_t checksum(ChecksumAlgorithm algorithm, std::span<const std::byte> data) noexcept
+    {
+        return algorithm == ChecksumAlgorithm::Crc32c ? crc32c(data) : crc32(data);
+    }
+
+    [[nodiscard]] constexpr bool isKnown(ChecksumAlgorithm algorithm) noexcept
+    {
+        return algorithm == ChecksumAlgorithm::Crc32 || algorithm == ChecksumAlgorithm::Crc32c;
+    }
+}// namespace DataLayer::Persistence
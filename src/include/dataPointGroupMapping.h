@@ -1,9 +1,12 @@
 #pragma once
 #include <cstdint>
 #include <detail.h>
-#ifdef USE_FILE_PERSISTENCE
+#if defined(USE_FILE_PERSISTENCE) || defined(USE_STORAGE_PERSISTENCE)
 #include <serialization.h>
 #endif
+#ifdef USE_STORAGE_PERSISTENCE
+#include <storage.h>
+#endif
 #include <tuple>
 
 namespace DataLayer
@@ -28,6 +31,11 @@ namespace DataLayer
 #endif
         }
 
+        [[nodiscard]] static constexpr bool containsDatapoint(uint32_t dataPointId) noexcept
+        {
+            return (Datapoints::matchesId(dataPointId) || ...);
+        }
+
         template<typename T>
         [[nodiscard]] constexpr Detail::CheckResult setDatapoint(uint32_t dataPointId, const T &value) const
         {
@@ -57,18 +65,59 @@ namespace DataLayer
               datapoints);
         }
 
+#if defined(USE_FILE_PERSISTENCE) || defined(USE_STORAGE_PERSISTENCE)
+
+        [[nodiscard]] SerializationStatus encodeGroup(std::vector<std::byte> &image) const
+        {
+            return Serialization(group.version, group.baseId, datapoints).encode(image);
+        }
+
+        [[nodiscard]] SerializationStatus decodeGroup(std::span<const std::byte> image) const
+        {
+            Deserialization value(group.version, group.baseId, datapoints, group.allowUpgrade);
+            return value.decode(image);
+        }
+
+#endif
+
 #ifdef USE_FILE_PERSISTENCE
 
         [[nodiscard]] SerializationStatus serializeGroup(const std::filesystem::path &path) const
         {
-            Serialization value(group.version, group.baseId, path, datapoints);
-            return value.write();
+            Serialization value(group.version, group.baseId, datapoints);
+            return value.write(path);
         }
 
         [[nodiscard]] SerializationStatus deserializeGroup(const std::filesystem::path &path) const
         {
-            Deserialization value(group.version, group.baseId, path, datapoints, group.allowUpgrade);
-            return value.read();
+            Deserialization value(group.version, group.baseId, datapoints, group.allowUpgrade);
+            return value.read(path);
+        }
+
+#endif
+
+#ifdef USE_STORAGE_PERSISTENCE
+
+        [[nodiscard]] SerializationStatus serializeGroup(Storage::WearLevelingStore &store) const
+        {
+            std::vector<std::byte> image;
+            const auto status = encodeGroup(image);
+            if (!status.result)
+            {
+                return status;
+            }
+            const bool stored = store.write(image) == Storage::Result::ok;
+            return { .result = stored, .size = image.size(), .errorCode = stored ? SerializationError::None : SerializationError::StorageFailure };
+        }
+
+        [[nodiscard]] SerializationStatus deserializeGroup(Storage::WearLevelingStore &store) const
+        {
+            std::vector<std::byte> image;
+            if (store.restore(image) != Storage::Result::ok)
+            {
+                return { .result = false, .size = 0, .errorCode = SerializationError::StorageFailure };
+            }
+            return decodeGroup(image);
         }
 
 #endif
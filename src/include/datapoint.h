@@ -1,9 +1,11 @@
 #pragma once
+#include <array>
 #include <cstdint>
 #include <cstring>
 #include <groupInfo.h>
 #include <span>
 #include <type_traits>
+#include <writeHooks.h>
 
 namespace DataLayer
 {
@@ -42,6 +44,11 @@ namespace DataLayer
             return dataPointId == getId() || ((dataPointId == group.baseId + LegacyIds) || ...);
         }
 
+        [[nodiscard]] constexpr static auto getLegacyIds() noexcept
+        {
+            return std::array<uint16_t, sizeof...(LegacyIds)>{ static_cast<uint16_t>(group.baseId + LegacyIds)... };
+        }
+
         [[nodiscard]] constexpr static auto getVersion() noexcept
         {
             return Version;
@@ -81,7 +88,14 @@ namespace DataLayer
         [[nodiscard]] auto serialize()
         {
             static_assert(std::is_trivially_copyable_v<T>);
-            return std::as_bytes(std::span{ &m_value, 1 });
+            if constexpr (VariableSize<T>)
+            {
+                return m_value.bytes();
+            }
+            else
+            {
+                return std::as_bytes(std::span{ &m_value, 1 });
+            }
         }
 
         // function that will be restricted by WRITE and READ_WRITE access
@@ -104,7 +118,11 @@ namespace DataLayer
             requires Helper::WriteConcept<A>
         void deserialize(std::span<const std::byte> bytes)
         {
-            if (bytes.size() == sizeof(T))
+            if constexpr (VariableSize<T>)
+            {
+                m_value.assign(bytes);
+            }
+            else if (bytes.size() == sizeof(T))
             {
                 std::memcpy(&m_value, bytes.data(), sizeof(T));
             }
@@ -151,6 +169,10 @@ namespace DataLayer
             if (result.has_value())
             {
                 m_value = *result;
+                if !consteval
+                {
+                    Detail::notifyWrite(getId(), valueBytes(m_value));
+                }
                 if (m_changeCallback != nullptr)
                 {
                     m_changeCallback(m_value, m_changeContext);
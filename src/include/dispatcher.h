@@ -9,10 +9,20 @@
 #include <detail.h>
 #include <groupInfo.h>
 #include <helper.h>
+#include <packedStore.h>
 #include <type_traits>
-#ifdef USE_FILE_PERSISTENCE
+#if defined(USE_FILE_PERSISTENCE) || defined(USE_STORAGE_PERSISTENCE)
 #include <serialization.h>
 #endif
+#ifdef USE_FILE_PERSISTENCE
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <memory>
+#include <thread>
+#endif
 
 namespace DataLayer
 {
@@ -36,11 +46,17 @@ namespace DataLayer
         template<typename T>
         [[nodiscard]] constexpr Detail::CheckResult setDatapoint(uint32_t dataPointId, const T &value) const
         {
+#ifdef USE_FILE_PERSISTENCE
+            if !consteval
+            {
+                restoreOnAccess(dataPointId);
+            }
+#endif
             return std::apply(
               [&](auto &...args) {
                   bool ret = false;
                   auto check{ Detail::RangeCheck::notChecked };
-                  ((setter(dataPointId, value, args, ret, check)) || ... || false);
+                  ((setter(dataPointId, value, args, ret, check)) && ... && true);
                   return Detail::CheckResult{ ret, check };
               },
               groups);
@@ -49,16 +65,310 @@ namespace DataLayer
         template<typename T>
         [[nodiscard]] constexpr bool getDatapoint(uint32_t dataPointId, T &value) const
         {
+#ifdef USE_FILE_PERSISTENCE
+            if !consteval
+            {
+                restoreOnAccess(dataPointId);
+            }
+#endif
             return std::apply(
               [&](const auto &...args) {
                   bool ret = false;
-                  ((getter(dataPointId, value, args, ret)) || ... || false);
+                  ((getter(dataPointId, value, args, ret)) && ... && true);
                   return ret;
               },
               groups);
         }
 
+#if defined(USE_FILE_PERSISTENCE) || defined(USE_STORAGE_PERSISTENCE)
+
+        // snapshot of all persisted groups (persistence other than None) in one container image
+        [[nodiscard]] SerializationStatus encodeAll(std::vector<std::byte> &output) const
+        {
+#ifdef USE_FILE_PERSISTENCE
+            // groups that were never restored must not be overwritten with their defaults
+            std::ignore = restorePending();
+#endif
+            Persistence::ContainerBuilder builder;
+            std::vector<std::byte> image;
+            SerializationStatus status{ .result = true };
+            std::apply([&](const auto &...args) { (addGroup(builder, image, args, status), ...); }, groups);
+            if (!status.result)
+            {
+                return status;
+            }
+            if (!builder.finish(output))
+            {
+                return { .result = false, .size = 0, .errorCode = SerializationError::InvalidFormat };
+            }
+            return { .result = true, .size = output.size(), .errorCode = SerializationError::None };
+        }
+
+        // restores every persisted group, a damaged or missing group image does not stop the others
+        [[nodiscard]] SerializationStatus decodeAll(std::span<const std::byte> input) const
+        {
+            const Persistence::ContainerView container(input);
+            if (!container.isValid())
+            {
+                return { .result = false, .size = input.size(), .errorCode = SerializationError::InvalidFormat };
+            }
+            SerializationStatus status{ .result = true, .size = input.size() };
+            std::apply([&](const auto &...args) { (restoreContainerGroup(container, args, status), ...); }, groups);
+            return status;
+        }
+
+        // restores a single group from a container image, the other group images are not touched
+        [[nodiscard]] SerializationStatus decodeGroup(std::span<const std::byte> input, uint16_t groupId) const
+        {
+            const Persistence::ContainerView container(input);
+            SerializationStatus status{ .result = false, .size = input.size(), .errorCode = SerializationError::GroupIdMismatch };
+            std::apply([&](const auto &...args) { ((args.group.baseId == groupId ? restoreSingleGroup(container, args, status) : void()), ...); }, groups);
+            return status;
+        }
+
+#endif
+
+#ifdef USE_FILE_PERSISTENCE
+
+        // all persisted groups are committed together with one rename
+        [[nodiscard]] SerializationStatus serializeAll(const std::filesystem::path &path) const
+        {
+            std::vector<std::byte> output;
+            if (const auto status = encodeAll(output); !status.result)
+            {
+                return status;
+            }
+            const bool written = Persistence::writeFile(path, output);
+            return { .result = written, .size = output.size(), .errorCode = written ? SerializationError::None : SerializationError::InvalidFormat };
+        }
+
+        [[nodiscard]] SerializationStatus deserializeAll(const std::filesystem::path &path) const
+        {
+            const Persistence::InputFile inputFile(path);
+            if (!inputFile.isOpen() || inputFile.size() > MaxPersistenceFileSize)
+            {
+                return { .result = false, .size = inputFile.size(), .errorCode = SerializationError::InvalidFormat };
+            }
+            return decodeAll(inputFile.bytes());
+        }
+
+        [[nodiscard]] SerializationStatus deserializeGroup(const std::filesystem::path &path, uint16_t groupId) const
+        {
+            const Persistence::InputFile inputFile(path);
+            if (!inputFile.isOpen() || inputFile.size() > MaxPersistenceFileSize)
+            {
+                return { .result = false, .size = inputFile.size(), .errorCode = SerializationError::InvalidFormat };
+            }
+            return decodeGroup(inputFile.bytes(), groupId);
+        }
+
+        // Opt-in lazy restore: only the group index is validated now. Each persisted group is restored on
+        // the first getDatapoint/setDatapoint that addresses one of its datapoints, by restoreGroup() or
+        // by restorePending(). The protocol table and a replication follower restore the groups they
+        // access. Other direct datapoint and group accesses bypass the dispatcher and are not tracked,
+        // call restoreGroup() or restoreOnAccess() before using them.
+        [[nodiscard]] SerializationStatus deserializeAllLazy(const std::filesystem::path &path) const
+        {
+            std::unique_lock lock(m_lazy.mutex);
+            m_lazy.restored.wait(lock, [] { return std::ranges::all_of(m_lazy.restoring, [](const auto &owner) { return owner == std::thread::id{}; }); });
+            m_lazy.file = std::make_shared<const Persistence::InputFile>(path);
+            const auto size = m_lazy.file->size();
+            if (!m_lazy.file->isOpen() || size > MaxPersistenceFileSize || !Persistence::ContainerView(m_lazy.file->bytes()).isValid())
+            {
+                releaseLazy();
+                return { .result = false, .size = size, .errorCode = SerializationError::InvalidFormat };
+            }
+            m_lazy.status = { .result = true, .size = size };
+            size_t pending = 0;
+            for (size_t position = 0; position < sizeof...(GroupInfos); ++position)
+            {
+                m_lazy.pending[position].store(Persisted[position], std::memory_order_relaxed);
+                pending += Persisted[position] ? 1U : 0U;
+            }
+            m_lazy.pendingCount.store(pending, std::memory_order_release);
+            return { .result = true, .size = size, .errorCode = SerializationError::None };
+        }
+
+        [[nodiscard]] SerializationStatus restoreGroup(uint16_t groupId) const
+        {
+            SerializationStatus status{ .result = true };
+            std::apply([&](const auto &...args) { ((args.group.baseId == groupId ? restoreLazy(args, status) : void()), ...); }, groups);
+            return status;
+        }
+
+        // restores all groups that are still pending and releases the file, e.g. when the system is idle
+        [[nodiscard]] SerializationStatus restorePending() const
+        {
+            SerializationStatus status{ .result = true };
+            if (m_lazy.pendingCount.load(std::memory_order_acquire) != 0U)
+            {
+                std::apply([&](const auto &...args) { (restoreLazy(args, status), ...); }, groups);
+            }
+            return status;
+        }
+
+        [[nodiscard]] bool isRestorePending(uint16_t groupId) const noexcept
+        {
+            const auto position = groupPosition(groupId);
+            return position < sizeof...(GroupInfos) && m_lazy.pending[position].load(std::memory_order_acquire);
+        }
+
+        // restores the group of dataPointId if it is pending, for code that accesses the datapoint directly
+        void restoreOnAccess(uint32_t dataPointId) const
+        {
+            if (m_lazy.pendingCount.load(std::memory_order_acquire) == 0U)
+            {
+                return;
+            }
+            SerializationStatus status{ .result = true };
+            std::apply([&](const auto &...args) { ((args.containsDatapoint(dataPointId) ? restoreLazy(args, status) : void()), ...); }, groups);
+        }
+
+        // accumulated result of all lazily restored groups so far
+        [[nodiscard]] SerializationStatus lazyRestoreStatus() const
+        {
+            const std::scoped_lock lock(m_lazy.mutex);
+            return m_lazy.status;
+        }
+
+#endif
+
       private:
+#ifdef USE_FILE_PERSISTENCE
+        static constexpr std::array<uint16_t, sizeof...(GroupInfos)> GroupIds{ std::remove_cvref_t<decltype(std::declval<GroupInfos &>().group)>::baseId... };
+        static constexpr std::array<bool, sizeof...(GroupInfos)> Persisted{ (std::remove_cvref_t<decltype(std::declval<GroupInfos &>().group)>::persist
+                                                                              != PersistenceType::None)... };
+
+        // the dispatcher itself is constexpr, the lazy restore state lives beside it (one per model)
+        struct LazyState
+        {
+            std::mutex mutex;
+            std::condition_variable restored;
+            std::shared_ptr<const Persistence::InputFile> file;
+            std::array<std::atomic<bool>, sizeof...(GroupInfos)> pending{};
+            std::array<std::thread::id, sizeof...(GroupInfos)> restoring{};
+            std::atomic<size_t> pendingCount{ 0 };
+            SerializationStatus status{};
+        };
+        static inline LazyState m_lazy{};
+
+        [[nodiscard]] static constexpr size_t groupPosition(uint16_t groupId) noexcept
+        {
+            size_t position = 0;
+            while (position < GroupIds.size() && GroupIds[position] != groupId)
+            {
+                ++position;
+            }
+            return position;
+        }
+
+        static void restoreLazy(const auto &args, SerializationStatus &status)
+        {
+            const auto position = groupPosition(args.group.baseId);
+            if (!m_lazy.pending[position].load(std::memory_order_acquire))
+            {
+                return;
+            }
+            // the group is claimed under the lock and decoded outside of it: the change callbacks of the
+            // decoded datapoints may access other lazily restored groups. A thread that finds the group
+            // claimed by another thread waits for it, the decoding thread itself sees it as it is.
+            std::shared_ptr<const Persistence::InputFile> file;
+            {
+                std::unique_lock lock(m_lazy.mutex);
+                while (m_lazy.pending[position].load(std::memory_order_relaxed) && m_lazy.restoring[position] != std::thread::id{})
+                {
+                    if (m_lazy.restoring[position] == std::this_thread::get_id())
+                    {
+                        return;
+                    }
+                    m_lazy.restored.wait(lock);
+                }
+                if (!m_lazy.pending[position].load(std::memory_order_relaxed))
+                {
+                    return;
+                }
+                m_lazy.restoring[position] = std::this_thread::get_id();
+                file = m_lazy.file;
+            }
+            SerializationStatus groupStatus{ .result = true };
+            restoreContainerGroup(Persistence::ContainerView(file->bytes()), args, groupStatus);
+            {
+                const std::scoped_lock lock(m_lazy.mutex);
+                for (auto *accumulated : { &status, &m_lazy.status })
+                {
+                    accumulated->result = accumulated->result && groupStatus.result;
+                    if (accumulated->errorCode == SerializationError::None)
+                    {
+                        accumulated->errorCode = groupStatus.errorCode;
+                    }
+                }
+                m_lazy.restoring[position] = std::thread::id{};
+                m_lazy.pending[position].store(false, std::memory_order_release);
+                if (m_lazy.pendingCount.fetch_sub(1U, std::memory_order_acq_rel) == 1U)
+                {
+                    releaseLazy();
+                }
+            }
+            m_lazy.restored.notify_all();
+        }
+
+        static void releaseLazy()
+        {
+            m_lazy.file.reset();
+            for (auto &pending : m_lazy.pending)
+            {
+                pending.store(false, std::memory_order_relaxed);
+            }
+            m_lazy.pendingCount.store(0U, std::memory_order_release);
+        }
+#endif
+
+#if defined(USE_FILE_PERSISTENCE) || defined(USE_STORAGE_PERSISTENCE)
+        static void addGroup(Persistence::ContainerBuilder &builder, std::vector<std::byte> &image, const auto &args, SerializationStatus &status)
+        {
+            if (args.group.persist == PersistenceType::None || !status.result)
+            {
+                return;
+            }
+            if (const auto groupStatus = args.encodeGroup(image); !groupStatus.result)
+            {
+                status = groupStatus;
+                return;
+            }
+            builder.add(args.group.baseId, args.group.version, image);
+        }
+
+        static void restoreContainerGroup(const Persistence::ContainerView &container, const auto &args, SerializationStatus &status)
+        {
+            if (args.group.persist == PersistenceType::None)
+            {
+                return;
+            }
+            std::span<const std::byte> image;
+            auto groupStatus = SerializationStatus{ .result = false, .size = 0, .errorCode = container.find(args.group.baseId, image) };
+            if (groupStatus.errorCode == SerializationError::None)
+            {
+                groupStatus = args.decodeGroup(image);
+            }
+            status.result = status.result && groupStatus.result;
+            if (status.errorCode == SerializationError::None)
+            {
+                status.errorCode = groupStatus.errorCode;
+            }
+        }
+
+        static void restoreSingleGroup(const Persistence::ContainerView &container, const auto &args, SerializationStatus &status)
+        {
+            if (args.group.persist == PersistenceType::None)
+            {
+                return;
+            }
+            status.result = true;
+            status.errorCode = SerializationError::None;
+            restoreContainerGroup(container, args, status);
+        }
+#endif
+
         constexpr static bool setter(const uint32_t dataPointId, const auto &value, [[maybe_unused]] auto &args, [[maybe_unused]] bool &ret, Detail::RangeCheck &check)
         {
             const auto returnCheck = args.setDatapoint(dataPointId, value);
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <span>
+#include <storage.h>
+#include <vector>
+
+namespace DataLayer::Storage
+{
+    // Host-side NOR flash model persisted in a regular file. Programming can only clear bits, just like
+    // the real device, and every erase is counted per sector. A program budget can be set to emulate a
+    // power loss in the middle of a write.
+    class FileFlashSimulator final : public Backend
+    {
+      public:
+        FileFlashSimulator(const std::filesystem::path &path, size_t sectorSize, size_t sectorCount)
+          : m_path(path), m_sectorSize(sectorSize), m_sectorCount(sectorCount), m_eraseCounts(sectorCount, 0)
+        {
+            std::error_code error;
+            const uintmax_t expectedSize = m_sectorSize * m_sectorCount;
+            if (!std::filesystem::exists(m_path, error) || std::filesystem::file_size(m_path, error) != expectedSize)
+            {
+                std::ofstream image(m_path, std::ios::binary | std::ios::trunc);
+                const std::vector<char> erased(m_sectorSize * m_sectorCount, static_cast<char>(0xFF));
+                image.write(erased.data(), static_cast<std::streamsize>(erased.size()));
+            }
+            m_file.open(m_path, std::ios::binary | std::ios::in | std::ios::out);
+        }
+
+        [[nodiscard]] size_t sectorSize() const noexcept override
+        {
+            return m_sectorSize;
+        }
+
+        [[nodiscard]] size_t sectorCount() const noexcept override
+        {
+            return m_sectorCount;
+        }
+
+        [[nodiscard]] bool erase(size_t sector) noexcept override
+        {
+            if (sector >= m_sectorCount || !consumeBudget(1))
+            {
+                return false;
+            }
+            const std::vector<std::byte> erased(m_sectorSize, std::byte{ 0xFF });
+            ++m_eraseCounts[sector];
+            return store(sector * m_sectorSize, erased);
+        }
+
+        [[nodiscard]] bool program(size_t address, std::span<const std::byte> data) noexcept override
+        {
+            if (address % ProgramAlignment != 0 || !inRange(address, data.size()))
+            {
+                return false;
+            }
+            std::vector<std::byte> current(data.size());
+            if (!load(address, current))
+            {
+                return false;
+            }
+
+            const auto allowed = std::min(data.size(), m_programBudget);
+            for (size_t index = 0; index < allowed; ++index)
+            {
+                // NOR flash can only clear bits, setting one requires an erase
+                if ((current[index] & data[index]) != data[index])
+                {
+                    return false;
+                }
+                current[index] = data[index];
+            }
+            const bool complete = consumeBudget(data.size());
+            ++m_programCount;
+            return store(address, std::span{ current }.first(allowed)) && complete;
+        }
+
+        [[nodiscard]] bool read(size_t address, std::span<std::byte> data) noexcept override
+        {
+            return inRange(address, data.size()) && load(address, data);
+        }
+
+        [[nodiscard]] uint32_t eraseCount(size_t sector) const noexcept
+        {
+            return sector < m_sectorCount ? m_eraseCounts[sector] : 0U;
+        }
+
+        [[nodiscard]] uint32_t totalEraseCount() const noexcept
+        {
+            uint32_t total = 0;
+            for (const auto count : m_eraseCounts)
+            {
+                total += count;
+            }
+            return total;
+        }
+
+        [[nodiscard]] uint32_t programCount() const noexcept
+        {
+            return m_programCount;
+        }
+
+        // limits the bytes that may still be programmed (an erase costs one), emulating a power loss
+        void setProgramBudget(size_t bytes) noexcept
+        {
+            m_programBudget = bytes;
+        }
+
+        void clearProgramBudget() noexcept
+        {
+            m_programBudget = std::numeric_limits<size_t>::max();
+        }
+
+      private:
+        [[nodiscard]] bool inRange(size_t address, size_t size) const noexcept
+        {
+            const auto capacity = m_sectorSize * m_sectorCount;
+            return address <= capacity && capacity - address >= size;
+        }
+
+        [[nodiscard]] bool consumeBudget(size_t bytes) noexcept
+        {
+            if (m_programBudget == std::numeric_limits<size_t>::max())
+            {
+                return true;
+            }
+            const bool sufficient = m_programBudget >= bytes;
+            m_programBudget -= std::min(m_programBudget, bytes);
+            return sufficient;
+        }
+
+        [[nodiscard]] bool load(size_t address, std::span<std::byte> data) noexcept
+        {
+            m_file.clear();
+            m_file.seekg(static_cast<std::streamoff>(address));
+            m_file.read(reinterpret_cast<char *>(data.data()), static_cast<std::streamsize>(data.size()));
+            return !m_file.fail();
+        }
+
+        [[nodiscard]] bool store(size_t address, std::span<const std::byte> data) noexcept
+        {
+            m_file.clear();
+            m_file.seekp(static_cast<std::streamoff>(address));
+            m_file.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+            m_file.flush();
+            return !m_file.fail();
+        }
+
+        std::filesystem::path m_path;
+        size_t m_sectorSize;
+        size_t m_sectorCount;
+        std::vector<uint32_t> m_eraseCounts;
+        std::fstream m_file;
+        size_t m_programBudget{ std::numeric_limits<size_t>::max() };
+        uint32_t m_programCount{ 0 };
+    };
+}// namespace DataLayer::Storage
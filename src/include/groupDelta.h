@@ -0,0 +1,315 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <serialization.h>
+#include <span>
+#include <vector>
+
+namespace DataLayer::Persistence
+{
+    inline constexpr std::array DeltaMagic{ 'D', 'L', 'D', '1' };
+    inline constexpr uint16_t DeltaFormatVersion = 1;
+
+    // Changed records of a group image relative to a base image. Base and target checksums are CRC32C
+    // over the record section of the images, the delta checksum covers everything after this header.
+    struct DeltaHeader
+    {
+        std::array<char, 4> magic{ DeltaMagic };
+        uint16_t formatVersion{ DeltaFormatVersion };
+        uint16_t groupId{};
+        Version groupVersion{};
+        uint32_t baseChecksum{};
+        uint32_t targetChecksum{};
+        uint32_t targetSize{};
+        uint16_t changedCount{};
+        // zero when the target keeps the record IDs and sizes of the base, otherwise the number of
+        // record IDs that follow in target order
+        uint16_t layoutCount{};
+        uint32_t checksum{};
+    };
+
+    namespace DeltaDetail
+    {
+        struct Record
+        {
+            uint16_t dataPointId{};
+            size_t offset{ 0 };
+            size_t size{ 0 };
+        };
+
+        [[nodiscard]] inline SerializationError readImage(std::span<const std::byte> image, Header &header, std::span<const std::byte> &records) noexcept
+        {
+            size_t offset = 0;
+            if (!readHeader(image, offset, header))
+            {
+                return SerializationError::InvalidFormat;
+            }
+            records = image.subspan(offset);
+            return header.checksum == checksum(header.checksumAlgorithm, records) ? SerializationError::None : SerializationError::ChecksumMismatch;
+        }
+
+        // record positions relative to the record section, each including its header
+        [[nodiscard]] inline bool scanRecords(std::span<const std::byte> records, std::vector<Record> &output)
+        {
+            output.clear();
+            size_t offset = 0;
+            while (offset < records.size())
+            {
+                RecordHeader header{};
+                const auto start = offset;
+                if (!read(records, offset, header) || records.size() - offset < header.payloadSize || output.size() == UINT16_MAX)
+                {
+                    return false;
+                }
+                offset += header.payloadSize;
+                output.push_back({ .dataPointId = header.dataPointId, .offset = start, .size = offset - start });
+            }
+            return true;
+        }
+
+        [[nodiscard]] inline const Record *findRecord(const std::vector<Record> &records, uint16_t dataPointId) noexcept
+        {
+            const auto found = std::ranges::find(records, dataPointId, &Record::dataPointId);
+            return found != records.end() ? &*found : nullptr;
+        }
+
+        [[nodiscard]] inline std::span<const std::byte> bytesOf(std::span<const std::byte> records, const Record &record) noexcept
+        {
+            return records.subspan(record.offset, record.size);
+        }
+
+        [[nodiscard]] inline bool sameLayout(const std::vector<Record> &base, const std::vector<Record> &target) noexcept
+        {
+            return std::ranges::equal(
+              base, target, [](const Record &lhs, const Record &rhs) { return lhs.dataPointId == rhs.dataPointId && lhs.size == rhs.size; });
+        }
+
+        [[nodiscard]] inline SerializationStatus failed(SerializationError error, size_t size = 0) noexcept
+        {
+            return { .result = false, .size = size, .errorCode = error };
+        }
+    }// namespace DeltaDetail
+
+    // Writes the records of target that differ from base (header and payload compared bytewise).
+    // Both images must be valid images of the same group.
+    [[nodiscard]] inline SerializationStatus makeDelta(std::span<const std::byte> base, std::span<const std::byte> target, std::vector<std::byte> &delta)
+    {
+        Header baseHeader{};
+        Header targetHeader{};
+        std::span<const std::byte> baseRecords;
+        std::span<const std::byte> targetRecords;
+        if (const auto error = DeltaDetail::readImage(base, baseHeader, baseRecords); error != SerializationError::None)
+        {
+            return DeltaDetail::failed(error);
+        }
+        if (const auto error = DeltaDetail::readImage(target, targetHeader, targetRecords); error != SerializationError::None)
+        {
+            return DeltaDetail::failed(error);
+        }
+        if (baseHeader.groupId != targetHeader.groupId)
+        {
+            return DeltaDetail::failed(SerializationError::GroupIdMismatch);
+        }
+
+        std::vector<DeltaDetail::Record> baseIndex;
+        std::vector<DeltaDetail::Record> targetIndex;
+        if (!DeltaDetail::scanRecords(baseRecords, baseIndex) || !DeltaDetail::scanRecords(targetRecords, targetIndex))
+        {
+            return DeltaDetail::failed(SerializationError::InvalidFormat);
+        }
+        const bool sameLayout = DeltaDetail::sameLayout(baseIndex, targetIndex);
+
+        std::vector<std::byte> body;
+        if (!sameLayout)
+        {
+            for (const auto &record : targetIndex)
+            {
+                append(body, record.dataPointId);
+            }
+        }
+        uint16_t changedCount = 0;
+        for (size_t position = 0; position < targetIndex.size(); ++position)
+        {
+            const auto &record = targetIndex[position];
+            const auto *previous = sameLayout ? &baseIndex[position] : DeltaDetail::findRecord(baseIndex, record.dataPointId);
+            const auto bytes = DeltaDetail::bytesOf(targetRecords, record);
+            if (previous == nullptr || !std::ranges::equal(bytes, DeltaDetail::bytesOf(baseRecords, *previous)))
+            {
+                body.insert(body.end(), bytes.begin(), bytes.end());
+                ++changedCount;
+            }
+        }
+
+        const DeltaHeader header{ .groupId = targetHeader.groupId,
+                                  .groupVersion = targetHeader.groupVersion,
+                                  .baseChecksum = crc32c(baseRecords),
+                                  .targetChecksum = crc32c(targetRecords),
+                                  .targetSize = static_cast<uint32_t>(targetRecords.size()),
+                                  .changedCount = changedCount,
+                                  .layoutCount = static_cast<uint16_t>(sameLayout ? 0U : targetIndex.size()),
+                                  .checksum = crc32c(body) };
+        delta.clear();
+        delta.reserve(sizeof(header) + body.size());
+        append(delta, header);
+        delta.insert(delta.end(), body.begin(), body.end());
+        return { .result = true, .size = delta.size(), .errorCode = SerializationError::None };
+    }
+
+    // Turns the base image into the target image. Records are patched in place when the delta keeps the
+    // layout, otherwise the record section is rebuilt. The image is left unchanged when the delta was
+    // made for another base or the result does not match the target checksum.
+    [[nodiscard]] inline SerializationStatus applyDelta(std::vector<std::byte> &image, std::span<const std::byte> delta)
+    {
+        DeltaHeader header{};
+        size_t offset = 0;
+        if (!read(delta, offset, header) || header.magic != DeltaMagic || header.formatVersion != DeltaFormatVersion)
+        {
+            return DeltaDetail::failed(SerializationError::InvalidFormat);
+        }
+        if (header.checksum != crc32c(delta.subspan(offset)))
+        {
+            return DeltaDetail::failed(SerializationError::ChecksumMismatch);
+        }
+
+        Header imageHeader{};
+        std::span<const std::byte> baseRecords;
+        if (const auto error = DeltaDetail::readImage(image, imageHeader, baseRecords); error != SerializationError::None)
+        {
+            return DeltaDetail::failed(error, image.size());
+        }
+        if (imageHeader.groupId != header.groupId)
+        {
+            return DeltaDetail::failed(SerializationError::GroupIdMismatch, image.size());
+        }
+        if (crc32c(baseRecords) != header.baseChecksum)
+        {
+            return DeltaDetail::failed(SerializationError::ChecksumMismatch, image.size());
+        }
+
+        std::vector<uint16_t> layout(header.layoutCount);
+        for (auto &dataPointId : layout)
+        {
+            if (!read(delta, offset, dataPointId))
+            {
+                return DeltaDetail::failed(SerializationError::InvalidFormat, image.size());
+            }
+        }
+        std::vector<DeltaDetail::Record> baseIndex;
+        std::vector<DeltaDetail::Record> changed;
+        const auto changedRecords = delta.subspan(offset);
+        if (!DeltaDetail::scanRecords(baseRecords, baseIndex) || !DeltaDetail::scanRecords(changedRecords, changed) || changed.size() != header.changedCount)
+        {
+            return DeltaDetail::failed(SerializationError::InvalidFormat, image.size());
+        }
+
+        const Header targetHeader{ .groupId = header.groupId, .groupVersion = header.groupVersion, .checksum = header.targetChecksum };
+        const auto recordOffset = image.size() - baseRecords.size();
+        if (layout.empty() && recordOffset == sizeof(Header))
+        {
+            // the overwritten bytes are kept to restore the image when the result does not verify
+            std::vector<size_t> positions;
+            std::vector<std::byte> previous;
+            for (const auto &record : changed)
+            {
+                const auto *target = DeltaDetail::findRecord(baseIndex, record.dataPointId);
+                if (target == nullptr || target->size != record.size)
+                {
+                    return DeltaDetail::failed(SerializationError::InvalidFormat, image.size());
+                }
+                positions.push_back(recordOffset + target->offset);
+                const auto bytes = DeltaDetail::bytesOf(baseRecords, *target);
+                previous.insert(previous.end(), bytes.begin(), bytes.end());
+            }
+            for (size_t index = 0; index < changed.size(); ++index)
+            {
+                std::ranges::copy(DeltaDetail::bytesOf(changedRecords, changed[index]), image.begin() + static_cast<std::ptrdiff_t>(positions[index]));
+            }
+            if (crc32c(std::span<const std::byte>{ image }.subspan(recordOffset)) != header.targetChecksum)
+            {
+                auto source = previous.begin();
+                for (size_t index = 0; index < changed.size(); ++index)
+                {
+                    std::copy_n(source, changed[index].size, image.begin() + static_cast<std::ptrdiff_t>(positions[index]));
+                    source += static_cast<std::ptrdiff_t>(changed[index].size);
+                }
+                return DeltaDetail::failed(SerializationError::ChecksumMismatch, image.size());
+            }
+            std::memcpy(image.data(), &targetHeader, sizeof(targetHeader));
+            return { .result = true, .size = image.size(), .errorCode = SerializationError::None };
+        }
+
+        // a base without layout change but an older header is rewritten in its own record order
+        if (layout.empty())
+        {
+            std::ranges::transform(baseIndex, std::back_inserter(layout), &DeltaDetail::Record::dataPointId);
+        }
+        std::vector<std::byte> output;
+        output.reserve(sizeof(Header) + header.targetSize);
+        append(output, targetHeader);
+        for (const auto dataPointId : layout)
+        {
+            if (const auto *record = DeltaDetail::findRecord(changed, dataPointId); record != nullptr)
+            {
+                const auto bytes = DeltaDetail::bytesOf(changedRecords, *record);
+                output.insert(output.end(), bytes.begin(), bytes.end());
+            }
+            else if (const auto *kept = DeltaDetail::findRecord(baseIndex, dataPointId); kept != nullptr)
+            {
+                const auto bytes = DeltaDetail::bytesOf(baseRecords, *kept);
+                output.insert(output.end(), bytes.begin(), bytes.end());
+            }
+            else
+            {
+                return DeltaDetail::failed(SerializationError::InvalidFormat, image.size());
+            }
+        }
+        if (crc32c(std::span<const std::byte>{ output }.subspan(sizeof(Header))) != header.targetChecksum)
+        {
+            return DeltaDetail::failed(SerializationError::ChecksumMismatch, image.size());
+        }
+        image = std::move(output);
+        return { .result = true, .size = image.size(), .errorCode = SerializationError::None };
+    }
+
+#ifdef USE_FILE_PERSISTENCE
+    [[nodiscard]] inline SerializationStatus makeDelta(const std::filesystem::path &base, const std::filesystem::path &target, const std::filesystem::path &delta)
+    {
+        const InputFile baseFile(base);
+        const InputFile targetFile(target);
+        if (!baseFile.isOpen() || !targetFile.isOpen())
+        {
+            return DeltaDetail::failed(SerializationError::InvalidFormat);
+        }
+        std::vector<std::byte> output;
+        auto status = makeDelta(baseFile.bytes(), targetFile.bytes(), output);
+        if (status.result && !writeFile(delta, output))
+        {
+            status = DeltaDetail::failed(SerializationError::StorageFailure, output.size());
+        }
+        return status;
+    }
+
+    // the image file is replaced only when the delta applied and verified
+    [[nodiscard]] inline SerializationStatus applyDelta(const std::filesystem::path &image, const std::filesystem::path &delta)
+    {
+        const InputFile imageFile(image);
+        const InputFile deltaFile(delta);
+        if (!imageFile.isOpen() || !deltaFile.isOpen())
+        {
+            return DeltaDetail::failed(SerializationError::InvalidFormat);
+        }
+        const auto bytes = imageFile.bytes();
+        std::vector<std::byte> output(bytes.begin(), bytes.end());
+        auto status = applyDelta(output, deltaFile.bytes());
+        if (status.result && !writeFile(image, output))
+        {
+            status = DeltaDetail::failed(SerializationError::StorageFailure, output.size());
+        }
+        return status;
+    }
+#endif
+}// namespace DataLayer::Persistence
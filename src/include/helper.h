@@ -1,9 +1,15 @@
 #pragma once
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <compare>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
 #include <span>
 #include <string_view>
+#include <type_traits>
 
 namespace DataLayer
 {
@@ -54,6 +60,173 @@ struct FixedString
 template<unsigned N>
 FixedString(const char (&)[N]) -> FixedString<N - 1>;
 
+namespace DataLayer
+{
+    // Values that are stored and transmitted with their used size only. The record or frame length acts
+    // as the length prefix, so the payload is never padded to the capacity.
+    template<typename T>
+    concept VariableSize = std::is_trivially_copyable_v<T> && requires(T value, const T constValue, std::span<const std::byte> bytes) {
+        { constValue.bytes() } -> std::same_as<std::span<const std::byte>>;
+        { value.assign(bytes) } -> std::same_as<bool>;
+        { T::capacity() } -> std::same_as<size_t>;
+    };
+
+    // the bytes the write hooks hand on for a value, the used bytes of a variable size value
+    template<typename T>
+    [[nodiscard]] std::span<const std::byte> valueBytes(const T &value) noexcept
+    {
+        if constexpr (VariableSize<T>)
+        {
+            return value.bytes();
+        }
+        else
+        {
+            return std::as_bytes(std::span{ &value, 1 });
+        }
+    }
+
+    using Clock = uint64_t (*)() noexcept;
+
+    [[nodiscard]] inline uint64_t steadyNanoseconds() noexcept
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    namespace Detail
+    {
+        // One observer of successful set() writes, called on the writing thread. Detach before the observer
+        // is destroyed and let writes in flight finish; without an observer a write costs one atomic load.
+        template<typename Observer, auto Receive>
+        class WriteHook
+        {
+          public:
+            void attach(Observer &observer) noexcept
+            {
+                m_observer.store(&observer, std::memory_order_release);
+            }
+
+            void detach() noexcept
+            {
+                m_observer.store(nullptr, std::memory_order_release);
+            }
+
+            void notify(uint16_t dataPointId, std::span<const std::byte> value) const noexcept
+            {
+                if (auto *observer = m_observer.load(std::memory_order_acquire); observer != nullptr)
+                {
+                    (observer->*Receive)(dataPointId, value);
+                }
+            }
+
+          private:
+            std::atomic<Observer *> m_observer{ nullptr };
+        };
+    }// namespace Detail
+
+    // fingerprint of the value type of a datapoint, specialised by the generated datalayer.h
+    template<typename DataPoint>
+    inline constexpr uint32_t TypeFingerprint = 0;
+
+    // datapoint living in the bits of a PackedStore, it is persisted by the record of its store
+    template<typename T>
+    concept PackedMember = std::remove_cvref_t<T>::PackedMember;
+
+    // store of packed datapoints, restored from its record as a whole
+    template<typename T>
+    concept PackedStorage = requires(std::remove_cvref_t<T> &store, std::span<const std::byte> payload) {
+        { store.restore(payload) } -> std::same_as<bool>;
+    };
+
+    // String with a fixed capacity stored inline, trivially copyable and never allocating
+    template<size_t Capacity>
+    class InlineString
+    {
+        static_assert(Capacity > 0 && Capacity <= UINT16_MAX, "unsupported string capacity");
+        using SizeType = std::conditional_t<(Capacity <= UINT8_MAX), uint8_t, uint16_t>;
+
+      public:
+        constexpr InlineString() = default;
+
+        template<size_t N>
+            requires(N - 1 <= Capacity)
+        constexpr InlineString(const char (&str)[N]) noexcept : m_size(static_cast<SizeType>(N - 1))
+        {
+            std::copy_n(str, N - 1, m_data.begin());
+        }
+
+        template<size_t N>
+            requires(N <= Capacity)
+        constexpr InlineString(const FixedString<N> &str) noexcept : InlineString(std::string_view{ str }.data(), N)
+        {}
+
+        // keeps the current content if the text does not fit
+        constexpr bool assign(std::string_view text) noexcept
+        {
+            if (text.size() > Capacity)
+            {
+                return false;
+            }
+            std::ranges::fill(std::ranges::copy(text, m_data.begin()).out, m_data.end(), '\0');
+            m_size = static_cast<SizeType>(text.size());
+            return true;
+        }
+
+        bool assign(std::span<const std::byte> bytes) noexcept
+        {
+            return assign(std::string_view{ reinterpret_cast<const char *>(bytes.data()), bytes.size() });
+        }
+
+        [[nodiscard]] std::span<const std::byte> bytes() const noexcept
+        {
+            return std::as_bytes(std::span{ m_data.data(), m_size });
+        }
+
+        [[nodiscard]] constexpr std::string_view view() const noexcept
+        {
+            return { m_data.data(), m_size };
+        }
+
+        [[nodiscard]] constexpr operator std::string_view() const noexcept
+        {
+            return view();
+        }
+
+        [[nodiscard]] constexpr const char *data() const noexcept
+        {
+            return m_data.data();
+        }
+
+        [[nodiscard]] constexpr size_t size() const noexcept
+        {
+            return m_size;
+        }
+
+        [[nodiscard]] constexpr bool empty() const noexcept
+        {
+            return m_size == 0;
+        }
+
+        [[nodiscard]] static constexpr size_t capacity() noexcept
+        {
+            return Capacity;
+        }
+
+        [[nodiscard]] constexpr bool operator==(std::string_view other) const noexcept
+        {
+            return view() == other;
+        }
+
+      private:
+        constexpr InlineString(const char *text, size_t size) noexcept : m_size(static_cast<SizeType>(size))
+        {
+            std::copy_n(text, size, m_data.begin());
+        }
+
+        std::array<char, Capacity> m_data{};
+        SizeType m_size{ 0 };
+    };
+}// namespace DataLayer
+
 namespace Helper
 {
     // helper classes
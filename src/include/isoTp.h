@@ -0,0 +1,464 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <canBus.h>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <tuple>
+
+// ISO 15765-2 style segmentation: single, first and consecutive frames on the identifier of the transfer,
+// flow control frames on a second identifier, a request/response pair as in ISO 15765-2. Both directions
+// use fixed session pools, nothing is allocated.
+namespace DataLayer::Can::IsoTp
+{
+    // largest length of a first frame without the 32 bit escape
+    inline constexpr size_t MaximumMessageSize = 4095;
+
+    // N_Bs: milliseconds a sender waits for the next flow control frame before the session is dropped
+    inline constexpr uint32_t FlowControlTimeout = 1000;
+
+    // N_Cr: milliseconds a receiver waits for the next consecutive frame before the partial message is dropped
+    inline constexpr uint32_t ConsecutiveFrameTimeout = 1000;
+
+    // The flow control frames of a datapoint transfer travel on the extended identifier with this bit set. It
+    // lies above every datapoint ID, so the two directions of a transfer never share an identifier.
+    inline constexpr uint32_t FlowControlFlag = 0x10000000;
+
+    [[nodiscard]] constexpr uint32_t flowControlIdentifier(uint32_t identifier) noexcept
+    {
+        return identifier | FlowControlFlag;
+    }
+
+    enum class FrameType : uint8_t
+    {
+        single = 0,
+        first = 1,
+        consecutive = 2,
+        flowControl = 3
+    };
+
+    enum class FlowStatus : uint8_t
+    {
+        continueToSend = 0,
+        wait = 1,
+        overflow = 2
+    };
+
+    enum class Status : uint8_t
+    {
+        complete,
+        pending,
+        sendFailed,
+        invalid,
+        overflow,
+        busy
+    };
+
+    struct Outcome
+    {
+        Status status{ Status::invalid };
+        // complete message, valid until the next received frame
+        std::span<const std::byte> message{};
+    };
+
+    [[nodiscard]] inline FrameType typeOf(const Frame &frame) noexcept
+    {
+        return static_cast<FrameType>(std::to_integer<uint8_t>(frame.payload[0]) >> 4U);
+    }
+
+    [[nodiscard]] constexpr std::byte pci(FrameType type, uint8_t low = 0) noexcept
+    {
+        return static_cast<std::byte>((static_cast<uint8_t>(type) << 4U) | (low & 0x0FU));
+    }
+
+    // single frame data length, CAN FD frames longer than 8 bytes use the escape with a second length byte
+    template<size_t PayloadCapacity>
+    [[nodiscard]] constexpr size_t singleFrameLimit() noexcept
+    {
+        return PayloadCapacity > 8 ? PayloadCapacity - 2U : PayloadCapacity - 1U;
+    }
+
+    // Each send expects its flow control frames on flowControlIdentifier, which must differ from the identifier
+    // of its data frames. Sessions waiting for flow control expire after FlowControlTimeout. Time comes from
+    // poll(now), so the timeout is enforced with the resolution of the poll period; without poll() a lost
+    // flow control frame blocks its identifier until abort().
+    template<size_t PayloadCapacity, size_t MessageCapacity, size_t Sessions>
+    class Sender
+    {
+        static_assert(PayloadCapacity >= 8 && MessageCapacity <= MaximumMessageSize && Sessions > 0);
+
+      public:
+        // pending while consecutive frames wait for flow control, invalid when both identifiers are equal
+        [[nodiscard]] Status start(Bus &bus, uint32_t identifier, std::span<const std::byte> message, uint32_t flowControlIdentifier) noexcept
+        {
+            if (identifier == flowControlIdentifier)
+            {
+                return Status::invalid;
+            }
+            if (message.size() > MessageCapacity)
+            {
+                return Status::overflow;
+            }
+            if (message.size() <= singleFrameLimit<PayloadCapacity>())
+            {
+                Frame frame{ .identifier = identifier };
+                size_t offset = 1;
+                if (message.size() > 7)
+                {
+                    frame.payload[1] = static_cast<std::byte>(message.size());
+                    offset = 2;
+                }
+                else
+                {
+                    frame.payload[0] = pci(FrameType::single, static_cast<uint8_t>(message.size()));
+                }
+                std::ranges::copy(message, frame.payload.begin() + static_cast<ptrdiff_t>(offset));
+                frame.length = static_cast<uint8_t>(offset + message.size());
+                return bus.update(frame) ? Status::complete : Status::sendFailed;
+            }
+
+            Session *session = nullptr;
+            for (auto &candidate : m_sessions)
+            {
+                if (candidate.active && (candidate.identifier == identifier || candidate.flowControlIdentifier == flowControlIdentifier))
+                {
+                    // a stale transfer of either identifier is replaced by the new one
+                    if (!expired(candidate))
+                    {
+                        return Status::busy;
+                    }
+                    candidate.active = false;
+                }
+                session = (!candidate.active && session == nullptr) ? &candidate : session;
+            }
+            if (session == nullptr)
+            {
+                return Status::busy;
+            }
+
+            Frame frame{ .identifier = identifier, .length = static_cast<uint8_t>(PayloadCapacity) };
+            frame.payload[0] = pci(FrameType::first, static_cast<uint8_t>(message.size() >> 8U));
+            frame.payload[1] = static_cast<std::byte>(message.size() & 0xFFU);
+            const auto firstSize = PayloadCapacity - 2U;
+            std::ranges::copy(message.first(firstSize), frame.payload.begin() + 2);
+            if (!bus.send(frame))
+            {
+                return Status::sendFailed;
+            }
+            std::ranges::copy(message, session->data.begin());
+            session->identifier = identifier;
+            session->flowControlIdentifier = flowControlIdentifier;
+            session->size = static_cast<uint16_t>(message.size());
+            session->sent = static_cast<uint16_t>(firstSize);
+            session->sequence = 1;
+            session->waitingSince = m_now;
+            session->active = true;
+            return Status::pending;
+        }
+
+        // sends the next block, complete once the last consecutive frame went out
+        [[nodiscard]] Status onFlowControl(Bus &bus, const Frame &frame) noexcept
+        {
+            auto *session = find(&Session::flowControlIdentifier, frame.identifier);
+            if (session == nullptr || frame.length < 3)
+            {
+                return Status::invalid;
+            }
+            const auto status = static_cast<FlowStatus>(std::to_integer<uint8_t>(frame.payload[0]) & 0x0FU);
+            session->waitingSince = m_now;
+            if (status == FlowStatus::wait)
+            {
+                return Status::pending;
+            }
+            if (status != FlowStatus::continueToSend)
+            {
+                session->active = false;
+                return Status::overflow;
+            }
+
+            // STmin is left to the driver, frames of one block are handed to the bus back to back
+            const auto blockSize = std::to_integer<uint8_t>(frame.payload[1]);
+            for (size_t block = 0; session->sent < session->size && (blockSize == 0 || block < blockSize); ++block)
+            {
+                const auto chunk = std::min<size_t>(PayloadCapacity - 1U, session->size - session->sent);
+                Frame consecutive{ .identifier = session->identifier, .length = static_cast<uint8_t>(1U + chunk) };
+                consecutive.payload[0] = pci(FrameType::consecutive, session->sequence);
+                std::copy_n(session->data.begin() + session->sent, chunk, consecutive.payload.begin() + 1);
+                if (!bus.send(consecutive))
+                {
+                    session->active = false;
+                    return Status::sendFailed;
+                }
+                session->sent = static_cast<uint16_t>(session->sent + chunk);
+                session->sequence = static_cast<uint8_t>((session->sequence + 1U) & 0x0FU);
+            }
+            if (session->sent < session->size)
+            {
+                return Status::pending;
+            }
+            session->active = false;
+            return Status::complete;
+        }
+
+        // advances the time in milliseconds and drops the sessions that waited longer than
+        // FlowControlTimeout for flow control; returns the number of dropped sessions
+        size_t poll(uint32_t now) noexcept
+        {
+            size_t dropped = 0;
+            for (auto &session : m_sessions)
+            {
+                // sessions started before the first poll start waiting now
+                session.waitingSince = m_polled ? session.waitingSince : now;
+            }
+            m_now = now;
+            m_polled = true;
+            for (auto &session : m_sessions)
+            {
+                if (session.active && expired(session))
+                {
+                    session.active = false;
+                    ++dropped;
+                }
+            }
+            return dropped;
+        }
+
+        // drops the transfer of identifier, false when none is in flight
+        bool abort(uint32_t identifier) noexcept
+        {
+            auto *session = find(&Session::identifier, identifier);
+            if (session == nullptr)
+            {
+                return false;
+            }
+            session->active = false;
+            return true;
+        }
+
+        [[nodiscard]] size_t activeSessions() const noexcept
+        {
+            return static_cast<size_t>(std::ranges::count(m_sessions, true, &Session::active));
+        }
+
+      private:
+        struct Session
+        {
+            uint32_t identifier{};
+            uint32_t flowControlIdentifier{};
+            uint16_t size{};
+            uint16_t sent{};
+            uint8_t sequence{};
+            bool active{ false };
+            uint32_t waitingSince{};
+            std::array<std::byte, MessageCapacity> data{};
+        };
+
+        [[nodiscard]] bool expired(const Session &session) const noexcept
+        {
+            return m_now - session.waitingSince >= FlowControlTimeout;
+        }
+
+        [[nodiscard]] Session *find(uint32_t Session::*member, uint32_t identifier) noexcept
+        {
+            const auto session = std::ranges::find_if(m_sessions, [member, identifier](const Session &candidate) { return candidate.active && candidate.*member == identifier; });
+            return session != m_sessions.end() ? &*session : nullptr;
+        }
+
+        std::array<Session, Sessions> m_sessions{};
+        uint32_t m_now{ 0 };
+        bool m_polled{ false };
+    };
+
+    // Reassembles segmented messages in a fixed pool. A first frame restarts the session of its identifier
+    // or takes a free one; with all sessions in use the least recently active one is dropped. Flow control
+    // frames are sent on the flowControlIdentifier passed with each frame, which must differ from the frame
+    // identifier. Partial messages whose next consecutive frame does not arrive within
+    // ConsecutiveFrameTimeout are dropped by poll(now).
+    template<size_t PayloadCapacity, size_t MessageCapacity, size_t Sessions, uint8_t BlockSize = 0>
+    class Receiver
+    {
+        static_assert(PayloadCapacity >= 8 && MessageCapacity <= MaximumMessageSize && Sessions > 0);
+
+      public:
+        [[nodiscard]] Outcome receive(Bus &bus, const Frame &frame, uint32_t flowControlIdentifier) noexcept
+        {
+            if (frame.length == 0 || frame.length > PayloadCapacity || frame.identifier == flowControlIdentifier)
+            {
+                return { .status = Status::invalid };
+            }
+            ++m_clock;
+            switch (typeOf(frame))
+            {
+                case FrameType::single:
+                    return single(frame);
+                case FrameType::first:
+                    return first(bus, frame, flowControlIdentifier);
+                case FrameType::consecutive:
+                    return consecutive(bus, frame, flowControlIdentifier);
+                default:
+                    return { .status = Status::invalid };
+            }
+        }
+
+        // advances the time in milliseconds and drops the partial messages that waited longer than
+        // ConsecutiveFrameTimeout for their next consecutive frame; returns the number of dropped messages
+        size_t poll(uint32_t now) noexcept
+        {
+            size_t dropped = 0;
+            for (auto &session : m_sessions)
+            {
+                // sessions started before the first poll start waiting now
+                session.waitingSince = m_polled ? session.waitingSince : now;
+            }
+            m_now = now;
+            m_polled = true;
+            for (auto &session : m_sessions)
+            {
+                if (session.active && m_now - session.waitingSince >= ConsecutiveFrameTimeout)
+                {
+                    session.active = false;
+                    ++dropped;
+                }
+            }
+            return dropped;
+        }
+
+        [[nodiscard]] size_t activeSessions() const noexcept
+        {
+            return static_cast<size_t>(std::ranges::count(m_sessions, true, &Session::active));
+        }
+
+      private:
+        struct Session
+        {
+            uint32_t identifier{};
+            uint16_t size{};
+            uint16_t received{};
+            uint8_t sequence{};
+            uint8_t block{};
+            bool active{ false };
+            uint32_t lastUse{};
+            uint32_t waitingSince{};
+            std::array<std::byte, MessageCapacity> data{};
+        };
+
+        [[nodiscard]] static Outcome single(const Frame &frame) noexcept
+        {
+            size_t size = std::to_integer<uint8_t>(frame.payload[0]) & 0x0FU;
+            size_t offset = 1;
+            if (size == 0 && frame.length > 1)
+            {
+                size = std::to_integer<uint8_t>(frame.payload[1]);
+                offset = 2;
+            }
+            if (size == 0 || offset + size > frame.length)
+            {
+                return { .status = Status::invalid };
+            }
+            return { .status = Status::complete, .message = std::span<const std::byte>{ frame.payload }.subspan(offset, size) };
+        }
+
+        [[nodiscard]] Outcome first(Bus &bus, const Frame &frame, uint32_t flowControlIdentifier) noexcept
+        {
+            const size_t size = ((std::to_integer<size_t>(frame.payload[0]) & 0x0FU) << 8U) | std::to_integer<size_t>(frame.payload[1]);
+            if (frame.length != PayloadCapacity || size <= singleFrameLimit<PayloadCapacity>())
+            {
+                return { .status = Status::invalid };
+            }
+            if (size > MessageCapacity)
+            {
+                std::ignore = sendFlowControl(bus, flowControlIdentifier, FlowStatus::overflow);
+                return { .status = Status::overflow };
+            }
+
+            auto &session = claim(frame.identifier);
+            const auto firstSize = PayloadCapacity - 2U;
+            std::copy_n(frame.payload.begin() + 2, firstSize, session.data.begin());
+            session.identifier = frame.identifier;
+            session.size = static_cast<uint16_t>(size);
+            session.received = static_cast<uint16_t>(firstSize);
+            session.sequence = 1;
+            session.block = 0;
+            session.active = true;
+            session.lastUse = m_clock;
+            session.waitingSince = m_now;
+            if (!sendFlowControl(bus, flowControlIdentifier, FlowStatus::continueToSend))
+            {
+                session.active = false;
+                return { .status = Status::sendFailed };
+            }
+            return { .status = Status::pending };
+        }
+
+        [[nodiscard]] Outcome consecutive(Bus &bus, const Frame &frame, uint32_t flowControlIdentifier) noexcept
+        {
+            auto session = std::ranges::find_if(m_sessions, [&frame](const Session &candidate) { return candidate.active && candidate.identifier == frame.identifier; });
+            if (session == m_sessions.end())
+            {
+                return { .status = Status::invalid };
+            }
+            const auto chunk = std::min<size_t>(PayloadCapacity - 1U, session->size - session->received);
+            if ((std::to_integer<uint8_t>(frame.payload[0]) & 0x0FU) != session->sequence || frame.length < 1U + chunk)
+            {
+                session->active = false;
+                return { .status = Status::invalid };
+            }
+            std::copy_n(frame.payload.begin() + 1, chunk, session->data.begin() + session->received);
+            session->received = static_cast<uint16_t>(session->received + chunk);
+            session->sequence = static_cast<uint8_t>((session->sequence + 1U) & 0x0FU);
+            session->lastUse = m_clock;
+            session->waitingSince = m_now;
+            if (session->received == session->size)
+            {
+                session->active = false;
+                return { .status = Status::complete, .message = std::span<const std::byte>{ session->data }.first(session->size) };
+            }
+            if (BlockSize != 0 && ++session->block == BlockSize)
+            {
+                session->block = 0;
+                if (!sendFlowControl(bus, flowControlIdentifier, FlowStatus::continueToSend))
+                {
+                    session->active = false;
+                    return { .status = Status::sendFailed };
+                }
+            }
+            return { .status = Status::pending };
+        }
+
+        [[nodiscard]] Session &claim(uint32_t identifier) noexcept
+        {
+            Session *oldest = &m_sessions.front();
+            for (auto &session : m_sessions)
+            {
+                if (session.active && session.identifier == identifier)
+                {
+                    return session;
+                }
+                if (!session.active)
+                {
+                    oldest = oldest->active ? &session : oldest;
+                }
+                else if (oldest->active && session.lastUse < oldest->lastUse)
+                {
+                    oldest = &session;
+                }
+            }
+            return *oldest;
+        }
+
+        [[nodiscard]] static bool sendFlowControl(Bus &bus, uint32_t identifier, FlowStatus status) noexcept
+        {
+            Frame frame{ .identifier = identifier, .length = 3 };
+            frame.payload[0] = pci(FrameType::flowControl, static_cast<uint8_t>(status));
+            frame.payload[1] = static_cast<std::byte>(BlockSize);
+            return bus.send(frame);
+        }
+
+        std::array<Session, Sessions> m_sessions{};
+        uint32_t m_clock{ 0 };
+        uint32_t m_now{ 0 };
+        bool m_polled{ false };
+    };
+}// namespace DataLayer::Can::IsoTp
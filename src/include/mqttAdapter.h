@@ -1,11 +1,12 @@
 #pragma once
 
+#include <array>
 #include <cstddef>
-#include <cstring>
 #include <dispatcher.h>
 #include <span>
 #include <string_view>
 #include <type_traits>
+#include <wireCodec.h>
 
 namespace DataLayer::Mqtt
 {
@@ -14,7 +15,8 @@ namespace DataLayer::Mqtt
         ok,
         publishFailed,
         invalidPayload,
-        rejected
+        rejected,
+        unknownTopic
     };
 
     class Client
@@ -35,22 +37,77 @@ namespace DataLayer::Mqtt
         [[nodiscard]] Result publish(std::string_view topic, const T &value, bool retain = false) noexcept
         {
             static_assert(std::is_trivially_copyable_v<T>, "MQTT binary transport requires a trivially copyable value");
-            const auto payload = std::as_bytes(std::span{ &value, 1 });
-            return m_client.publish(topic, payload, retain) ? Result::ok : Result::publishFailed;
+            if constexpr (VariableSize<T>)
+            {
+                // the message length carries the used size
+                return m_client.publish(topic, value.bytes(), retain) ? Result::ok : Result::publishFailed;
+            }
+            else
+            {
+                std::array<std::byte, Wire::PayloadSize<T>> payload{};
+                Wire::encode(value, std::span{ payload });
+                return m_client.publish(topic, payload, retain) ? Result::ok : Result::publishFailed;
+            }
         }
 
         template<typename T>
         [[nodiscard]] Result applySet(uint32_t dataPointId, std::span<const std::byte> payload) const noexcept
         {
             static_assert(std::is_trivially_copyable_v<T>, "MQTT binary transport requires a trivially copyable value");
-            if (payload.size() != sizeof(T))
+            T value{};
+            if constexpr (VariableSize<T>)
+            {
+                if (!value.assign(payload))
+                {
+                    return Result::invalidPayload;
+                }
+            }
+            else
+            {
+                if (payload.size() != Wire::PayloadSize<T>)
+                {
+                    return Result::invalidPayload;
+                }
+                value = Wire::decode<T>(payload.template first<Wire::PayloadSize<T>>());
+            }
+            return m_dispatcher.setDatapoint(dataPointId, value).success ? Result::ok : Result::rejected;
+        }
+
+        // one message with the datapoints of a GroupBatch that changed since its last publish, nothing is
+        // sent when none changed and a failed publish is repeated by the next call
+        template<typename Batch>
+        [[nodiscard]] Result publishGroup(std::string_view topic, Batch &batch, bool retain = false) noexcept
+        {
+            const auto message = batch.collect();
+            if (message.empty())
+            {
+                return Result::ok;
+            }
+            if (!m_client.publish(topic, message, retain))
+            {
+                return Result::publishFailed;
+            }
+            batch.commit();
+            return Result::ok;
+        }
+
+        // Answers a protocol request received on a request topic with the ID table, e.g.
+        // ProtocolTable::Table, and publishes the answer to responseTopic; buffer holds the answer.
+        template<typename TableType>
+        [[nodiscard]] Result serve(const TableType &table, std::string_view responseTopic, std::span<const std::byte> request, std::span<std::byte> buffer) noexcept
+        {
+            const auto size = table.respond(request, buffer);
+            if (size == 0)
             {
                 return Result::invalidPayload;
             }
+            return m_client.publish(responseTopic, buffer.first(size), false) ? Result::ok : Result::publishFailed;
+        }
 
-            T value{};
-            std::memcpy(&value, payload.data(), sizeof(T));
-            return m_dispatcher.setDatapoint(dataPointId, value).success ? Result::ok : Result::rejected;
+        template<typename Batch>
+        [[nodiscard]] Result applyGroup(const Batch &batch, std::span<const std::byte> message) const noexcept
+        {
+            return batch.apply(*this, message);
         }
 
       private:
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <dataPointGroupMapping.h>
+#include <mqttAdapter.h>
+#include <packedStore.h>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace DataLayer::Mqtt
+{
+    namespace BatchDetail
+    {
+        inline constexpr size_t HeaderSize = 2U * sizeof(uint16_t);
+        inline constexpr size_t RecordHeaderSize = 2U * sizeof(uint16_t);
+
+        template<typename T>
+        inline constexpr bool IsPackedImage = false;
+
+        template<size_t Words>
+        inline constexpr bool IsPackedImage<PackedImage<Words>> = true;
+
+        // readable datapoints are batched, packed stores are not since their members are
+        template<typename DataPoint>
+        inline constexpr bool Batched = Helper::ReadConcept<std::remove_cvref_t<decltype(DataPoint::TypeAccess)>> && !IsPackedImage<Wire::ValueOf<DataPoint>>;
+
+        template<typename DataPoint>
+        inline constexpr size_t MaximumPayload = Batched<DataPoint> ? Wire::MaximumPayload<Wire::ValueOf<DataPoint>> : 0U;
+    }// namespace BatchDetail
+
+    // Changed datapoints of one group in one message: group base ID and record count, then per record the
+    // datapoint ID, the payload length and the wire payload, all little endian 16 bit fields. The last
+    // published payload of every datapoint is kept in a fixed shadow buffer, so a value counts as changed
+    // however it was written. Nothing is allocated; collect and commit must not run concurrently.
+    template<typename GroupInfo, typename... Datapoints>
+    class GroupBatch
+    {
+        static constexpr size_t Count = sizeof...(Datapoints);
+        static constexpr std::array<size_t, Count> Sizes{ BatchDetail::MaximumPayload<Datapoints>... };
+        static constexpr std::array<size_t, Count> ShadowOffsets = [] {
+            std::array<size_t, Count> offsets{};
+            for (size_t index = 1; index < Count; ++index)
+            {
+                offsets[index] = offsets[index - 1U] + Sizes[index - 1U];
+            }
+            return offsets;
+        }();
+        static constexpr size_t ShadowSize = (BatchDetail::MaximumPayload<Datapoints> + ... + 0U);
+
+      public:
+        using Mapping = GroupDataPointMapping<GroupInfo, Datapoints...>;
+
+        // largest message, every batched datapoint changed
+        static constexpr size_t Capacity = BatchDetail::HeaderSize + ((BatchDetail::Batched<Datapoints> ? BatchDetail::RecordHeaderSize : 0U) + ... + 0U) + ShadowSize;
+
+        static_assert(Capacity <= UINT16_MAX, "a group batch must fit 16 bit lengths");
+
+        constexpr explicit GroupBatch(const Mapping &mapping) noexcept : m_mapping(mapping)
+        {}
+
+        // message of the datapoints that differ from the last committed one, empty when nothing changed
+        [[nodiscard]] std::span<const std::byte> collect() noexcept
+        {
+            m_size = BatchDetail::HeaderSize;
+            m_records = 0;
+            collectAll(std::index_sequence_for<Datapoints...>{});
+            if (m_records == 0)
+            {
+                return {};
+            }
+            Wire::store(m_message.data(), m_mapping.group.baseId);
+            Wire::store(m_message.data() + 2, m_records);
+            return std::span{ m_message }.first(m_size);
+        }
+
+        // the collected values were published and become the reference of the next collect
+        void commit() noexcept
+        {
+            for (size_t index = 0; index < Count; ++index)
+            {
+                if (m_offsets[index] != 0)
+                {
+                    const auto *payload = m_message.data() + m_offsets[index];
+                    m_lengths[index] = Wire::load(payload - 2);
+                    std::memcpy(m_shadow.data() + ShadowOffsets[index], payload, m_lengths[index]);
+                    m_published[index] = true;
+                }
+            }
+        }
+
+        // the next collect contains every batched datapoint, e.g. after a reconnect
+        void invalidate() noexcept
+        {
+            m_published.fill(false);
+        }
+
+        // Applies every record through the typed applySet. A malformed message is rejected before anything is
+        // written; otherwise all records are applied and the first failing result is returned.
+        template<typename DispatcherType>
+        [[nodiscard]] Result apply(const Adapter<DispatcherType> &adapter, std::span<const std::byte> message) const noexcept
+        {
+            if (message.size() < BatchDetail::HeaderSize || Wire::load(message.data()) != m_mapping.group.baseId)
+            {
+                return Result::invalidPayload;
+            }
+            const auto records = Wire::load(message.data() + 2);
+            size_t offset = BatchDetail::HeaderSize;
+            for (size_t record = 0; record < records; ++record)
+            {
+                if (message.size() - offset < BatchDetail::RecordHeaderSize
+                    || message.size() - offset - BatchDetail::RecordHeaderSize < Wire::load(message.data() + offset + 2))
+                {
+                    return Result::invalidPayload;
+                }
+                offset += BatchDetail::RecordHeaderSize + Wire::load(message.data() + offset + 2);
+            }
+            if (offset != message.size())
+            {
+                return Result::invalidPayload;
+            }
+
+            auto result = Result::ok;
+            offset = BatchDetail::HeaderSize;
+            for (size_t record = 0; record < records; ++record)
+            {
+                const auto dataPointId = Wire::load(message.data() + offset);
+                const auto payload = message.subspan(offset + BatchDetail::RecordHeaderSize, Wire::load(message.data() + offset + 2));
+                const auto applied = applyRecord(adapter, dataPointId, payload);
+                result = result == Result::ok ? applied : result;
+                offset += BatchDetail::RecordHeaderSize + payload.size();
+            }
+            return result;
+        }
+
+      private:
+        template<size_t... Index>
+        void collectAll(std::index_sequence<Index...>) noexcept
+        {
+            (collectOne<Index>(), ...);
+        }
+
+        template<size_t Index>
+        void collectOne() noexcept
+        {
+            using DataPoint = std::tuple_element_t<Index, std::tuple<Datapoints...>>;
+            m_offsets[Index] = 0;
+            if constexpr (BatchDetail::Batched<DataPoint>)
+            {
+                using T = Wire::ValueOf<DataPoint>;
+                const auto &dataPoint = std::get<Index>(m_mapping.datapoints);
+                // the payload is encoded in place and only kept when it differs from the shadow
+                auto *payload = m_message.data() + m_size + BatchDetail::RecordHeaderSize;
+                size_t length = Wire::PayloadSize<T>;
+                if constexpr (VariableSize<T>)
+                {
+                    const auto value = dataPoint();
+                    length = value.bytes().size();
+                    std::memcpy(payload, value.bytes().data(), length);
+                }
+                else
+                {
+                    Wire::encode(dataPoint(), std::span<std::byte, Wire::PayloadSize<T>>{ payload, Wire::PayloadSize<T> });
+                }
+                if (m_published[Index] && m_lengths[Index] == length && std::memcmp(m_shadow.data() + ShadowOffsets[Index], payload, length) == 0)
+                {
+                    return;
+                }
+                Wire::store(payload - 4, dataPoint.getId());
+                Wire::store(payload - 2, static_cast<uint16_t>(length));
+                m_offsets[Index] = static_cast<uint16_t>(m_size + BatchDetail::RecordHeaderSize);
+                m_size += BatchDetail::RecordHeaderSize + length;
+                ++m_records;
+            }
+        }
+
+        // rejected for IDs outside the group and datapoints without write access
+        template<typename DispatcherType>
+        [[nodiscard]] static Result applyRecord(const Adapter<DispatcherType> &adapter, uint16_t dataPointId, std::span<const std::byte> payload) noexcept
+        {
+            auto result = Result::rejected;
+            std::ignore = ((Datapoints::matchesId(dataPointId) && (result = applyTo<Datapoints>(adapter, dataPointId, payload), true)) || ...);
+            return result;
+        }
+
+        template<typename DataPoint, typename DispatcherType>
+        [[nodiscard]] static Result applyTo(const Adapter<DispatcherType> &adapter, uint16_t dataPointId, std::span<const std::byte> payload) noexcept
+        {
+            if constexpr (BatchDetail::Batched<DataPoint> && Helper::WriteConcept<std::remove_cvref_t<decltype(DataPoint::TypeAccess)>>)
+            {
+                return adapter.template applySet<Wire::ValueOf<DataPoint>>(dataPointId, payload);
+            }
+            else
+            {
+                return Result::rejected;
+            }
+        }
+
+        const Mapping &m_mapping;
+        std::array<std::byte, Capacity> m_message{};
+        std::array<std::byte, ShadowSize> m_shadow{};
+        std::array<uint16_t, Count> m_lengths{};
+        // payload offset of each datapoint in the collected message, 0 when it is not part of it
+        std::array<uint16_t, Count> m_offsets{};
+        std::array<bool, Count> m_published{};
+        size_t m_size{ 0 };
+        uint16_t m_records{ 0 };
+    };
+
+    template<typename GroupInfo, typename... Datapoints>
+    GroupBatch(const GroupDataPointMapping<GroupInfo, Datapoints...> &) -> GroupBatch<GroupInfo, Datapoints...>;
+}// namespace DataLayer::Mqtt
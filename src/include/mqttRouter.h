@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mqttAdapter.h>
+#include <span>
+#include <string_view>
+
+namespace DataLayer::Mqtt
+{
+    // canonical topic of a datapoint, specialised by the generated datalayer.h
+    template<auto &DataPoint>
+    inline constexpr std::string_view Topic{};
+
+    // seeded FNV-1a with the murmur3 finalizer for usable low bits, the generator computes the router seeds
+    // with the same function
+    [[nodiscard]] constexpr uint32_t topicHash(std::string_view topic, uint32_t seed) noexcept
+    {
+        uint32_t hash = 2166136261U ^ seed;
+        for (const char character : topic)
+        {
+            hash ^= static_cast<uint8_t>(character);
+            hash *= 16777619U;
+        }
+        hash = (hash ^ (hash >> 16U)) * 0x85EBCA6BU;
+        hash = (hash ^ (hash >> 13U)) * 0xC2B2AE35U;
+        return hash ^ (hash >> 16U);
+    }
+
+    template<typename DispatcherType>
+    struct Route
+    {
+        using Setter = Result (Adapter<DispatcherType>::*)(uint32_t, std::span<const std::byte>) const noexcept;
+
+        std::string_view topic{};
+        uint32_t dataPointId{};
+        Setter apply{ nullptr };
+    };
+
+    // Perfect hash from the topics of the writable datapoints to their typed setters, generated as
+    // MqttTopics::Router. The first hash selects a bucket whose seed places every topic of the bucket in its
+    // own slot, so a lookup costs two hashes and one compare independent of the model size.
+    template<typename DispatcherType, size_t Buckets, size_t Slots>
+    struct Router
+    {
+        static_assert(Buckets > 0 && Slots > 0);
+
+        std::array<uint32_t, Buckets> seeds{};
+        std::array<Route<DispatcherType>, Slots> routes{};
+
+        // nullptr for topics without a writable datapoint
+        [[nodiscard]] constexpr const Route<DispatcherType> *find(std::string_view topic) const noexcept
+        {
+            const auto &route = routes[topicHash(topic, seeds[topicHash(topic, 0) % Buckets]) % Slots];
+            return route.apply != nullptr && route.topic == topic ? &route : nullptr;
+        }
+
+        [[nodiscard]] Result apply(const Adapter<DispatcherType> &adapter, std::string_view topic, std::span<const std::byte> payload) const noexcept
+        {
+            const auto *route = find(topic);
+            return route != nullptr ? (adapter.*route->apply)(route->dataPointId, payload) : Result::unknownTopic;
+        }
+    };
+}// namespace DataLayer::Mqtt
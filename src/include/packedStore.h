@@ -0,0 +1,320 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <detail.h>
+#include <groupInfo.h>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <writeHooks.h>
+
+namespace DataLayer
+{
+    // position of one packed datapoint inside its store, initial holds the default value
+    struct PackedField
+    {
+        uint16_t dataPointId{};
+        uint16_t offset{};
+        uint8_t width{};
+        uint32_t initial{};
+    };
+
+    // record payload of a store, the layout hash guards against restoring bits of another field layout
+    template<size_t Words>
+    struct PackedImage
+    {
+        uint32_t layout{};
+        std::array<uint32_t, Words> words{};
+    };
+
+    // Bits of the packed bool and small enum datapoints of one group. A field never crosses a word, so single
+    // bits are set and cleared with one atomic fetch_or/fetch_and and wider fields with a compare exchange loop.
+    // The store itself is a member of the group mapping and is persisted as one record.
+    template<GroupInfo group, uint16_t id, size_t Bits, auto Version = Version{ 0, 0, 0 }, FixedString Name = { "" }>
+    class PackedStore
+    {
+        static_assert(Bits > 0);
+
+      public:
+        static constexpr size_t Words = (Bits + 31U) / 32U;
+        using Image = PackedImage<Words>;
+
+        constexpr static Helper::READ_ONLY TypeAccess{};
+
+        static constexpr std::string_view name{ Name };
+
+        template<size_t N>
+        consteval explicit PackedStore(const std::array<PackedField, N> &fields)
+          : PackedStore(initialWords(fields), layoutHash(fields), std::make_index_sequence<Words>{})
+        {}
+
+        PackedStore(const PackedStore &) = delete;
+        PackedStore &operator=(const PackedStore &) = delete;
+
+        [[nodiscard]] constexpr static uint16_t getId() noexcept
+        {
+            return group.baseId + id;
+        }
+
+        [[nodiscard]] constexpr static bool matchesId(uint32_t dataPointId) noexcept
+        {
+            return dataPointId == getId();
+        }
+
+        [[nodiscard]] constexpr static auto getLegacyIds() noexcept
+        {
+            return std::array<uint16_t, 0>{};
+        }
+
+        [[nodiscard]] constexpr static auto getVersion() noexcept
+        {
+            return Version;
+        }
+
+        [[nodiscard]] static constexpr bool getIsUpgradeAllowed() noexcept
+        {
+            return false;
+        }
+
+        // snapshot of all words, each word is read atomically but not the store as a whole
+        [[nodiscard]] Image operator()() const noexcept
+        {
+            Image image{ .layout = m_layout };
+            for (size_t word = 0; word < Words; ++word)
+            {
+                image.words[word] = m_words[word].load(std::memory_order_acquire);
+            }
+            return image;
+        }
+
+        // false if the payload was written for another field layout, the bits are then left untouched
+        [[nodiscard]] bool restore(std::span<const std::byte> payload) noexcept
+        {
+            Image image{};
+            if (payload.size() != sizeof(Image))
+            {
+                return false;
+            }
+            std::memcpy(&image, payload.data(), sizeof(Image));
+            if (image.layout != m_layout)
+            {
+                return false;
+            }
+            for (size_t word = 0; word < Words; ++word)
+            {
+                m_words[word].store(image.words[word], std::memory_order_release);
+            }
+            return true;
+        }
+
+        [[nodiscard]] bool testBit(size_t offset) const noexcept
+        {
+            return (m_words[offset / 32U].load(std::memory_order_acquire) & bit(offset)) != 0U;
+        }
+
+        void setBit(size_t offset) noexcept
+        {
+            m_words[offset / 32U].fetch_or(bit(offset), std::memory_order_acq_rel);
+        }
+
+        void clearBit(size_t offset) noexcept
+        {
+            m_words[offset / 32U].fetch_and(~bit(offset), std::memory_order_acq_rel);
+        }
+
+        template<uint8_t Width>
+        [[nodiscard]] uint32_t load(size_t offset) const noexcept
+        {
+            return (m_words[offset / 32U].load(std::memory_order_acquire) >> (offset % 32U)) & mask<Width>();
+        }
+
+        template<uint8_t Width>
+        void store(size_t offset, uint32_t value) noexcept
+        {
+            if constexpr (Width == 1)
+            {
+                value != 0U ? setBit(offset) : clearBit(offset);
+            }
+            else
+            {
+                const auto shift = offset % 32U;
+                auto &word = m_words[offset / 32U];
+                auto current = word.load(std::memory_order_relaxed);
+                while (!word.compare_exchange_weak(current,
+                  (current & ~(mask<Width>() << shift)) | ((value & mask<Width>()) << shift),
+                  std::memory_order_acq_rel,
+                  std::memory_order_relaxed))
+                {
+                }
+            }
+        }
+
+      private:
+        template<size_t... Positions>
+        consteval PackedStore(const std::array<uint32_t, Words> &words, uint32_t layout, std::index_sequence<Positions...>)
+          : m_words{ words[Positions]... }, m_layout(layout)
+        {}
+
+        template<uint8_t Width>
+        [[nodiscard]] static constexpr uint32_t mask() noexcept
+        {
+            static_assert(Width > 0 && Width < 32);
+            return (uint32_t{ 1 } << Width) - 1U;
+        }
+
+        [[nodiscard]] static constexpr uint32_t bit(size_t offset) noexcept
+        {
+            return uint32_t{ 1 } << (offset % 32U);
+        }
+
+        template<size_t N>
+        [[nodiscard]] static consteval std::array<uint32_t, Words> initialWords(const std::array<PackedField, N> &fields) noexcept
+        {
+            std::array<uint32_t, Words> words{};
+            for (const auto &field : fields)
+            {
+                words.at(field.offset / 32U) |= field.initial << (field.offset % 32U);
+            }
+            return words;
+        }
+
+        // FNV-1a over ID, offset and width of every field
+        template<size_t N>
+        [[nodiscard]] static consteval uint32_t layoutHash(const std::array<PackedField, N> &fields) noexcept
+        {
+            uint32_t hash = 2166136261U;
+            const auto mix = [&hash](uint32_t value) {
+                for (size_t byte = 0; byte < sizeof(value); ++byte)
+                {
+                    hash = (hash ^ ((value >> (byte * 8U)) & 0xFFU)) * 16777619U;
+                }
+            };
+            for (const auto &field : fields)
+            {
+                mix(field.dataPointId);
+                mix(field.offset);
+                mix(field.width);
+            }
+            return hash;
+        }
+
+        std::array<std::atomic<uint32_t>, Words> m_words;
+        uint32_t m_layout;
+    };
+
+    // bool or small enum datapoint without storage of its own, the value lives in Width bits of a PackedStore
+    template<typename T,
+      GroupInfo group,
+      uint16_t id,
+      typename Access,
+      auto Version,
+      FixedString Name,
+      auto &Store,
+      uint16_t Offset,
+      uint8_t Width,
+      uint16_t... LegacyIds>
+    class PackedDataPoint
+    {
+        static_assert(std::is_same_v<T, bool> || std::is_enum_v<T>, "only bool and enum datapoints can be packed");
+        static_assert(Width > 0 && Width <= 8 && Offset % 32U + Width <= 32U, "a packed field must fit into one word");
+
+      public:
+        // persisted through the record of its store
+        static constexpr bool PackedMember = true;
+
+        constexpr static Access TypeAccess{};
+
+        consteval PackedDataPoint() = default;
+
+        static constexpr std::string_view name{ Name };
+
+        [[nodiscard]] constexpr static uint16_t getId() noexcept
+        {
+            return group.baseId + id;
+        }
+
+        [[nodiscard]] constexpr static bool matchesId(uint32_t dataPointId) noexcept
+        {
+            return dataPointId == getId() || ((dataPointId == group.baseId + LegacyIds) || ...);
+        }
+
+        [[nodiscard]] constexpr static auto getLegacyIds() noexcept
+        {
+            return std::array<uint16_t, sizeof...(LegacyIds)>{ static_cast<uint16_t>(group.baseId + LegacyIds)... };
+        }
+
+        [[nodiscard]] constexpr static auto getVersion() noexcept
+        {
+            return Version;
+        }
+
+        [[nodiscard]] static constexpr bool getIsUpgradeAllowed() noexcept
+        {
+            return false;
+        }
+
+        [[nodiscard]] static bool tryMigrate(const DataLayer::Version &, std::span<const std::byte>, T &) noexcept
+        {
+            return false;
+        }
+
+        // function to read everytime
+        [[nodiscard]] T operator()() const noexcept
+        {
+            return static_cast<T>(Store.template load<Width>(Offset));
+        }
+
+        // function to write anyway
+        const PackedDataPoint &operator=(const T &value) const noexcept
+        {
+            setValue(value);
+            return *this;
+        }
+
+        // function that will be restricted by READ and READ_WRITE access
+        template<typename A = Access>
+            requires Helper::ReadConcept<A>
+        [[nodiscard]] T get() const noexcept
+        {
+            return (*this)();
+        }
+
+        // function that will be restricted by WRITE and READ_WRITE access
+        template<typename A = Access>
+            requires Helper::WriteConcept<A>
+        [[nodiscard]] auto set(const T &value) const noexcept
+        {
+            return setValue(value);
+        }
+
+      private:
+        static Detail::RangeCheck setValue(const T &value) noexcept
+        {
+            uint32_t bits = 0;
+            if constexpr (std::is_enum_v<T>)
+            {
+                const auto underlying = std::to_underlying(value);
+                if (std::cmp_less(underlying, 0))
+                {
+                    return Detail::RangeCheck::underflow;
+                }
+                if (std::cmp_greater_equal(underlying, uint32_t{ 1 } << Width))
+                {
+                    return Detail::RangeCheck::overflow;
+                }
+                bits = static_cast<uint32_t>(underlying);
+            }
+            else
+            {
+                bits = value ? 1U : 0U;
+            }
+            Store.template store<Width>(Offset, bits);
+            Detail::notifyWrite(getId(), valueBytes(value));
+            return Detail::RangeCheck::ok;
+        }
+    };
+}// namespace DataLayer
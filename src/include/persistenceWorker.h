@@ -0,0 +1,221 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <future>
+#include <mutex>
+#include <serialization.h>
+#include <stop_token>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace DataLayer::Persistence
+{
+    struct WorkerMetrics
+    {
+        // submitted writes that are not yet durable
+        size_t queueDepth{ 0 };
+        size_t maxQueueDepth{ 0 };
+        uint64_t completed{ 0 };
+        uint64_t failed{ 0 };
+        // submissions merged into a pending write of the same file
+        uint64_t coalesced{ 0 };
+        uint64_t batches{ 0 };
+        uint64_t fileSyncs{ 0 };
+        uint64_t directorySyncs{ 0 };
+        // from submit until the file is durable (or failed)
+        std::chrono::microseconds lastLatency{ 0 };
+        std::chrono::microseconds maxLatency{ 0 };
+        std::chrono::microseconds totalLatency{ 0 };
+    };
+
+    // Write-behind persistence on a background thread. submit() encodes a snapshot of the group (or the
+    // whole dispatcher) on the calling thread and returns immediately. Producers fill one queue while the
+    // worker drains the other; all files of a batch are written and fsynced first, then renamed, and
+    // every affected directory is fsynced once for the whole batch.
+    class Worker
+    {
+      public:
+        explicit Worker(bool durable = true) : m_durable(durable), m_thread([this](std::stop_token stopToken) { run(stopToken); })
+        {}
+
+        Worker(const Worker &) = delete;
+        Worker &operator=(const Worker &) = delete;
+        Worker(Worker &&) = delete;
+        Worker &operator=(Worker &&) = delete;
+
+        // pending writes are completed before the thread stops
+        ~Worker()
+        {
+            m_thread.request_stop();
+            m_thread.join();
+        }
+
+        // accepts a group mapping (encodeGroup) or a dispatcher (encodeAll, written as snapshot container)
+        template<typename Source>
+        [[nodiscard]] std::future<SerializationStatus> submit(const Source &source, const std::filesystem::path &path)
+        {
+            std::vector<std::byte> image;
+            SerializationStatus status{};
+            if constexpr (requires { source.encodeAll(image); })
+            {
+                status = source.encodeAll(image);
+            }
+            else
+            {
+                status = source.encodeGroup(image);
+            }
+            if (!status.result)
+            {
+                std::promise<SerializationStatus> failed;
+                failed.set_value(status);
+                return failed.get_future();
+            }
+            return submit(path, std::move(image));
+        }
+
+        [[nodiscard]] std::future<SerializationStatus> submit(const std::filesystem::path &path, std::vector<std::byte> image)
+        {
+            std::promise<SerializationStatus> promise;
+            auto future = promise.get_future();
+            {
+                const std::scoped_lock lock(m_mutex);
+                const auto now = Clock::now();
+                auto pending = std::ranges::find(m_front, path, &Job::path);
+                if (pending != m_front.end())
+                {
+                    // the newer snapshot replaces the queued one, both callers get the result of the write
+                    pending->image = std::move(image);
+                    pending->promises.push_back(std::move(promise));
+                    ++m_metrics.coalesced;
+                }
+                else
+                {
+                    Job job{ .path = path, .image = std::move(image), .submitted = now, .promises = {}, .success = false };
+                    job.promises.push_back(std::move(promise));
+                    m_front.push_back(std::move(job));
+                }
+                ++m_metrics.queueDepth;
+                m_metrics.maxQueueDepth = std::max(m_metrics.maxQueueDepth, m_metrics.queueDepth);
+            }
+            m_wakeup.notify_one();
+            return future;
+        }
+
+        // blocks until everything submitted so far is written
+        void flush()
+        {
+            std::unique_lock lock(m_mutex);
+            m_idle.wait(lock, [this] { return m_metrics.queueDepth == 0; });
+        }
+
+        [[nodiscard]] WorkerMetrics metrics() const
+        {
+            const std::scoped_lock lock(m_mutex);
+            return m_metrics;
+        }
+
+      private:
+        using Clock = std::chrono::steady_clock;
+
+        struct Job
+        {
+            std::filesystem::path path;
+            std::vector<std::byte> image;
+            Clock::time_point submitted;
+            std::vector<std::promise<SerializationStatus>> promises;
+            bool success{ false };
+        };
+
+        void run(const std::stop_token &stopToken)
+        {
+            while (true)
+            {
+                {
+                    std::unique_lock lock(m_mutex);
+                    m_wakeup.wait(lock, stopToken, [this] { return !m_front.empty(); });
+                    if (m_front.empty())
+                    {
+                        return;
+                    }
+                    std::swap(m_front, m_back);
+                }
+                writeBatch();
+                m_back.clear();
+            }
+        }
+
+        void writeBatch()
+        {
+            uint64_t fileSyncs = 0;
+            for (auto &job : m_back)
+            {
+                job.success = stageFile(temporaryPath(job.path), job.image, m_durable);
+                fileSyncs += m_durable ? 1U : 0U;
+            }
+
+            std::vector<std::filesystem::path> directories;
+            for (auto &job : m_back)
+            {
+                job.success = job.success && commitFile(temporaryPath(job.path), job.path);
+                if (job.success && std::ranges::find(directories, job.path.parent_path()) == directories.end())
+                {
+                    directories.push_back(job.path.parent_path());
+                }
+            }
+            if (m_durable)
+            {
+                for (const auto &directory : directories)
+                {
+                    const bool synced = syncDirectory(directory);
+                    for (auto &job : m_back)
+                    {
+                        job.success = job.success && (synced || job.path.parent_path() != directory);
+                    }
+                }
+            }
+
+            const auto finished = Clock::now();
+            {
+                const std::scoped_lock lock(m_mutex);
+                ++m_metrics.batches;
+                m_metrics.fileSyncs += fileSyncs;
+                m_metrics.directorySyncs += m_durable ? directories.size() : 0U;
+                for (const auto &job : m_back)
+                {
+                    const auto latency = std::chrono::duration_cast<std::chrono::microseconds>(finished - job.submitted);
+                    m_metrics.lastLatency = latency;
+                    m_metrics.maxLatency = std::max(m_metrics.maxLatency, latency);
+                    m_metrics.totalLatency += latency;
+                    ++(job.success ? m_metrics.completed : m_metrics.failed);
+                    m_metrics.queueDepth -= job.promises.size();
+                }
+            }
+            for (auto &job : m_back)
+            {
+                const SerializationStatus status{ .result = job.success,
+                                                  .size = job.image.size(),
+                                                  .errorCode = job.success ? SerializationError::None : SerializationError::StorageFailure };
+                for (auto &promise : job.promises)
+                {
+                    promise.set_value(status);
+                }
+            }
+            m_idle.notify_all();
+        }
+
+        bool m_durable;
+        mutable std::mutex m_mutex;
+        std::condition_variable_any m_wakeup;
+        std::condition_variable m_idle;
+        std::vector<Job> m_front;
+        std::vector<Job> m_back;
+        WorkerMetrics m_metrics{};
+        // declared last so it starts after and stops before the members it uses
+        std::jthread m_thread;
+    };
+}// namespace DataLayer::Persistence
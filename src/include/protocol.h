@@ -0,0 +1,453 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <detail.h>
+#include <helper.h>
+#include <span>
+#include <type_traits>
+#include <wireCodec.h>
+
+// Transport independent binary request/response protocol over datapoint IDs. Every message starts with a
+// six byte header: protocol version, operation, sequence and item count, 16 bit fields little endian.
+//
+//   read         request items: ID                      response items: ID, status, length, value
+//   write        request items: ID, length, value       response items: ID, status
+//   subscribe    request items: first ID, last ID       response items: status
+//   unsubscribe  no items, drops every subscription of the sender
+//   notify       sent unrequested, items as a read response
+//   error        response to a request that could not be parsed, one status byte follows the header
+//
+// A read or write carries one or many items, so a single request reads or writes several datapoints.
+// Responses repeat the sequence with ResponseFlag set in the operation. A response that would exceed the
+// buffer answers the leading items only, its count tells how many. Values use the wire encoding, strings
+// their used bytes. Encoding and decoding work on caller buffers and never allocate.
+namespace DataLayer::Protocol
+{
+    inline constexpr uint8_t ProtocolVersion = 1;
+    inline constexpr size_t HeaderSize = 6;
+    inline constexpr uint8_t ResponseFlag = 0x80;
+
+    enum class Operation : uint8_t
+    {
+        read = 1,
+        write = 2,
+        subscribe = 3,
+        unsubscribe = 4,
+        notify = 5,
+        error = 0x7F
+    };
+
+    // underflow and overflow are the RangeCheck results of a rejected write
+    enum class Status : uint8_t
+    {
+        ok,
+        underflow,
+        overflow,
+        unknownId,
+        accessDenied,
+        invalidPayload,
+        noCapacity,
+        invalidRequest
+    };
+
+    struct Header
+    {
+        uint8_t version{ ProtocolVersion };
+        uint8_t operation{};
+        uint16_t sequence{};
+        uint16_t count{};
+    };
+
+    [[nodiscard]] constexpr Status statusOf(DataLayer::Detail::RangeCheck check) noexcept
+    {
+        switch (check)
+        {
+            case DataLayer::Detail::RangeCheck::underflow:
+                return Status::underflow;
+            case DataLayer::Detail::RangeCheck::overflow:
+                return Status::overflow;
+            case DataLayer::Detail::RangeCheck::ok:
+            case DataLayer::Detail::RangeCheck::notChecked:
+                break;
+        }
+        return Status::ok;
+    }
+
+    namespace Detail
+    {
+        template<auto &DataPoint, auto &Model>
+        size_t readValue(std::span<std::byte> output) noexcept;
+
+        template<auto &DataPoint, auto &Model>
+        Status writeValue(std::span<const std::byte> payload) noexcept;
+    }// namespace Detail
+
+    inline constexpr size_t NoSpace = SIZE_MAX;
+
+    inline void storeHeader(std::span<std::byte> output, const Header &header) noexcept
+    {
+        output[0] = std::byte{ header.version };
+        output[1] = std::byte{ header.operation };
+        Wire::store(&output[2], header.sequence);
+        Wire::store(&output[4], header.count);
+    }
+
+    [[nodiscard]] inline bool parseHeader(std::span<const std::byte> message, Header &header) noexcept
+    {
+        if (message.size() < HeaderSize)
+        {
+            return false;
+        }
+        header = Header{ .version = std::to_integer<uint8_t>(message[0]),
+          .operation = std::to_integer<uint8_t>(message[1]),
+          .sequence = Wire::load(&message[2]),
+          .count = Wire::load(&message[4]) };
+        return header.version == ProtocolVersion;
+    }
+
+    // error response to request, response needs HeaderSize + 1 bytes
+    [[nodiscard]] inline size_t error(const Header &request, Status status, std::span<std::byte> response) noexcept
+    {
+        storeHeader(response, Header{ .operation = static_cast<uint8_t>(static_cast<uint8_t>(Operation::error) | ResponseFlag), .sequence = request.sequence });
+        response[HeaderSize] = std::byte{ static_cast<uint8_t>(status) };
+        return HeaderSize + 1U;
+    }
+
+    // Access to one datapoint by ID, read and write are null without the access. read() returns the size
+    // of the encoded value or NoSpace, write() the outcome of the typed setter.
+    struct Entry
+    {
+        uint16_t dataPointId{};
+        uint16_t maximumPayload{};
+        size_t (*read)(std::span<std::byte> output) noexcept { nullptr };
+        Status (*write)(std::span<const std::byte> payload) noexcept { nullptr };
+    };
+
+    // Model is the dispatcher of the datapoint, a group it restores lazily is restored before the first
+    // access. Packed members are declared const but set their bits through a const set(), other const
+    // datapoints are read-only.
+    template<auto &DataPoint, auto &Model>
+    [[nodiscard]] consteval Entry entry() noexcept
+    {
+        using Type = std::remove_cvref_t<decltype(DataPoint)>;
+        using Access = std::remove_cvref_t<decltype(Type::TypeAccess)>;
+        static_assert(!PackedStorage<Type>, "packed stores are served through their members");
+        Entry result{ .dataPointId = Type::getId(), .maximumPayload = static_cast<uint16_t>(Wire::MaximumPayload<Wire::ValueOf<Type>>) };
+        if constexpr (Helper::ReadConcept<Access>)
+        {
+            result.read = &Detail::readValue<DataPoint, Model>;
+        }
+        if constexpr (Helper::WriteConcept<Access> && requires(const Wire::ValueOf<Type> &value) { DataPoint.set(value); })
+        {
+            result.write = &Detail::writeValue<DataPoint, Model>;
+        }
+        return result;
+    }
+
+    // ID table of a model sorted by datapoint ID, generated as ProtocolTable::Table
+    template<size_t Size>
+    struct Table
+    {
+        std::array<Entry, Size> entries{};
+
+        // strictly increasing IDs, checked by the generated table
+        [[nodiscard]] constexpr bool sorted() const noexcept
+        {
+            return std::ranges::adjacent_find(entries, [](const Entry &left, const Entry &right) { return left.dataPointId >= right.dataPointId; }) == entries.end();
+        }
+
+        [[nodiscard]] constexpr const Entry *find(uint16_t dataPointId) const noexcept
+        {
+            const auto entry = std::ranges::lower_bound(entries, dataPointId, {}, &Entry::dataPointId);
+            return entry != entries.end() && entry->dataPointId == dataPointId ? &*entry : nullptr;
+        }
+
+        // Answers a read or write request into response and returns the response size, every other
+        // operation is answered with an invalidRequest error. 0 when response cannot hold an error.
+        [[nodiscard]] size_t respond(std::span<const std::byte> request, std::span<std::byte> response) const noexcept
+        {
+            Header header{};
+            if (response.size() < HeaderSize + 1U)
+            {
+                return 0;
+            }
+            if (!parseHeader(request, header))
+            {
+                return error(header, Status::invalidRequest, response);
+            }
+            switch (static_cast<Operation>(header.operation))
+            {
+                case Operation::read:
+                    return read(header, request, response);
+                case Operation::write:
+                    return write(header, request, response);
+                default:
+                    break;
+            }
+            return error(header, Status::invalidRequest, response);
+        }
+
+      private:
+        [[nodiscard]] size_t read(const Header &header, std::span<const std::byte> request, std::span<std::byte> response) const noexcept
+        {
+            if (request.size() != HeaderSize + header.count * sizeof(uint16_t))
+            {
+                return error(header, Status::invalidRequest, response);
+            }
+            size_t offset = HeaderSize;
+            uint16_t answered = 0;
+            for (; answered < header.count; ++answered)
+            {
+                const auto dataPointId = Wire::load(&request[HeaderSize + answered * sizeof(uint16_t)]);
+                if (response.size() - offset < 5U)
+                {
+                    break;
+                }
+                const auto *entry = find(dataPointId);
+                auto status = entry == nullptr ? Status::unknownId : (entry->read == nullptr ? Status::accessDenied : Status::ok);
+                size_t size = 0;
+                if (status == Status::ok)
+                {
+                    size = entry->read(response.subspan(offset + 5U));
+                    if (size == NoSpace)
+                    {
+                        break;
+                    }
+                }
+                Wire::store(&response[offset], dataPointId);
+                response[offset + 2U] = std::byte{ static_cast<uint8_t>(status) };
+                Wire::store(&response[offset + 3U], static_cast<uint16_t>(size));
+                offset += 5U + size;
+            }
+            storeHeader(response, Header{ .operation = static_cast<uint8_t>(header.operation | ResponseFlag), .sequence = header.sequence, .count = answered });
+            return offset;
+        }
+
+        [[nodiscard]] size_t write(const Header &header, std::span<const std::byte> request, std::span<std::byte> response) const noexcept
+        {
+            // the whole request is validated first, so a malformed one changes nothing
+            size_t input = HeaderSize;
+            for (uint16_t item = 0; item < header.count; ++item)
+            {
+                if (request.size() - input < 4U || request.size() - input - 4U < Wire::load(&request[input + 2U]))
+                {
+                    return error(header, Status::invalidRequest, response);
+                }
+                input += 4U + Wire::load(&request[input + 2U]);
+            }
+            if (input != request.size())
+            {
+                return error(header, Status::invalidRequest, response);
+            }
+
+            input = HeaderSize;
+            size_t offset = HeaderSize;
+            uint16_t answered = 0;
+            for (; answered < header.count && response.size() - offset >= 3U; ++answered)
+            {
+                const auto dataPointId = Wire::load(&request[input]);
+                const auto payload = request.subspan(input + 4U, Wire::load(&request[input + 2U]));
+                input += 4U + payload.size();
+                const auto *entry = find(dataPointId);
+                const auto status = entry == nullptr ? Status::unknownId : (entry->write == nullptr ? Status::accessDenied : entry->write(payload));
+                Wire::store(&response[offset], dataPointId);
+                response[offset + 2U] = std::byte{ static_cast<uint8_t>(status) };
+                offset += 3U;
+            }
+            storeHeader(response, Header{ .operation = static_cast<uint8_t>(header.operation | ResponseFlag), .sequence = header.sequence, .count = answered });
+            return offset;
+        }
+    };
+
+    // Builds a request in a caller buffer, the add functions fail once the buffer is full
+    class Request
+    {
+      public:
+        Request(std::span<std::byte> buffer, Operation operation, uint16_t sequence) noexcept
+          : m_buffer(buffer), m_header{ .operation = static_cast<uint8_t>(operation), .sequence = sequence }, m_size(std::min(HeaderSize, buffer.size()))
+        {}
+
+        bool read(uint16_t dataPointId) noexcept
+        {
+            return add(dataPointId, {}, false);
+        }
+
+        bool write(uint16_t dataPointId, std::span<const std::byte> payload) noexcept
+        {
+            return add(dataPointId, payload, true);
+        }
+
+        template<typename T>
+            requires(!std::convertible_to<const T &, std::span<const std::byte>>)
+        bool write(uint16_t dataPointId, const T &value) noexcept
+        {
+            if constexpr (VariableSize<T>)
+            {
+                return write(dataPointId, value.bytes());
+            }
+            else
+            {
+                std::array<std::byte, Wire::PayloadSize<T>> payload{};
+                Wire::encode(value, std::span{ payload });
+                return write(dataPointId, std::span<const std::byte>{ payload });
+            }
+        }
+
+        bool subscribe(uint16_t firstId, uint16_t lastId) noexcept
+        {
+            if (m_buffer.size() - m_size < 4U)
+            {
+                return false;
+            }
+            Wire::store(&m_buffer[m_size], firstId);
+            Wire::store(&m_buffer[m_size + 2U], lastId);
+            m_size += 4U;
+            ++m_header.count;
+            return true;
+        }
+
+        [[nodiscard]] std::span<const std::byte> message() noexcept
+        {
+            if (m_buffer.size() < HeaderSize)
+            {
+                return {};
+            }
+            storeHeader(m_buffer, m_header);
+            return m_buffer.first(m_size);
+        }
+
+      private:
+        bool add(uint16_t dataPointId, std::span<const std::byte> payload, bool withPayload) noexcept
+        {
+            const auto size = sizeof(uint16_t) + (withPayload ? sizeof(uint16_t) + payload.size() : 0U);
+            if (m_buffer.size() - m_size < size || payload.size() > UINT16_MAX)
+            {
+                return false;
+            }
+            Wire::store(&m_buffer[m_size], dataPointId);
+            if (withPayload)
+            {
+                Wire::store(&m_buffer[m_size + 2U], static_cast<uint16_t>(payload.size()));
+                std::ranges::copy(payload, m_buffer.begin() + static_cast<ptrdiff_t>(m_size + 4U));
+            }
+            m_size += size;
+            ++m_header.count;
+            return true;
+        }
+
+        std::span<std::byte> m_buffer;
+        Header m_header;
+        size_t m_size;
+    };
+
+    // Calls callback(dataPointId, status, payload) for every item of a read, write, subscribe or notify
+    // answer; write items carry no payload and subscribe items use the range index as ID. False when the
+    // message is truncated or not an answer.
+    template<typename Callback>
+    [[nodiscard]] bool forEachItem(std::span<const std::byte> message, Callback &&callback)
+    {
+        Header header{};
+        if (!parseHeader(message, header))
+        {
+            return false;
+        }
+        const auto operation = static_cast<Operation>(header.operation & ~ResponseFlag);
+        const bool values = operation == Operation::read || operation == Operation::notify;
+        if (operation != Operation::notify && (header.operation & ResponseFlag) == 0U)
+        {
+            return false;
+        }
+        size_t offset = HeaderSize;
+        for (uint16_t item = 0; item < header.count; ++item)
+        {
+            if (operation == Operation::subscribe)
+            {
+                if (message.size() - offset < 1U)
+                {
+                    return false;
+                }
+                callback(item, static_cast<Status>(message[offset]), std::span<const std::byte>{});
+                offset += 1U;
+                continue;
+            }
+            const auto fixed = values ? 5U : 3U;
+            if (message.size() - offset < fixed)
+            {
+                return false;
+            }
+            const auto size = values ? Wire::load(&message[offset + 3U]) : uint16_t{ 0 };
+            if (message.size() - offset - fixed < size)
+            {
+                return false;
+            }
+            callback(Wire::load(&message[offset]), static_cast<Status>(message[offset + 2U]), message.subspan(offset + fixed, size));
+            offset += fixed + size;
+        }
+        return offset == message.size();
+    }
+
+    namespace Detail
+    {
+        template<auto &DataPoint, auto &Model>
+        void restore() noexcept
+        {
+#ifdef USE_FILE_PERSISTENCE
+            Model.restoreOnAccess(DataPoint.getId());
+#endif
+        }
+
+        template<auto &DataPoint, auto &Model>
+        size_t readValue(std::span<std::byte> output) noexcept
+        {
+            using T = Wire::ValueOf<std::remove_reference_t<decltype(DataPoint)>>;
+            restore<DataPoint, Model>();
+            const T value = DataPoint();
+            if constexpr (VariableSize<T>)
+            {
+                const auto bytes = value.bytes();
+                if (bytes.size() > output.size())
+                {
+                    return NoSpace;
+                }
+                std::ranges::copy(bytes, output.begin());
+                return bytes.size();
+            }
+            else
+            {
+                if (output.size() < Wire::PayloadSize<T>)
+                {
+                    return NoSpace;
+                }
+                Wire::encode(value, output.template first<Wire::PayloadSize<T>>());
+                return Wire::PayloadSize<T>;
+            }
+        }
+
+        template<auto &DataPoint, auto &Model>
+        Status writeValue(std::span<const std::byte> payload) noexcept
+        {
+            using T = Wire::ValueOf<std::remove_reference_t<decltype(DataPoint)>>;
+            restore<DataPoint, Model>();
+            T value{};
+            if constexpr (VariableSize<T>)
+            {
+                if (!value.assign(payload))
+                {
+                    return Status::invalidPayload;
+                }
+            }
+            else
+            {
+                if (payload.size() != Wire::PayloadSize<T>)
+                {
+                    return Status::invalidPayload;
+                }
+                value = Wire::decode<T>(payload.template first<Wire::PayloadSize<T>>());
+            }
+            return statusOf(DataPoint.set(value));
+        }
+    }// namespace Detail
+}// namespace DataLayer::Protocol
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <detail.h>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <wireCodec.h>
+
+namespace DataLayer::Publish
+{
+    // publish rules of a datapoint, intervals in milliseconds, 0 disables a rule
+    struct Policy
+    {
+        uint32_t minInterval{ 0 };
+        uint32_t maxInterval{ 0 };
+        double deadband{ 0.0 };
+        double relativeDeadband{ 0.0 };
+    };
+
+    // policy of a datapoint, specialised by the generated datalayer.h from the model fields
+    template<auto &DataPoint>
+    inline constexpr Policy PolicyOf{};
+
+    // handed to the publish callable, entry.dataPoint is usable as template argument, e.g. for Mqtt::Topic
+    template<auto &DataPoint>
+    struct Entry
+    {
+        static constexpr auto &dataPoint = DataPoint;
+        static constexpr Policy policy = PolicyOf<DataPoint>;
+    };
+
+    namespace Detail
+    {
+        template<typename T>
+        concept Numeric = std::is_arithmetic_v<T> && !std::is_same_v<T, bool>;
+
+        template<typename T>
+        concept Banded = Numeric<T> || (Wire::Detail::Generated<T> && Numeric<typename T::Type>);
+
+        template<Banded T>
+        [[nodiscard]] constexpr double magnitude(const T &value) noexcept
+        {
+            if constexpr (Numeric<T>)
+            {
+                return static_cast<double>(value);
+            }
+            else
+            {
+                return static_cast<double>(value.value);
+            }
+        }
+
+        // numeric values move by more than the larger deadband, everything else by any byte on the wire
+        template<typename T>
+        [[nodiscard]] bool significant(const T &last, const T &value, const Policy &policy) noexcept
+        {
+            if constexpr (Banded<T>)
+            {
+                const auto band = std::max(policy.deadband, policy.relativeDeadband * std::fabs(magnitude(last)));
+                // a NaN on either side counts as a change
+                return !(std::fabs(magnitude(value) - magnitude(last)) <= band);
+            }
+            else if constexpr (VariableSize<T>)
+            {
+                return !std::ranges::equal(last.bytes(), value.bytes());
+            }
+            else
+            {
+                std::array<std::byte, Wire::PayloadSize<T>> before{};
+                std::array<std::byte, Wire::PayloadSize<T>> after{};
+                Wire::encode(last, std::span{ before });
+                Wire::encode(value, std::span{ after });
+                return before != after;
+            }
+        }
+    }// namespace Detail
+
+    // Decides when the values of its datapoints are worth publishing and hands them to any transport. poll
+    // publishes a datapoint that was never published, that moved beyond its deadband once minInterval passed
+    // since its last publish, or that was not published for maxInterval (heartbeat). A held back change is
+    // not queued; the value current at the next due poll is sent. publish(entry, value) returns true when
+    // the transport took the value, otherwise the datapoint stays due. now is a wrapping millisecond clock.
+    template<auto &...DataPoints>
+    class Scheduler
+    {
+      public:
+        template<typename Publish>
+        size_t poll(uint32_t now, Publish &&publish) noexcept
+        {
+            return pollAll(now, publish, std::index_sequence_for<decltype(DataPoints)...>{});
+        }
+
+        // every datapoint is published by the next poll, e.g. after a reconnect
+        void invalidate() noexcept
+        {
+            std::apply([](auto &...states) { ((states.published = false), ...); }, m_states);
+        }
+
+        [[nodiscard]] uint64_t published() const noexcept
+        {
+            return m_published;
+        }
+
+        [[nodiscard]] uint64_t heartbeats() const noexcept
+        {
+            return m_heartbeats;
+        }
+
+      private:
+        template<typename T>
+        struct State
+        {
+            T last{};
+            uint32_t time{ 0 };
+            bool published{ false };
+        };
+
+        template<typename Publish, size_t... Index>
+        size_t pollAll(uint32_t now, Publish &publish, std::index_sequence<Index...>) noexcept
+        {
+            return (pollOne<DataPoints, Index>(now, publish) + ... + 0U);
+        }
+
+        template<auto &DataPoint, size_t Index, typename Publish>
+        size_t pollOne(uint32_t now, Publish &publish) noexcept
+        {
+            constexpr auto policy = PolicyOf<DataPoint>;
+            auto &state = std::get<Index>(m_states);
+            const auto value = DataPoint();
+            const auto elapsed = static_cast<uint32_t>(now - state.time);
+            const bool changed = !state.published || (elapsed >= policy.minInterval && Detail::significant(state.last, value, policy));
+            const bool heartbeat = !changed && policy.maxInterval != 0 && elapsed >= policy.maxInterval;
+            if ((!changed && !heartbeat) || !publish(Entry<DataPoint>{}, value))
+            {
+                return 0;
+            }
+            state.last = value;
+            state.time = now;
+            state.published = true;
+            ++m_published;
+            m_heartbeats += heartbeat ? 1U : 0U;
+            return 1;
+        }
+
+        std::tuple<State<std::remove_cvref_t<decltype(DataPoints())>>...> m_states{};
+        uint64_t m_published{ 0 };
+        uint64_t m_heartbeats{ 0 };
+    };
+}// namespace DataLayer::Publish
@@ -0,0 +1,781 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <helper.h>
+#include <mutex>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include <wireCodec.h>
+
+// Leader/follower replication of datapoint values. With USE_REPLICATION every successful set() of the
+// leader process becomes a change record with a sequence number. Leader::pump() batches the records into
+// messages for a Transport, and Follower::pump() applies them to the same model in another process. A
+// follower that starts or falls behind the leader history catches up from a snapshot of every group.
+namespace DataLayer::Replication
+{
+    class Sink
+    {
+      public:
+        virtual ~Sink() = default;
+        virtual void record(uint16_t dataPointId, std::span<const std::byte> payload) noexcept = 0;
+    };
+
+    inline DataLayer::Detail::WriteHook<Sink, &Sink::record> hook;
+
+    namespace Detail
+    {
+        // set while a follower applies records, so they are not recorded again
+        inline thread_local bool applying = false;
+    }// namespace Detail
+
+    inline void attach(Sink &sink) noexcept
+    {
+        hook.attach(sink);
+    }
+
+    inline void detach() noexcept
+    {
+        hook.detach();
+    }
+
+    inline void record(uint16_t dataPointId, std::span<const std::byte> payload) noexcept
+    {
+        if (!Detail::applying)
+        {
+            hook.notify(dataPointId, payload);
+        }
+    }
+
+    // Message oriented byte transport between leader and follower. Messages have to arrive in order;
+    // lost messages are detected by their sequence and sent again.
+    class Transport
+    {
+      public:
+        virtual ~Transport() = default;
+        // false when the message cannot be taken now, it is offered again by the next pump
+        [[nodiscard]] virtual bool send(std::span<const std::byte> message) noexcept = 0;
+        // size of the next message, 0 when none is waiting
+        [[nodiscard]] virtual size_t receive(std::span<std::byte> buffer) noexcept = 0;
+    };
+
+    inline constexpr std::array MessageMagic{ 'D', 'L', 'R', 'P' };
+    inline constexpr uint8_t LastSnapshotFlag = 0x01;
+
+    enum class Kind : uint8_t
+    {
+        // consecutive records, the first one has the sequence of the header
+        records = 1,
+        // current values in numbered fragments, the fragment with LastSnapshotFlag completes the snapshot
+        snapshot = 2,
+        // follower to leader: send again from the sequence of the header, 0 asks for a snapshot
+        resume = 3,
+        // follower to leader: every record before the sequence of the header is applied, the timestamp
+        // echoes the one of the last applied message
+        acknowledge = 4
+    };
+
+    struct MessageHeader
+    {
+        std::array<char, 4> magic{ MessageMagic };
+        Kind kind{};
+        uint8_t flags{};
+        uint16_t count{};
+        // snapshot: index of the message within the snapshot, a gap means a lost fragment
+        uint16_t fragment{};
+        std::array<std::byte, 6> reserved{};
+        // records: sequence of the first record, snapshot: sequence of the first record after it
+        uint64_t sequence{};
+        // leader clock when the first record was written or the snapshot was taken
+        uint64_t timestamp{};
+    };
+    static_assert(sizeof(MessageHeader) == 32);
+
+    struct RecordHeader
+    {
+        uint16_t dataPointId{};
+        uint16_t size{};
+    };
+
+    namespace Detail
+    {
+        // packed stores are not replicated since their members are
+        template<typename DataPoint>
+        inline constexpr bool Replicated = !PackedStorage<std::remove_const_t<DataPoint>>;
+
+        // records carry the object bytes, not the packed wire representation
+        template<typename DataPoint>
+        inline constexpr size_t PayloadSize = Replicated<DataPoint> ? Wire::MaximumPayload<Wire::ValueOf<DataPoint>, sizeof(Wire::ValueOf<DataPoint>)> : 0U;
+
+        template<typename Mapping>
+        struct LargestOfMapping;
+
+        template<typename... DataPoints>
+        struct LargestOfMapping<std::tuple<DataPoints &...>>
+        {
+            static constexpr size_t Value = std::max({ size_t{ 0 }, PayloadSize<DataPoints>... });
+        };
+
+        template<typename Groups>
+        struct LargestOfGroups;
+
+        template<typename... Mappings>
+        struct LargestOfGroups<std::tuple<Mappings...>>
+        {
+            static constexpr size_t Value = std::max({ size_t{ 0 }, LargestOfMapping<typename std::remove_cvref_t<Mappings>::ArgsT>::Value... });
+        };
+
+        template<typename DispatcherType>
+        inline constexpr size_t LargestPayload = LargestOfGroups<std::remove_cvref_t<decltype(std::declval<const DispatcherType &>().groups)>>::Value;
+
+        // stops at the first datapoint for which callback returns false
+        template<typename DispatcherType, typename Callback>
+        bool forEachDataPoint(const DispatcherType &dispatcher, Callback &&callback)
+        {
+            return std::apply([&callback](const auto &...mappings) { return (std::apply([&callback](auto &...dataPoints) { return (callback(dataPoints) && ...); }, mappings.datapoints) && ...); },
+              dispatcher.groups);
+        }
+
+        [[nodiscard]] inline bool parse(std::span<const std::byte> message, MessageHeader &header) noexcept
+        {
+            if (message.size() < sizeof(MessageHeader))
+            {
+                return false;
+            }
+            std::memcpy(&header, message.data(), sizeof(MessageHeader));
+            return header.magic == MessageMagic;
+        }
+
+        class ApplyingScope
+        {
+          public:
+            ApplyingScope() noexcept
+            {
+                applying = true;
+            }
+
+            ApplyingScope(const ApplyingScope &) = delete;
+            ApplyingScope &operator=(const ApplyingScope &) = delete;
+            ApplyingScope(ApplyingScope &&) = delete;
+            ApplyingScope &operator=(ApplyingScope &&) = delete;
+
+            ~ApplyingScope()
+            {
+                applying = false;
+            }
+        };
+
+        // writes a record regardless of the access of the datapoint, the leader already checked it
+        template<typename DataPoint>
+        bool applyValue(void *dataPoint, std::span<const std::byte> payload) noexcept
+        {
+            using T = Wire::ValueOf<DataPoint>;
+            T value{};
+            if constexpr (VariableSize<T>)
+            {
+                if (!value.assign(payload))
+                {
+                    return false;
+                }
+            }
+            else
+            {
+                if (payload.size() != sizeof(T))
+                {
+                    return false;
+                }
+                std::memcpy(&value, payload.data(), sizeof(T));
+            }
+            *static_cast<DataPoint *>(dataPoint) = value;
+            return true;
+        }
+
+        struct Target
+        {
+            uint16_t dataPointId{};
+            void *dataPoint{ nullptr };
+            bool (*apply)(void *dataPoint, std::span<const std::byte> payload) noexcept { nullptr };
+        };
+    }// namespace Detail
+
+    // Records the writes of this process and streams them to one follower. record() runs on the writing
+    // threads and takes a short lock; pump() belongs to one thread, e.g. a cyclic task.
+    template<typename DispatcherType, size_t HistorySlots = 4096, size_t MessageCapacity = 1400>
+    class Leader final : public Sink
+    {
+        static constexpr size_t PayloadCapacity = Detail::LargestPayload<DispatcherType>;
+        static_assert(std::has_single_bit(HistorySlots));
+        static_assert(MessageCapacity >= sizeof(MessageHeader) + sizeof(RecordHeader) + PayloadCapacity, "message capacity below the largest record");
+
+      public:
+        struct Statistics
+        {
+            // sequence the next write gets
+            uint64_t sequence{};
+            // records handed to the transport
+            uint64_t sent{};
+            // records the follower applied
+            uint64_t acknowledged{};
+            uint64_t messages{};
+            uint64_t snapshots{};
+            // leader clock from the write of the last acknowledged message to its acknowledgement
+            uint64_t lastLag{};
+            uint64_t maximumLag{};
+        };
+
+        Leader(const DispatcherType &dispatcher, Transport &transport, Clock clock = &steadyNanoseconds) noexcept
+          : m_dispatcher(dispatcher), m_transport(transport), m_clock(clock)
+        {}
+
+        void record(uint16_t dataPointId, std::span<const std::byte> payload) noexcept override
+        {
+            const std::scoped_lock lock(m_mutex);
+            auto &slot = m_history[m_next & (HistorySlots - 1U)];
+            slot.sequence = m_next++;
+            slot.timestamp = m_clock();
+            slot.dataPointId = dataPointId;
+            slot.size = static_cast<uint16_t>(std::min(payload.size(), PayloadCapacity));
+            std::copy_n(payload.begin(), slot.size, slot.payload.begin());
+        }
+
+        // handles follower requests, then sends the pending records or a snapshot; returns sent messages
+        size_t pump() noexcept
+        {
+            handleRequests();
+            size_t messages = 0;
+            while (!m_snapshotPending && sendRecords())
+            {
+                ++messages;
+            }
+            if (m_snapshotPending)
+            {
+                messages += sendSnapshot();
+            }
+            return messages;
+        }
+
+        [[nodiscard]] Statistics statistics() const noexcept
+        {
+            Statistics result{ .sent = m_sent.load(std::memory_order_relaxed),
+              .acknowledged = m_acknowledged.load(std::memory_order_relaxed),
+              .messages = m_messages.load(std::memory_order_relaxed),
+              .snapshots = m_snapshots.load(std::memory_order_relaxed),
+              .lastLag = m_lastLag.load(std::memory_order_relaxed),
+              .maximumLag = m_maximumLag.load(std::memory_order_relaxed) };
+            const std::scoped_lock lock(m_mutex);
+            result.sequence = m_next;
+            return result;
+        }
+
+        // records written but not yet applied by the follower
+        [[nodiscard]] uint64_t lag() const noexcept
+        {
+            const auto current = statistics();
+            return current.sequence - 1U - current.acknowledged;
+        }
+
+      private:
+        struct Slot
+        {
+            uint64_t sequence{};
+            uint64_t timestamp{};
+            uint16_t dataPointId{};
+            uint16_t size{};
+            std::array<std::byte, PayloadCapacity> payload{};
+        };
+
+        void handleRequests() noexcept
+        {
+            std::array<std::byte, sizeof(MessageHeader)> buffer{};
+            while (const auto size = m_transport.receive(buffer))
+            {
+                MessageHeader header{};
+                if (!Detail::parse(std::span{ buffer }.first(std::min(size, buffer.size())), header))
+                {
+                    continue;
+                }
+                if (header.kind == Kind::acknowledge && header.sequence != 0U)
+                {
+                    m_acknowledged.store(std::max(m_acknowledged.load(std::memory_order_relaxed), header.sequence - 1U), std::memory_order_relaxed);
+                    acknowledged(header.timestamp);
+                }
+                else if (header.kind == Kind::resume)
+                {
+                    resume(header.sequence);
+                }
+            }
+        }
+
+        // the timestamp was taken by this leader, so both ends of the lag come from one clock
+        void acknowledged(uint64_t timestamp) noexcept
+        {
+            const auto now = m_clock();
+            const auto elapsed = now > timestamp ? now - timestamp : uint64_t{ 0 };
+            m_lastLag.store(elapsed, std::memory_order_relaxed);
+            m_maximumLag.store(std::max(m_maximumLag.load(std::memory_order_relaxed), elapsed), std::memory_order_relaxed);
+        }
+
+        // rewinds to sequence while the history still holds it, a snapshot follows otherwise
+        void resume(uint64_t sequence) noexcept
+        {
+            const std::scoped_lock lock(m_mutex);
+            m_snapshotPending = sequence == 0U || sequence > m_next || m_next - sequence > HistorySlots;
+            if (!m_snapshotPending)
+            {
+                m_toSend = sequence;
+                m_acknowledged.store(sequence - 1U, std::memory_order_relaxed);
+            }
+        }
+
+        bool sendRecords() noexcept
+        {
+            MessageHeader header{ .kind = Kind::records };
+            size_t offset = sizeof(MessageHeader);
+            {
+                const std::scoped_lock lock(m_mutex);
+                if (m_toSend == m_next)
+                {
+                    return false;
+                }
+                if (m_next - m_toSend > HistorySlots)
+                {
+                    // unsent records were overwritten
+                    m_snapshotPending = true;
+                    return false;
+                }
+                header.sequence = m_toSend;
+                header.timestamp = m_history[m_toSend & (HistorySlots - 1U)].timestamp;
+                for (auto sequence = m_toSend; sequence < m_next && header.count < UINT16_MAX; ++sequence)
+                {
+                    const auto &slot = m_history[sequence & (HistorySlots - 1U)];
+                    if (!append(offset, slot.dataPointId, std::span{ slot.payload }.first(slot.size)))
+                    {
+                        break;
+                    }
+                    ++header.count;
+                }
+            }
+            if (!finish(header, offset))
+            {
+                return false;
+            }
+            m_toSend += header.count;
+            m_sent.fetch_add(header.count, std::memory_order_relaxed);
+            return true;
+        }
+
+        // Writes that race with the snapshot get later sequences and are applied after it, so the follower
+        // ends up with the values of the leader.
+        size_t sendSnapshot() noexcept
+        {
+#ifdef USE_FILE_PERSISTENCE
+            // groups that were never restored are sent with their stored values, not their defaults
+            std::ignore = m_dispatcher.restorePending();
+#endif
+            MessageHeader header{ .kind = Kind::snapshot, .timestamp = m_clock() };
+            {
+                const std::scoped_lock lock(m_mutex);
+                header.sequence = m_next;
+            }
+            size_t offset = sizeof(MessageHeader);
+            size_t messages = 0;
+            const bool complete = Detail::forEachDataPoint(m_dispatcher, [&](const auto &dataPoint) {
+                if constexpr (Detail::Replicated<std::remove_reference_t<decltype(dataPoint)>>)
+                {
+                    const auto value = dataPoint();
+                    const auto bytes = valueBytes(value);
+                    if (!append(offset, dataPoint.getId(), bytes))
+                    {
+                        if (!finish(header, offset))
+                        {
+                            return false;
+                        }
+                        ++messages;
+                        ++header.fragment;
+                        header.count = 0;
+                        offset = sizeof(MessageHeader);
+                        std::ignore = append(offset, dataPoint.getId(), bytes);
+                    }
+                    ++header.count;
+                }
+                return true;
+            });
+            header.flags = LastSnapshotFlag;
+            if (!complete || !finish(header, offset))
+            {
+                // tried again from the start by the next pump
+                return messages;
+            }
+            const std::scoped_lock lock(m_mutex);
+            m_toSend = header.sequence;
+            m_snapshotPending = false;
+            m_snapshots.fetch_add(1U, std::memory_order_relaxed);
+            return messages + 1U;
+        }
+
+        bool append(size_t &offset, uint16_t dataPointId, std::span<const std::byte> payload) noexcept
+        {
+            if (m_message.size() - offset < sizeof(RecordHeader) + payload.size())
+            {
+                return false;
+            }
+            const RecordHeader record{ .dataPointId = dataPointId, .size = static_cast<uint16_t>(payload.size()) };
+            std::memcpy(&m_message[offset], &record, sizeof(record));
+            std::ranges::copy(payload, m_message.begin() + static_cast<ptrdiff_t>(offset + sizeof(record)));
+            offset += sizeof(record) + payload.size();
+            return true;
+        }
+
+        bool finish(const MessageHeader &header, size_t size) noexcept
+        {
+            std::memcpy(m_message.data(), &header, sizeof(header));
+            if (!m_transport.send(std::span{ m_message }.first(size)))
+            {
+                return false;
+            }
+            m_messages.fetch_add(1U, std::memory_order_relaxed);
+            return true;
+        }
+
+        const DispatcherType &m_dispatcher;
+        Transport &m_transport;
+        Clock m_clock;
+        mutable std::mutex m_mutex{};
+        std::array<Slot, HistorySlots> m_history{};
+        // sequence numbers start at 1, a resume from 0 asks for a snapshot
+        uint64_t m_next{ 1 };
+        uint64_t m_toSend{ 1 };
+        bool m_snapshotPending{ false };
+        std::array<std::byte, MessageCapacity> m_message{};
+        std::atomic<uint64_t> m_sent{ 0 };
+        std::atomic<uint64_t> m_acknowledged{ 0 };
+        std::atomic<uint64_t> m_messages{ 0 };
+        std::atomic<uint64_t> m_snapshots{ 0 };
+        std::atomic<uint64_t> m_lastLag{ 0 };
+        std::atomic<uint64_t> m_maximumLag{ 0 };
+    };
+
+    // Applies the messages of a leader to the datapoints of this process, through the assignment so range
+    // checks and change callbacks run as on the leader. Its first pump asks for a snapshot.
+    template<typename DispatcherType, size_t MessageCapacity = 1400>
+    class Follower
+    {
+      public:
+        struct Statistics
+        {
+            // sequence of the next expected record, 0 until the first snapshot is complete
+            uint64_t sequence{};
+            uint64_t records{};
+            uint64_t snapshots{};
+            uint64_t gaps{};
+            // records of unknown datapoints or with a wrong size
+            uint64_t rejected{};
+        };
+
+        Follower(const DispatcherType &dispatcher, Transport &transport) : m_dispatcher(dispatcher), m_transport(transport)
+        {
+            // packed members are declared const but assign their bits through a const operator=
+            Detail::forEachDataPoint(dispatcher, [this](auto &dataPoint) {
+                using DataPoint = std::remove_reference_t<decltype(dataPoint)>;
+                if constexpr (Detail::Replicated<DataPoint> && std::is_assignable_v<DataPoint &, const Wire::ValueOf<DataPoint> &>)
+                {
+                    m_targets.push_back(Detail::Target{ .dataPointId = DataPoint::getId(),
+                      .dataPoint = const_cast<std::remove_const_t<DataPoint> *>(&dataPoint),
+                      .apply = &Detail::applyValue<DataPoint> });
+                }
+                return true;
+            });
+            std::ranges::sort(m_targets, {}, &Detail::Target::dataPointId);
+        }
+
+        // applies every waiting message and acknowledges them; returns the applied records
+        size_t pump() noexcept
+        {
+            if (!m_started)
+            {
+                m_started = requestResume();
+                m_resumePending = m_started;
+            }
+            size_t applied = 0;
+            const Detail::ApplyingScope scope;
+            while (const auto size = m_transport.receive(m_message))
+            {
+                applied += handle(std::span{ m_message }.first(std::min(size, m_message.size())));
+            }
+            if (applied != 0U)
+            {
+                std::ignore = send(Kind::acknowledge, m_statistics.sequence.load(std::memory_order_relaxed), m_timestamp);
+            }
+            return applied;
+        }
+
+        [[nodiscard]] Statistics statistics() const noexcept
+        {
+            return Statistics{ .sequence = m_statistics.sequence.load(std::memory_order_relaxed),
+              .records = m_statistics.records.load(std::memory_order_relaxed),
+              .snapshots = m_statistics.snapshots.load(std::memory_order_relaxed),
+              .gaps = m_statistics.gaps.load(std::memory_order_relaxed),
+              .rejected = m_statistics.rejected.load(std::memory_order_relaxed) };
+        }
+
+      private:
+        // messages discarded after a gap before the resume request is repeated, in case it was lost
+        static constexpr size_t ResumeRetry = 256;
+
+        size_t handle(std::span<const std::byte> message) noexcept
+        {
+            MessageHeader header{};
+            if (!Detail::parse(message, header))
+            {
+                return 0;
+            }
+            const auto next = m_statistics.sequence.load(std::memory_order_relaxed);
+            size_t skip = 0;
+            if (header.kind == Kind::records)
+            {
+                if (next == 0U)
+                {
+                    // waiting for the snapshot, records after a partial one mean its last fragment was lost
+                    lostSnapshot();
+                    return 0;
+                }
+                if (header.sequence > next)
+                {
+                    gap(next);
+                    return 0;
+                }
+                skip = static_cast<size_t>(next - header.sequence);
+                if (skip >= header.count)
+                {
+                    return 0;
+                }
+            }
+            else if (header.kind != Kind::snapshot)
+            {
+                return 0;
+            }
+            else if (header.fragment == 0U)
+            {
+                // the leader answers a resume, further gaps ask again at once
+                m_fragment = 0;
+                m_resumePending = false;
+            }
+            else if (header.fragment != m_fragment)
+            {
+                lostSnapshot();
+                return 0;
+            }
+
+            size_t applied = 0;
+            size_t offset = sizeof(MessageHeader);
+            for (size_t index = 0; index < header.count; ++index)
+            {
+                RecordHeader record{};
+                if (message.size() - offset < sizeof(record))
+                {
+                    break;
+                }
+                std::memcpy(&record, &message[offset], sizeof(record));
+                offset += sizeof(record);
+                if (message.size() - offset < record.size)
+                {
+                    break;
+                }
+                if (index >= skip && apply(record.dataPointId, message.subspan(offset, record.size)))
+                {
+                    ++applied;
+                }
+                else if (index >= skip)
+                {
+                    m_statistics.rejected.fetch_add(1U, std::memory_order_relaxed);
+                }
+                offset += record.size;
+            }
+            m_statistics.records.fetch_add(applied, std::memory_order_relaxed);
+
+            if (header.kind == Kind::records)
+            {
+                m_statistics.sequence.store(header.sequence + header.count, std::memory_order_relaxed);
+            }
+            else if ((header.flags & LastSnapshotFlag) != 0U)
+            {
+                m_statistics.sequence.store(header.sequence, std::memory_order_relaxed);
+                m_statistics.snapshots.fetch_add(1U, std::memory_order_relaxed);
+                m_fragment = 0;
+            }
+            else
+            {
+                ++m_fragment;
+                return applied;
+            }
+            m_resumePending = false;
+            m_timestamp = header.timestamp;
+            return applied;
+        }
+
+        // a partial snapshot is lost for sure and asked for at once, otherwise the resume retry applies
+        void lostSnapshot() noexcept
+        {
+            if (m_fragment != 0U)
+            {
+                m_fragment = 0;
+                m_resumePending = false;
+            }
+            gap(0);
+        }
+
+        void gap(uint64_t next) noexcept
+        {
+            if (!m_resumePending)
+            {
+                m_statistics.gaps.fetch_add(1U, std::memory_order_relaxed);
+                m_discarded = 0;
+            }
+            if (!m_resumePending || ++m_discarded % ResumeRetry == 0U)
+            {
+                m_resumePending = send(Kind::resume, next);
+            }
+        }
+
+        bool apply(uint16_t dataPointId, std::span<const std::byte> payload) noexcept
+        {
+#ifdef USE_FILE_PERSISTENCE
+            // a lazily restored group is loaded first, it must not overwrite the record later
+            m_dispatcher.restoreOnAccess(dataPointId);
+#endif
+            const auto target = std::ranges::lower_bound(m_targets, dataPointId, {}, &Detail::Target::dataPointId);
+            return target != m_targets.end() && target->dataPointId == dataPointId && target->apply(target->dataPoint, payload);
+        }
+
+        bool requestResume() noexcept
+        {
+            return send(Kind::resume, m_statistics.sequence.load(std::memory_order_relaxed));
+        }
+
+        bool send(Kind kind, uint64_t sequence, uint64_t timestamp = 0) noexcept
+        {
+            const MessageHeader header{ .kind = kind, .sequence = sequence, .timestamp = timestamp };
+            std::array<std::byte, sizeof(MessageHeader)> buffer{};
+            std::memcpy(buffer.data(), &header, sizeof(header));
+            return m_transport.send(buffer);
+        }
+
+        // written by the pumping thread, readable from others for lag reports
+        struct Counters
+        {
+            std::atomic<uint64_t> sequence{ 0 };
+            std::atomic<uint64_t> records{ 0 };
+            std::atomic<uint64_t> snapshots{ 0 };
+            std::atomic<uint64_t> gaps{ 0 };
+            std::atomic<uint64_t> rejected{ 0 };
+        };
+
+        const DispatcherType &m_dispatcher;
+        Transport &m_transport;
+        std::vector<Detail::Target> m_targets{};
+        std::array<std::byte, MessageCapacity> m_message{};
+        Counters m_statistics{};
+        size_t m_discarded{ 0 };
+        // leader timestamp of the last applied message, echoed by the acknowledgement
+        uint64_t m_timestamp{ 0 };
+        // next expected fragment of the snapshot in progress, 0 when none is
+        uint16_t m_fragment{ 0 };
+        bool m_started{ false };
+        bool m_resumePending{ false };
+    };
+
+    // In-process transport pair for tests and simulations. Each direction queues up to capacity messages,
+    // further sends fail until the other side receives.
+    class Loopback
+    {
+      public:
+        explicit Loopback(size_t capacity = 1024) : m_toFollower{ .capacity = capacity }, m_toLeader{ .capacity = capacity }
+        {}
+
+        [[nodiscard]] Transport &leader() noexcept
+        {
+            return m_leader;
+        }
+
+        [[nodiscard]] Transport &follower() noexcept
+        {
+            return m_follower;
+        }
+
+        // loses count messages of the leader after passing the next after ones, to exercise the recovery
+        void dropLeaderMessages(size_t count, size_t after = 0) noexcept
+        {
+            const std::scoped_lock lock(m_toFollower.mutex);
+            m_toFollower.pass = after;
+            m_toFollower.drop += count;
+        }
+
+      private:
+        struct Queue
+        {
+            std::mutex mutex{};
+            std::deque<std::vector<std::byte>> messages{};
+            size_t capacity{};
+            size_t pass{ 0 };
+            size_t drop{ 0 };
+        };
+
+        class Endpoint final : public Transport
+        {
+          public:
+            Endpoint(Queue &outgoing, Queue &incoming) noexcept : m_outgoing(outgoing), m_incoming(incoming)
+            {}
+
+            [[nodiscard]] bool send(std::span<const std::byte> message) noexcept override
+            {
+                const std::scoped_lock lock(m_outgoing.mutex);
+                if (m_outgoing.pass != 0U)
+                {
+                    --m_outgoing.pass;
+                }
+                else if (m_outgoing.drop != 0U)
+                {
+                    --m_outgoing.drop;
+                    return true;
+                }
+                if (m_outgoing.messages.size() >= m_outgoing.capacity)
+                {
+                    return false;
+                }
+                m_outgoing.messages.emplace_back(message.begin(), message.end());
+                return true;
+            }
+
+            [[nodiscard]] size_t receive(std::span<std::byte> buffer) noexcept override
+            {
+                const std::scoped_lock lock(m_incoming.mutex);
+                if (m_incoming.messages.empty())
+                {
+                    return 0;
+                }
+                const auto &message = m_incoming.messages.front();
+                const auto size = std::min(message.size(), buffer.size());
+                std::copy_n(message.begin(), size, buffer.begin());
+                m_incoming.messages.pop_front();
+                return size;
+            }
+
+          private:
+            Queue &m_outgoing;
+            Queue &m_incoming;
+        };
+
+        Queue m_toFollower;
+        Queue m_toLeader;
+        Endpoint m_leader{ m_toFollower, m_toLeader };
+        Endpoint m_follower{ m_toLeader, m_toFollower };
+    };
+}// namespace DataLayer::Replication
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <rttEmitter.h>
+#include <span>
+#include <tuple>
+#include <vector>
+
+namespace DataLayer::Rtt
+{
+    // payloads of one datapoint from one feed, in arrival order
+    struct Column
+    {
+        std::vector<std::byte> payloads{};
+        // end offset of every payload in payloads
+        std::vector<uint32_t> ends{};
+        // position of every frame in the feed, to merge columns back into stream order
+        std::vector<uint32_t> indices{};
+    };
+
+    using Batch = std::map<uint16_t, Column>;
+
+    // Host side splitter of the frame stream written by Emitter. Garbage is skipped by scanning for the
+    // magic with memchr, a header with another version or a payload above maximumPayload is treated as
+    // noise. An incomplete frame at the end of a feed is kept for the next one, so every byte is inspected
+    // a bounded number of times however the stream is chunked.
+    class Decoder
+    {
+      public:
+        explicit Decoder(size_t maximumPayload = UINT16_MAX) noexcept : m_maximumPayload(maximumPayload)
+        {}
+
+        // sink(dataPointId, flags, payload) per complete frame, returns the number of frames
+        template<typename Sink>
+        size_t feed(std::span<const std::byte> input, Sink &&sink)
+        {
+            if (m_pending.empty())
+            {
+                const auto consumed = split(input, sink);
+                m_pending.assign(input.begin() + static_cast<ptrdiff_t>(consumed), input.end());
+            }
+            else
+            {
+                m_pending.insert(m_pending.end(), input.begin(), input.end());
+                const auto consumed = split(m_pending, sink);
+                m_pending.erase(m_pending.begin(), m_pending.begin() + static_cast<ptrdiff_t>(consumed));
+            }
+            const auto frames = m_batchFrames;
+            m_batchFrames = 0;
+            return frames;
+        }
+
+        // frames of the feed grouped by datapoint ID
+        [[nodiscard]] Batch feed(std::span<const std::byte> input)
+        {
+            Batch batch;
+            uint32_t index = 0;
+            std::ignore = feed(input, [&batch, &index](uint16_t dataPointId, uint8_t, std::span<const std::byte> payload) {
+                auto &column = batch[dataPointId];
+                column.payloads.insert(column.payloads.end(), payload.begin(), payload.end());
+                column.ends.push_back(static_cast<uint32_t>(column.payloads.size()));
+                column.indices.push_back(index++);
+            });
+            return batch;
+        }
+
+        // frames the target reported as dropped through the overflow flag
+        [[nodiscard]] uint64_t lostFrames() const noexcept
+        {
+            return m_lostFrames;
+        }
+
+        [[nodiscard]] uint64_t skippedBytes() const noexcept
+        {
+            return m_skippedBytes;
+        }
+
+        [[nodiscard]] uint64_t frames() const noexcept
+        {
+            return m_frames;
+        }
+
+        // bytes of an incomplete frame waiting for the next feed
+        [[nodiscard]] size_t pending() const noexcept
+        {
+            return m_pending.size();
+        }
+
+      private:
+        // returns the bytes that were consumed, the rest may start a frame
+        template<typename Sink>
+        size_t split(std::span<const std::byte> input, Sink &sink)
+        {
+            const auto *const begin = input.data();
+            const auto *const end = begin + input.size();
+            const auto *position = begin;
+            while (position < end)
+            {
+                const auto *magic = static_cast<const std::byte *>(std::memchr(position, 'D', static_cast<size_t>(end - position)));
+                if (magic == nullptr)
+                {
+                    m_skippedBytes += static_cast<size_t>(end - position);
+                    return input.size();
+                }
+                m_skippedBytes += static_cast<size_t>(magic - position);
+                position = magic;
+                const auto available = static_cast<size_t>(end - position);
+                if (available < 2)
+                {
+                    break;
+                }
+                if (position[1] != std::byte{ 'L' })
+                {
+                    ++m_skippedBytes;
+                    ++position;
+                    continue;
+                }
+                if (available < HeaderSize)
+                {
+                    break;
+                }
+                const auto size = static_cast<size_t>(std::to_integer<uint16_t>(position[6]) | (std::to_integer<uint16_t>(position[7]) << 8U));
+                if (std::to_integer<uint8_t>(position[2]) != ProtocolVersion || size > m_maximumPayload)
+                {
+                    ++m_skippedBytes;
+                    ++position;
+                    continue;
+                }
+                if (available < HeaderSize + size)
+                {
+                    break;
+                }
+                const auto flags = std::to_integer<uint8_t>(position[3]);
+                m_lostFrames += (flags & OverflowFlag) != 0 ? flags & LostMask : 0U;
+                sink(static_cast<uint16_t>(std::to_integer<uint16_t>(position[4]) | (std::to_integer<uint16_t>(position[5]) << 8U)), flags, std::span{ position + HeaderSize, size });
+                position += HeaderSize + size;
+                ++m_frames;
+                ++m_batchFrames;
+            }
+            return static_cast<size_t>(position - begin);
+        }
+
+        std::vector<std::byte> m_pending{};
+        size_t m_maximumPayload;
+        size_t m_batchFrames{ 0 };
+        uint64_t m_frames{ 0 };
+        uint64_t m_lostFrames{ 0 };
+        uint64_t m_skippedBytes{ 0 };
+    };
+}// namespace DataLayer::Rtt
@@ -0,0 +1,224 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <wireCodec.h>
+
+// Producer side of the frames decoded by the generated rtt.py: little endian "DL", protocol version,
+// flags, datapoint ID and payload length, followed by the wire payload.
+namespace DataLayer::Rtt
+{
+    inline constexpr uint8_t ProtocolVersion = 1;
+    inline constexpr size_t HeaderSize = 8;
+
+    // flags byte: frames lost right before this frame, saturating at LostMask, OverflowFlag set when any were
+    inline constexpr uint8_t OverflowFlag = 0x80;
+    inline constexpr uint8_t LostMask = 0x7F;
+
+    inline constexpr std::array<char, 8> ChannelIdentifier{ 'D', 'L', 'R', 'T', 'T', '\0', '\0', '\0' };
+
+    namespace Detail
+    {
+        // the reader decodes native scalars, so quantized values travel as their engineering value
+        template<typename T>
+        struct Engineering
+        {
+            using Type = T;
+
+            [[nodiscard]] static constexpr const T &convert(const T &value) noexcept
+            {
+                return value;
+            }
+        };
+
+        template<Wire::Detail::Quantized T>
+        struct Engineering<T>
+        {
+            using Type = typename T::Type;
+
+            [[nodiscard]] static constexpr Type convert(const T &value) noexcept
+            {
+                return value.value;
+            }
+        };
+
+        template<Wire::Detail::Quantized T, size_t Size>
+        struct Engineering<std::array<T, Size>>
+        {
+            using Type = std::array<typename T::Type, Size>;
+
+            [[nodiscard]] static constexpr Type convert(const std::array<T, Size> &values) noexcept
+            {
+                Type converted{};
+                std::ranges::transform(values, converted.begin(), &T::value);
+                return converted;
+            }
+        };
+    }// namespace Detail
+
+    // Byte ring in the style of an RTT up-buffer. The producer only advances writeOffset, the reader only
+    // readOffset, and one byte stays free to tell a full ring from an empty one. The block is standard
+    // layout, so a probe or another process finds it by its identifier and reads it in place.
+    template<size_t Capacity>
+    struct Channel
+    {
+        static_assert(Capacity > HeaderSize && Capacity <= UINT32_MAX);
+
+        std::array<char, 8> identifier{ ChannelIdentifier };
+        uint32_t capacity{ Capacity };
+        std::atomic<uint32_t> writeOffset{ 0 };
+        std::atomic<uint32_t> readOffset{ 0 };
+        uint32_t reserved{ 0 };
+        std::array<std::byte, Capacity> buffer{};
+
+        // bytes written and not yet read
+        [[nodiscard]] size_t pending() const noexcept
+        {
+            const auto write = writeOffset.load(std::memory_order_acquire);
+            const auto read = readOffset.load(std::memory_order_relaxed);
+            return (write + Capacity - read) % Capacity;
+        }
+
+        // reader side, copies up to output.size() pending bytes
+        size_t read(std::span<std::byte> output) noexcept
+        {
+            const auto write = writeOffset.load(std::memory_order_acquire);
+            const auto start = readOffset.load(std::memory_order_relaxed);
+            const auto size = std::min<size_t>((write + Capacity - start) % Capacity, output.size());
+            const auto first = std::min<size_t>(size, Capacity - start);
+            std::copy_n(buffer.begin() + static_cast<ptrdiff_t>(start), first, output.begin());
+            std::copy_n(buffer.begin(), size - first, output.begin() + static_cast<ptrdiff_t>(first));
+            readOffset.store(static_cast<uint32_t>((start + size) % Capacity), std::memory_order_release);
+            return size;
+        }
+    };
+
+    // Lock-free single producer. All emits, including the change callbacks installed by watch, must come
+    // from one context at a time, e.g. one task or one interrupt priority. A frame that does not fit is
+    // dropped whole and reported in the flags of the next frame that does; nothing blocks or allocates.
+    template<size_t Capacity>
+    class Emitter
+    {
+        static_assert(std::atomic<uint32_t>::is_always_lock_free);
+        static_assert(std::is_standard_layout_v<Channel<Capacity>> && offsetof(Channel<Capacity>, buffer) == 24);
+
+      public:
+        static constexpr size_t MaximumPayload = std::min<size_t>(Capacity - 1U - HeaderSize, UINT16_MAX);
+
+        explicit Emitter(Channel<Capacity> &channel) noexcept : m_channel(channel), m_read(channel.readOffset.load(std::memory_order_acquire))
+        {}
+
+        // false when the ring lacks space or the payload exceeds MaximumPayload, the frame counts as lost
+        bool emit(uint16_t dataPointId, std::span<const std::byte> payload) noexcept
+        {
+            const auto write = m_channel.writeOffset.load(std::memory_order_relaxed);
+            const auto size = HeaderSize + payload.size();
+            // the reader offset is only fetched again when the cached one leaves too little space
+            if (space(write) < size)
+            {
+                m_read = m_channel.readOffset.load(std::memory_order_acquire);
+            }
+            if (payload.size() > MaximumPayload || space(write) < size)
+            {
+                ++m_lost;
+                m_lostSinceFrame = static_cast<uint8_t>(std::min<unsigned>(m_lostSinceFrame + 1U, LostMask));
+                return false;
+            }
+
+            const std::array<std::byte, HeaderSize> header{
+                std::byte{ 'D' },
+                std::byte{ 'L' },
+                std::byte{ ProtocolVersion },
+                static_cast<std::byte>(m_lostSinceFrame != 0 ? (OverflowFlag | m_lostSinceFrame) : 0U),
+                static_cast<std::byte>(dataPointId & 0xFFU),
+                static_cast<std::byte>(dataPointId >> 8U),
+                static_cast<std::byte>(payload.size() & 0xFFU),
+                static_cast<std::byte>(payload.size() >> 8U),
+            };
+            auto offset = copy(write, header);
+            offset = copy(offset, payload);
+            m_channel.writeOffset.store(static_cast<uint32_t>(offset), std::memory_order_release);
+            m_lostSinceFrame = 0;
+            ++m_emitted;
+            m_bytes += size;
+            return true;
+        }
+
+        // Little endian payload the generated reader decodes for scalars and arrays, quantized types as their
+        // engineering value. Structs use the wire encoding and strings their bytes.
+        template<typename T>
+        bool emit(uint16_t dataPointId, const T &value) noexcept
+        {
+            if constexpr (VariableSize<T>)
+            {
+                return emit(dataPointId, value.bytes());
+            }
+            else
+            {
+                using Engineering = Detail::Engineering<T>;
+                static_assert(Wire::PayloadSize<typename Engineering::Type> <= MaximumPayload, "value does not fit the channel");
+                std::array<std::byte, Wire::PayloadSize<typename Engineering::Type>> payload{};
+                Wire::encode(Engineering::convert(value), std::span{ payload });
+                return emit(dataPointId, std::span<const std::byte>{ payload });
+            }
+        }
+
+        // Emits every change of the datapoint. This takes the single change callback slot of the datapoint,
+        // and the emitter must outlive the subscription.
+        template<auto &DataPoint>
+        void watch() noexcept
+        {
+            using T = std::remove_cvref_t<decltype(DataPoint())>;
+            DataPoint.setChangeCallback([](const T &value, void *context) noexcept { std::ignore = static_cast<Emitter *>(context)->emit(DataPoint.getId(), value); }, this);
+        }
+
+        template<auto &DataPoint>
+        void unwatch() noexcept
+        {
+            DataPoint.clearChangeCallback();
+        }
+
+        // counters belong to the producer, read them from its context
+        [[nodiscard]] uint64_t emitted() const noexcept
+        {
+            return m_emitted;
+        }
+
+        [[nodiscard]] uint64_t lost() const noexcept
+        {
+            return m_lost;
+        }
+
+        [[nodiscard]] uint64_t bytes() const noexcept
+        {
+            return m_bytes;
+        }
+
+      private:
+        [[nodiscard]] size_t space(size_t write) const noexcept
+        {
+            return (m_read + Capacity - write - 1U) % Capacity;
+        }
+
+        [[nodiscard]] size_t copy(size_t offset, std::span<const std::byte> data) noexcept
+        {
+            const auto first = std::min(data.size(), Capacity - offset);
+            std::copy_n(data.begin(), first, m_channel.buffer.begin() + static_cast<ptrdiff_t>(offset));
+            std::copy_n(data.begin() + static_cast<ptrdiff_t>(first), data.size() - first, m_channel.buffer.begin());
+            return (offset + data.size()) % Capacity;
+        }
+
+        Channel<Capacity> &m_channel;
+        uint32_t m_read{ 0 };
+        uint64_t m_emitted{ 0 };
+        uint64_t m_lost{ 0 };
+        uint64_t m_bytes{ 0 };
+        uint8_t m_lostSinceFrame{ 0 };
+    };
+}// namespace DataLayer::Rtt
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <fcntl.h>
+#include <new>
+#include <rttEmitter.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+namespace DataLayer::Rtt
+{
+    // POSIX shared memory stand-in for the probe on Linux hosts. The producing process creates the channel
+    // under a name such as "/datalayer-rtt", a reader process or the generated rtt.py maps the same block.
+    // The creator removes the name again when it is destroyed.
+    template<size_t Capacity>
+    class SharedChannel
+    {
+      public:
+        enum class Mode : uint8_t
+        {
+            create,
+            open
+        };
+
+        SharedChannel(std::string name, Mode mode) noexcept : m_name(std::move(name)), m_owner(mode == Mode::create)
+        {
+            const int descriptor = m_owner ? ::shm_open(m_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600) : ::shm_open(m_name.c_str(), O_RDWR, 0);
+            if (descriptor < 0)
+            {
+                m_owner = false;
+                return;
+            }
+            struct stat status
+            {
+            };
+            const bool sized = m_owner ? ::ftruncate(descriptor, sizeof(Channel<Capacity>)) == 0
+                                       : ::fstat(descriptor, &status) == 0 && static_cast<size_t>(status.st_size) == sizeof(Channel<Capacity>);
+            void *mapping = sized ? ::mmap(nullptr, sizeof(Channel<Capacity>), PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0) : MAP_FAILED;
+            ::close(descriptor);
+            if (mapping == MAP_FAILED)
+            {
+                release();
+                return;
+            }
+            // the creator constructs the block, an opened one must carry the identifier and capacity
+            m_channel = m_owner ? new (mapping) Channel<Capacity>{} : static_cast<Channel<Capacity> *>(mapping);
+            if (!m_owner && (m_channel->identifier != ChannelIdentifier || m_channel->capacity != Capacity))
+            {
+                release();
+            }
+        }
+
+        SharedChannel(SharedChannel &&other) noexcept
+          : m_name(std::move(other.m_name)), m_channel(std::exchange(other.m_channel, nullptr)), m_owner(std::exchange(other.m_owner, false))
+        {}
+
+        SharedChannel(const SharedChannel &) = delete;
+        SharedChannel &operator=(const SharedChannel &) = delete;
+        SharedChannel &operator=(SharedChannel &&) = delete;
+
+        ~SharedChannel()
+        {
+            release();
+        }
+
+        [[nodiscard]] bool isOpen() const noexcept
+        {
+            return m_channel != nullptr;
+        }
+
+        // only valid while isOpen()
+        [[nodiscard]] Channel<Capacity> &channel() const noexcept
+        {
+            return *m_channel;
+        }
+
+      private:
+        void release() noexcept
+        {
+            if (m_channel != nullptr)
+            {
+                ::munmap(static_cast<void *>(m_channel), sizeof(Channel<Capacity>));
+                m_channel = nullptr;
+            }
+            if (m_owner)
+            {
+                ::shm_unlink(m_name.c_str());
+                m_owner = false;
+            }
+        }
+
+        std::string m_name;
+        Channel<Capacity> *m_channel{ nullptr };
+        bool m_owner{ false };
+    };
+}// namespace DataLayer::Rtt
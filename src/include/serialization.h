@@ -1,12 +1,26 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <checksum.h>
+#include <cstdint>
 #include <cstring>
+#ifdef USE_FILE_PERSISTENCE
 #include <filesystem>
 #include <fstream>
+#if __has_include(<sys/mman.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define DATALAYER_HAS_POSIX_FILES 1
+#endif
+#endif
 #include <helper.h>
 #include <tuple>
+#include <utility>
 #include <vector>
+#include <wireCodec.h>
 
 inline constexpr size_t MaxPersistenceFileSize = 16 * 1024 * 1024;
 
@@ -18,7 +32,8 @@ enum class SerializationError : uint8_t
     GroupAndDatapointVersion,
     InvalidFormat,
     ChecksumMismatch,
-    GroupIdMismatch
+    GroupIdMismatch,
+    StorageFailure
 };
 
 struct SerializationStatus
@@ -31,7 +46,8 @@ struct SerializationStatus
 namespace DataLayer::Persistence
 {
     inline constexpr std::array Magic{ 'D', 'L', 'G', '1' };
-    inline constexpr uint16_t FormatVersion = 1;
+    inline constexpr uint16_t FormatVersion = 2;
+    inline constexpr uint16_t LegacyFormatVersion = 1;
 
     struct Header
     {
@@ -40,29 +56,29 @@ namespace DataLayer::Persistence
         uint16_t groupId{};
         Version groupVersion{};
         uint32_t checksum{};
+        ChecksumAlgorithm checksumAlgorithm{ ChecksumAlgorithm::Crc32c };
+        uint16_t reserved{};
+    };
+
+    // format version 1 header, always checksummed with CRC32
+    struct LegacyHeader
+    {
+        std::array<char, 4> magic{ Magic };
+        uint16_t formatVersion{ LegacyFormatVersion };
+        uint16_t groupId{};
+        Version groupVersion{};
+        uint32_t checksum{};
     };
 
     struct RecordHeader
     {
         uint16_t dataPointId{};
+        // former padding, written as zero so equal records are equal byte for byte
+        uint16_t reserved{};
         Version version{};
         uint32_t payloadSize{};
     };
 
-    [[nodiscard]] inline uint32_t crc32(std::span<const std::byte> data) noexcept
-    {
-        uint32_t checksum = 0xFFFFFFFFU;
-        for (const auto byte : data)
-        {
-            checksum ^= std::to_integer<uint8_t>(byte);
-            for (uint8_t bit = 0; bit < 8; ++bit)
-            {
-                checksum = (checksum >> 1U) ^ (0xEDB88320U & (0U - (checksum & 1U)));
-            }
-        }
-        return ~checksum;
-    }
-
     template<typename Value>
     void append(std::vector<std::byte> &output, const Value &value)
     {
@@ -81,16 +97,381 @@ namespace DataLayer::Persistence
         offset += sizeof(Value);
         return true;
     }
+
+    // reads either header format, a version 1 header is reported with its implicit CRC32 algorithm
+    [[nodiscard]] inline bool readHeader(std::span<const std::byte> input, size_t &offset, Header &header) noexcept
+    {
+        LegacyHeader legacy{};
+        if (!read(input, offset, legacy) || legacy.magic != Magic)
+        {
+            return false;
+        }
+        if (legacy.formatVersion == LegacyFormatVersion)
+        {
+            header = { .magic = legacy.magic,
+                       .formatVersion = legacy.formatVersion,
+                       .groupId = legacy.groupId,
+                       .groupVersion = legacy.groupVersion,
+                       .checksum = legacy.checksum,
+                       .checksumAlgorithm = ChecksumAlgorithm::Crc32 };
+            return true;
+        }
+        offset = 0;
+        return legacy.formatVersion == FormatVersion && read(input, offset, header) && isKnown(header.checksumAlgorithm) && header.reserved == 0;
+    }
+
+    struct IndexEntry
+    {
+        uint16_t dataPointId{};
+        bool legacy{ false };
+        uint16_t position{};
+    };
+
+    // sorted datapoint ID (current and legacy) to tuple position table, built at compile time
+    template<typename Data>
+    [[nodiscard]] consteval auto makeRecordIndex() noexcept
+    {
+        using Tuple = std::remove_cvref_t<Data>;
+        return []<size_t... Positions>(std::index_sequence<Positions...>) {
+            constexpr size_t Count = ((1U + std::remove_cvref_t<std::tuple_element_t<Positions, Tuple>>::getLegacyIds().size()) + ... + 0U);
+            std::array<IndexEntry, Count> index{};
+            size_t next = 0;
+            const auto add = [&]<size_t Position>() {
+                using DataPoint = std::remove_cvref_t<std::tuple_element_t<Position, Tuple>>;
+                index[next++] = { .dataPointId = DataPoint::getId(), .legacy = false, .position = static_cast<uint16_t>(Position) };
+                for (const auto legacyId : DataPoint::getLegacyIds())
+                {
+                    index[next++] = { .dataPointId = legacyId, .legacy = true, .position = static_cast<uint16_t>(Position) };
+                }
+            };
+            (add.template operator()<Positions>(), ...);
+            // a current ID wins over an equal legacy ID of another datapoint
+            std::ranges::sort(index, [](const IndexEntry &lhs, const IndexEntry &rhs) {
+                return lhs.dataPointId != rhs.dataPointId ? lhs.dataPointId < rhs.dataPointId : !lhs.legacy && rhs.legacy;
+            });
+            return index;
+        }(std::make_index_sequence<std::tuple_size_v<Tuple>>{});
+    }
+
+    template<size_t N>
+    [[nodiscard]] constexpr const IndexEntry *findRecord(const std::array<IndexEntry, N> &index, uint16_t dataPointId) noexcept
+    {
+        const auto *entry = std::ranges::lower_bound(index, dataPointId, {}, &IndexEntry::dataPointId);
+        return entry != index.end() && entry->dataPointId == dataPointId ? entry : nullptr;
+    }
+
+#ifdef USE_FILE_PERSISTENCE
+    // Read-only view of a whole file. POSIX hosts map the file so records are decoded in place without a
+    // copy, other platforms read it into one buffer.
+    class InputFile
+    {
+      public:
+        explicit InputFile(const std::filesystem::path &path) noexcept
+        {
+#ifdef DATALAYER_HAS_POSIX_FILES
+            const int descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (descriptor < 0)
+            {
+                return;
+            }
+            struct stat status
+            {
+            };
+            if (::fstat(descriptor, &status) == 0 && status.st_size >= 0)
+            {
+                m_size = static_cast<size_t>(status.st_size);
+                m_open = true;
+                if (m_size > 0)
+                {
+                    m_data = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+                    if (m_data == MAP_FAILED)
+                    {
+                        m_data = nullptr;
+                        m_open = false;
+                    }
+                    else
+                    {
+                        ::madvise(m_data, m_size, MADV_SEQUENTIAL);
+                    }
+                }
+            }
+            ::close(descriptor);
+#else
+            std::ifstream inputFile(path, std::ios::binary | std::ios::ate);
+            if (!inputFile)
+            {
+                return;
+            }
+            m_size = static_cast<size_t>(inputFile.tellg());
+            m_open = true;
+            if (m_size > MaxPersistenceFileSize)
+            {
+                // only the size is reported, the content is rejected anyway
+                return;
+            }
+            m_buffer.resize(m_size);
+            inputFile.seekg(0);
+            inputFile.read(reinterpret_cast<char *>(m_buffer.data()), static_cast<std::streamsize>(m_buffer.size()));
+            m_open = !inputFile.fail();
+#endif
+        }
+
+        InputFile(InputFile &&other) noexcept
+          : m_data(std::exchange(other.m_data, nullptr)), m_buffer(std::move(other.m_buffer)), m_size(std::exchange(other.m_size, 0U)), m_open(std::exchange(other.m_open, false))
+        {}
+
+        InputFile(const InputFile &) = delete;
+        InputFile &operator=(const InputFile &) = delete;
+        InputFile &operator=(InputFile &&) = delete;
+
+        ~InputFile()
+        {
+#ifdef DATALAYER_HAS_POSIX_FILES
+            if (m_data != nullptr)
+            {
+                ::munmap(m_data, m_size);
+            }
+#endif
+        }
+
+        [[nodiscard]] bool isOpen() const noexcept
+        {
+            return m_open;
+        }
+
+        [[nodiscard]] size_t size() const noexcept
+        {
+            return m_size;
+        }
+
+        [[nodiscard]] std::span<const std::byte> bytes() const noexcept
+        {
+            if (m_data != nullptr)
+            {
+                return { static_cast<const std::byte *>(m_data), m_size };
+            }
+            return m_buffer;
+        }
+
+      private:
+        void *m_data{ nullptr };
+        std::vector<std::byte> m_buffer;
+        size_t m_size{ 0 };
+        bool m_open{ false };
+    };
+
+    [[nodiscard]] inline std::filesystem::path temporaryPath(const std::filesystem::path &path)
+    {
+        return path.string() + ".tmp";
+    }
+
+    // writes the file, durable additionally waits until the content reached the storage device
+    [[nodiscard]] inline bool stageFile(const std::filesystem::path &path, std::span<const std::byte> data, bool durable)
+    {
+#ifdef DATALAYER_HAS_POSIX_FILES
+        const int descriptor = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (descriptor < 0)
+        {
+            return false;
+        }
+        bool success = true;
+        for (size_t written = 0; success && written < data.size();)
+        {
+            const auto result = ::write(descriptor, data.data() + written, data.size() - written);
+            success = result > 0;
+            written += success ? static_cast<size_t>(result) : 0U;
+        }
+        success = success && (!durable || ::fsync(descriptor) == 0);
+        return ::close(descriptor) == 0 && success;
+#else
+        static_cast<void>(durable);
+        std::ofstream outputFile(path, std::ios::binary | std::ios::trunc);
+        outputFile.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+        outputFile.flush();
+        return !outputFile.fail();
+#endif
+    }
+
+    [[nodiscard]] inline bool commitFile(const std::filesystem::path &stagedPath, const std::filesystem::path &path)
+    {
+        std::error_code error;
+        std::filesystem::rename(stagedPath, path, error);
+        if (error)
+        {
+            std::filesystem::remove(path, error);
+            error.clear();
+            std::filesystem::rename(stagedPath, path, error);
+        }
+        return !error;
+    }
+
+    // makes completed renames inside the directory durable
+    [[nodiscard]] inline bool syncDirectory(const std::filesystem::path &directory)
+    {
+#ifdef DATALAYER_HAS_POSIX_FILES
+        const int descriptor = ::open(directory.empty() ? "." : directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (descriptor < 0)
+        {
+            return false;
+        }
+        const bool synced = ::fsync(descriptor) == 0;
+        return ::close(descriptor) == 0 && synced;
+#else
+        static_cast<void>(directory);
+        return true;
+#endif
+    }
+
+    // stages the data in a .tmp file and replaces the target with a single rename
+    [[nodiscard]] inline bool writeFile(const std::filesystem::path &path, std::span<const std::byte> data, bool durable = false)
+    {
+        const auto stagedPath = temporaryPath(path);
+        return stageFile(stagedPath, data, durable) && commitFile(stagedPath, path) && (!durable || syncDirectory(path.parent_path()));
+    }
+#endif
+
+    inline constexpr std::array ContainerMagic{ 'D', 'L', 'C', '1' };
+    inline constexpr uint16_t ContainerFormatVersion = 1;
+
+    // snapshot of several groups in one file: header, group index, then the group images
+    struct ContainerHeader
+    {
+        std::array<char, 4> magic{ ContainerMagic };
+        uint16_t formatVersion{ ContainerFormatVersion };
+        uint16_t groupCount{};
+        // CRC32C of the group index
+        uint32_t indexChecksum{};
+    };
+
+    struct GroupIndexEntry
+    {
+        uint16_t groupId{};
+        uint16_t reserved{};
+        Version groupVersion{};
+        // offset from the start of the container
+        uint32_t offset{};
+        uint32_t size{};
+        // CRC32C of the group image
+        uint32_t checksum{};
+    };
+
+    // validated index of a container image, the group images are not checked until they are requested
+    class ContainerView
+    {
+      public:
+        explicit ContainerView(std::span<const std::byte> input) noexcept : m_input(input)
+        {
+            size_t offset = 0;
+            if (!read(input, offset, m_header) || m_header.magic != ContainerMagic || m_header.formatVersion != ContainerFormatVersion)
+            {
+                return;
+            }
+            const auto indexSize = size_t{ m_header.groupCount } * sizeof(GroupIndexEntry);
+            if (input.size() - offset < indexSize)
+            {
+                return;
+            }
+            m_index = input.subspan(offset, indexSize);
+            m_valid = crc32c(m_index) == m_header.indexChecksum;
+        }
+
+        [[nodiscard]] bool isValid() const noexcept
+        {
+            return m_valid;
+        }
+
+        [[nodiscard]] uint16_t groupCount() const noexcept
+        {
+            return m_valid ? m_header.groupCount : uint16_t{ 0 };
+        }
+
+        [[nodiscard]] bool entry(size_t position, GroupIndexEntry &output) const noexcept
+        {
+            size_t offset = position * sizeof(GroupIndexEntry);
+            return position < groupCount() && read(m_index, offset, output);
+        }
+
+        // image of one group, SerializationError::None when it is present and intact
+        [[nodiscard]] SerializationError find(uint16_t groupId, std::span<const std::byte> &image) const noexcept
+        {
+            if (!m_valid)
+            {
+                return SerializationError::InvalidFormat;
+            }
+            GroupIndexEntry current{};
+            for (size_t position = 0; entry(position, current); ++position)
+            {
+                if (current.groupId != groupId)
+                {
+                    continue;
+                }
+                if (current.offset > m_input.size() || m_input.size() - current.offset < current.size)
+                {
+                    return SerializationError::InvalidFormat;
+                }
+                image = m_input.subspan(current.offset, current.size);
+                return crc32c(image) == current.checksum ? SerializationError::None : SerializationError::ChecksumMismatch;
+            }
+            return SerializationError::GroupIdMismatch;
+        }
+
+      private:
+        std::span<const std::byte> m_input;
+        std::span<const std::byte> m_index;
+        ContainerHeader m_header{};
+        bool m_valid{ false };
+    };
+
+    // collects group images and writes them behind a group index
+    class ContainerBuilder
+    {
+      public:
+        void add(uint16_t groupId, const Version &groupVersion, std::span<const std::byte> image)
+        {
+            m_index.push_back({ .groupId = groupId,
+                                .groupVersion = groupVersion,
+                                .offset = static_cast<uint32_t>(m_images.size()),
+                                .size = static_cast<uint32_t>(image.size()),
+                                .checksum = crc32c(image) });
+            m_images.insert(m_images.end(), image.begin(), image.end());
+        }
+
+        [[nodiscard]] bool finish(std::vector<std::byte> &output)
+        {
+            const auto indexSize = m_index.size() * sizeof(GroupIndexEntry);
+            const auto imageOffset = sizeof(ContainerHeader) + indexSize;
+            if (m_index.size() > UINT16_MAX || imageOffset + m_images.size() > MaxPersistenceFileSize)
+            {
+                return false;
+            }
+            for (auto &current : m_index)
+            {
+                current.offset += static_cast<uint32_t>(imageOffset);
+            }
+            const auto indexBytes = std::as_bytes(std::span{ m_index });
+            const ContainerHeader header{ .groupCount = static_cast<uint16_t>(m_index.size()), .indexChecksum = crc32c(indexBytes) };
+            output.clear();
+            output.reserve(imageOffset + m_images.size());
+            append(output, header);
+            output.insert(output.end(), indexBytes.begin(), indexBytes.end());
+            output.insert(output.end(), m_images.begin(), m_images.end());
+            return true;
+        }
+
+      private:
+        std::vector<GroupIndexEntry> m_index;
+        std::vector<std::byte> m_images;
+    };
 }// namespace DataLayer::Persistence
 
 template<typename Data>
 struct Serialization
 {
-    constexpr explicit Serialization(const DataLayer::Version &groupVersionInfo, uint16_t groupId, const std::filesystem::path &path, Data &input)
-      : m_dataVariables(input), m_groupVersionInfo(groupVersionInfo), m_groupId(groupId), m_path(path)
+    constexpr explicit Serialization(const DataLayer::Version &groupVersionInfo, uint16_t groupId, Data &input)
+      : m_dataVariables(input), m_groupVersionInfo(groupVersionInfo), m_groupId(groupId)
     {}
 
-    [[nodiscard]] SerializationStatus write()
+    [[nodiscard]] SerializationStatus encode(std::vector<std::byte> &output) const
     {
         std::vector<std::byte> records;
         bool success = true;
@@ -100,36 +481,36 @@ struct Serialization
             return { .result = false, .size = 0, .errorCode = SerializationError::InvalidFormat };
         }
 
-        DataLayer::Persistence::Header header{ .groupId = m_groupId, .groupVersion = m_groupVersionInfo, .checksum = DataLayer::Persistence::crc32(records) };
-        std::vector<std::byte> output;
+        DataLayer::Persistence::Header header{ .groupId = m_groupId, .groupVersion = m_groupVersionInfo, .checksum = DataLayer::Persistence::crc32c(records) };
+        output.clear();
+        output.reserve(sizeof(header) + records.size());
         DataLayer::Persistence::append(output, header);
         output.insert(output.end(), records.begin(), records.end());
+        return { .result = true, .size = output.size(), .errorCode = SerializationError::None };
+    }
 
-        const auto temporaryPath = m_path.string() + ".tmp";
+#ifdef USE_FILE_PERSISTENCE
+    [[nodiscard]] SerializationStatus write(const std::filesystem::path &path) const
+    {
+        std::vector<std::byte> output;
+        if (const auto status = encode(output); !status.result)
         {
-            std::ofstream outputFile(temporaryPath, std::ios::binary | std::ios::trunc);
-            outputFile.write(reinterpret_cast<const char *>(output.data()), static_cast<std::streamsize>(output.size()));
-            outputFile.flush();
-            if (outputFile.fail())
-            {
-                return { .result = false, .size = output.size(), .errorCode = SerializationError::InvalidFormat };
-            }
+            return status;
         }
 
-        std::error_code error;
-        std::filesystem::rename(temporaryPath, m_path, error);
-        if (error)
-        {
-            std::filesystem::remove(m_path, error);
-            error.clear();
-            std::filesystem::rename(temporaryPath, m_path, error);
-        }
-        return { .result = !error, .size = output.size(), .errorCode = error ? SerializationError::InvalidFormat : SerializationError::None };
+        const bool written = DataLayer::Persistence::writeFile(path, output);
+        return { .result = written, .size = output.size(), .errorCode = written ? SerializationError::None : SerializationError::InvalidFormat };
     }
+#endif
 
   private:
     static void appendRecord(std::vector<std::byte> &records, const auto &dataPoint, bool &success)
     {
+        if constexpr (DataLayer::PackedMember<decltype(dataPoint)>)
+        {
+            // written as part of the record of its store
+            return;
+        }
         const auto value = dataPoint();
         using Value = std::remove_cvref_t<decltype(value)>;
         if constexpr (!std::is_trivially_copyable_v<Value>)
@@ -137,49 +518,67 @@ struct Serialization
             success = false;
             return;
         }
-        const DataLayer::Persistence::RecordHeader header{ .dataPointId = dataPoint.getId(), .version = dataPoint.getVersion(), .payloadSize = sizeof(Value) };
-        DataLayer::Persistence::append(records, header);
-        DataLayer::Persistence::append(records, value);
+        if constexpr (DataLayer::VariableSize<Value>)
+        {
+            // only the used bytes are written, the payload size is the length prefix
+            const auto payload = value.bytes();
+            const DataLayer::Persistence::RecordHeader header{ .dataPointId = dataPoint.getId(),
+                                                               .version = dataPoint.getVersion(),
+                                                               .payloadSize = static_cast<uint32_t>(payload.size()) };
+            DataLayer::Persistence::append(records, header);
+            records.insert(records.end(), payload.begin(), payload.end());
+        }
+        else if constexpr (DataLayer::Wire::Detail::Quantized<Value>)
+        {
+            // the raw value, decoded back to engineering units on restore
+            using Codec = DataLayer::Wire::Codec<Value>;
+            std::array<std::byte, Codec::Size> payload{};
+            Codec::encode(value, payload.data());
+            const DataLayer::Persistence::RecordHeader header{ .dataPointId = dataPoint.getId(), .version = dataPoint.getVersion(), .payloadSize = Codec::Size };
+            DataLayer::Persistence::append(records, header);
+            records.insert(records.end(), payload.begin(), payload.end());
+        }
+        else
+        {
+            const DataLayer::Persistence::RecordHeader header{ .dataPointId = dataPoint.getId(), .version = dataPoint.getVersion(), .payloadSize = sizeof(Value) };
+            DataLayer::Persistence::append(records, header);
+            DataLayer::Persistence::append(records, value);
+        }
     }
 
     Data &m_dataVariables;
     DataLayer::Version m_groupVersionInfo;
     uint16_t m_groupId;
-    std::filesystem::path m_path;
 };
 
 template<typename Data>
 struct Deserialization
 {
-    constexpr explicit Deserialization(const DataLayer::Version &groupVersionInfo, uint16_t groupId, const std::filesystem::path &path, Data &input, bool allowUpgrade)
-      : m_dataVariables(input), m_groupVersionInfo(groupVersionInfo), m_groupId(groupId), m_path(path), m_allowUpgrade(allowUpgrade)
+    constexpr explicit Deserialization(const DataLayer::Version &groupVersionInfo, uint16_t groupId, Data &input, bool allowUpgrade)
+      : m_dataVariables(input), m_groupVersionInfo(groupVersionInfo), m_groupId(groupId), m_allowUpgrade(allowUpgrade)
     {}
 
-    [[nodiscard]] SerializationStatus read()
+#ifdef USE_FILE_PERSISTENCE
+    [[nodiscard]] SerializationStatus read(const std::filesystem::path &path) const
     {
-        std::ifstream inputFile(m_path, std::ios::binary | std::ios::ate);
-        if (!inputFile)
+        const DataLayer::Persistence::InputFile inputFile(path);
+        if (!inputFile.isOpen())
         {
             return { .result = false, .size = 0, .errorCode = SerializationError::InvalidFormat };
         }
-        const auto fileSize = static_cast<size_t>(inputFile.tellg());
-        if (fileSize < sizeof(DataLayer::Persistence::Header) || fileSize > MaxPersistenceFileSize)
+        if (inputFile.size() < sizeof(DataLayer::Persistence::LegacyHeader) || inputFile.size() > MaxPersistenceFileSize)
         {
-            return { .result = false, .size = fileSize, .errorCode = SerializationError::InvalidFormat };
-        }
-
-        std::vector<std::byte> input(fileSize);
-        inputFile.seekg(0);
-        inputFile.read(reinterpret_cast<char *>(input.data()), static_cast<std::streamsize>(input.size()));
-        if (inputFile.fail())
-        {
-            return { .result = false, .size = 0, .errorCode = SerializationError::InvalidFormat };
+            return { .result = false, .size = inputFile.size(), .errorCode = SerializationError::InvalidFormat };
         }
+        return decode(inputFile.bytes());
+    }
+#endif
 
+    [[nodiscard]] SerializationStatus decode(std::span<const std::byte> input) const
+    {
         DataLayer::Persistence::Header header{};
         size_t offset = 0;
-        if (!DataLayer::Persistence::read(std::span{ input }, offset, header) || header.magic != DataLayer::Persistence::Magic
-            || header.formatVersion != DataLayer::Persistence::FormatVersion)
+        if (!DataLayer::Persistence::readHeader(input, offset, header))
         {
             return { .result = false, .size = input.size(), .errorCode = SerializationError::InvalidFormat };
         }
@@ -188,36 +587,66 @@ struct Deserialization
             return { .result = false, .size = input.size(), .errorCode = SerializationError::GroupIdMismatch };
         }
 
-        const auto records = std::span<const std::byte>{ input }.subspan(offset);
-        if (header.checksum != DataLayer::Persistence::crc32(records))
+        const auto records = input.subspan(offset);
+        if (header.checksum != DataLayer::Persistence::checksum(header.checksumAlgorithm, records))
         {
             return { .result = false, .size = input.size(), .errorCode = SerializationError::ChecksumMismatch };
         }
 
+        static constexpr auto Index = DataLayer::Persistence::makeRecordIndex<Data>();
+        static constexpr auto Readers = makeRecordReaders(std::make_index_sequence<std::tuple_size_v<std::remove_cvref_t<Data>>>{});
+
         SerializationError error = (m_groupVersionInfo > header.groupVersion && !m_allowUpgrade) ? SerializationError::GroupVersion : SerializationError::None;
         bool success = true;
         while (offset < input.size())
         {
             DataLayer::Persistence::RecordHeader record{};
-            if (!DataLayer::Persistence::read(std::span{ input }, offset, record) || input.size() - offset < record.payloadSize)
+            if (!DataLayer::Persistence::read(input, offset, record) || input.size() - offset < record.payloadSize)
             {
                 return { .result = false, .size = offset, .errorCode = SerializationError::InvalidFormat };
             }
-            const auto payload = std::span<const std::byte>{ input }.subspan(offset, record.payloadSize);
+            const auto payload = input.subspan(offset, record.payloadSize);
             offset += record.payloadSize;
-            std::apply([&](auto &...dataPoints) { (readRecord(dataPoints, record, payload, error, success), ...); }, m_dataVariables);
+            if (const auto *entry = DataLayer::Persistence::findRecord(Index, record.dataPointId); entry != nullptr)
+            {
+                Readers[entry->position](m_dataVariables, record, payload, error, success);
+            }
         }
         return { .result = success, .size = input.size(), .errorCode = error };
     }
 
   private:
+    using RecordReader = void (*)(Data &, const DataLayer::Persistence::RecordHeader &, std::span<const std::byte>, SerializationError &, bool &);
+
+    template<size_t... Positions>
+    [[nodiscard]] static consteval auto makeRecordReaders(std::index_sequence<Positions...>) noexcept
+    {
+        return std::array<RecordReader, sizeof...(Positions)>{ [](Data &dataVariables,
+                                                                 const DataLayer::Persistence::RecordHeader &record,
+                                                                 std::span<const std::byte> payload,
+                                                                 SerializationError &error,
+                                                                 bool &success) { readRecord(std::get<Positions>(dataVariables), record, payload, error, success); }... };
+    }
+
     static void readRecord(auto &dataPoint, const DataLayer::Persistence::RecordHeader &record, std::span<const std::byte> payload, SerializationError &error, bool &success)
     {
-        if (!dataPoint.matchesId(record.dataPointId))
+        if constexpr (DataLayer::PackedStorage<decltype(dataPoint)>)
         {
-            return;
+            // another field layout, the packed datapoints keep their current values
+            if (!dataPoint.restore(payload))
+            {
+                success = false;
+                setVersionError(error);
+            }
         }
+        else
+        {
+            readValue(dataPoint, record, payload, error, success);
+        }
+    }
 
+    static void readValue(auto &dataPoint, const DataLayer::Persistence::RecordHeader &record, std::span<const std::byte> payload, SerializationError &error, bool &success)
+    {
         using Value = std::remove_cvref_t<decltype(dataPoint())>;
         if constexpr (!std::is_trivially_copyable_v<Value>)
         {
@@ -234,7 +663,21 @@ struct Deserialization
             setVersionError(error);
             return;
         }
-        if (payload.size() != sizeof(Value))
+        if constexpr (DataLayer::VariableSize<Value>)
+        {
+            // any length up to the capacity is valid, so an upgrade needs no migration
+            if (!value.assign(payload))
+            {
+                success = false;
+                error = SerializationError::InvalidFormat;
+                return;
+            }
+        }
+        else if (readQuantized(payload, value))
+        {
+            // restored from the raw value
+        }
+        else if (payload.size() != sizeof(Value))
         {
             if (!requiresUpgrade || !dataPoint.tryMigrate(record.version, payload, value))
             {
@@ -250,6 +693,23 @@ struct Deserialization
         dataPoint = value;
     }
 
+    // quantized types store the raw value, images written before the quantization hold the full value
+    template<typename Value>
+    [[nodiscard]] static bool readQuantized(std::span<const std::byte> payload, Value &value) noexcept
+    {
+        if constexpr (DataLayer::Wire::Detail::Quantized<Value>)
+        {
+            using Codec = DataLayer::Wire::Codec<Value>;
+            static_assert(Codec::Size < sizeof(Value), "a quantized record must be smaller than the value");
+            if (payload.size() == Codec::Size)
+            {
+                value = Codec::decode(payload.data());
+                return true;
+            }
+        }
+        return false;
+    }
+
     static void setVersionError(SerializationError &error)
     {
         error = error == SerializationError::GroupVersion ? SerializationError::GroupAndDatapointVersion : SerializationError::DatapointVersion;
@@ -258,6 +718,5 @@ struct Deserialization
     Data &m_dataVariables;
     DataLayer::Version m_groupVersionInfo;
     uint16_t m_groupId;
-    std::filesystem::path m_path;
     bool m_allowUpgrade;
 };
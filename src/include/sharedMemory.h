@@ -0,0 +1,487 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <helper.h>
+#include <new>
+#include <span>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <unistd.h>
+#include <utility>
+#include <wireCodec.h>
+
+// Datapoint values mirrored into a POSIX shared memory segment. One writer process publishes every
+// successful set() of its datapoints, other processes of the same model build map the segment read-only
+// and read the values through a per-group seqlock, without syscalls or locks.
+namespace DataLayer::Shared
+{
+    class Publisher
+    {
+      public:
+        virtual ~Publisher() = default;
+        virtual void publish(uint16_t dataPointId, std::span<const std::byte> value) noexcept = 0;
+    };
+
+    inline DataLayer::Detail::WriteHook<Publisher, &Publisher::publish> hook;
+
+    inline void attach(Publisher &publisher) noexcept
+    {
+        hook.attach(publisher);
+    }
+
+    inline void detach() noexcept
+    {
+        hook.detach();
+    }
+
+    inline void publish(uint16_t dataPointId, std::span<const std::byte> value) noexcept
+    {
+        hook.notify(dataPointId, value);
+    }
+
+    inline constexpr std::array SegmentMagic{ 'D', 'L', 'S', 'M' };
+    inline constexpr uint16_t FormatVersion = 1;
+    inline constexpr size_t CacheLine = 64;
+
+    struct SegmentHeader
+    {
+        std::array<char, 4> magic{ SegmentMagic };
+        uint16_t formatVersion{ FormatVersion };
+        uint16_t groupCount{};
+        // FNV-1a over the groups and datapoints with their IDs, versions, type fingerprints, sizes and offsets
+        uint32_t layoutHash{};
+        uint32_t dataPointCount{};
+        uint64_t size{};
+        // set by the writer once every value was published
+        std::atomic<uint32_t> ready{ 0 };
+        uint32_t reserved{};
+    };
+
+    // odd sequence while the writer changes a value of the group
+    struct alignas(CacheLine) GroupHeader
+    {
+        std::atomic<uint64_t> sequence{ 0 };
+        uint16_t baseId{};
+        uint16_t reserved{};
+        uint32_t firstWord{};
+        uint32_t words{};
+    };
+
+    enum class Mode : uint8_t
+    {
+        create,
+        open
+    };
+
+    enum class Status : uint8_t
+    {
+        ok,
+        // no segment under the name, or the writer has not published yet
+        unavailable,
+        formatMismatch,
+        layoutMismatch
+    };
+
+    namespace Detail
+    {
+        inline constexpr size_t WordsPerLine = CacheLine / sizeof(uint64_t);
+
+        // packed stores are not mirrored since their members are
+        template<typename DataPoint>
+        inline constexpr bool Mirrored = !PackedStorage<DataPoint>;
+
+        [[nodiscard]] constexpr size_t words(size_t bytes) noexcept
+        {
+            return (bytes + sizeof(uint64_t) - 1U) / sizeof(uint64_t);
+        }
+
+        // FNV-1a over the little endian bytes of value
+        constexpr void mix(uint32_t &hash, uint32_t value) noexcept
+        {
+            for (size_t shift = 0; shift < 32U; shift += 8U)
+            {
+                hash = (hash ^ ((value >> shift) & 0xFFU)) * 16777619U;
+            }
+        }
+
+        struct Slot
+        {
+            uint16_t dataPointId{};
+            uint16_t group{};
+            uint32_t firstWord{};
+            // value bytes, the capacity of a variable size value
+            uint32_t size{};
+            // a variable size value keeps its used size in the first word
+            bool variable{};
+        };
+
+        [[nodiscard]] constexpr size_t words(const Slot &slot) noexcept
+        {
+            return (slot.variable ? 1U : 0U) + words(slot.size);
+        }
+
+        template<typename Tuple>
+        struct GroupLayout;
+
+        template<typename... DataPoints>
+        struct GroupLayout<std::tuple<DataPoints &...>>
+        {
+            static constexpr size_t Count = (size_t{ Mirrored<DataPoints> } + ... + 0U);
+
+            static constexpr void add(auto &slots, size_t &slot, size_t group, size_t &word, uint32_t &hash) noexcept
+            {
+                (addDataPoint<DataPoints>(slots, slot, group, word, hash), ...);
+            }
+
+          private:
+            template<typename DataPoint>
+            static constexpr void addDataPoint(auto &slots, size_t &slot, size_t group, size_t &word, uint32_t &hash) noexcept
+            {
+                if constexpr (Mirrored<DataPoint>)
+                {
+                    using Point = std::remove_cvref_t<DataPoint>;
+                    using T = Wire::ValueOf<DataPoint>;
+                    constexpr auto version = Point::getVersion();
+                    const Slot added{ .dataPointId = Point::getId(),
+                      .group = static_cast<uint16_t>(group),
+                      .firstWord = static_cast<uint32_t>(word),
+                      .size = static_cast<uint32_t>(Wire::MaximumPayload<T, sizeof(T)>),
+                      .variable = VariableSize<T> };
+                    slots[slot++] = added;
+                    for (const uint32_t value : { uint32_t{ Point::getId() }, TypeFingerprint<Point>, added.size, uint32_t{ added.variable }, static_cast<uint32_t>(alignof(T)),
+                           static_cast<uint32_t>(word), version.major, version.minor, version.build })
+                    {
+                        mix(hash, value);
+                    }
+                    word += words(added);
+                }
+            }
+        };
+
+        struct GroupRange
+        {
+            uint16_t baseId{};
+            uint32_t firstWord{};
+            uint32_t words{};
+        };
+
+        template<typename Groups>
+        struct Layout;
+
+        template<typename... Mappings>
+        struct Layout<std::tuple<Mappings &...>>
+        {
+            static constexpr size_t GroupCount = sizeof...(Mappings);
+            static constexpr size_t Count = (GroupLayout<typename std::remove_cvref_t<Mappings>::ArgsT>::Count + ... + 0U);
+
+            struct Result
+            {
+                // sorted by datapoint ID
+                std::array<Slot, Count> slots{};
+                std::array<GroupRange, GroupCount> groups{};
+                size_t words{ 0 };
+                uint32_t hash{ 2166136261U };
+            };
+
+            template<typename Mapping>
+            static constexpr void addGroup(Result &result, size_t &slot, size_t &group) noexcept
+            {
+                using Group = std::remove_cvref_t<decltype(std::declval<Mapping &>().group)>;
+                // every group starts on its own cache line
+                result.words = (result.words + WordsPerLine - 1U) / WordsPerLine * WordsPerLine;
+                const auto first = result.words;
+                mix(result.hash, Group::baseId);
+                mix(result.hash, Group::version.major);
+                GroupLayout<typename std::remove_cvref_t<Mapping>::ArgsT>::add(result.slots, slot, group, result.words, result.hash);
+                result.groups[group++] = GroupRange{ .baseId = Group::baseId, .firstWord = static_cast<uint32_t>(first), .words = static_cast<uint32_t>(result.words - first) };
+            }
+
+            static constexpr Result Computed = [] {
+                Result result{};
+                size_t slot = 0;
+                size_t group = 0;
+                mix(result.hash, FormatVersion);
+                (addGroup<Mappings>(result, slot, group), ...);
+                std::ranges::sort(result.slots, {}, &Slot::dataPointId);
+                return result;
+            }();
+        };
+    }// namespace Detail
+
+    // Writer side (Mode::create) maps the segment read-write, attach() it to mirror every set(). Readers
+    // (Mode::open) map it read-only and are refused when the writer was built from another model layout.
+    // The creator unlinks the name when it is destroyed. A restarted writer creates a new segment, readers
+    // keep the old mapping until they construct a new Segment.
+    template<typename DispatcherType>
+    class Segment final : public Publisher
+    {
+        using Layout = Detail::Layout<std::remove_cvref_t<decltype(std::declval<const DispatcherType &>().groups)>>;
+        static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic_ref<uint64_t>::is_always_lock_free);
+
+      public:
+        static constexpr uint32_t LayoutHash = Layout::Computed.hash;
+        static constexpr size_t HeaderBytes = (sizeof(SegmentHeader) + CacheLine - 1U) / CacheLine * CacheLine;
+        static constexpr size_t Size = HeaderBytes + Layout::GroupCount * sizeof(GroupHeader) + Layout::Computed.words * sizeof(uint64_t);
+
+        Segment(std::string name, const DispatcherType &dispatcher, Mode openMode) noexcept : m_name(std::move(name)), m_dispatcher(dispatcher), m_writer(openMode == Mode::create)
+        {
+            m_writer ? create() : open();
+        }
+
+        Segment(const Segment &) = delete;
+        Segment &operator=(const Segment &) = delete;
+        Segment(Segment &&) = delete;
+        Segment &operator=(Segment &&) = delete;
+
+        ~Segment() override
+        {
+            release();
+        }
+
+        [[nodiscard]] Status status() const noexcept
+        {
+            return m_status;
+        }
+
+        [[nodiscard]] bool isOpen() const noexcept
+        {
+            return m_status == Status::ok;
+        }
+
+        // writer side, called through the set() hook with the valueBytes() of a datapoint; unknown IDs and
+        // other sizes are ignored
+        void publish(uint16_t dataPointId, std::span<const std::byte> value) noexcept override
+        {
+            const auto slot = std::ranges::lower_bound(Layout::Computed.slots, dataPointId, {}, &Detail::Slot::dataPointId);
+            if (!m_writer || m_base == nullptr || slot == Layout::Computed.slots.end() || slot->dataPointId != dataPointId
+                || (slot->variable ? value.size() > slot->size : value.size() != slot->size))
+            {
+                return;
+            }
+            auto &sequence = groupHeader(slot->group).sequence;
+            auto current = sequence.load(std::memory_order_relaxed);
+            // writer threads of the process take the group by making the sequence odd
+            while ((current & 1U) != 0U || !sequence.compare_exchange_weak(current, current + 1U, std::memory_order_acquire, std::memory_order_relaxed))
+            {
+                std::this_thread::yield();
+                current = sequence.load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_release);
+            auto *word = data() + slot->firstWord;
+            if (slot->variable)
+            {
+                std::atomic_ref{ *word++ }.store(value.size(), std::memory_order_relaxed);
+            }
+            for (size_t offset = 0; offset < value.size(); offset += sizeof(uint64_t), ++word)
+            {
+                uint64_t bits = 0;
+                std::memcpy(&bits, value.data() + offset, std::min(sizeof(uint64_t), value.size() - offset));
+                std::atomic_ref{ *word }.store(bits, std::memory_order_relaxed);
+            }
+            sequence.store(current + 2U, std::memory_order_release);
+        }
+
+        // writer side, publishes the current value of every datapoint, e.g. after a restore
+        void sync() noexcept
+        {
+            std::apply(
+              [this](const auto &...mappings) {
+                  (std::apply(
+                     [this](const auto &...dataPoints) {
+                         (
+                           [this](const auto &dataPoint) {
+                               if constexpr (Detail::Mirrored<decltype(dataPoint)>)
+                               {
+                                   const auto value = dataPoint();
+                                   publish(dataPoint.getId(), valueBytes(value));
+                               }
+                           }(dataPoints),
+                           ...);
+                     },
+                     mappings.datapoints),
+                   ...);
+              },
+              m_dispatcher.groups);
+        }
+
+        // Copies a consistent value. Fails when the segment is not open or the writer held the group for
+        // all attempts, e.g. because it died while writing.
+        template<auto &DataPoint>
+        [[nodiscard]] bool read(Wire::ValueOf<decltype(DataPoint)> &value, size_t attempts = 1U << 16U) const noexcept
+        {
+            using T = Wire::ValueOf<decltype(DataPoint)>;
+            static_assert(std::is_trivially_copyable_v<T>);
+            constexpr auto slot = find(std::remove_cvref_t<decltype(DataPoint)>::getId());
+            if (m_base == nullptr)
+            {
+                return false;
+            }
+            const auto &sequence = groupHeader(slot.group).sequence;
+            std::array<uint64_t, Detail::words(slot)> words{};
+            for (size_t attempt = 0; attempt < attempts; ++attempt)
+            {
+                const auto before = sequence.load(std::memory_order_acquire);
+                if ((before & 1U) == 0U)
+                {
+                    // the mapping may be read-only, atomic_ref only loads from it
+                    auto *word = const_cast<uint64_t *>(data() + slot.firstWord);
+                    for (auto &bits : words)
+                    {
+                        bits = std::atomic_ref{ *word++ }.load(std::memory_order_relaxed);
+                    }
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    if (sequence.load(std::memory_order_relaxed) == before)
+                    {
+                        const auto bytes = std::as_bytes(std::span{ words });
+                        if constexpr (VariableSize<T>)
+                        {
+                            return words.front() <= slot.size && value.assign(bytes.subspan(sizeof(uint64_t), words.front()));
+                        }
+                        else
+                        {
+                            std::memcpy(&value, bytes.data(), sizeof(T));
+                            return true;
+                        }
+                    }
+                }
+                std::this_thread::yield();
+            }
+            return false;
+        }
+
+        // number of completed writes to the group of the datapoint, readers poll it to skip unchanged groups
+        template<auto &DataPoint>
+        [[nodiscard]] uint64_t generation() const noexcept
+        {
+            constexpr auto slot = find(std::remove_cvref_t<decltype(DataPoint)>::getId());
+            return m_base == nullptr ? 0U : groupHeader(slot.group).sequence.load(std::memory_order_acquire) / 2U;
+        }
+
+      private:
+        [[nodiscard]] static consteval Detail::Slot find(uint16_t dataPointId)
+        {
+            const auto slot = std::ranges::find(Layout::Computed.slots, dataPointId, &Detail::Slot::dataPointId);
+            if (slot == Layout::Computed.slots.end())
+            {
+                throw "datapoint is not part of the dispatcher or not mirrored";
+            }
+            return *slot;
+        }
+
+        void create() noexcept
+        {
+            // a segment left by a crashed writer is replaced, its readers keep the old mapping
+            ::shm_unlink(m_name.c_str());
+            const int descriptor = ::shm_open(m_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+            if (descriptor < 0)
+            {
+                m_writer = false;
+                return;
+            }
+            void *mapping = ::ftruncate(descriptor, Size) == 0 ? ::mmap(nullptr, Size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0) : MAP_FAILED;
+            ::close(descriptor);
+            if (mapping == MAP_FAILED)
+            {
+                release();
+                return;
+            }
+            m_base = static_cast<std::byte *>(mapping);
+            auto *header = new (m_base) SegmentHeader{};
+            header->groupCount = static_cast<uint16_t>(Layout::GroupCount);
+            header->layoutHash = LayoutHash;
+            header->dataPointCount = static_cast<uint32_t>(Layout::Computed.slots.size());
+            header->size = Size;
+            for (size_t group = 0; group < Layout::GroupCount; ++group)
+            {
+                auto *groupHeader = new (m_base + HeaderBytes + group * sizeof(GroupHeader)) GroupHeader{};
+                groupHeader->baseId = Layout::Computed.groups[group].baseId;
+                groupHeader->firstWord = Layout::Computed.groups[group].firstWord;
+                groupHeader->words = Layout::Computed.groups[group].words;
+            }
+            sync();
+            header->ready.store(1U, std::memory_order_release);
+            m_status = Status::ok;
+        }
+
+        void open() noexcept
+        {
+            const int descriptor = ::shm_open(m_name.c_str(), O_RDONLY, 0);
+            if (descriptor < 0)
+            {
+                return;
+            }
+            struct stat status
+            {
+            };
+            const auto size = ::fstat(descriptor, &status) == 0 ? static_cast<size_t>(status.st_size) : 0U;
+            void *mapping = size >= sizeof(SegmentHeader) ? ::mmap(nullptr, size, PROT_READ, MAP_SHARED, descriptor, 0) : MAP_FAILED;
+            ::close(descriptor);
+            if (mapping == MAP_FAILED)
+            {
+                return;
+            }
+            m_base = static_cast<std::byte *>(mapping);
+            m_mappedSize = size;
+            const auto *header = std::launder(reinterpret_cast<const SegmentHeader *>(m_base));
+            if (header->magic != SegmentMagic || header->formatVersion != FormatVersion)
+            {
+                m_status = Status::formatMismatch;
+            }
+            else if (header->ready.load(std::memory_order_acquire) == 0U)
+            {
+                m_status = Status::unavailable;
+            }
+            else if (header->layoutHash != LayoutHash || header->groupCount != Layout::GroupCount || header->size != Size || size != Size)
+            {
+                m_status = Status::layoutMismatch;
+            }
+            else
+            {
+                m_status = Status::ok;
+                return;
+            }
+            release();
+        }
+
+        void release() noexcept
+        {
+            if (m_base != nullptr)
+            {
+                ::munmap(static_cast<void *>(m_base), m_writer ? Size : m_mappedSize);
+                m_base = nullptr;
+            }
+            if (m_writer)
+            {
+                ::shm_unlink(m_name.c_str());
+                m_writer = false;
+            }
+        }
+
+        [[nodiscard]] GroupHeader &groupHeader(size_t group) const noexcept
+        {
+            return *std::launder(reinterpret_cast<GroupHeader *>(m_base + HeaderBytes + group * sizeof(GroupHeader)));
+        }
+
+        [[nodiscard]] uint64_t *data() const noexcept
+        {
+            return std::launder(reinterpret_cast<uint64_t *>(m_base + HeaderBytes + Layout::GroupCount * sizeof(GroupHeader)));
+        }
+
+        std::string m_name;
+        const DispatcherType &m_dispatcher;
+        std::byte *m_base{ nullptr };
+        size_t m_mappedSize{ 0 };
+        Status m_status{ Status::unavailable };
+        bool m_writer;
+    };
+}// namespace DataLayer::Shared
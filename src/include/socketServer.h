@@ -0,0 +1,613 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <netinet/in.h>
+#include <poll.h>
+#include <protocol.h>
+#include <span>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <sys/un.h>
+#include <tuple>
+#include <type_traits>
+#include <unistd.h>
+#include <vector>
+
+// Datagram server giving external tools access to the datapoints of a protocol table over a Unix domain
+// socket or UDP on the loopback interface. Every datagram carries one message of the binary protocol in
+// protocol.h: reads and writes are answered by the table, subscribe and unsubscribe are handled here since
+// they need the peer.
+namespace DataLayer::Server
+{
+    using Protocol::Header;
+    using Protocol::HeaderSize;
+    using Protocol::Operation;
+    using Protocol::ResponseFlag;
+    using Protocol::Status;
+
+    namespace Detail
+    {
+        struct Peer
+        {
+            sockaddr_storage address{};
+            socklen_t length{ 0 };
+
+            [[nodiscard]] bool operator==(const Peer &other) const noexcept
+            {
+                return length == other.length && std::memcmp(&address, &other.address, length) == 0;
+            }
+        };
+
+        // one descriptor, closed on destruction
+        class Descriptor
+        {
+          public:
+            Descriptor() = default;
+
+            explicit Descriptor(int descriptor) noexcept : m_descriptor(descriptor)
+            {}
+
+            Descriptor(const Descriptor &) = delete;
+            Descriptor &operator=(const Descriptor &) = delete;
+
+            Descriptor(Descriptor &&other) noexcept : m_descriptor(std::exchange(other.m_descriptor, -1))
+            {}
+
+            Descriptor &operator=(Descriptor &&other) noexcept
+            {
+                reset(std::exchange(other.m_descriptor, -1));
+                return *this;
+            }
+
+            ~Descriptor()
+            {
+                reset();
+            }
+
+            void reset(int descriptor = -1) noexcept
+            {
+                if (m_descriptor >= 0)
+                {
+                    ::close(m_descriptor);
+                }
+                m_descriptor = descriptor;
+            }
+
+            [[nodiscard]] int get() const noexcept
+            {
+                return m_descriptor;
+            }
+
+            [[nodiscard]] bool valid() const noexcept
+            {
+                return m_descriptor >= 0;
+            }
+
+          private:
+            int m_descriptor{ -1 };
+        };
+
+        [[nodiscard]] inline Peer unixAddress(const std::string &path) noexcept
+        {
+            Peer peer{};
+            sockaddr_un address{};
+            address.sun_family = AF_UNIX;
+            const auto size = std::min(path.size(), sizeof(address.sun_path) - 1U);
+            std::memcpy(address.sun_path, path.data(), size);
+            std::memcpy(&peer.address, &address, sizeof(address));
+            peer.length = static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + size + 1U);
+            return peer;
+        }
+
+        [[nodiscard]] inline Peer loopbackAddress(uint16_t port) noexcept
+        {
+            Peer peer{};
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_port = htons(port);
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            std::memcpy(&peer.address, &address, sizeof(address));
+            peer.length = sizeof(address);
+            return peer;
+        }
+    }// namespace Detail
+
+    // Single threaded epoll loop: the socket, a timer that sends notifications of changed values to
+    // subscribers and an eventfd that stops run(). Nothing but stop() may be called from other threads.
+    template<typename TableType, size_t MessageCapacity = 4096, size_t MaximumClients = 16, size_t RangesPerClient = 8>
+    class Server
+    {
+        static_assert(MessageCapacity > HeaderSize + 5U && MessageCapacity <= 65507);
+
+      public:
+        explicit Server(const TableType &table) : m_table(table)
+        {
+            size_t offset = 0;
+            for (const auto &entry : m_table.entries)
+            {
+                m_shadowOffsets.push_back(offset);
+                offset += entry.maximumPayload;
+            }
+            m_shadow.resize(offset);
+            m_shadowSizes.resize(m_table.entries.size());
+            m_changed.resize(m_table.entries.size());
+            refreshShadow(false);
+        }
+
+        Server(const Server &) = delete;
+        Server &operator=(const Server &) = delete;
+        Server(Server &&) = delete;
+        Server &operator=(Server &&) = delete;
+
+        ~Server()
+        {
+            if (!m_path.empty())
+            {
+                ::unlink(m_path.c_str());
+            }
+        }
+
+        // an existing socket file at path is replaced
+        [[nodiscard]] bool bindUnix(const std::string &path) noexcept
+        {
+            const auto address = Detail::unixAddress(path);
+            ::unlink(path.c_str());
+            if (!open(AF_UNIX, address))
+            {
+                return false;
+            }
+            m_path = path;
+            return true;
+        }
+
+        // 127.0.0.1 only, port 0 picks a free port reported by port()
+        [[nodiscard]] bool bindUdp(uint16_t port) noexcept
+        {
+            return open(AF_INET, Detail::loopbackAddress(port));
+        }
+
+        [[nodiscard]] uint16_t port() const noexcept
+        {
+            sockaddr_in address{};
+            socklen_t length = sizeof(address);
+            if (::getsockname(m_socket.get(), reinterpret_cast<sockaddr *>(&address), &length) != 0 || address.sin_family != AF_INET)
+            {
+                return 0;
+            }
+            return ntohs(address.sin_port);
+        }
+
+        // period of the change scan for subscribers, zero disables the timer
+        bool setNotifyInterval(std::chrono::microseconds interval) noexcept
+        {
+            const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(interval);
+            itimerspec timer{};
+            timer.it_interval.tv_sec = seconds.count();
+            timer.it_interval.tv_nsec = std::chrono::duration_cast<std::chrono::nanoseconds>(interval - seconds).count();
+            timer.it_value = timer.it_interval;
+            return m_timer.valid() && ::timerfd_settime(m_timer.get(), 0, &timer, nullptr) == 0;
+        }
+
+        // waits up to timeout milliseconds, -1 blocks, and handles what is ready; returns handled messages
+        size_t poll(int timeout) noexcept
+        {
+            std::array<epoll_event, 3> events{};
+            const int ready = ::epoll_wait(m_epoll.get(), events.data(), static_cast<int>(events.size()), timeout);
+            size_t handled = 0;
+            for (int index = 0; index < ready; ++index)
+            {
+                const auto descriptor = events[static_cast<size_t>(index)].data.fd;
+                if (descriptor == m_socket.get())
+                {
+                    handled += receive();
+                }
+                else if (descriptor == m_timer.get())
+                {
+                    uint64_t expirations = 0;
+                    std::ignore = ::read(m_timer.get(), &expirations, sizeof(expirations));
+                    notifyChanges();
+                }
+                else if (descriptor == m_stop.get())
+                {
+                    uint64_t count = 0;
+                    std::ignore = ::read(m_stop.get(), &count, sizeof(count));
+                    m_running = false;
+                }
+            }
+            return handled;
+        }
+
+        void run() noexcept
+        {
+            m_running = true;
+            while (m_running)
+            {
+                std::ignore = poll(-1);
+            }
+        }
+
+        // safe from any thread and from signal handlers
+        void stop() noexcept
+        {
+            const uint64_t count = 1;
+            std::ignore = ::write(m_stop.get(), &count, sizeof(count));
+        }
+
+        // Answers a read or write request into response by the table, returns the response size; 0 for
+        // operations that need a peer, i.e. subscribe and unsubscribe.
+        [[nodiscard]] size_t respond(std::span<const std::byte> request, std::span<std::byte> response) const noexcept
+        {
+            Header header{};
+            if (Protocol::parseHeader(request, header) && (static_cast<Operation>(header.operation) == Operation::subscribe || static_cast<Operation>(header.operation) == Operation::unsubscribe))
+            {
+                return 0;
+            }
+            return m_table.respond(request, response);
+        }
+
+        // Compares the served values of subscribed datapoints with the last sent ones and notifies every
+        // subscriber of its changed datapoints. Called by the timer, or directly without one.
+        void notifyChanges() noexcept
+        {
+            if (m_clientCount == 0)
+            {
+                return;
+            }
+            refreshShadow(true);
+            // gone clients are removed after the scan, the removal moves the last client into their slot
+            std::array<Detail::Peer, MaximumClients> gone{};
+            size_t goneCount = 0;
+            for (size_t client = 0; client < m_clientCount; ++client)
+            {
+                if (!sendValues(m_clients[client], [this](size_t index) { return m_changed[index]; }))
+                {
+                    gone[goneCount++] = m_clients[client].peer;
+                }
+            }
+            for (size_t client = 0; client < goneCount; ++client)
+            {
+                unsubscribe(gone[client]);
+            }
+        }
+
+        [[nodiscard]] uint64_t requests() const noexcept
+        {
+            return m_requests;
+        }
+
+        [[nodiscard]] uint64_t notifications() const noexcept
+        {
+            return m_notifications;
+        }
+
+        [[nodiscard]] size_t clients() const noexcept
+        {
+            return m_clientCount;
+        }
+
+      private:
+        struct Range
+        {
+            uint16_t first{};
+            uint16_t last{};
+        };
+
+        struct Client
+        {
+            Detail::Peer peer{};
+            std::array<Range, RangesPerClient> ranges{};
+            size_t rangeCount{ 0 };
+
+            [[nodiscard]] bool covers(uint16_t dataPointId) const noexcept
+            {
+                return std::any_of(ranges.begin(), ranges.begin() + static_cast<ptrdiff_t>(rangeCount), [dataPointId](const Range &range) {
+                    return dataPointId >= range.first && dataPointId <= range.last;
+                });
+            }
+        };
+
+        [[nodiscard]] bool open(int family, const Detail::Peer &address) noexcept
+        {
+            m_socket.reset(::socket(family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0));
+            m_epoll.reset(::epoll_create1(EPOLL_CLOEXEC));
+            m_timer.reset(::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC));
+            m_stop.reset(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC));
+            if (!m_socket.valid() || !m_epoll.valid() || !m_timer.valid() || !m_stop.valid()
+                || ::bind(m_socket.get(), reinterpret_cast<const sockaddr *>(&address.address), address.length) != 0)
+            {
+                m_socket.reset();
+                return false;
+            }
+            for (const auto descriptor : { m_socket.get(), m_timer.get(), m_stop.get() })
+            {
+                epoll_event event{};
+                event.events = EPOLLIN;
+                event.data.fd = descriptor;
+                if (::epoll_ctl(m_epoll.get(), EPOLL_CTL_ADD, descriptor, &event) != 0)
+                {
+                    m_socket.reset();
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // drains the socket, every datagram is one request
+        size_t receive() noexcept
+        {
+            size_t handled = 0;
+            while (true)
+            {
+                Detail::Peer peer{};
+                peer.length = sizeof(peer.address);
+                const auto received = ::recvfrom(m_socket.get(), m_request.data(), m_request.size(), 0, reinterpret_cast<sockaddr *>(&peer.address), &peer.length);
+                if (received < 0)
+                {
+                    return handled;
+                }
+                ++handled;
+                ++m_requests;
+                handle(std::span{ m_request }.first(static_cast<size_t>(received)), peer);
+            }
+        }
+
+        void handle(std::span<const std::byte> request, const Detail::Peer &peer) noexcept
+        {
+            Header header{};
+            const bool parsed = Protocol::parseHeader(request, header);
+            if (parsed && static_cast<Operation>(header.operation) == Operation::subscribe)
+            {
+                subscribe(header, request, peer);
+                return;
+            }
+            if (parsed && static_cast<Operation>(header.operation) == Operation::unsubscribe)
+            {
+                unsubscribe(peer);
+                Protocol::storeHeader(m_response, Header{ .operation = static_cast<uint8_t>(header.operation | ResponseFlag), .sequence = header.sequence });
+                std::ignore = send(peer, std::span{ m_response }.first(HeaderSize));
+                return;
+            }
+            const auto size = respond(request, m_response);
+            answer(peer, std::span{ m_response }.first(size));
+        }
+
+        // false when the client socket is gone
+        [[nodiscard]] bool send(const Detail::Peer &peer, std::span<const std::byte> message) const noexcept
+        {
+            return ::sendto(m_socket.get(), message.data(), message.size(), 0, reinterpret_cast<const sockaddr *>(&peer.address), peer.length) >= 0
+                   || (errno != ECONNREFUSED && errno != ENOENT);
+        }
+
+        void answer(const Detail::Peer &peer, std::span<const std::byte> message) noexcept
+        {
+            if (!send(peer, message))
+            {
+                unsubscribe(peer);
+            }
+        }
+
+        void subscribe(const Header &header, std::span<const std::byte> request, const Detail::Peer &peer) noexcept
+        {
+            if (request.size() != HeaderSize + header.count * 4U || header.count + HeaderSize > m_response.size())
+            {
+                answer(peer, std::span{ m_response }.first(Protocol::error(header, Status::invalidRequest, m_response)));
+                return;
+            }
+            auto *client = std::find_if(m_clients.begin(), m_clients.begin() + static_cast<ptrdiff_t>(m_clientCount), [&peer](const Client &candidate) { return candidate.peer == peer; });
+            if (client == m_clients.begin() + static_cast<ptrdiff_t>(m_clientCount) && m_clientCount < MaximumClients)
+            {
+                m_clients[m_clientCount++] = Client{ .peer = peer };
+            }
+            const bool known = client != m_clients.begin() + static_cast<ptrdiff_t>(m_clientCount);
+            Client added{};
+            for (uint16_t item = 0; item < header.count; ++item)
+            {
+                const Range range{ Wire::load(&request[HeaderSize + item * 4U]), Wire::load(&request[HeaderSize + item * 4U + 2U]) };
+                auto status = Status::ok;
+                if (range.first > range.last)
+                {
+                    status = Status::invalidRequest;
+                }
+                else if (!known || client->rangeCount == RangesPerClient)
+                {
+                    status = Status::noCapacity;
+                }
+                else
+                {
+                    client->ranges[client->rangeCount++] = range;
+                    added.ranges[added.rangeCount++] = range;
+                }
+                m_response[HeaderSize + item] = std::byte{ static_cast<uint8_t>(status) };
+            }
+            if (known && client->rangeCount == 0)
+            {
+                // nothing was subscribed, the slot is not kept
+                unsubscribe(peer);
+            }
+            Protocol::storeHeader(m_response, Header{ .operation = static_cast<uint8_t>(header.operation | ResponseFlag), .sequence = header.sequence, .count = header.count });
+            answer(peer, std::span{ m_response }.first(HeaderSize + header.count));
+            // the current values of the new ranges follow the answer
+            if (added.rangeCount != 0)
+            {
+                added.peer = peer;
+                if (!sendValues(added, [](size_t) { return true; }))
+                {
+                    unsubscribe(peer);
+                }
+            }
+        }
+
+        void unsubscribe(const Detail::Peer &peer) noexcept
+        {
+            const auto end = m_clients.begin() + static_cast<ptrdiff_t>(m_clientCount);
+            auto *client = std::find_if(m_clients.begin(), end, [&peer](const Client &candidate) { return candidate.peer == peer; });
+            if (client != end)
+            {
+                *client = m_clients[--m_clientCount];
+            }
+        }
+
+        // notify messages with the values of the entries the client covers and select accepts; false when the
+        // client socket is gone, the caller removes the client
+        template<typename Select>
+        [[nodiscard]] bool sendValues(const Client &client, Select &&select) noexcept
+        {
+            size_t offset = HeaderSize;
+            uint16_t count = 0;
+            bool reachable = true;
+            const auto flush = [&] {
+                if (count != 0 && reachable)
+                {
+                    Protocol::storeHeader(m_notify, Header{ .operation = static_cast<uint8_t>(Operation::notify), .sequence = m_notifySequence++, .count = count });
+                    reachable = send(client.peer, std::span{ m_notify }.first(offset));
+                    ++m_notifications;
+                }
+                offset = HeaderSize;
+                count = 0;
+            };
+            for (size_t index = 0; index < m_table.entries.size(); ++index)
+            {
+                const auto &entry = m_table.entries[index];
+                if (entry.read == nullptr || !select(index) || !client.covers(entry.dataPointId))
+                {
+                    continue;
+                }
+                if (m_notify.size() - offset < 5U + entry.maximumPayload)
+                {
+                    flush();
+                }
+                const auto size = entry.read(std::span{ m_notify }.subspan(offset + 5U));
+                if (size == Protocol::NoSpace)
+                {
+                    continue;
+                }
+                Wire::store(&m_notify[offset], entry.dataPointId);
+                m_notify[offset + 2U] = std::byte{ static_cast<uint8_t>(Status::ok) };
+                Wire::store(&m_notify[offset + 3U], static_cast<uint16_t>(size));
+                offset += 5U + size;
+                ++count;
+            }
+            flush();
+            return reachable;
+        }
+
+        // encodes every subscribed, readable entry and marks the ones that differ from the last scan
+        void refreshShadow(bool subscribedOnly) noexcept
+        {
+            std::array<std::byte, MessageCapacity> scratch{};
+            for (size_t index = 0; index < m_table.entries.size(); ++index)
+            {
+                const auto &entry = m_table.entries[index];
+                m_changed[index] = false;
+                if (entry.read == nullptr
+                    || (subscribedOnly
+                        && std::none_of(m_clients.begin(), m_clients.begin() + static_cast<ptrdiff_t>(m_clientCount), [&entry](const Client &client) {
+                               return client.covers(entry.dataPointId);
+                           })))
+                {
+                    continue;
+                }
+                const auto size = entry.read(std::span{ scratch }.first(entry.maximumPayload));
+                const auto shadow = std::span{ m_shadow }.subspan(m_shadowOffsets[index], size);
+                if (size != m_shadowSizes[index] || !std::ranges::equal(shadow, std::span{ scratch }.first(size)))
+                {
+                    std::ranges::copy(std::span{ scratch }.first(size), shadow.begin());
+                    m_shadowSizes[index] = size;
+                    m_changed[index] = true;
+                }
+            }
+        }
+
+        const TableType &m_table;
+        std::vector<std::byte> m_shadow{};
+        std::vector<size_t> m_shadowOffsets{};
+        std::vector<size_t> m_shadowSizes{};
+        std::vector<bool> m_changed{};
+        std::array<Client, MaximumClients> m_clients{};
+        size_t m_clientCount{ 0 };
+        std::array<std::byte, MessageCapacity> m_request{};
+        std::array<std::byte, MessageCapacity> m_response{};
+        std::array<std::byte, MessageCapacity> m_notify{};
+        Detail::Descriptor m_socket{};
+        Detail::Descriptor m_epoll{};
+        Detail::Descriptor m_timer{};
+        Detail::Descriptor m_stop{};
+        std::string m_path{};
+        uint64_t m_requests{ 0 };
+        uint64_t m_notifications{ 0 };
+        uint16_t m_notifySequence{ 0 };
+        bool m_running{ false };
+    };
+
+    // Blocking client for tools and tests. request() skips notifications while it waits for its answer,
+    // use receive() to collect them.
+    class Client
+    {
+      public:
+        // binds an autogenerated abstract address so the server can answer
+        [[nodiscard]] bool connectUnix(const std::string &path) noexcept
+        {
+            m_socket.reset(::socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0));
+            const sa_family_t family = AF_UNIX;
+            const auto address = Detail::unixAddress(path);
+            return m_socket.valid() && ::bind(m_socket.get(), reinterpret_cast<const sockaddr *>(&family), sizeof(family)) == 0
+                   && ::connect(m_socket.get(), reinterpret_cast<const sockaddr *>(&address.address), address.length) == 0;
+        }
+
+        [[nodiscard]] bool connectUdp(uint16_t port) noexcept
+        {
+            m_socket.reset(::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0));
+            const auto address = Detail::loopbackAddress(port);
+            return m_socket.valid() && ::connect(m_socket.get(), reinterpret_cast<const sockaddr *>(&address.address), address.length) == 0;
+        }
+
+        [[nodiscard]] bool send(std::span<const std::byte> message) const noexcept
+        {
+            return ::send(m_socket.get(), message.data(), message.size(), 0) == static_cast<ssize_t>(message.size());
+        }
+
+        // one message, 0 after timeout milliseconds
+        [[nodiscard]] size_t receive(std::span<std::byte> buffer, int timeout) const noexcept
+        {
+            pollfd descriptor{ .fd = m_socket.get(), .events = POLLIN, .revents = 0 };
+            if (::poll(&descriptor, 1, timeout) <= 0)
+            {
+                return 0;
+            }
+            const auto received = ::recv(m_socket.get(), buffer.data(), buffer.size(), 0);
+            return received < 0 ? 0U : static_cast<size_t>(received);
+        }
+
+        // sends the request and returns the size of the answer with the same sequence, 0 after timeout
+        [[nodiscard]] size_t request(std::span<const std::byte> message, std::span<std::byte> response, int timeout = 1000) const noexcept
+        {
+            Header sent{};
+            if (!Protocol::parseHeader(message, sent) || !send(message))
+            {
+                return 0;
+            }
+            while (true)
+            {
+                const auto size = receive(response, timeout);
+                Header header{};
+                if (size == 0 || (Protocol::parseHeader(response.first(size), header) && header.sequence == sent.sequence && (header.operation & ResponseFlag) != 0U))
+                {
+                    return size;
+                }
+            }
+        }
+
+      private:
+        Detail::Descriptor m_socket{};
+    };
+}// namespace DataLayer::Server
@@ -0,0 +1,287 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <vector>
+
+namespace DataLayer::Storage
+{
+    enum class Result : uint8_t
+    {
+        ok,
+        eraseFailed,
+        programFailed,
+        readFailed,
+        noSpace,
+        notFound
+    };
+
+    // sector based non-volatile memory, e.g. internal flash or an external EEPROM/NOR device
+    class Backend
+    {
+      public:
+        virtual ~Backend() = default;
+        [[nodiscard]] virtual size_t sectorSize() const noexcept = 0;
+        [[nodiscard]] virtual size_t sectorCount() const noexcept = 0;
+        // sets every byte of the sector to the erased state (0xFF)
+        [[nodiscard]] virtual bool erase(size_t sector) noexcept = 0;
+        // programs previously erased bytes, the address must be aligned to ProgramAlignment
+        [[nodiscard]] virtual bool program(size_t address, std::span<const std::byte> data) noexcept = 0;
+        [[nodiscard]] virtual bool read(size_t address, std::span<std::byte> data) noexcept = 0;
+    };
+
+    inline constexpr std::array SlotMagic{ 'D', 'L', 'W', '1' };
+    inline constexpr uint32_t CommitMarker = 0x434F4D54U;
+    inline constexpr size_t ProgramAlignment = 8;
+
+    struct SlotHeader
+    {
+        std::array<char, 4> magic{ SlotMagic };
+        uint32_t sequence{};
+        uint32_t size{};
+        uint32_t checksum{};
+    };
+
+    struct SlotCommit
+    {
+        uint32_t marker{ CommitMarker };
+        uint32_t sequence{};
+    };
+
+    [[nodiscard]] constexpr size_t alignUp(size_t value) noexcept
+    {
+        return (value + ProgramAlignment - 1U) & ~(ProgramAlignment - 1U);
+    }
+
+    [[nodiscard]] constexpr size_t slotSize(size_t payloadSize) noexcept
+    {
+        return sizeof(SlotHeader) + alignUp(payloadSize) + sizeof(SlotCommit);
+    }
+
+    // Log-structured store for one persisted image (e.g. one group). Every write appends a new slot
+    // behind the previous one and only moves on to (and erases) the next sector once the current one is
+    // full, so the erase load is spread over all sectors. A slot only becomes valid after its commit
+    // word is programmed last; an interrupted write leaves the previously committed slot untouched.
+    class WearLevelingStore
+    {
+      public:
+        explicit WearLevelingStore(Backend &backend) noexcept : m_backend(backend)
+        {}
+
+        [[nodiscard]] Result mount() noexcept
+        {
+            m_mounted = false;
+            m_latest = {};
+            m_writeSector = 0;
+            m_writeOffset = 0;
+            for (size_t sector = 0; sector < m_backend.sectorCount(); ++sector)
+            {
+                if (const auto result = scanSector(sector); result != Result::ok)
+                {
+                    return result;
+                }
+            }
+            if (m_latest.valid)
+            {
+                m_writeSector = m_latest.sector;
+                m_writeOffset = m_latestSectorEnd;
+            }
+            else
+            {
+                // nothing committed yet, force a fresh sector on the first write
+                m_writeSector = m_backend.sectorCount() - 1U;
+                m_writeOffset = m_backend.sectorSize();
+            }
+            m_mounted = true;
+            return Result::ok;
+        }
+
+        [[nodiscard]] Result write(std::span<const std::byte> payload) noexcept
+        {
+            if (!m_mounted)
+            {
+                if (const auto result = mount(); result != Result::ok)
+                {
+                    return result;
+                }
+            }
+            if (m_backend.sectorCount() < 2U || slotSize(payload.size()) > m_backend.sectorSize())
+            {
+                return Result::noSpace;
+            }
+            const auto result = append(payload);
+            if (result != Result::ok)
+            {
+                // treat a failed write like a power loss, the next write starts again behind the latest slot
+                m_mounted = false;
+            }
+            return result;
+        }
+
+        [[nodiscard]] Result restore(std::vector<std::byte> &output) noexcept
+        {
+            if (!m_mounted)
+            {
+                if (const auto result = mount(); result != Result::ok)
+                {
+                    return result;
+                }
+            }
+            if (!m_latest.valid)
+            {
+                return Result::notFound;
+            }
+            output.resize(m_latest.size);
+            const auto address = m_latest.sector * m_backend.sectorSize() + m_latest.offset + sizeof(SlotHeader);
+            return m_backend.read(address, output) ? Result::ok : Result::readFailed;
+        }
+
+        [[nodiscard]] uint32_t sequence() const noexcept
+        {
+            return m_latest.valid ? m_latest.sequence : 0U;
+        }
+
+      private:
+        struct Slot
+        {
+            bool valid{ false };
+            size_t sector{};
+            size_t offset{};
+            uint32_t sequence{};
+            uint32_t size{};
+        };
+
+        [[nodiscard]] Result append(std::span<const std::byte> payload) noexcept
+        {
+            const auto requiredSize = slotSize(payload.size());
+            if (m_backend.sectorSize() - m_writeOffset < requiredSize)
+            {
+                // the next sector never holds the latest committed slot, it lives in the current one
+                const auto nextSector = (m_writeSector + 1U) % m_backend.sectorCount();
+                if (!m_backend.erase(nextSector))
+                {
+                    return Result::eraseFailed;
+                }
+                m_writeSector = nextSector;
+                m_writeOffset = 0;
+            }
+
+            const auto base = m_writeSector * m_backend.sectorSize() + m_writeOffset;
+            const auto sequence = m_latest.valid ? m_latest.sequence + 1U : 1U;
+            const SlotHeader header{ .sequence = sequence, .size = static_cast<uint32_t>(payload.size()), .checksum = checksum(payload) };
+            // the slot space is consumed as soon as the header is programmed, even when a later step fails
+            m_writeOffset += requiredSize;
+            if (!m_backend.program(base, std::as_bytes(std::span{ &header, 1 })))
+            {
+                return Result::programFailed;
+            }
+
+            const auto alignedSize = payload.size() - payload.size() % ProgramAlignment;
+            if (alignedSize > 0 && !m_backend.program(base + sizeof(SlotHeader), payload.first(alignedSize)))
+            {
+                return Result::programFailed;
+            }
+            if (alignedSize != payload.size())
+            {
+                std::array<std::byte, ProgramAlignment> tail{};
+                tail.fill(std::byte{ 0xFF });
+                std::memcpy(tail.data(), payload.data() + alignedSize, payload.size() - alignedSize);
+                if (!m_backend.program(base + sizeof(SlotHeader) + alignedSize, tail))
+                {
+                    return Result::programFailed;
+                }
+            }
+
+            const SlotCommit commit{ .sequence = sequence };
+            if (!m_backend.program(base + sizeof(SlotHeader) + alignUp(payload.size()), std::as_bytes(std::span{ &commit, 1 })))
+            {
+                return Result::programFailed;
+            }
+            m_latest = { .valid = true, .sector = m_writeSector, .offset = base - m_writeSector * m_backend.sectorSize(), .sequence = sequence, .size = header.size };
+            return Result::ok;
+        }
+
+        [[nodiscard]] Result scanSector(size_t sector) noexcept
+        {
+            const auto sectorBase = sector * m_backend.sectorSize();
+            size_t offset = 0;
+            while (m_backend.sectorSize() - offset >= slotSize(0))
+            {
+                SlotHeader header{};
+                if (!m_backend.read(sectorBase + offset, std::as_writable_bytes(std::span{ &header, 1 })))
+                {
+                    return Result::readFailed;
+                }
+                if (isErased(header))
+                {
+                    break;
+                }
+                if (header.magic != SlotMagic || header.size > m_backend.sectorSize() || m_backend.sectorSize() - offset < slotSize(header.size))
+                {
+                    // torn header, the remainder of this sector can't be trusted nor reused
+                    offset = m_backend.sectorSize();
+                    break;
+                }
+
+                if (header.sequence >= m_latest.sequence && isCommitted(sectorBase + offset, header))
+                {
+                    m_latest = { .valid = true, .sector = sector, .offset = offset, .sequence = header.sequence, .size = header.size };
+                    m_latestSectorEnd = offset + slotSize(header.size);
+                }
+                offset += slotSize(header.size);
+            }
+            if (m_latest.valid && m_latest.sector == sector)
+            {
+                m_latestSectorEnd = offset;
+            }
+            return Result::ok;
+        }
+
+        [[nodiscard]] bool isCommitted(size_t address, const SlotHeader &header) noexcept
+        {
+            SlotCommit commit{};
+            if (!m_backend.read(address + sizeof(SlotHeader) + alignUp(header.size), std::as_writable_bytes(std::span{ &commit, 1 })) || commit.marker != CommitMarker
+                || commit.sequence != header.sequence)
+            {
+                return false;
+            }
+            m_scratch.resize(header.size);
+            return m_backend.read(address + sizeof(SlotHeader), m_scratch) && checksum(m_scratch) == header.checksum;
+        }
+
+        [[nodiscard]] static bool isErased(const SlotHeader &header) noexcept
+        {
+            const auto bytes = std::as_bytes(std::span{ &header, 1 });
+            for (const auto byte : bytes)
+            {
+                if (byte != std::byte{ 0xFF })
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // FNV-1a, the group image inside the slot carries its own CRC32
+        [[nodiscard]] static uint32_t checksum(std::span<const std::byte> data) noexcept
+        {
+            uint32_t hash = 2166136261U;
+            for (const auto byte : data)
+            {
+                hash = (hash ^ std::to_integer<uint8_t>(byte)) * 16777619U;
+            }
+            return hash;
+        }
+
+        Backend &m_backend;
+        std::vector<std::byte> m_scratch;
+        Slot m_latest{};
+        size_t m_latestSectorEnd{ 0 };
+        size_t m_writeSector{ 0 };
+        size_t m_writeOffset{ 0 };
+        bool m_mounted{ false };
+    };
+}// namespace DataLayer::Storage
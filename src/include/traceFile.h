@@ -0,0 +1,448 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <checksum.h>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <serialization.h>
+#include <span>
+#include <thread>
+#include <traceRecorder.h>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+// Trace files: a file header, then self-describing blocks of records, then a block index written on
+// close. A file without the index, e.g. after a crash, is read by walking the blocks.
+namespace DataLayer::Trace
+{
+    inline constexpr std::array FileMagic{ 'D', 'L', 'T', 'R' };
+    inline constexpr std::array BlockMagic{ 'D', 'L', 'T', 'B' };
+    inline constexpr std::array IndexMagic{ 'D', 'L', 'T', 'I' };
+    inline constexpr uint16_t FormatVersion = 1;
+
+    // records per block, a block also ends when its time span exceeds the 32 bit delta
+    inline constexpr uint32_t MaximumBlockRecords = 4096;
+    // set in RecordHeader::size when the value was cut to the recorder payload capacity
+    inline constexpr uint16_t TruncatedFlag = 0x8000;
+    inline constexpr uint16_t SizeMask = 0x7FFF;
+
+    struct FileHeader
+    {
+        std::array<char, 4> magic{ FileMagic };
+        uint16_t formatVersion{ FormatVersion };
+        uint16_t reserved{};
+    };
+
+    struct BlockHeader
+    {
+        std::array<char, 4> magic{ BlockMagic };
+        uint32_t recordCount{};
+        // bytes of the records behind this header
+        uint32_t size{};
+        // CRC32C of the records
+        uint32_t checksum{};
+        uint64_t firstTimestamp{};
+        // writes the recorder dropped before this block
+        uint32_t dropped{};
+        uint32_t reserved{};
+    };
+
+    struct RecordHeader
+    {
+        // nanoseconds since the first record of the block
+        uint32_t delta{};
+        uint16_t dataPointId{};
+        uint16_t size{};
+    };
+
+    struct IndexEntry
+    {
+        uint64_t offset{};
+        uint64_t firstTimestamp{};
+        uint32_t recordCount{};
+        uint32_t reserved{};
+    };
+
+    struct IndexTrailer
+    {
+        uint64_t indexOffset{};
+        uint32_t blockCount{};
+        std::array<char, 4> magic{ IndexMagic };
+    };
+
+    // Spills recorder entries into a trace file. Timestamps are made non-decreasing, since writers of
+    // different threads may fill their slots out of order.
+    class FileWriter
+    {
+      public:
+        explicit FileWriter(const std::filesystem::path &path) : m_file(path, std::ios::binary | std::ios::trunc)
+        {
+            const FileHeader header{};
+            m_file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            m_offset = sizeof(header);
+        }
+
+        FileWriter(const FileWriter &) = delete;
+        FileWriter &operator=(const FileWriter &) = delete;
+        FileWriter(FileWriter &&) = delete;
+        FileWriter &operator=(FileWriter &&) = delete;
+
+        ~FileWriter()
+        {
+            std::ignore = close();
+        }
+
+        [[nodiscard]] bool isOpen() const
+        {
+            return m_file.is_open() && m_file.good();
+        }
+
+        // moves every filled entry of the recorder into the file, returns the number of records
+        template<size_t Slots, size_t PayloadCapacity>
+        size_t spill(Recorder<Slots, PayloadCapacity> &recorder)
+        {
+            static_assert(PayloadCapacity < TruncatedFlag);
+            size_t records = 0;
+            Entry entry{};
+            while (recorder.pop(entry))
+            {
+                append(entry);
+                ++records;
+            }
+            m_dropped += recorder.takeDropped();
+            writeBlock();
+            return records;
+        }
+
+        // writes the open block and the index, the file is complete afterwards
+        [[nodiscard]] bool close()
+        {
+            if (!m_file.is_open())
+            {
+                return false;
+            }
+            writeBlock();
+            const IndexTrailer trailer{ .indexOffset = m_offset, .blockCount = static_cast<uint32_t>(m_index.size()) };
+            m_file.write(reinterpret_cast<const char *>(m_index.data()), static_cast<std::streamsize>(m_index.size() * sizeof(IndexEntry)));
+            m_file.write(reinterpret_cast<const char *>(&trailer), sizeof(trailer));
+            const bool written = m_file.good();
+            m_file.close();
+            return written;
+        }
+
+        [[nodiscard]] uint64_t records() const noexcept
+        {
+            return m_records;
+        }
+
+        [[nodiscard]] size_t blocks() const noexcept
+        {
+            return m_index.size();
+        }
+
+      private:
+        void append(const Entry &entry)
+        {
+            const auto timestamp = std::max(entry.timestamp, m_lastTimestamp);
+            if (m_header.recordCount == MaximumBlockRecords || (m_header.recordCount != 0 && timestamp - m_header.firstTimestamp > UINT32_MAX))
+            {
+                writeBlock();
+            }
+            if (m_header.recordCount == 0)
+            {
+                m_header.firstTimestamp = timestamp;
+            }
+            const RecordHeader header{ .delta = static_cast<uint32_t>(timestamp - m_header.firstTimestamp),
+              .dataPointId = entry.dataPointId,
+              .size = static_cast<uint16_t>(entry.payload.size() | (entry.truncated() ? TruncatedFlag : 0U)) };
+            Persistence::append(m_block, header);
+            m_block.insert(m_block.end(), entry.payload.begin(), entry.payload.end());
+            ++m_header.recordCount;
+            ++m_records;
+            m_lastTimestamp = timestamp;
+        }
+
+        void writeBlock()
+        {
+            if (m_header.recordCount == 0 || !m_file.is_open())
+            {
+                return;
+            }
+            m_header.size = static_cast<uint32_t>(m_block.size());
+            m_header.checksum = Persistence::crc32c(m_block);
+            m_header.dropped = static_cast<uint32_t>(std::min<uint64_t>(m_dropped, UINT32_MAX));
+            m_file.write(reinterpret_cast<const char *>(&m_header), sizeof(m_header));
+            m_file.write(reinterpret_cast<const char *>(m_block.data()), static_cast<std::streamsize>(m_block.size()));
+            m_index.push_back({ .offset = m_offset, .firstTimestamp = m_header.firstTimestamp, .recordCount = m_header.recordCount });
+            m_offset += sizeof(m_header) + m_block.size();
+            m_dropped = 0;
+            m_block.clear();
+            m_header = BlockHeader{};
+        }
+
+        std::ofstream m_file;
+        std::vector<std::byte> m_block{};
+        std::vector<IndexEntry> m_index{};
+        BlockHeader m_header{};
+        uint64_t m_offset{ 0 };
+        uint64_t m_lastTimestamp{ 0 };
+        uint64_t m_dropped{ 0 };
+        uint64_t m_records{ 0 };
+    };
+
+    struct Record
+    {
+        uint64_t timestamp{};
+        uint16_t dataPointId{};
+        bool truncated{ false };
+        std::span<const std::byte> payload{};
+    };
+
+    // Reads a whole trace file into memory and iterates its records. Blocks whose checksum does not match
+    // are skipped and counted.
+    class Reader
+    {
+      public:
+        explicit Reader(const std::filesystem::path &path)
+        {
+            std::ifstream input(path, std::ios::binary | std::ios::ate);
+            if (!input)
+            {
+                return;
+            }
+            m_bytes.resize(static_cast<size_t>(input.tellg()));
+            input.seekg(0);
+            input.read(reinterpret_cast<char *>(m_bytes.data()), static_cast<std::streamsize>(m_bytes.size()));
+            FileHeader header{};
+            size_t offset = 0;
+            m_open = input.good() && Persistence::read(m_bytes, offset, header) && header.magic == FileMagic && header.formatVersion == FormatVersion;
+            if (m_open && !readIndex())
+            {
+                scanBlocks();
+            }
+        }
+
+        [[nodiscard]] bool isOpen() const noexcept
+        {
+            return m_open;
+        }
+
+        // true when the index written on close was found, otherwise the blocks were walked
+        [[nodiscard]] bool indexed() const noexcept
+        {
+            return m_indexed;
+        }
+
+        [[nodiscard]] const std::vector<IndexEntry> &blocks() const noexcept
+        {
+            return m_index;
+        }
+
+        // continues with the first record at or after timestamp, found through the block index
+        void seek(uint64_t timestamp) noexcept
+        {
+            const auto block = std::ranges::upper_bound(m_index, timestamp, {}, &IndexEntry::firstTimestamp);
+            m_block = block == m_index.begin() ? 0 : static_cast<size_t>(block - m_index.begin()) - 1U;
+            m_record = 0;
+            m_position = 0;
+            m_seek = timestamp;
+        }
+
+        [[nodiscard]] bool next(Record &record) noexcept
+        {
+            while (m_block < m_index.size())
+            {
+                if (m_record == 0 && m_position == 0 && !enterBlock())
+                {
+                    ++m_corruptBlocks;
+                    ++m_block;
+                    continue;
+                }
+                if (m_record == m_header.recordCount)
+                {
+                    ++m_block;
+                    m_record = 0;
+                    m_position = 0;
+                    continue;
+                }
+                RecordHeader header{};
+                const auto records = std::span<const std::byte>{ m_bytes }.subspan(m_index[m_block].offset + sizeof(BlockHeader), m_header.size);
+                if (!Persistence::read(records, m_position, header) || records.size() - m_position < static_cast<size_t>(header.size & SizeMask))
+                {
+                    ++m_corruptBlocks;
+                    ++m_block;
+                    m_record = 0;
+                    m_position = 0;
+                    continue;
+                }
+                record = Record{ .timestamp = m_header.firstTimestamp + header.delta,
+                  .dataPointId = header.dataPointId,
+                  .truncated = (header.size & TruncatedFlag) != 0,
+                  .payload = records.subspan(m_position, static_cast<size_t>(header.size & SizeMask)) };
+                m_position += record.payload.size();
+                ++m_record;
+                if (record.timestamp >= m_seek)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        [[nodiscard]] uint64_t dropped() const noexcept
+        {
+            uint64_t dropped = 0;
+            for (const auto &entry : m_index)
+            {
+                BlockHeader header{};
+                size_t offset = entry.offset;
+                dropped += Persistence::read(m_bytes, offset, header) ? header.dropped : 0U;
+            }
+            return dropped;
+        }
+
+        [[nodiscard]] size_t corruptBlocks() const noexcept
+        {
+            return m_corruptBlocks;
+        }
+
+      private:
+        [[nodiscard]] bool readIndex()
+        {
+            IndexTrailer trailer{};
+            size_t offset = m_bytes.size() - std::min(m_bytes.size(), sizeof(IndexTrailer));
+            if (!Persistence::read(m_bytes, offset, trailer) || trailer.magic != IndexMagic || trailer.indexOffset > m_bytes.size() - sizeof(IndexTrailer)
+                || (m_bytes.size() - sizeof(IndexTrailer) - trailer.indexOffset) != trailer.blockCount * sizeof(IndexEntry))
+            {
+                return false;
+            }
+            offset = trailer.indexOffset;
+            m_index.resize(trailer.blockCount);
+            for (auto &entry : m_index)
+            {
+                std::ignore = Persistence::read(m_bytes, offset, entry);
+            }
+            m_indexed = true;
+            return true;
+        }
+
+        void scanBlocks()
+        {
+            size_t offset = sizeof(FileHeader);
+            BlockHeader header{};
+            while (true)
+            {
+                const auto start = offset;
+                if (!Persistence::read(m_bytes, offset, header) || header.magic != BlockMagic || m_bytes.size() - offset < header.size)
+                {
+                    return;
+                }
+                m_index.push_back({ .offset = start, .firstTimestamp = header.firstTimestamp, .recordCount = header.recordCount });
+                offset += header.size;
+            }
+        }
+
+        [[nodiscard]] bool enterBlock() noexcept
+        {
+            size_t offset = m_index[m_block].offset;
+            return Persistence::read(m_bytes, offset, m_header) && m_header.magic == BlockMagic && m_bytes.size() - offset >= m_header.size
+                   && Persistence::crc32c(std::span<const std::byte>{ m_bytes }.subspan(offset, m_header.size)) == m_header.checksum;
+        }
+
+        std::vector<std::byte> m_bytes{};
+        std::vector<IndexEntry> m_index{};
+        BlockHeader m_header{};
+        size_t m_block{ 0 };
+        size_t m_record{ 0 };
+        size_t m_position{ 0 };
+        uint64_t m_seek{ 0 };
+        size_t m_corruptBlocks{ 0 };
+        bool m_open{ false };
+        bool m_indexed{ false };
+    };
+
+    struct ReplayStatus
+    {
+        uint64_t applied{ 0 };
+        // unknown IDs, truncated or mis-sized payloads and writes the datapoint refused
+        uint64_t rejected{ 0 };
+    };
+
+    namespace Detail
+    {
+        template<typename DispatcherType, typename DataPoint>
+        [[nodiscard]] bool applyTo(const DispatcherType &dispatcher, const DataPoint &dataPoint, const Record &record) noexcept
+        {
+            using T = std::remove_cvref_t<decltype(dataPoint())>;
+            T value{};
+            if constexpr (VariableSize<T>)
+            {
+                if (!value.assign(record.payload))
+                {
+                    return false;
+                }
+            }
+            else
+            {
+                if (record.payload.size() != sizeof(T))
+                {
+                    return false;
+                }
+                std::memcpy(&value, record.payload.data(), sizeof(T));
+            }
+            return dispatcher.setDatapoint(record.dataPointId, value).success;
+        }
+    }// namespace Detail
+
+    // Writes one record through Dispatcher::setDatapoint with the type of its datapoint, so range checks,
+    // change callbacks and lazy restore behave like the original write.
+    template<typename DispatcherType>
+    [[nodiscard]] bool applyRecord(const DispatcherType &dispatcher, const Record &record) noexcept
+    {
+        if (record.truncated)
+        {
+            return false;
+        }
+        bool applied = false;
+        std::apply(
+          [&](const auto &...mappings) {
+              std::ignore = (std::apply(
+                               [&](const auto &...dataPoints) {
+                                   return ((dataPoints.getId() == record.dataPointId && (applied = Detail::applyTo(dispatcher, dataPoints, record), true)) || ...);
+                               },
+                               mappings.datapoints)
+                             || ...);
+          },
+          dispatcher.groups);
+        return applied;
+    }
+
+    // Replays every remaining record of the reader. speed scales the original timing, 2.0 replays twice as
+    // fast; 0 applies the records back to back.
+    template<typename DispatcherType>
+    ReplayStatus replay(const DispatcherType &dispatcher, Reader &reader, double speed = 1.0)
+    {
+        ReplayStatus status{};
+        Record record{};
+        const auto start = std::chrono::steady_clock::now();
+        uint64_t first = 0;
+        bool started = false;
+        while (reader.next(record))
+        {
+            if (speed > 0.0)
+            {
+                first = started ? first : record.timestamp;
+                started = true;
+                const auto offset = std::chrono::duration<double, std::nano>(static_cast<double>(record.timestamp - first) / speed);
+                std::this_thread::sleep_until(start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(offset));
+            }
+            ++(applyRecord(dispatcher, record) ? status.applied : status.rejected);
+        }
+        return status;
+    }
+}// namespace DataLayer::Trace
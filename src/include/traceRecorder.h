@@ -0,0 +1,156 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <helper.h>
+#include <span>
+
+// Recording of datapoint writes. With USE_TRACE every successful DataPoint::setValue hands its ID and the
+// stored value to the attached sink.
+namespace DataLayer::Trace
+{
+    class Sink
+    {
+      public:
+        virtual ~Sink() = default;
+        virtual void record(uint16_t dataPointId, std::span<const std::byte> payload) noexcept = 0;
+    };
+
+    inline DataLayer::Detail::WriteHook<Sink, &Sink::record> hook;
+
+    inline void attach(Sink &sink) noexcept
+    {
+        hook.attach(sink);
+    }
+
+    inline void detach() noexcept
+    {
+        hook.detach();
+    }
+
+    inline void record(uint16_t dataPointId, std::span<const std::byte> payload) noexcept
+    {
+        hook.notify(dataPointId, payload);
+    }
+
+    // one recorded write, valid until the next pop
+    struct Entry
+    {
+        uint64_t timestamp{};
+        uint16_t dataPointId{};
+        // value bytes before truncation
+        uint16_t size{};
+        std::span<const std::byte> payload{};
+
+        [[nodiscard]] bool truncated() const noexcept
+        {
+            return payload.size() < size;
+        }
+    };
+
+    // Bounded multi-producer, single-consumer ring of fixed slots. Writers of any thread claim a slot with
+    // one compare-exchange and never wait; a full ring drops the write and counts it. Values larger than
+    // PayloadCapacity keep their first bytes and are marked truncated. pop belongs to one consumer, which
+    // spills the entries, e.g. to a Trace::FileWriter.
+    template<size_t Slots, size_t PayloadCapacity = 40>
+    class Recorder final : public Sink
+    {
+        static_assert(std::has_single_bit(Slots) && PayloadCapacity <= UINT16_MAX);
+
+      public:
+        explicit Recorder(Clock clock = &steadyNanoseconds) noexcept : m_clock(clock)
+        {
+            for (size_t index = 0; index < Slots; ++index)
+            {
+                m_slots[index].sequence.store(index, std::memory_order_relaxed);
+            }
+        }
+
+        void record(uint16_t dataPointId, std::span<const std::byte> payload) noexcept override
+        {
+            auto position = m_head.load(std::memory_order_relaxed);
+            Slot *slot = nullptr;
+            while (true)
+            {
+                slot = &m_slots[position & (Slots - 1U)];
+                const auto distance = static_cast<int64_t>(slot->sequence.load(std::memory_order_acquire) - position);
+                if (distance == 0)
+                {
+                    if (m_head.compare_exchange_weak(position, position + 1U, std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                }
+                else if (distance < 0)
+                {
+                    m_dropped.fetch_add(1U, std::memory_order_relaxed);
+                    return;
+                }
+                else
+                {
+                    position = m_head.load(std::memory_order_relaxed);
+                }
+            }
+            slot->timestamp = m_clock();
+            slot->dataPointId = dataPointId;
+            slot->size = static_cast<uint16_t>(std::min<size_t>(payload.size(), UINT16_MAX));
+            std::copy_n(payload.begin(), std::min(payload.size(), PayloadCapacity), slot->payload.begin());
+            slot->sequence.store(position + 1U, std::memory_order_release);
+        }
+
+        // false while the oldest claimed slot is not yet filled or the ring is empty
+        [[nodiscard]] bool pop(Entry &entry) noexcept
+        {
+            if (m_pending)
+            {
+                release();
+            }
+            auto &slot = m_slots[m_tail & (Slots - 1U)];
+            if (slot.sequence.load(std::memory_order_acquire) != m_tail + 1U)
+            {
+                return false;
+            }
+            entry = Entry{ .timestamp = slot.timestamp,
+              .dataPointId = slot.dataPointId,
+              .size = slot.size,
+              .payload = std::span<const std::byte>{ slot.payload }.first(std::min<size_t>(slot.size, PayloadCapacity)) };
+            m_pending = true;
+            return true;
+        }
+
+        // writes lost to a full ring since the last call
+        [[nodiscard]] uint64_t takeDropped() noexcept
+        {
+            return m_dropped.exchange(0U, std::memory_order_relaxed);
+        }
+
+      private:
+        // the slot of the last popped entry is handed back to the writers on the next pop
+        void release() noexcept
+        {
+            m_slots[m_tail & (Slots - 1U)].sequence.store(m_tail + Slots, std::memory_order_release);
+            ++m_tail;
+            m_pending = false;
+        }
+
+        struct alignas(64) Slot
+        {
+            std::atomic<uint64_t> sequence{ 0 };
+            uint64_t timestamp{};
+            uint16_t dataPointId{};
+            uint16_t size{};
+            std::array<std::byte, PayloadCapacity> payload{};
+        };
+
+        std::array<Slot, Slots> m_slots{};
+        alignas(64) std::atomic<uint64_t> m_head{ 0 };
+        std::atomic<uint64_t> m_dropped{ 0 };
+        alignas(64) uint64_t m_tail{ 0 };
+        bool m_pending{ false };
+        Clock m_clock;
+    };
+}// namespace DataLayer::Trace
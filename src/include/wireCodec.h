@@ -0,0 +1,370 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <detail.h>
+#include <limits>
+#include <span>
+#include <tuple>
+#include <type_traits>
+
+namespace DataLayer::Wire
+{
+    // Member pointers of a generated struct in declaration order, specialized by the generator.
+    template<typename T>
+    struct Fields
+    {
+    };
+
+    // Packed little endian representation of a value. Native is true when the host layout already is
+    // that representation, encode and decode are then a single memcpy.
+    template<typename T>
+    struct Codec
+    {
+    };
+
+    // Linear quantization of a generated alias type: value = raw * scale + offset with an unsigned raw
+    // value of bits bits, transmitted and persisted in the fewest whole bytes.
+    struct Quantization
+    {
+        double scale{ 1.0 };
+        double offset{ 0.0 };
+        uint8_t bits{ 0 };
+    };
+
+    template<typename T>
+    concept Encodable = requires {
+        { Codec<T>::Size } -> std::convertible_to<size_t>;
+        { Codec<T>::Native } -> std::convertible_to<bool>;
+    };
+
+    namespace Detail
+    {
+        template<size_t Size>
+        using Bits = std::conditional_t<Size == 1, uint8_t, std::conditional_t<Size == 2, uint16_t, std::conditional_t<Size == 4, uint32_t, uint64_t>>>;
+
+        template<typename Pointer>
+        struct MemberType;
+
+        template<typename Class, typename Member>
+        struct MemberType<Member Class::*>
+        {
+            using Type = Member;
+        };
+
+        template<typename Tuple>
+        inline constexpr bool AllEncodable = false;
+
+        template<typename... Pointers>
+        inline constexpr bool AllEncodable<std::tuple<Pointers...>> = (Encodable<typename MemberType<Pointers>::Type> && ...);
+
+        template<typename T>
+        concept GeneratedStruct = requires { Fields<T>::Members; } && AllEncodable<std::remove_cvref_t<decltype(Fields<T>::Members)>>;
+
+        template<typename T>
+        concept Scalar = (std::is_arithmetic_v<T> || std::is_enum_v<T>) && !std::is_same_v<T, bool> && std::has_single_bit(sizeof(T)) && sizeof(T) <= sizeof(uint64_t);
+
+        template<typename T>
+        concept Generated = requires { typename T::Type; } && std::is_base_of_v<DataLayer::Detail::BaseType<typename T::Type>, T>;
+
+        template<typename T>
+        concept Quantized = Generated<T> && requires {
+            { T::Quantization } -> std::convertible_to<Quantization>;
+        };
+
+        template<typename T>
+        concept Alias = Generated<T> && !Quantized<T>;
+    }// namespace Detail
+
+    template<Detail::Scalar T>
+    struct Codec<T>
+    {
+        static_assert(!std::is_floating_point_v<T> || std::numeric_limits<T>::is_iec559, "wire format requires IEEE 754 floating point");
+        using Bits = Detail::Bits<sizeof(T)>;
+
+        static constexpr size_t Size = sizeof(T);
+        static constexpr bool Native = std::endian::native == std::endian::little;
+
+        static void encode(const T &value, std::byte *output) noexcept
+        {
+            auto bits = std::bit_cast<Bits>(value);
+            if constexpr (!Native)
+            {
+                bits = std::byteswap(bits);
+            }
+            std::memcpy(output, &bits, Size);
+        }
+
+        [[nodiscard]] static T decode(const std::byte *input) noexcept
+        {
+            Bits bits{};
+            std::memcpy(&bits, input, Size);
+            if constexpr (!Native)
+            {
+                bits = std::byteswap(bits);
+            }
+            return std::bit_cast<T>(bits);
+        }
+    };
+
+    // one byte, any non-zero value decodes to true
+    template<>
+    struct Codec<bool>
+    {
+        static constexpr size_t Size = 1;
+        static constexpr bool Native = false;
+
+        static void encode(const bool &value, std::byte *output) noexcept
+        {
+            *output = std::byte{ value ? uint8_t{ 1 } : uint8_t{ 0 } };
+        }
+
+        [[nodiscard]] static bool decode(const std::byte *input) noexcept
+        {
+            return *input != std::byte{ 0 };
+        }
+    };
+
+    template<Detail::Alias T>
+        requires Encodable<typename T::Type>
+    struct Codec<T>
+    {
+        using Underlying = Codec<typename T::Type>;
+
+        static constexpr size_t Size = Underlying::Size;
+        static constexpr bool Native = Underlying::Native && sizeof(T) == Size;
+
+        static void encode(const T &value, std::byte *output) noexcept
+        {
+            Underlying::encode(value.value, output);
+        }
+
+        [[nodiscard]] static T decode(const std::byte *input) noexcept
+        {
+            return T{ Underlying::decode(input) };
+        }
+    };
+
+    // the raw value is clamped to its bits and rounded to the nearest step
+    template<Detail::Quantized T>
+    struct Codec<T>
+    {
+        using Type = typename T::Type;
+        static constexpr Quantization Parameters = T::Quantization;
+        static_assert(Parameters.bits > 0 && Parameters.bits <= 32 && Parameters.scale > 0.0, "invalid quantization");
+
+        static constexpr uint8_t Bits = Parameters.bits;
+        static constexpr size_t Size = (Bits + 7U) / 8U;
+        static constexpr bool Native = false;
+        static constexpr uint32_t MaximumRaw = static_cast<uint32_t>((uint64_t{ 1 } << Bits) - 1U);
+
+        [[nodiscard]] static constexpr uint32_t quantize(const T &value) noexcept
+        {
+            const double scaled = (static_cast<double>(value()) - Parameters.offset) / Parameters.scale;
+            if (!(scaled > 0.0))
+            {
+                return 0;
+            }
+            if (scaled >= static_cast<double>(MaximumRaw))
+            {
+                return MaximumRaw;
+            }
+            return static_cast<uint32_t>(scaled + 0.5);
+        }
+
+        [[nodiscard]] static constexpr T dequantize(uint32_t raw) noexcept
+        {
+            const double value = static_cast<double>(raw & MaximumRaw) * Parameters.scale + Parameters.offset;
+            if constexpr (std::is_integral_v<Type>)
+            {
+                return T{ static_cast<Type>(value < 0.0 ? value - 0.5 : value + 0.5) };
+            }
+            else
+            {
+                return T{ static_cast<Type>(value) };
+            }
+        }
+
+        static void encode(const T &value, std::byte *output) noexcept
+        {
+            const auto raw = quantize(value);
+            for (size_t index = 0; index < Size; ++index)
+            {
+                output[index] = static_cast<std::byte>(raw >> (index * 8U));
+            }
+        }
+
+        [[nodiscard]] static T decode(const std::byte *input) noexcept
+        {
+            uint32_t raw = 0;
+            for (size_t index = 0; index < Size; ++index)
+            {
+                raw |= std::to_integer<uint32_t>(input[index]) << (index * 8U);
+            }
+            return dequantize(raw);
+        }
+    };
+
+    template<Encodable T, size_t N>
+    struct Codec<std::array<T, N>>
+    {
+        static constexpr size_t Size = N * Codec<T>::Size;
+        static constexpr bool Native = Codec<T>::Native && sizeof(std::array<T, N>) == Size;
+
+        static void encode(const std::array<T, N> &value, std::byte *output) noexcept
+        {
+            if constexpr (Native)
+            {
+                std::memcpy(output, value.data(), Size);
+            }
+            else
+            {
+                for (const auto &element : value)
+                {
+                    Codec<T>::encode(element, output);
+                    output += Codec<T>::Size;
+                }
+            }
+        }
+
+        [[nodiscard]] static std::array<T, N> decode(const std::byte *input) noexcept
+        {
+            std::array<T, N> value{};
+            if constexpr (Native)
+            {
+                std::memcpy(value.data(), input, Size);
+            }
+            else
+            {
+                for (auto &element : value)
+                {
+                    element = Codec<T>::decode(input);
+                    input += Codec<T>::Size;
+                }
+            }
+            return value;
+        }
+    };
+
+    // Members are packed in declaration order. Without padding and with native members the packed
+    // layout equals the object representation.
+    template<Detail::GeneratedStruct T>
+    struct Codec<T>
+    {
+        static constexpr auto Members = Fields<T>::Members;
+
+        template<typename Pointer>
+        using MemberCodec = Codec<typename Detail::MemberType<Pointer>::Type>;
+
+        static constexpr size_t Size = std::apply([](auto... members) { return (MemberCodec<decltype(members)>::Size + ... + 0U); }, Members);
+        static constexpr bool Native = sizeof(T) == Size && std::apply([](auto... members) { return (MemberCodec<decltype(members)>::Native && ...); }, Members);
+
+        static void encode(const T &value, std::byte *output) noexcept
+        {
+            if constexpr (Native)
+            {
+                std::memcpy(output, &value, Size);
+            }
+            else
+            {
+                std::apply(
+                  [&](auto... members) {
+                      ((MemberCodec<decltype(members)>::encode(value.*members, output), output += MemberCodec<decltype(members)>::Size), ...);
+                  },
+                  Members);
+            }
+        }
+
+        [[nodiscard]] static T decode(const std::byte *input) noexcept
+        {
+            T value{};
+            if constexpr (Native)
+            {
+                std::memcpy(&value, input, Size);
+            }
+            else
+            {
+                std::apply(
+                  [&](auto... members) {
+                      ((value.*members = MemberCodec<decltype(members)>::decode(input), input += MemberCodec<decltype(members)>::Size), ...);
+                  },
+                  Members);
+            }
+            return value;
+        }
+    };
+
+    // payload size on the wire, packed for encodable types and the object size for everything else
+    template<typename T>
+    inline constexpr size_t PayloadSize = [] {
+        if constexpr (Encodable<T>)
+        {
+            return Codec<T>::Size;
+        }
+        else
+        {
+            return sizeof(T);
+        }
+    }();
+
+    template<typename DataPoint>
+    using ValueOf = std::remove_cvref_t<decltype(std::declval<DataPoint &>()())>;
+
+    // largest payload of a value, the capacity of a variable size value and FixedSize for everything else
+    template<typename T, size_t FixedSize = PayloadSize<T>>
+    inline constexpr size_t MaximumPayload = [] {
+        if constexpr (VariableSize<T>)
+        {
+            return T::capacity();
+        }
+        else
+        {
+            return FixedSize;
+        }
+    }();
+
+    // little endian 16 bit field of a message header or record
+    inline void store(std::byte *output, uint16_t value) noexcept
+    {
+        output[0] = static_cast<std::byte>(value & 0xFFU);
+        output[1] = static_cast<std::byte>(value >> 8U);
+    }
+
+    [[nodiscard]] inline uint16_t load(const std::byte *input) noexcept
+    {
+        return static_cast<uint16_t>(std::to_integer<uint16_t>(input[0]) | (std::to_integer<uint16_t>(input[1]) << 8U));
+    }
+
+    template<typename T>
+    void encode(const T &value, std::span<std::byte, PayloadSize<T>> output) noexcept
+    {
+        if constexpr (Encodable<T>)
+        {
+            Codec<T>::encode(value, output.data());
+        }
+        else
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "wire transport requires an encodable or trivially copyable value");
+            std::memcpy(output.data(), &value, sizeof(T));
+        }
+    }
+
+    template<typename T>
+    [[nodiscard]] T decode(std::span<const std::byte, PayloadSize<T>> input) noexcept
+    {
+        if constexpr (Encodable<T>)
+        {
+            return Codec<T>::decode(input.data());
+        }
+        else
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "wire transport requires an encodable or trivially copyable value");
+            T value{};
+            std::memcpy(&value, input.data(), sizeof(T));
+            return value;
+        }
+    }
+}// namespace DataLayer::Wire
@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#ifdef USE_TRACE
+#include <traceRecorder.h>
+#endif
+#ifdef USE_SHARED_MEMORY
+#include <sharedMemory.h>
+#endif
+#ifdef USE_REPLICATION
+#include <replication.h>
+#endif
+
+namespace DataLayer::Detail
+{
+    // hands a successful write to the hooks the build enables
+    inline void notifyWrite([[maybe_unused]] uint16_t dataPointId, [[maybe_unused]] std::span<const std::byte> value) noexcept
+    {
+#ifdef USE_TRACE
+        Trace::record(dataPointId, value);
+#endif
+#ifdef USE_SHARED_MEMORY
+        Shared::publish(dataPointId, value);
+#endif
+#ifdef USE_REPLICATION
+        Replication::record(dataPointId, value);
+#endif
+    }
+}// namespace DataLayer::Detail
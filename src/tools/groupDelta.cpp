@@ -0,0 +1,81 @@
+// Computes and applies binary deltas between two group images written by serializeGroup.
+//
+//   DataLayerGroupDelta diff <base> <target> <delta>
+//   DataLayerGroupDelta apply <image> <delta>
+#include <cstdio>
+#include <filesystem>
+#include <groupDelta.h>
+#include <span>
+#include <string_view>
+
+namespace
+{
+    constexpr std::string_view errorName(SerializationError error) noexcept
+    {
+        switch (error)
+        {
+            case SerializationError::None:
+                return "none";
+            case SerializationError::GroupVersion:
+            case SerializationError::DatapointVersion:
+            case SerializationError::GroupAndDatapointVersion:
+                return "version mismatch";
+            case SerializationError::InvalidFormat:
+                return "invalid format";
+            case SerializationError::ChecksumMismatch:
+                return "checksum mismatch";
+            case SerializationError::GroupIdMismatch:
+                return "group id mismatch";
+            case SerializationError::StorageFailure:
+                return "storage failure";
+        }
+        return "unknown";
+    }
+
+    int usage()
+    {
+        std::fputs("usage: DataLayerGroupDelta diff <base> <target> <delta>\n"
+                   "       DataLayerGroupDelta apply <image> <delta>\n",
+                   stderr);
+        return 2;
+    }
+}// namespace
+
+int main(int argc, char **argv)
+{
+    const std::span arguments{ argv, static_cast<size_t>(argc) };
+    if (arguments.size() < 2)
+    {
+        return usage();
+    }
+
+    const std::string_view command{ arguments[1] };
+    SerializationStatus status{};
+    if (command == "diff" && arguments.size() == 5)
+    {
+        status = DataLayer::Persistence::makeDelta(std::filesystem::path{ arguments[2] }, std::filesystem::path{ arguments[3] }, std::filesystem::path{ arguments[4] });
+        if (status.result)
+        {
+            std::printf("delta written: %zu bytes\n", status.size);
+        }
+    }
+    else if (command == "apply" && arguments.size() == 4)
+    {
+        status = DataLayer::Persistence::applyDelta(std::filesystem::path{ arguments[2] }, std::filesystem::path{ arguments[3] });
+        if (status.result)
+        {
+            std::printf("image updated: %zu bytes\n", status.size);
+        }
+    }
+    else
+    {
+        return usage();
+    }
+
+    if (!status.result)
+    {
+        std::fprintf(stderr, "%.*s failed: %.*s\n", static_cast<int>(command.size()), command.data(), static_cast<int>(errorName(status.errorCode).size()), errorName(status.errorCode).data());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,187 @@
+// Load test of the datapoint socket server against the example model. Without --unix or --udp a server
+// is started in process on a temporary Unix socket.
+//
+//   DataLayerSocketLoad [--unix <path> | --udp <port>] [--clients N] [--batch N] [--requests N] [--write]
+//
+// Every client sends batches of reads (or writes of test3) and waits for each answer, the report lists
+// requests per second and latency percentiles over all clients.
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <include/datalayer.h>
+#include <socketServer.h>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+    struct Options
+    {
+        std::string path{};
+        uint16_t port{ 0 };
+        size_t clients{ 1 };
+        size_t batch{ 8 };
+        size_t requests{ 20000 };
+        bool write{ false };
+    };
+
+    struct Result
+    {
+        std::vector<uint64_t> latencies{};
+        size_t failed{ 0 };
+    };
+
+    int usage()
+    {
+        std::fputs("usage: DataLayerSocketLoad [--unix <path> | --udp <port>] [--clients N] [--batch N] [--requests N] [--write]\n", stderr);
+        return 2;
+    }
+
+    bool parse(std::span<char *> arguments, Options &options)
+    {
+        for (size_t index = 1; index < arguments.size(); ++index)
+        {
+            const std::string_view argument{ arguments[index] };
+            if (argument == "--write")
+            {
+                options.write = true;
+                continue;
+            }
+            if (index + 1 == arguments.size())
+            {
+                return false;
+            }
+            const char *value = arguments[++index];
+            if (argument == "--unix")
+            {
+                options.path = value;
+            }
+            else if (argument == "--udp")
+            {
+                options.port = static_cast<uint16_t>(std::strtoul(value, nullptr, 10));
+            }
+            else if (argument == "--clients")
+            {
+                options.clients = std::max<size_t>(1, std::strtoul(value, nullptr, 10));
+            }
+            else if (argument == "--batch")
+            {
+                options.batch = std::max<size_t>(1, std::strtoul(value, nullptr, 10));
+            }
+            else if (argument == "--requests")
+            {
+                options.requests = std::strtoul(value, nullptr, 10);
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void load(const Options &options, Result &result)
+    {
+        DataLayer::Server::Client client;
+        if (options.port != 0 ? !client.connectUdp(options.port) : !client.connectUnix(options.path))
+        {
+            result.failed = options.requests;
+            return;
+        }
+        constexpr std::array<uint16_t, 5> Readable{ test3.getId(), test4.getId(), errorCode.getId(), Testify::arrayTest2.getId(), structInStructType.getId() };
+        std::array<std::byte, 4096> request{};
+        std::array<std::byte, 4096> response{};
+        result.latencies.reserve(options.requests);
+        for (size_t sequence = 0; sequence < options.requests; ++sequence)
+        {
+            DataLayer::Protocol::Request builder{ request, options.write ? DataLayer::Protocol::Operation::write : DataLayer::Protocol::Operation::read, static_cast<uint16_t>(sequence) };
+            for (size_t item = 0; item < options.batch; ++item)
+            {
+                std::ignore = options.write ? builder.write(test3.getId(), static_cast<int32_t>(sequence + item)) : builder.read(Readable[item % Readable.size()]);
+            }
+            const auto start = std::chrono::steady_clock::now();
+            const auto size = client.request(builder.message(), response);
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+            if (size == 0)
+            {
+                ++result.failed;
+                continue;
+            }
+            result.latencies.push_back(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+    }
+
+    double percentile(const std::vector<uint64_t> &sorted, double fraction)
+    {
+        if (sorted.empty())
+        {
+            return 0.0;
+        }
+        const auto index = std::min(sorted.size() - 1, static_cast<size_t>(fraction * static_cast<double>(sorted.size())));
+        return static_cast<double>(sorted[index]) / 1000.0;
+    }
+}// namespace
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if (!parse(std::span{ argv, static_cast<size_t>(argc) }, options))
+    {
+        return usage();
+    }
+
+    DataLayer::Server::Server<std::remove_cvref_t<decltype(ProtocolTable::Table)>> server{ ProtocolTable::Table };
+    std::thread serverThread;
+    if (options.path.empty() && options.port == 0)
+    {
+        options.path = "/tmp/DataLayerSocketLoad." + std::to_string(::getpid());
+        if (!server.bindUnix(options.path))
+        {
+            std::fprintf(stderr, "cannot bind %s\n", options.path.c_str());
+            return 1;
+        }
+        serverThread = std::thread{ [&server] { server.run(); } };
+    }
+
+    std::vector<Result> results(options.clients);
+    std::vector<std::thread> clients;
+    const auto start = std::chrono::steady_clock::now();
+    for (auto &result : results)
+    {
+        clients.emplace_back([&options, &result] { load(options, result); });
+    }
+    for (auto &client : clients)
+    {
+        client.join();
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    if (serverThread.joinable())
+    {
+        server.stop();
+        serverThread.join();
+    }
+
+    std::vector<uint64_t> latencies;
+    size_t failed = 0;
+    for (const auto &result : results)
+    {
+        latencies.insert(latencies.end(), result.latencies.begin(), result.latencies.end());
+        failed += result.failed;
+    }
+    std::ranges::sort(latencies);
+    const auto answered = static_cast<double>(latencies.size());
+    std::printf("%zu clients, batch %zu, %s: %.0f req/s, %.0f items/s\n", options.clients, options.batch, options.write ? "write" : "read", answered / elapsed.count(),
+      answered * static_cast<double>(options.batch) / elapsed.count());
+    std::printf("latency us: p50 %.1f, p99 %.1f, p99.9 %.1f, max %.1f\n", percentile(latencies, 0.5), percentile(latencies, 0.99), percentile(latencies, 0.999),
+      latencies.empty() ? 0.0 : static_cast<double>(latencies.back()) / 1000.0);
+    std::printf("failed %zu\n", failed);
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,77 @@
+// Lists or replays a datapoint trace written by DataLayer::Trace::FileWriter against the example model.
+//
+//   DataLayerTraceReplay dump <trace> [from]
+//   DataLayerTraceReplay replay <trace> [speed]
+//
+// from is a timestamp in nanoseconds found through the block index, speed 0 replays without delays.
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <include/datalayer.h>
+#include <span>
+#include <string_view>
+#include <traceFile.h>
+
+namespace
+{
+    int usage()
+    {
+        std::fputs("usage: DataLayerTraceReplay dump <trace> [from]\n"
+                   "       DataLayerTraceReplay replay <trace> [speed]\n",
+                   stderr);
+        return 2;
+    }
+
+    void dump(DataLayer::Trace::Reader &reader)
+    {
+        DataLayer::Trace::Record record{};
+        while (reader.next(record))
+        {
+            std::printf("%llu %u %zu%s", static_cast<unsigned long long>(record.timestamp), record.dataPointId, record.payload.size(), record.truncated ? " truncated" : "");
+            for (const auto byte : record.payload)
+            {
+                std::printf(" %02x", std::to_integer<unsigned>(byte));
+            }
+            std::fputc('\n', stdout);
+        }
+    }
+}// namespace
+
+int main(int argc, char **argv)
+{
+    const std::span arguments{ argv, static_cast<size_t>(argc) };
+    if (arguments.size() < 3 || arguments.size() > 4)
+    {
+        return usage();
+    }
+
+    const std::string_view command{ arguments[1] };
+    DataLayer::Trace::Reader reader{ std::filesystem::path{ arguments[2] } };
+    if (!reader.isOpen())
+    {
+        std::fprintf(stderr, "%s is not a trace file\n", arguments[2]);
+        return 1;
+    }
+
+    if (command == "dump")
+    {
+        if (arguments.size() == 4)
+        {
+            reader.seek(std::strtoull(arguments[3], nullptr, 10));
+        }
+        dump(reader);
+    }
+    else if (command == "replay")
+    {
+        const double speed = arguments.size() == 4 ? std::strtod(arguments[3], nullptr) : 1.0;
+        const auto status = DataLayer::Trace::replay(Dispatcher, reader, speed);
+        std::printf("applied %llu, rejected %llu\n", static_cast<unsigned long long>(status.applied), static_cast<unsigned long long>(status.rejected));
+    }
+    else
+    {
+        return usage();
+    }
+
+    std::printf("blocks %zu%s, corrupt %zu, dropped %llu\n", reader.blocks().size(), reader.indexed() ? "" : " (no index)", reader.corruptBlocks(), static_cast<unsigned long long>(reader.dropped()));
+    return reader.corruptBlocks() == 0 ? 0 : 1;
+}
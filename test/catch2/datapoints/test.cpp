@@ -1,7 +1,15 @@
+#include <canAdapter.h>
+#include <canLoopback.h>
+#include <canTransmitQueue.h>
 #include <catch2/catch_all.hpp>
 #include <catch2/matchers/catch_matchers_floating_point.hpp>
 #include <filesystem>
 #include <fstream>
+#include <numeric>
+#include <rttDecoder.h>
+#include <rttEmitter.h>
+#include <rttSharedMemory.h>
+#include <thread>
 #include <include/datalayer.h>
 
 namespace DataLayer::Migration
@@ -47,7 +55,7 @@ namespace
     {
         DataLayer::Persistence::Header header{};
         std::memcpy(&header, bytes.data(), sizeof(header));
-        header.checksum = DataLayer::Persistence::crc32(std::span<const std::byte>{ bytes }.subspan(sizeof(header)));
+        header.checksum = DataLayer::Persistence::checksum(header.checksumAlgorithm, std::span<const std::byte>{ bytes }.subspan(sizeof(header)));
         std::memcpy(bytes.data(), &header, sizeof(header));
     }
 
@@ -79,7 +87,7 @@ namespace
         DataLayer::Persistence::append(records, record);
         records.insert(records.end(), payload.begin(), payload.end());
 
-        DataLayer::Persistence::Header header{ .groupId = groupId, .groupVersion = groupVersion, .checksum = DataLayer::Persistence::crc32(records) };
+        DataLayer::Persistence::Header header{ .groupId = groupId, .groupVersion = groupVersion, .checksum = DataLayer::Persistence::crc32c(records) };
         ByteBuffer file;
         DataLayer::Persistence::append(file, header);
         file.insert(file.end(), records.begin(), records.end());
@@ -95,6 +103,57 @@ namespace
     {
         return (lhs.raw == rhs.raw) && (static_cast<double>(std::fabs(lhs.value - rhs.value)) <= EPSILON);
     }
+
+    using CanBus = DataLayer::Can::LoopbackBus<64>;
+
+    // delivers queued frames of both ends until the buses are idle, returns the last result of each end
+    template<typename T, typename Adapter>
+    std::pair<DataLayer::Can::Result, DataLayer::Can::Result> exchange(CanBus &busA, Adapter &nodeA, CanBus &busB, Adapter &nodeB)
+    {
+        std::pair results{ DataLayer::Can::Result::pending, DataLayer::Can::Result::pending };
+        DataLayer::Can::Frame frame{};
+        while (busA.pending() != 0 || busB.pending() != 0)
+        {
+            while (busB.receive(frame))
+            {
+                results.second = nodeB.template applySet<T>(frame);
+            }
+            while (busA.receive(frame))
+            {
+                results.first = nodeA.template applySet<T>(frame);
+            }
+        }
+        return results;
+    }
+    struct RttFrame
+    {
+        uint8_t flags{};
+        uint16_t dataPointId{};
+        std::vector<std::byte> payload{};
+    };
+
+    // drains the channel and splits the stream like the generated rtt.py
+    template<size_t Capacity>
+    std::vector<RttFrame> readFrames(DataLayer::Rtt::Channel<Capacity> &channel)
+    {
+        std::vector<std::byte> stream(channel.pending());
+        stream.resize(channel.read(stream));
+        std::vector<RttFrame> frames;
+        for (size_t offset = 0; offset + DataLayer::Rtt::HeaderSize <= stream.size();)
+        {
+            REQUIRE(stream[offset] == std::byte{ 'D' });
+            REQUIRE(stream[offset + 1] == std::byte{ 'L' });
+            REQUIRE(std::to_integer<uint8_t>(stream[offset + 2]) == DataLayer::Rtt::ProtocolVersion);
+            const auto size = static_cast<size_t>(std::to_integer<uint16_t>(stream[offset + 6]) | (std::to_integer<uint16_t>(stream[offset + 7]) << 8U));
+            REQUIRE(offset + DataLayer::Rtt::HeaderSize + size <= stream.size());
+            const auto payload = stream.begin() + static_cast<ptrdiff_t>(offset + DataLayer::Rtt::HeaderSize);
+            frames.push_back({ .flags = std::to_integer<uint8_t>(stream[offset + 3]),
+              .dataPointId = static_cast<uint16_t>(std::to_integer<uint16_t>(stream[offset + 4]) | (std::to_integer<uint16_t>(stream[offset + 5]) << 8U)),
+              .payload = { payload, payload + static_cast<ptrdiff_t>(size) } });
+            offset += DataLayer::Rtt::HeaderSize + size;
+        }
+        return frames;
+    }
 }// namespace
 
 TEST_CASE("Test datapoints")
@@ -858,7 +917,7 @@ TEST_CASE("Test datapoints")
         constexpr Temperature newValue{ .raw = 7777, .value = 77.7F };
         const auto [success, check] = Dispatcher.setDatapoint(test.getId(), newValue);
         REQUIRE(success);
-        REQUIRE(check == DataLayer::Detail::RangeCheck::notChecked);
+        REQUIRE(check == DataLayer::Detail::RangeCheck::ok);
         REQUIRE(test().raw == newValue.raw);
     }
 
@@ -908,3 +967,1177 @@ TEST_CASE("Test datapoints")
     arrayTest2 = initialArrayTest2;
     structInStructType = initialStructInStructType;
 }
+
+TEST_CASE("Test wire codec", "[Wire]")
+{
+    enum class Direction : uint16_t
+    {
+        up = 0x0102,
+        down = 0x0304
+    };
+
+    SECTION("padding is removed and multi-byte members are little endian")
+    {
+        STATIC_REQUIRE(sizeof(Sample) == 8);
+        STATIC_REQUIRE(DataLayer::Wire::Codec<Sample>::Size == 7);
+        STATIC_REQUIRE_FALSE(DataLayer::Wire::Codec<Sample>::Native);
+
+        std::array<std::byte, 7> bytes{};
+        DataLayer::Wire::encode(Sample{ .flag = true, .level = 0x0A0B, .value = 0x01020304 }, std::span{ bytes });
+        const std::array expected{ std::byte{ 0x01 }, std::byte{ 0x0B }, std::byte{ 0x0A }, std::byte{ 0x04 }, std::byte{ 0x03 }, std::byte{ 0x02 }, std::byte{ 0x01 } };
+        REQUIRE(bytes == expected);
+
+        bytes[0] = std::byte{ 0x7F };
+        const auto decoded = DataLayer::Wire::decode<Sample>(std::span<const std::byte, 7>{ bytes });
+        REQUIRE(decoded.flag);
+        REQUIRE(decoded.level == 0x0A0B);
+        REQUIRE(decoded.value == 0x01020304U);
+    }
+
+    SECTION("host layout that matches the wire format uses the memcpy fast path")
+    {
+        constexpr bool LittleEndian = std::endian::native == std::endian::little;
+        STATIC_REQUIRE(DataLayer::Wire::Codec<Temperature>::Size == sizeof(Temperature));
+        STATIC_REQUIRE(DataLayer::Wire::Codec<Temperature>::Native == LittleEndian);
+        STATIC_REQUIRE(DataLayer::Wire::Codec<Environment>::Native == LittleEndian);
+        STATIC_REQUIRE(DataLayer::Wire::Codec<std::array<Temperature, 10>>::Native == LittleEndian);
+        STATIC_REQUIRE(DataLayer::Wire::Codec<RangeAlias>::Size == sizeof(uint32_t));
+
+        const Environment environment{ .external = { .raw = 1, .value = 2.5F }, .internal = { .raw = 3, .value = -4.0F } };
+        std::array<std::byte, sizeof(Environment)> bytes{};
+        DataLayer::Wire::encode(environment, std::span{ bytes });
+        const auto decoded = DataLayer::Wire::decode<Environment>(std::span<const std::byte, sizeof(Environment)>{ bytes });
+        REQUIRE(decoded.external.raw == 1U);
+        REQUIRE(decoded.external.value == 2.5F);
+        REQUIRE(decoded.internal.raw == 3U);
+        REQUIRE(decoded.internal.value == -4.0F);
+    }
+
+    SECTION("enums, floating point and aliases use their underlying representation")
+    {
+        std::array<std::byte, 2> direction{};
+        DataLayer::Wire::encode(Direction::down, std::span{ direction });
+        REQUIRE(direction == std::array{ std::byte{ 0x04 }, std::byte{ 0x03 } });
+        REQUIRE(DataLayer::Wire::decode<Direction>(std::span<const std::byte, 2>{ direction }) == Direction::down);
+
+        std::array<std::byte, 4> number{};
+        DataLayer::Wire::encode(1.0F, std::span{ number });
+        REQUIRE(number == std::array{ std::byte{ 0x00 }, std::byte{ 0x00 }, std::byte{ 0x80 }, std::byte{ 0x3F } });
+
+        DataLayer::Wire::encode(RangeAlias{ 0x11223344U }, std::span{ number });
+        REQUIRE(DataLayer::Wire::decode<RangeAlias>(std::span<const std::byte, 4>{ number }).value == 0x11223344U);
+    }
+}
+
+TEST_CASE("Test quantized types", "[Wire]")
+{
+    using Temperature12 = DataLayer::Wire::Codec<CoolantTemperature>;
+    using Current10 = DataLayer::Wire::Codec<BatteryCurrent>;
+    const auto initialTemperature = coolantTemperature();
+    const auto initialCurrent = batteryCurrent();
+
+    SECTION("range is derived from scale, offset and bits")
+    {
+        STATIC_REQUIRE(Temperature12::Size == 2);
+        STATIC_REQUIRE(Temperature12::MaximumRaw == 4095U);
+        STATIC_REQUIRE(Current10::Size == 2);
+        STATIC_REQUIRE(DataLayer::Wire::PayloadSize<CoolantTemperature> == 2);
+        STATIC_REQUIRE(CoolantTemperature::Minimum == -40.0F);
+        STATIC_REQUIRE(CoolantTemperature::Maximum == 369.5F);
+        REQUIRE(coolantTemperature().value == 21.5F);
+        REQUIRE(coolantTemperature.set(CoolantTemperature{ 400.0F }) == DataLayer::Detail::RangeCheck::overflow);
+    }
+
+    SECTION("values are rounded to the nearest step and clamped to the raw range")
+    {
+        STATIC_REQUIRE(Temperature12::quantize(CoolantTemperature{ 21.5F }) == 615U);
+        STATIC_REQUIRE(Temperature12::quantize(CoolantTemperature{ -50.0F }) == 0U);
+        STATIC_REQUIRE(Temperature12::quantize(CoolantTemperature{ 1000.0F }) == 4095U);
+        STATIC_REQUIRE(Current10::quantize(BatteryCurrent{ -499 }) == 251U);
+        STATIC_REQUIRE(Current10::dequantize(251U).value == -498);
+        REQUIRE_THAT(Temperature12::dequantize(615U).value, Catch::Matchers::WithinAbs(21.5, 0.05));
+
+        std::array<std::byte, 2> bytes{};
+        DataLayer::Wire::encode(CoolantTemperature{ 21.5F }, std::span{ bytes });
+        REQUIRE(bytes == std::array{ std::byte{ 0x67 }, std::byte{ 0x02 } });
+        const auto decoded = DataLayer::Wire::decode<CoolantTemperature>(std::span<const std::byte, 2>{ bytes });
+        REQUIRE_THAT(decoded.value, Catch::Matchers::WithinAbs(21.5, 0.05));
+    }
+
+    SECTION("records hold the raw value and images with the full value are still restored")
+    {
+        std::ignore = coolantTemperature.set(CoolantTemperature{ 87.3F });
+        std::ignore = batteryCurrent.set(BatteryCurrent{ -120 });
+        std::tuple<decltype(coolantTemperature) &, decltype(batteryCurrent) &> quantized{ coolantTemperature, batteryCurrent };
+        std::vector<std::byte> image;
+        REQUIRE(Serialization(SecondGroup.group.version, SecondGroup.group.baseId, quantized).encode(image).result);
+        REQUIRE(image.size() == sizeof(DataLayer::Persistence::Header) + 2U * (sizeof(DataLayer::Persistence::RecordHeader) + 2U));
+
+        coolantTemperature = CoolantTemperature{ 0.0F };
+        batteryCurrent = BatteryCurrent{ 0 };
+        REQUIRE(SecondGroup.decodeGroup(image).result);
+        REQUIRE_THAT(coolantTemperature().value, Catch::Matchers::WithinAbs(87.3, 0.05));
+        REQUIRE(batteryCurrent().value == -120);
+
+        std::vector<std::byte> records;
+        const CoolantTemperature full{ 55.55F };
+        DataLayer::Persistence::append(
+          records, DataLayer::Persistence::RecordHeader{ .dataPointId = coolantTemperature.getId(), .version = coolantTemperature.getVersion(), .payloadSize = sizeof(full) });
+        DataLayer::Persistence::append(records, full);
+        image.clear();
+        DataLayer::Persistence::append(
+          image, DataLayer::Persistence::Header{ .groupId = SecondGroup.group.baseId, .groupVersion = SecondGroup.group.version, .checksum = DataLayer::Persistence::crc32c(records) });
+        image.insert(image.end(), records.begin(), records.end());
+        REQUIRE(SecondGroup.decodeGroup(image).result);
+        REQUIRE(coolantTemperature().value == 55.55F);
+    }
+
+    coolantTemperature = initialTemperature;
+    batteryCurrent = initialCurrent;
+}
+
+TEST_CASE("Wire codec benchmarks", "[.][benchmark]")
+{
+    std::array<Sample, 64> samples{};
+    std::array<Environment, 64> environments{};
+    for (uint16_t index = 0; index < samples.size(); ++index)
+    {
+        samples[index] = { .flag = (index & 1U) != 0U, .level = index, .value = index * 1000U };
+        environments[index] = { .external = { .raw = index, .value = 1.5F }, .internal = { .raw = index, .value = 2.5F } };
+    }
+    std::array<std::byte, sizeof(environments)> buffer{};
+
+    BENCHMARK("memcpy 64 Environment")
+    {
+        std::memcpy(buffer.data(), environments.data(), sizeof(environments));
+        return buffer[5];
+    };
+
+    BENCHMARK("encode 64 Environment (native)")
+    {
+        DataLayer::Wire::encode(environments, std::span{ buffer }.first<DataLayer::Wire::PayloadSize<decltype(environments)>>());
+        return buffer[5];
+    };
+
+    BENCHMARK("encode 64 Sample (packed)")
+    {
+        DataLayer::Wire::encode(samples, std::span{ buffer }.first<DataLayer::Wire::PayloadSize<decltype(samples)>>());
+        return buffer[5];
+    };
+
+    BENCHMARK("decode 64 Sample (packed)")
+    {
+        return DataLayer::Wire::decode<decltype(samples)>(std::span<const std::byte>{ buffer }.first<DataLayer::Wire::PayloadSize<decltype(samples)>>())[7].value;
+    };
+}
+
+TEST_CASE("Test CAN segmentation", "[Can]")
+{
+    using Result = DataLayer::Can::Result;
+    using Status = DataLayer::Can::IsoTp::Status;
+    using Array = std::array<int32_t, 10>;
+
+    CanBus busA;
+    CanBus busB;
+    busA.connect(busB);
+    const auto initialArray = arrayTest2();
+
+    SECTION("values larger than a classic frame are segmented with flow control")
+    {
+        DataLayer::Can::Adapter<decltype(Dispatcher), 8, 128> nodeA{ busA, Dispatcher };
+        DataLayer::Can::Adapter<decltype(Dispatcher), 8, 128> nodeB{ busB, Dispatcher };
+        Array expected{};
+        std::iota(expected.begin(), expected.end(), -5);
+
+        REQUIRE(nodeA.publish(arrayTest2.getId(), expected) == Result::pending);
+        REQUIRE(busB.pending() == 1);
+        const auto [sender, receiver] = exchange<Array>(busA, nodeA, busB, nodeB);
+        REQUIRE(sender == Result::ok);
+        REQUIRE(receiver == Result::ok);
+        REQUIRE(arrayTest2() == expected);
+        // first frame, five consecutive frames and one flow control frame
+        REQUIRE(busA.sent() == 6);
+        REQUIRE(busB.sent() == 1);
+    }
+
+    SECTION("a read-only segmented publish passes the generated filters of its node")
+    {
+        DataLayer::Can::Adapter<decltype(Dispatcher), 8, 128> nodeA{ busA, Dispatcher };
+        DataLayer::Can::Adapter<decltype(Dispatcher), 8, 128> nodeB{ busB, Dispatcher };
+        const auto passes = [](const DataLayer::Can::Frame &frame) {
+            return DataLayer::Can::accepts(CanFilter::Filters, frame.identifier) && CanFilter::Accepted.contains(frame.identifier);
+        };
+        REQUIRE_FALSE(CanFilter::Accepted.contains(sampleHistory.getId()));
+        REQUIRE(CanFilter::Accepted.contains(DataLayer::Can::IsoTp::flowControlIdentifier(sampleHistory.getId())));
+        REQUIRE_FALSE(CanFilter::Accepted.contains(DataLayer::Can::IsoTp::flowControlIdentifier(test.getId())));
+
+        REQUIRE(nodeA.publish(sampleHistory.getId(), sampleHistory()) == Result::pending);
+        auto sender = Result::pending;
+        DataLayer::Can::Frame frame{};
+        while (busA.pending() != 0 || busB.pending() != 0)
+        {
+            while (busB.receive(frame))
+            {
+                // the read-only datapoint rejects the reassembled value on the peer
+                std::ignore = nodeB.applySet<Array>(frame);
+            }
+            while (busA.receive(frame))
+            {
+                if (passes(frame))
+                {
+                    sender = nodeA.applySet<Array>(frame);
+                }
+            }
+        }
+        REQUIRE(sender == Result::ok);
+        REQUIRE(busA.sent() == 6);
+    }
+
+    SECTION("values that fit a frame keep the unframed single frame format")
+    {
+        DataLayer::Can::Adapter<decltype(Dispatcher), 8, 128> node{ busA, Dispatcher };
+        REQUIRE(node.publish(test.getId(), Temperature{ .raw = 7, .value = 1.0F }) == Result::ok);
+        DataLayer::Can::Frame frame{};
+        REQUIRE(busB.receive(frame));
+        REQUIRE(frame.length == sizeof(Temperature));
+    }
+
+    SECTION("CAN FD frames carry the larger first and consecutive frames")
+    {
+        using Temperatures = std::array<Temperature, 10>;
+        DataLayer::Can::Adapter<decltype(Dispatcher), 64, 128> nodeA{ busA, Dispatcher };
+        DataLayer::Can::Adapter<decltype(Dispatcher), 64, 128> nodeB{ busB, Dispatcher };
+        const auto initial = arrayTest();
+        const auto expected = DataLayer::Detail::make_array<Temperature, 10>({ .raw = 42, .value = 4.5F });
+
+        REQUIRE(nodeA.publish(arrayTest.getId(), expected) == Result::pending);
+        const auto [sender, receiver] = exchange<Temperatures>(busA, nodeA, busB, nodeB);
+        REQUIRE(sender == Result::ok);
+        REQUIRE(receiver == Result::ok);
+        REQUIRE(std::ranges::all_of(arrayTest(), [](const Temperature &value) { return value.raw == 42 && value.value == 4.5F; }));
+        REQUIRE(busA.sent() == 2);
+        arrayTest = initial;
+    }
+
+    SECTION("a consecutive frame out of sequence aborts the message")
+    {
+        DataLayer::Can::Adapter<decltype(Dispatcher), 8, 128> nodeA{ busA, Dispatcher };
+        DataLayer::Can::Adapter<decltype(Dispatcher), 8, 128> nodeB{ busB, Dispatcher };
+        Array changed{};
+        changed.fill(99);
+        DataLayer::Can::Frame frame{};
+
+        REQUIRE(nodeA.publish(arrayTest2.getId(), changed) == Result::pending);
+        REQUIRE(busB.receive(frame));
+        REQUIRE(nodeB.applySet<Array>(frame) == Result::pending);
+        REQUIRE(busA.receive(frame));
+        REQUIRE(frame.identifier == DataLayer::Can::IsoTp::flowControlIdentifier(arrayTest2.getId()));
+        REQUIRE(nodeA.applySet<Array>(frame) == Result::ok);
+        REQUIRE(busB.receive(frame));
+        frame.payload[0] = DataLayer::Can::IsoTp::pci(DataLayer::Can::IsoTp::FrameType::consecutive, 2);
+        REQUIRE(nodeB.applySet<Array>(frame) == Result::invalidPayload);
+        while (busB.receive(frame))
+        {
+            REQUIRE(nodeB.applySet<Array>(frame) == Result::invalidPayload);
+        }
+        REQUIRE(arrayTest2() == initialArray);
+    }
+
+    SECTION("the receiver requests a new block after BlockSize consecutive frames")
+    {
+        DataLayer::Can::IsoTp::Sender<8, 64, 1> sender;
+        DataLayer::Can::IsoTp::Receiver<8, 64, 1, 2> receiver;
+        std::array<std::byte, 40> message{};
+        std::ranges::generate(message, [value = 0]() mutable { return static_cast<std::byte>(value++); });
+        DataLayer::Can::Frame frame{};
+
+        REQUIRE(sender.start(busA, 0x123, message, 0x124) == Status::pending);
+        DataLayer::Can::IsoTp::Outcome outcome{};
+        size_t flowControls = 0;
+        while (busB.receive(frame))
+        {
+            outcome = receiver.receive(busB, frame, 0x124);
+            while (busA.receive(frame))
+            {
+                ++flowControls;
+                REQUIRE(DataLayer::Can::IsoTp::typeOf(frame) == DataLayer::Can::IsoTp::FrameType::flowControl);
+                REQUIRE(frame.identifier == 0x124U);
+                std::ignore = sender.onFlowControl(busA, frame);
+            }
+        }
+        REQUIRE(outcome.status == Status::complete);
+        REQUIRE(std::ranges::equal(outcome.message, message));
+        REQUIRE(flowControls == 3);
+        REQUIRE(sender.activeSessions() == 0);
+    }
+
+    SECTION("messages above the receive capacity are refused with an overflow flow control")
+    {
+        DataLayer::Can::IsoTp::Sender<8, 64, 1> sender;
+        DataLayer::Can::IsoTp::Receiver<8, 32, 1> receiver;
+        const std::array<std::byte, 40> message{};
+        DataLayer::Can::Frame frame{};
+
+        REQUIRE(sender.start(busA, 0x10, message, 0x90) == Status::pending);
+        REQUIRE(sender.start(busA, 0x11, message, 0x91) == Status::busy);
+        REQUIRE(busB.receive(frame));
+        REQUIRE(receiver.receive(busB, frame, 0x90).status == Status::overflow);
+        REQUIRE(busA.receive(frame));
+        REQUIRE(sender.onFlowControl(busA, frame) == Status::overflow);
+        REQUIRE(sender.activeSessions() == 0);
+        REQUIRE(receiver.activeSessions() == 0);
+    }
+
+    SECTION("a send whose flow control is lost expires and frees its identifier")
+    {
+        DataLayer::Can::IsoTp::Sender<8, 64, 1> sender;
+        const std::array<std::byte, 40> message{};
+        DataLayer::Can::Frame frame{};
+
+        REQUIRE(sender.poll(5000) == 0);
+        REQUIRE(sender.start(busA, 0x20, message, 0xA0) == Status::pending);
+        REQUIRE(busB.receive(frame));
+        // the flow control frame never arrives
+        REQUIRE(sender.start(busA, 0x20, message, 0xA0) == Status::busy);
+        REQUIRE(sender.start(busA, 0x21, message, 0xA1) == Status::busy);
+        REQUIRE(sender.poll(5000 + DataLayer::Can::IsoTp::FlowControlTimeout - 1U) == 0);
+        REQUIRE(sender.activeSessions() == 1);
+        REQUIRE(sender.poll(5000 + DataLayer::Can::IsoTp::FlowControlTimeout) == 1);
+        REQUIRE(sender.activeSessions() == 0);
+        REQUIRE(sender.start(busA, 0x21, message, 0xA1) == Status::pending);
+        REQUIRE(busB.receive(frame));
+        REQUIRE(sender.abort(0x21));
+        REQUIRE_FALSE(sender.abort(0x21));
+        REQUIRE(sender.activeSessions() == 0);
+    }
+
+    SECTION("the adapter expires segmented publishes on poll")
+    {
+        DataLayer::Can::Adapter<decltype(Dispatcher), 8, 128> node{ busA, Dispatcher };
+        Array value{};
+        REQUIRE(node.poll(0) == 0);
+        REQUIRE(node.publish(arrayTest2.getId(), value) == Result::pending);
+        REQUIRE(node.publish(arrayTest2.getId(), value) == Result::busy);
+        REQUIRE(node.poll(DataLayer::Can::IsoTp::FlowControlTimeout) == 1);
+        REQUIRE(node.publish(arrayTest2.getId(), value) == Result::pending);
+    }
+
+    SECTION("a partial message whose consecutive frames are lost expires")
+    {
+        DataLayer::Can::IsoTp::Sender<8, 64, 1> sender;
+        DataLayer::Can::IsoTp::Receiver<8, 64, 1> receiver;
+        const std::array<std::byte, 40> message{};
+        DataLayer::Can::Frame frame{};
+
+        REQUIRE(receiver.poll(200) == 0);
+        REQUIRE(sender.start(busA, 0x22, message, 0xA2) == Status::pending);
+        REQUIRE(busB.receive(frame));
+        // the sender never gets the flow control frame, so no consecutive frame arrives
+        REQUIRE(receiver.receive(busB, frame, 0xA2).status == Status::pending);
+        REQUIRE(receiver.poll(200 + DataLayer::Can::IsoTp::ConsecutiveFrameTimeout - 1U) == 0);
+        REQUIRE(receiver.activeSessions() == 1);
+        REQUIRE(receiver.poll(200 + DataLayer::Can::IsoTp::ConsecutiveFrameTimeout) == 1);
+        REQUIRE(receiver.activeSessions() == 0);
+    }
+
+    SECTION("data and flow control frames of a transfer need different identifiers")
+    {
+        DataLayer::Can::IsoTp::Sender<8, 64, 1> sender;
+        DataLayer::Can::IsoTp::Receiver<8, 64, 1> receiver;
+        const std::array<std::byte, 40> message{};
+        DataLayer::Can::Frame frame{};
+
+        REQUIRE(sender.start(busA, 0x23, message, 0x23) == Status::invalid);
+        REQUIRE(sender.start(busA, 0x23, message, 0xA3) == Status::pending);
+        REQUIRE(sender.start(busA, 0x24, message, 0xA3) == Status::busy);
+        REQUIRE(busB.receive(frame));
+        REQUIRE(receiver.receive(busB, frame, frame.identifier).status == Status::invalid);
+        REQUIRE(receiver.activeSessions() == 0);
+    }
+
+    SECTION("the least recently used reassembly session is evicted when the pool is full")
+    {
+        DataLayer::Can::IsoTp::Sender<8, 64, 3> sender;
+        DataLayer::Can::IsoTp::Receiver<8, 64, 2> receiver;
+        std::array<std::byte, 20> message{};
+        message.fill(std::byte{ 0x5A });
+        DataLayer::Can::Frame frame{};
+
+        for (uint32_t identifier : { 1U, 2U, 3U })
+        {
+            REQUIRE(sender.start(busA, identifier, message, DataLayer::Can::IsoTp::flowControlIdentifier(identifier)) == Status::pending);
+            REQUIRE(busB.receive(frame));
+            REQUIRE(receiver.receive(busB, frame, DataLayer::Can::IsoTp::flowControlIdentifier(frame.identifier)).status == Status::pending);
+        }
+        REQUIRE(receiver.activeSessions() == 2);
+        while (busA.receive(frame))
+        {
+            REQUIRE(sender.onFlowControl(busA, frame) == Status::complete);
+        }
+
+        size_t completed = 0;
+        size_t rejected = 0;
+        while (busB.receive(frame))
+        {
+            const auto outcome = receiver.receive(busB, frame, DataLayer::Can::IsoTp::flowControlIdentifier(frame.identifier));
+            completed += outcome.status == Status::complete ? 1U : 0U;
+            rejected += (frame.identifier == 1U && outcome.status == Status::invalid) ? 1U : 0U;
+        }
+        REQUIRE(completed == 2);
+        REQUIRE(rejected == 2);
+        REQUIRE(busA.dropped() == 0);
+    }
+
+    SECTION("a full bus fails the send")
+    {
+        DataLayer::Can::LoopbackBus<1> small;
+        DataLayer::Can::LoopbackBus<1> peer;
+        small.connect(peer);
+        DataLayer::Can::Adapter<decltype(Dispatcher), 8, 128> node{ small, Dispatcher };
+        REQUIRE(node.publish(test.getId(), Temperature{}) == Result::ok);
+        REQUIRE(node.publish(test.getId(), Temperature{}) == Result::sendFailed);
+        REQUIRE(small.dropped() == 1);
+    }
+
+    arrayTest2 = initialArray;
+}
+
+TEST_CASE("Test CAN signal messages", "[Can]")
+{
+    using EngineStatus = CanMessages::EngineStatus;
+    using Result = DataLayer::Can::Result;
+    const auto initialTemperature = coolantTemperature();
+    const auto initialCurrent = batteryCurrent();
+    const auto initialRange = rangeAlias();
+    const auto initialGear = gearPosition();
+    CanBus bus;
+    CanBus peer;
+    bus.connect(peer);
+    DataLayer::Can::Adapter can{ bus, Dispatcher };
+
+    SECTION("bits are numbered little endian across byte boundaries")
+    {
+        std::array<std::byte, 4> payload{};
+        DataLayer::Can::Detail::insertBits(payload, 6, 12, 0xABC);
+        REQUIRE(payload == std::array{ std::byte{ 0x00 }, std::byte{ 0xAF }, std::byte{ 0x02 }, std::byte{ 0x00 } });
+        REQUIRE(DataLayer::Can::Detail::extractBits(payload, 6, 12) == 0xABCU);
+        REQUIRE(DataLayer::Can::Detail::SignalValue<int16_t>::fromRaw(DataLayer::Can::Detail::signExtend(0x3FF, 10)) == -1);
+        REQUIRE(DataLayer::Can::Detail::SignalValue<int16_t>::fromRaw(DataLayer::Can::Detail::signExtend(0x1FF, 10)) == 511);
+    }
+
+    SECTION("quantized and alias datapoints are packed as raw values")
+    {
+        STATIC_REQUIRE(EngineStatus::identifier == 0x18FF0010U);
+        std::ignore = coolantTemperature.set(CoolantTemperature{ 87.3F });
+        std::ignore = batteryCurrent.set(BatteryCurrent{ 100 });
+        std::ignore = rangeAlias.set(RangeAlias{ 50U });
+        REQUIRE(can.publishMessage<EngineStatus>() == Result::ok);
+        DataLayer::Can::Frame frame{};
+        REQUIRE(peer.receive(frame));
+        REQUIRE(frame.length == 4);
+        const auto payload = std::span<const std::byte>{ frame.payload }.first(4);
+        REQUIRE(DataLayer::Can::Detail::extractBits(payload, 0, 12) == 1273U);
+        REQUIRE(DataLayer::Can::Detail::extractBits(payload, 12, 10) == 550U);
+        REQUIRE(DataLayer::Can::Detail::extractBits(payload, 22, 8) == 50U);
+
+        coolantTemperature = CoolantTemperature{ 0.0F };
+        batteryCurrent = BatteryCurrent{ 0 };
+        rangeAlias = RangeAlias{ 10U };
+        REQUIRE(can.applyMessage<EngineStatus>(frame) == Result::ok);
+        REQUIRE_THAT(coolantTemperature().value, Catch::Matchers::WithinAbs(87.3, 0.05));
+        REQUIRE(batteryCurrent().value == 100);
+        REQUIRE(rangeAlias().value == 50U);
+    }
+
+    SECTION("a signal out of range is rejected while the others are written")
+    {
+        DataLayer::Can::Frame frame = EngineStatus::pack();
+        DataLayer::Can::Detail::insertBits(frame.payload, 0, 12, 1000);
+        DataLayer::Can::Detail::insertBits(frame.payload, 22, 8, 5);
+        REQUIRE(can.applyMessage<EngineStatus>(frame) == Result::rejected);
+        REQUIRE_THAT(coolantTemperature().value, Catch::Matchers::WithinAbs(60.0, 0.05));
+        REQUIRE(rangeAlias().value == initialRange.value);
+    }
+
+    SECTION("a compact enum of a signed type is an unsigned signal")
+    {
+        using GearStatus = CanMessages::GearStatus;
+        // Drive sets the top bit of the two bit signal
+        std::ignore = gearPosition.set(GearPosition::Drive);
+        REQUIRE(can.publishMessage<GearStatus>() == Result::ok);
+        DataLayer::Can::Frame frame{};
+        REQUIRE(peer.receive(frame));
+        REQUIRE(DataLayer::Can::Detail::extractBits(std::span<const std::byte>{ frame.payload }.first(1), 0, 2) == 3U);
+
+        gearPosition = GearPosition::Park;
+        REQUIRE(can.applyMessage<GearStatus>(frame) == Result::ok);
+        REQUIRE(gearPosition() == GearPosition::Drive);
+    }
+
+    coolantTemperature = initialTemperature;
+    batteryCurrent = initialCurrent;
+    rangeAlias = initialRange;
+    gearPosition = initialGear;
+}
+
+TEST_CASE("Test CAN transmit queue", "[Can]")
+{
+    using Frame = DataLayer::Can::Frame;
+    using Result = DataLayer::Can::Result;
+    // a one frame ring in front of the peer stands in for a single transmit mailbox
+    DataLayer::Can::LoopbackBus<1> driver;
+    DataLayer::Can::LoopbackBus<1> peer;
+    driver.connect(peer);
+    Frame frame{};
+
+    SECTION("pending frames leave lowest identifier first and updates are coalesced")
+    {
+        DataLayer::Can::TransmitQueue<8> queue{ driver };
+        const auto make = [](uint32_t identifier, uint8_t value) {
+            Frame result{ .identifier = identifier, .length = 1 };
+            result.payload[0] = std::byte{ value };
+            return result;
+        };
+        REQUIRE(queue.send(make(0x300, 0)));
+        REQUIRE(queue.update(make(0x300, 1)));
+        REQUIRE(queue.send(make(0x200, 2)));
+        REQUIRE(queue.update(make(0x100, 3)));
+        REQUIRE(queue.update(make(0x300, 4)));
+        REQUIRE(queue.occupancy() == 3);
+        REQUIRE(queue.coalesced() == 1);
+
+        std::vector<std::pair<uint32_t, uint8_t>> order;
+        while (peer.receive(frame))
+        {
+            order.emplace_back(frame.identifier, std::to_integer<uint8_t>(frame.payload[0]));
+            queue.onTransmitComplete();
+        }
+        REQUIRE(order == std::vector<std::pair<uint32_t, uint8_t>>{ { 0x300, 0 }, { 0x100, 3 }, { 0x200, 2 }, { 0x300, 4 } });
+        REQUIRE(queue.occupancy() == 0);
+        REQUIRE(queue.highWatermark() == 3);
+        REQUIRE(queue.sent() == 4);
+    }
+
+    SECTION("frames of one identifier keep their order and are not coalesced by send")
+    {
+        DataLayer::Can::TransmitQueue<8> queue{ driver };
+        for (uint8_t value = 0; value < 5; ++value)
+        {
+            Frame sequence{ .identifier = 0x42, .length = 1 };
+            sequence.payload[0] = std::byte{ value };
+            REQUIRE(queue.send(sequence));
+        }
+        for (uint8_t value = 0; value < 5; ++value)
+        {
+            REQUIRE(peer.receive(frame));
+            REQUIRE(std::to_integer<uint8_t>(frame.payload[0]) == value);
+            queue.onTransmitComplete();
+        }
+        REQUIRE(queue.coalesced() == 0);
+    }
+
+    SECTION("a full queue rejects frames and the adapter reports the failed send")
+    {
+        DataLayer::Can::TransmitQueue<2> queue{ driver };
+        DataLayer::Can::Adapter can{ queue, Dispatcher };
+        REQUIRE(queue.send(Frame{ .identifier = 0x10 }));
+        REQUIRE(queue.send(Frame{ .identifier = 0x11 }));
+        REQUIRE(queue.send(Frame{ .identifier = 0x12 }));
+        REQUIRE_FALSE(queue.send(Frame{ .identifier = 0x13 }));
+        REQUIRE(can.publish(test.getId(), test()) == Result::sendFailed);
+        REQUIRE(queue.dropped() == 2);
+        REQUIRE(queue.occupancy() == 2);
+
+        queue.resetCounters();
+        REQUIRE(queue.dropped() == 0);
+        REQUIRE(queue.highWatermark() == 2);
+    }
+
+    SECTION("segmented transfers pass through queues on both ends")
+    {
+        using Array = std::array<int32_t, 10>;
+        const auto initialArray = arrayTest2();
+        DataLayer::Can::TransmitQueue<8> queueA{ driver };
+        DataLayer::Can::TransmitQueue<8> queueB{ peer };
+        DataLayer::Can::Adapter<decltype(Dispatcher), 8, 128> nodeA{ queueA, Dispatcher };
+        DataLayer::Can::Adapter<decltype(Dispatcher), 8, 128> nodeB{ queueB, Dispatcher };
+        Array expected{};
+        std::iota(expected.begin(), expected.end(), 3);
+
+        REQUIRE(nodeA.publish(arrayTest2.getId(), expected) == Result::pending);
+        auto receiver = Result::pending;
+        auto sender = Result::pending;
+        while (driver.pending() != 0 || peer.pending() != 0)
+        {
+            while (peer.receive(frame))
+            {
+                receiver = nodeB.applySet<Array>(frame);
+                queueA.onTransmitComplete();
+            }
+            while (driver.receive(frame))
+            {
+                sender = nodeA.applySet<Array>(frame);
+                queueB.onTransmitComplete();
+            }
+        }
+        REQUIRE(sender == Result::ok);
+        REQUIRE(receiver == Result::ok);
+        REQUIRE(arrayTest2() == expected);
+        REQUIRE(queueA.sent() == 6);
+        REQUIRE(queueA.dropped() == 0);
+        arrayTest2 = initialArray;
+    }
+}
+
+TEST_CASE("Test publish scheduler", "[Publish]")
+{
+    const auto initialTest = test();
+    const auto initialTemperature = coolantTemperature();
+    const auto initialCurrent = batteryCurrent();
+    std::vector<uint16_t> sent;
+    bool accept = true;
+    const auto record = [&sent, &accept](auto entry, const auto &) {
+        if (accept)
+        {
+            sent.push_back(entry.dataPoint.getId());
+        }
+        return accept;
+    };
+    Publishing::Scheduler scheduler;
+    coolantTemperature = CoolantTemperature{ 20.0F };
+    batteryCurrent = BatteryCurrent{ 0 };
+
+    STATIC_REQUIRE(DataLayer::Publish::PolicyOf<coolantTemperature>.maxInterval == 1000U);
+    STATIC_REQUIRE(DataLayer::Publish::PolicyOf<batteryCurrent>.relativeDeadband == 0.1);
+    STATIC_REQUIRE(DataLayer::Publish::PolicyOf<arrayTest>.minInterval == 0U);
+
+    REQUIRE(scheduler.poll(0, record) == 3);
+    sent.clear();
+
+    SECTION("changes inside the deadband are held back")
+    {
+        coolantTemperature = CoolantTemperature{ 20.3F };
+        REQUIRE(scheduler.poll(200, record) == 0);
+        coolantTemperature = CoolantTemperature{ 20.6F };
+        REQUIRE(scheduler.poll(250, record) == 1);
+        REQUIRE(sent == std::vector<uint16_t>{ coolantTemperature.getId() });
+    }
+
+    SECTION("the minimum interval limits the rate and the latest value is sent")
+    {
+        coolantTemperature = CoolantTemperature{ 30.0F };
+        REQUIRE(scheduler.poll(50, record) == 0);
+        coolantTemperature = CoolantTemperature{ 40.0F };
+        REQUIRE(scheduler.poll(99, record) == 0);
+        REQUIRE(scheduler.poll(100, [](auto, const auto &value) {
+            if constexpr (std::is_same_v<std::remove_cvref_t<decltype(value)>, CoolantTemperature>)
+            {
+                return value.value == 40.0F;
+            }
+            return false;
+        }) == 1);
+    }
+
+    SECTION("unchanged values are repeated after the maximum interval")
+    {
+        REQUIRE(scheduler.poll(999, record) == 0);
+        REQUIRE(scheduler.poll(1000, record) == 1);
+        REQUIRE(scheduler.heartbeats() == 1);
+        REQUIRE(scheduler.poll(1500, record) == 0);
+        REQUIRE(sent == std::vector<uint16_t>{ coolantTemperature.getId() });
+    }
+
+    SECTION("the relative deadband grows with the value above the absolute one")
+    {
+        batteryCurrent = BatteryCurrent{ 2 };
+        REQUIRE(scheduler.poll(10, record) == 0);
+        batteryCurrent = BatteryCurrent{ 100 };
+        REQUIRE(scheduler.poll(20, record) == 1);
+        batteryCurrent = BatteryCurrent{ 109 };
+        REQUIRE(scheduler.poll(30, record) == 0);
+        batteryCurrent = BatteryCurrent{ 111 };
+        REQUIRE(scheduler.poll(40, record) == 1);
+    }
+
+    SECTION("structs publish on any change once the interval passed")
+    {
+        test = Temperature{ .raw = initialTest.raw + 1, .value = initialTest.value };
+        REQUIRE(scheduler.poll(49, record) == 0);
+        REQUIRE(scheduler.poll(50, record) == 1);
+        REQUIRE(sent == std::vector<uint16_t>{ test.getId() });
+    }
+
+    SECTION("a rejected publish stays due and the clock may wrap")
+    {
+        Publishing::Scheduler wrapping;
+        REQUIRE(wrapping.poll(UINT32_MAX - 10U, record) == 3);
+        coolantTemperature = CoolantTemperature{ 25.0F };
+        accept = false;
+        REQUIRE(wrapping.poll(100, record) == 0);
+        accept = true;
+        REQUIRE(wrapping.poll(101, record) == 1);
+        wrapping.invalidate();
+        REQUIRE(wrapping.poll(102, record) == 3);
+    }
+
+    SECTION("the scheduler drives the MQTT and CAN adapters")
+    {
+        struct TopicClient final : DataLayer::Mqtt::Client
+        {
+            bool publish(std::string_view topic, std::span<const std::byte>, bool) noexcept override
+            {
+                topics.emplace_back(topic);
+                return true;
+            }
+
+            std::vector<std::string> topics;
+        } client;
+        DataLayer::Mqtt::Adapter mqtt{ client, Dispatcher };
+        CanBus bus;
+        CanBus peer;
+        bus.connect(peer);
+        DataLayer::Can::Adapter can{ bus, Dispatcher };
+
+        scheduler.invalidate();
+        REQUIRE(scheduler.poll(10, [&mqtt](auto entry, const auto &value) {
+            return mqtt.publish(DataLayer::Mqtt::Topic<decltype(entry)::dataPoint>, value) == DataLayer::Mqtt::Result::ok;
+        }) == 3);
+        REQUIRE(client.topics == std::vector<std::string>{ "DefaultGroup/test", "SecondGroup/coolantTemperature", "SecondGroup/batteryCurrent" });
+
+        scheduler.invalidate();
+        REQUIRE(scheduler.poll(20, [&can](auto entry, const auto &value) { return can.publish(entry.dataPoint.getId(), value) == DataLayer::Can::Result::ok; }) == 3);
+        REQUIRE(peer.pending() == 3);
+    }
+
+    test = initialTest;
+    coolantTemperature = initialTemperature;
+    batteryCurrent = initialCurrent;
+}
+
+TEST_CASE("Test RTT emitter", "[Rtt]")
+{
+    SECTION("frames follow the rtt.py header and carry the wire payload")
+    {
+        DataLayer::Rtt::Channel<256> channel;
+        DataLayer::Rtt::Emitter emitter{ channel };
+        REQUIRE(emitter.emit(coolantTemperature.getId(), CoolantTemperature{ 21.5F }));
+        REQUIRE(emitter.emit(arrayTest2.getId(), arrayTest2()));
+        REQUIRE(emitter.emit(0x1234, std::span<const std::byte>{}));
+        REQUIRE(channel.pending() == 3 * DataLayer::Rtt::HeaderSize + 4 + 40);
+
+        const auto frames = readFrames(channel);
+        REQUIRE(frames.size() == 3);
+        REQUIRE(frames[0].flags == 0);
+        REQUIRE(frames[0].dataPointId == coolantTemperature.getId());
+        float temperature{};
+        REQUIRE(frames[0].payload.size() == sizeof(temperature));
+        std::memcpy(&temperature, frames[0].payload.data(), sizeof(temperature));
+        REQUIRE(temperature == 21.5F);
+        REQUIRE(frames[1].payload.size() == 10 * sizeof(int32_t));
+        REQUIRE(frames[2].dataPointId == 0x1234);
+        REQUIRE(frames[2].payload.empty());
+        REQUIRE(emitter.emitted() == 3);
+        REQUIRE(emitter.bytes() == 3 * DataLayer::Rtt::HeaderSize + 44);
+        REQUIRE(channel.pending() == 0);
+    }
+
+    SECTION("change callbacks emit every accepted write")
+    {
+        const auto initial = coolantTemperature();
+        DataLayer::Rtt::Channel<256> channel;
+        DataLayer::Rtt::Emitter emitter{ channel };
+        emitter.watch<coolantTemperature>();
+        REQUIRE(coolantTemperature.set(CoolantTemperature{ 30.0F }) == DataLayer::Detail::RangeCheck::ok);
+        REQUIRE(Dispatcher.setDatapoint(coolantTemperature.getId(), CoolantTemperature{ 31.0F }).success);
+        emitter.unwatch<coolantTemperature>();
+        std::ignore = coolantTemperature.set(initial);
+
+        const auto frames = readFrames(channel);
+        REQUIRE(frames.size() == 2);
+        float temperature{};
+        std::memcpy(&temperature, frames[1].payload.data(), sizeof(temperature));
+        REQUIRE(temperature == 31.0F);
+    }
+
+    SECTION("a full ring drops whole frames and the next frame reports them")
+    {
+        // 31 usable bytes hold two 12 byte frames
+        DataLayer::Rtt::Channel<32> channel;
+        DataLayer::Rtt::Emitter emitter{ channel };
+        for (uint16_t index = 0; index < 5; ++index)
+        {
+            std::ignore = emitter.emit(index, uint32_t{ index });
+        }
+        REQUIRE(emitter.emitted() == 2);
+        REQUIRE(emitter.lost() == 3);
+        REQUIRE(readFrames(channel).size() == 2);
+
+        REQUIRE(emitter.emit(7, uint32_t{ 7 }));
+        REQUIRE(emitter.emit(8, uint32_t{ 8 }));
+        const auto frames = readFrames(channel);
+        REQUIRE(frames[0].flags == (DataLayer::Rtt::OverflowFlag | 3U));
+        REQUIRE(frames[1].flags == 0);
+
+        REQUIRE_FALSE(emitter.emit(9, std::span<const std::byte>{ channel.buffer }));
+        for (size_t index = 0; index < 300; ++index)
+        {
+            std::ignore = emitter.emit(9, std::span<const std::byte>{ channel.buffer }.first(24));
+        }
+        REQUIRE(emitter.emit(10, uint8_t{ 10 }));
+        REQUIRE(readFrames(channel).front().flags == (DataLayer::Rtt::OverflowFlag | DataLayer::Rtt::LostMask));
+    }
+
+    SECTION("frames wrap around the end of the ring")
+    {
+        DataLayer::Rtt::Channel<61> channel;
+        DataLayer::Rtt::Emitter emitter{ channel };
+        std::array<std::byte, 13> payload{};
+        for (uint16_t round = 0; round < 100; ++round)
+        {
+            payload.fill(static_cast<std::byte>(round));
+            const auto size = static_cast<size_t>(round % 14U);
+            REQUIRE(emitter.emit(round, std::span<const std::byte>{ payload }.first(size)));
+            const auto frames = readFrames(channel);
+            REQUIRE(frames.size() == 1);
+            REQUIRE(frames[0].dataPointId == round);
+            REQUIRE(std::ranges::equal(frames[0].payload, std::span{ payload }.first(size)));
+        }
+    }
+
+    SECTION("a concurrent reader sees every emitted frame in order")
+    {
+        constexpr uint32_t Count = 100000;
+        DataLayer::Rtt::Channel<1024> channel;
+        DataLayer::Rtt::Emitter emitter{ channel };
+        std::atomic<bool> done{ false };
+        std::thread producer([&emitter, &done] {
+            for (uint32_t sequence = 0; sequence < Count; ++sequence)
+            {
+                std::ignore = emitter.emit(1, sequence);
+            }
+            done = true;
+        });
+
+        uint64_t received = 0;
+        uint32_t expected = 0;
+        bool ordered = true;
+        const auto check = [&] {
+            for (const auto &frame : readFrames(channel))
+            {
+                uint32_t sequence{};
+                std::memcpy(&sequence, frame.payload.data(), sizeof(sequence));
+                // an unsaturated lost count accounts exactly for the gap
+                const auto lost = (frame.flags & DataLayer::Rtt::OverflowFlag) != 0 ? frame.flags & DataLayer::Rtt::LostMask : 0U;
+                ordered = ordered && sequence >= expected + lost && (lost == DataLayer::Rtt::LostMask || sequence == expected + lost);
+                expected = sequence + 1U;
+                ++received;
+            }
+        };
+        while (!done)
+        {
+            check();
+        }
+        producer.join();
+        check();
+
+        REQUIRE(ordered);
+        REQUIRE(received == emitter.emitted());
+        REQUIRE(emitter.emitted() + emitter.lost() == Count);
+    }
+
+    SECTION("shared memory stand-in between two mappings")
+    {
+        const std::string name = "/datalayer-rtt-test-" + std::to_string(::getpid());
+        DataLayer::Rtt::SharedChannel<512> target{ name, DataLayer::Rtt::SharedChannel<512>::Mode::create };
+        REQUIRE(target.isOpen());
+        REQUIRE_FALSE(DataLayer::Rtt::SharedChannel<512>{ name, DataLayer::Rtt::SharedChannel<512>::Mode::create }.isOpen());
+        REQUIRE_FALSE(DataLayer::Rtt::SharedChannel<256>{ name, DataLayer::Rtt::SharedChannel<256>::Mode::open }.isOpen());
+
+        DataLayer::Rtt::SharedChannel<512> host{ name, DataLayer::Rtt::SharedChannel<512>::Mode::open };
+        REQUIRE(host.isOpen());
+        DataLayer::Rtt::Emitter emitter{ target.channel() };
+        REQUIRE(emitter.emit(coolantTemperature.getId(), coolantTemperature()));
+        const auto frames = readFrames(host.channel());
+        REQUIRE(frames.size() == 1);
+        REQUIRE(frames[0].dataPointId == coolantTemperature.getId());
+        REQUIRE(target.channel().pending() == 0);
+    }
+    REQUIRE_FALSE(DataLayer::Rtt::SharedChannel<512>{ "/datalayer-rtt-test-" + std::to_string(::getpid()), DataLayer::Rtt::SharedChannel<512>::Mode::open }.isOpen());
+}
+
+TEST_CASE("Test RTT decoder", "[Rtt]")
+{
+    DataLayer::Rtt::Channel<1024> channel;
+    DataLayer::Rtt::Emitter emitter{ channel };
+    const auto drain = [&channel] {
+        std::vector<std::byte> stream(channel.pending());
+        stream.resize(channel.read(stream));
+        return stream;
+    };
+
+    SECTION("emitted frames come back grouped by datapoint in arrival order")
+    {
+        for (uint32_t value = 0; value < 10; ++value)
+        {
+            std::ignore = emitter.emit(static_cast<uint16_t>(1U + value % 2U), value);
+        }
+        DataLayer::Rtt::Decoder decoder;
+        const auto batch = decoder.feed(drain());
+        REQUIRE(batch.size() == 2);
+        const auto &odd = batch.at(2);
+        REQUIRE(odd.ends == std::vector<uint32_t>{ 4, 8, 12, 16, 20 });
+        REQUIRE(odd.indices == std::vector<uint32_t>{ 1, 3, 5, 7, 9 });
+        uint32_t value{};
+        std::memcpy(&value, odd.payloads.data() + 8, sizeof(value));
+        REQUIRE(value == 5);
+        REQUIRE(decoder.frames() == 10);
+        REQUIRE(decoder.skippedBytes() == 0);
+    }
+
+    SECTION("noise is skipped and frames survive any chunking")
+    {
+        std::vector<std::byte> stream{ std::byte{ 'x' }, std::byte{ 'D' }, std::byte{ 'D' } };
+        std::ignore = emitter.emit(7, uint16_t{ 0x0201 });
+        // a header of another protocol version
+        stream.insert(stream.end(), { std::byte{ 'D' }, std::byte{ 'L' }, std::byte{ 2 }, std::byte{}, std::byte{ 7 }, std::byte{}, std::byte{}, std::byte{} });
+        const auto first = drain();
+        stream.insert(stream.begin() + 3, first.begin(), first.end());
+        const std::array<std::byte, 100> oversized{};
+        std::ignore = emitter.emit(9, std::span<const std::byte>{ oversized });
+        std::ignore = emitter.emit(8, uint8_t{ 3 });
+        const auto rest = drain();
+        stream.insert(stream.end(), rest.begin(), rest.end());
+        stream.insert(stream.end(), { std::byte{ 'D' }, std::byte{ 'L' }, std::byte{ 1 } });
+
+        for (size_t chunk = 1; chunk <= stream.size(); chunk += 3)
+        {
+            DataLayer::Rtt::Decoder decoder{ 64 };
+            std::vector<uint16_t> ids;
+            for (size_t offset = 0; offset < stream.size(); offset += chunk)
+            {
+                std::ignore = decoder.feed(std::span{ stream }.subspan(offset, std::min(chunk, stream.size() - offset)),
+                  [&ids](uint16_t dataPointId, uint8_t, std::span<const std::byte>) { ids.push_back(dataPointId); });
+            }
+            REQUIRE(ids == std::vector<uint16_t>{ 7, 8 });
+            // x, two D without L, the foreign header and the oversized frame
+            REQUIRE(decoder.skippedBytes() == 3 + 8 + DataLayer::Rtt::HeaderSize + 100);
+            REQUIRE(decoder.pending() == 3);
+        }
+    }
+
+    SECTION("overflow flags add up to the lost frames")
+    {
+        DataLayer::Rtt::Channel<32> small;
+        DataLayer::Rtt::Emitter producer{ small };
+        DataLayer::Rtt::Decoder decoder;
+        std::array<std::byte, 32> stream{};
+        for (uint32_t value = 0; value < 20; ++value)
+        {
+            std::ignore = producer.emit(1, value);
+            if (value % 5 == 4)
+            {
+                std::ignore = decoder.feed(std::span{ stream }.first(small.read(stream)));
+            }
+        }
+        std::ignore = producer.emit(1, uint32_t{ 20 });
+        std::ignore = decoder.feed(std::span{ stream }.first(small.read(stream)));
+        REQUIRE(decoder.frames() == producer.emitted());
+        REQUIRE(decoder.lostFrames() == producer.lost());
+    }
+}
+
+TEST_CASE("CAN segmentation benchmarks", "[.][benchmark]")
+{
+    using Array = std::array<int32_t, 10>;
+    using Temperatures = std::array<Temperature, 10>;
+    CanBus busA;
+    CanBus busB;
+    busA.connect(busB);
+    DataLayer::Can::Adapter<decltype(Dispatcher), 8, 128> classicA{ busA, Dispatcher };
+    DataLayer::Can::Adapter<decltype(Dispatcher), 8, 128> classicB{ busB, Dispatcher };
+    DataLayer::Can::Adapter<decltype(Dispatcher), 64, 128> fdA{ busA, Dispatcher };
+    DataLayer::Can::Adapter<decltype(Dispatcher), 64, 128> fdB{ busB, Dispatcher };
+    const auto initialArray = arrayTest2();
+    const auto initialTemperatures = arrayTest();
+
+    BENCHMARK("classic CAN transfer of 40 bytes")
+    {
+        std::ignore = classicA.publish(arrayTest2.getId(), initialArray);
+        return exchange<Array>(busA, classicA, busB, classicB).second;
+    };
+
+    BENCHMARK("CAN FD transfer of 80 bytes")
+    {
+        std::ignore = fdA.publish(arrayTest.getId(), initialTemperatures);
+        return exchange<Temperatures>(busA, fdA, busB, fdB).second;
+    };
+}
+
+TEST_CASE("CAN transmit queue benchmarks", "[.][benchmark]")
+{
+    DataLayer::Can::LoopbackBus<1> driver;
+    DataLayer::Can::LoopbackBus<1> peer;
+    driver.connect(peer);
+    DataLayer::Can::TransmitQueue<32> queue{ driver };
+    DataLayer::Can::Frame frame{ .identifier = 0x7FF, .length = 8 };
+    std::ignore = queue.send(frame);
+
+    BENCHMARK("32 prioritised frames through one mailbox")
+    {
+        for (uint32_t identifier = 32; identifier > 0; --identifier)
+        {
+            frame.identifier = identifier;
+            std::ignore = queue.update(frame);
+        }
+        uint32_t last = 0;
+        while (peer.receive(frame))
+        {
+            last = frame.identifier;
+            queue.onTransmitComplete();
+        }
+        return last;
+    };
+
+    BENCHMARK("coalesced update of a pending frame")
+    {
+        frame.identifier = 0x100;
+        return queue.update(frame);
+    };
+}
+
+TEST_CASE("Publish scheduler benchmarks", "[.][benchmark]")
+{
+    Publishing::Scheduler scheduler;
+    uint32_t now = 0;
+    size_t published = 0;
+    const auto count = [&published](auto, const auto &) {
+        ++published;
+        return true;
+    };
+    std::ignore = scheduler.poll(now, count);
+
+    BENCHMARK("poll without due datapoints")
+    {
+        return scheduler.poll(++now % 1000U, count);
+    };
+
+    BENCHMARK("poll of a noisy value inside its deadband")
+    {
+        coolantTemperature = CoolantTemperature{ (now & 1U) != 0 ? 21.6F : 21.4F };
+        return scheduler.poll(++now, count);
+    };
+}
+
+TEST_CASE("RTT emitter benchmarks", "[.][benchmark]")
+{
+    DataLayer::Rtt::Channel<4096> channel;
+    DataLayer::Rtt::Emitter emitter{ channel };
+    std::array<std::byte, 4096> sink{};
+
+    BENCHMARK("emit and drain a float frame")
+    {
+        std::ignore = emitter.emit(coolantTemperature.getId(), CoolantTemperature{ 21.5F });
+        return channel.read(sink);
+    };
+
+    BENCHMARK("emit into a full ring")
+    {
+        return emitter.emit(coolantTemperature.getId(), CoolantTemperature{ 21.5F });
+    };
+    std::ignore = channel.read(sink);
+
+    const auto initial = coolantTemperature();
+    emitter.watch<coolantTemperature>();
+    BENCHMARK("watched write and drain")
+    {
+        std::ignore = coolantTemperature.set(CoolantTemperature{ 22.0F });
+        return channel.read(sink);
+    };
+    emitter.unwatch<coolantTemperature>();
+    std::ignore = coolantTemperature.set(initial);
+
+    constexpr uint32_t Count = 1000000;
+    DataLayer::Rtt::Channel<16384> shared;
+    DataLayer::Rtt::Emitter producer{ shared };
+    std::atomic<bool> done{ false };
+    const auto start = std::chrono::steady_clock::now();
+    std::thread reader([&shared, &done] {
+        std::array<std::byte, 16384> buffer{};
+        while (!done.load() || shared.pending() != 0)
+        {
+            if (shared.read(buffer) == 0)
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+    // the producer retries a full ring, so the rate is bounded by the reader
+    for (uint32_t sequence = 0; sequence < Count; ++sequence)
+    {
+        while (!producer.emit(1, sequence))
+        {
+            std::this_thread::yield();
+        }
+    }
+    done = true;
+    reader.join();
+    const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    WARN("concurrent reader: " << static_cast<double>(Count) / seconds << " frames/s, " << static_cast<double>(producer.bytes()) / seconds << " bytes/s, "
+                               << producer.lost() << " full ring retries");
+}
+
+TEST_CASE("RTT decoder benchmarks", "[.][benchmark]")
+{
+    DataLayer::Rtt::Channel<65536> channel;
+    DataLayer::Rtt::Emitter emitter{ channel };
+    for (uint32_t value = 0; emitter.emit(static_cast<uint16_t>(value % 8U), value); ++value)
+    {
+    }
+    std::vector<std::byte> clean(channel.pending());
+    clean.resize(channel.read(clean));
+    // every third byte a magic lookalike in between the frames
+    std::vector<std::byte> noisy;
+    for (size_t offset = 0; offset < clean.size(); offset += 12)
+    {
+        noisy.insert(noisy.end(), { std::byte{ 'D' }, std::byte{ 0 }, std::byte{ 'D' }, std::byte{ 'L' }, std::byte{ 9 } });
+        noisy.insert(noisy.end(), clean.begin() + static_cast<ptrdiff_t>(offset), clean.begin() + static_cast<ptrdiff_t>(offset + 12));
+    }
+
+    DataLayer::Rtt::Decoder decoder;
+    size_t frames = 0;
+    const auto count = [&frames](uint16_t, uint8_t, std::span<const std::byte>) { ++frames; };
+    BENCHMARK("split 64 KiB of frames")
+    {
+        return decoder.feed(clean, count);
+    };
+
+    BENCHMARK("split 64 KiB of frames in 1 KiB chunks")
+    {
+        size_t total = 0;
+        for (size_t offset = 0; offset < clean.size(); offset += 1024)
+        {
+            total += decoder.feed(std::span{ clean }.subspan(offset, std::min<size_t>(1024, clean.size() - offset)), count);
+        }
+        return total;
+    };
+
+    BENCHMARK("split noisy frames")
+    {
+        return decoder.feed(noisy, count);
+    };
+
+    BENCHMARK("batch 64 KiB of frames by datapoint")
+    {
+        return decoder.feed(clean).size();
+    };
+
+    const auto start = std::chrono::steady_clock::now();
+    size_t bytes = 0;
+    while (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(200))
+    {
+        std::ignore = decoder.feed(noisy, count);
+        bytes += noisy.size();
+    }
+    const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    WARN("noisy stream: " << static_cast<double>(bytes) / seconds / 1.0e6 << " MB/s");
+}
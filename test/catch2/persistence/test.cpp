@@ -0,0 +1,2931 @@
+#include <canAdapter.h>
+#include <canLoopback.h>
+#include <canFilter.h>
+#include <catch2/catch_all.hpp>
+#include <checksum.h>
+#include <chrono>
+#include <filesystem>
+#include <flashSimulator.h>
+#include <fmt/format.h>
+#include <groupDelta.h>
+#include <include/datalayer.h>
+#include <mqttAdapter.h>
+#include <mqttBatch.h>
+#include <persistenceWorker.h>
+#include <protocol.h>
+#include <replication.h>
+#include <sharedMemory.h>
+#include <socketServer.h>
+#include <string>
+#include <string_view>
+#include <sys/wait.h>
+#include <thread>
+#include <traceFile.h>
+#include <vector>
+
+namespace
+{
+    constexpr size_t SectorSize = 512;
+    constexpr size_t SectorCount = 4;
+
+    DataLayer::Storage::FileFlashSimulator makeFlash(const std::filesystem::path &path, size_t sectorSize = SectorSize, size_t sectorCount = SectorCount)
+    {
+        std::filesystem::remove(path);
+        return { path, sectorSize, sectorCount };
+    }
+
+    template<typename Value>
+    void appendRecord(std::vector<std::byte> &records, uint16_t dataPointId, const DataLayer::Version &version, const Value &value)
+    {
+        DataLayer::Persistence::append(records, DataLayer::Persistence::RecordHeader{ .dataPointId = dataPointId, .version = version, .payloadSize = sizeof(Value) });
+        DataLayer::Persistence::append(records, value);
+    }
+
+    struct RecordingBus final : DataLayer::Can::Bus
+    {
+        bool send(const DataLayer::Can::Frame &frame) noexcept override
+        {
+            last = frame;
+            return true;
+        }
+
+        DataLayer::Can::Frame last{};
+    };
+
+    struct RecordingClient final : DataLayer::Mqtt::Client
+    {
+        bool publish(std::string_view, std::span<const std::byte> payload, bool) noexcept override
+        {
+            if (fail)
+            {
+                return false;
+            }
+            last.assign(payload.begin(), payload.end());
+            ++messages;
+            return true;
+        }
+
+        std::vector<std::byte> last;
+        size_t messages{ 0 };
+        bool fail{ false };
+    };
+
+    // in-process broker stand-in, counts without copying
+    struct CountingClient final : DataLayer::Mqtt::Client
+    {
+        bool publish(std::string_view, std::span<const std::byte> payload, bool) noexcept override
+        {
+            ++messages;
+            bytes += payload.size();
+            return true;
+        }
+
+        size_t messages{ 0 };
+        size_t bytes{ 0 };
+    };
+
+    std::vector<std::byte> makeImage(uint16_t groupId, const DataLayer::Version &groupVersion, const std::vector<std::byte> &records)
+    {
+        std::vector<std::byte> image;
+        DataLayer::Persistence::append(image, DataLayer::Persistence::Header{ .groupId = groupId, .groupVersion = groupVersion, .checksum = DataLayer::Persistence::crc32c(records) });
+        image.insert(image.end(), records.begin(), records.end());
+        return image;
+    }
+
+    // advances one microsecond per recorded write
+    std::atomic<uint64_t> traceTime{ 0 };
+
+    uint64_t traceClock() noexcept
+    {
+        return traceTime.fetch_add(1000U, std::memory_order_relaxed);
+    }
+
+    // attaches the recorder for the lifetime of the scope
+    struct TraceScope
+    {
+        explicit TraceScope(DataLayer::Trace::Sink &sink) noexcept
+        {
+            DataLayer::Trace::attach(sink);
+        }
+
+        TraceScope(const TraceScope &) = delete;
+        TraceScope &operator=(const TraceScope &) = delete;
+        TraceScope(TraceScope &&) = delete;
+        TraceScope &operator=(TraceScope &&) = delete;
+
+        ~TraceScope()
+        {
+            DataLayer::Trace::detach();
+        }
+    };
+
+    using SharedSegment = DataLayer::Shared::Segment<std::remove_cvref_t<decltype(Dispatcher)>>;
+
+    // attaches the segment as the set() publisher for the lifetime of the scope
+    struct PublishScope
+    {
+        explicit PublishScope(DataLayer::Shared::Publisher &publisher) noexcept
+        {
+            DataLayer::Shared::attach(publisher);
+        }
+
+        PublishScope(const PublishScope &) = delete;
+        PublishScope &operator=(const PublishScope &) = delete;
+        PublishScope(PublishScope &&) = delete;
+        PublishScope &operator=(PublishScope &&) = delete;
+
+        ~PublishScope()
+        {
+            DataLayer::Shared::detach();
+        }
+    };
+
+    // attaches the leader as the set() recorder for the lifetime of the scope
+    struct ReplicationScope
+    {
+        explicit ReplicationScope(DataLayer::Replication::Sink &sink) noexcept
+        {
+            DataLayer::Replication::attach(sink);
+        }
+
+        ReplicationScope(const ReplicationScope &) = delete;
+        ReplicationScope &operator=(const ReplicationScope &) = delete;
+        ReplicationScope(ReplicationScope &&) = delete;
+        ReplicationScope &operator=(ReplicationScope &&) = delete;
+
+        ~ReplicationScope()
+        {
+            DataLayer::Replication::detach();
+        }
+    };
+
+    template<size_t HistorySlots, size_t MessageCapacity = 1400>
+    using ReplicationLeader = DataLayer::Replication::Leader<std::remove_cvref_t<decltype(Dispatcher)>, HistorySlots, MessageCapacity>;
+    using ReplicationFollower = DataLayer::Replication::Follower<std::remove_cvref_t<decltype(Dispatcher)>>;
+
+    using SocketServer = DataLayer::Server::Server<std::remove_cvref_t<decltype(ProtocolTable::Table)>>;
+
+    constexpr DataLayer::Dispatcher ConfigOnlyDispatcher{ ConfigGroup };
+
+    // same group and record ID as StatusGroupPacked but another field layout
+    constinit DataLayer::PackedStore<StatusGroupInfo, 0x100, 8, DataLayer::Version{ 1, 0, 0 }> foreignStatus{ std::array{ DataLayer::PackedField{ 0x1, 0, 8, 0 } } };
+}// namespace
+
+TEST_CASE("Test storage backend persistence", "[Storage]")
+{
+    const auto initialSetpoint = setpoint();
+    const auto initialCounter = counter();
+    const auto initialCalibration = calibration();
+
+    SECTION("group image round-trips through the wear-leveling store")
+    {
+        auto flash = makeFlash("flash.bin");
+        DataLayer::Storage::WearLevelingStore store{ flash };
+        REQUIRE(setpoint.set(42.5F) == DataLayer::Detail::RangeCheck::ok);
+        REQUIRE(calibration.set(Calibration{ .gain = 2.0F, .offset = -1.5F }) == DataLayer::Detail::RangeCheck::ok);
+
+        const auto writeStatus = ConfigGroup.serializeGroup(store);
+        REQUIRE(writeStatus.result);
+        REQUIRE(writeStatus.errorCode == SerializationError::None);
+
+        std::ignore = setpoint.set(0.0F);
+        std::ignore = calibration.set(Calibration{});
+        const auto readStatus = ConfigGroup.deserializeGroup(store);
+        REQUIRE(readStatus.result);
+        REQUIRE(readStatus.size == writeStatus.size);
+        REQUIRE(setpoint() == 42.5F);
+        REQUIRE(calibration().gain == 2.0F);
+        REQUIRE(calibration().offset == -1.5F);
+    }
+
+    SECTION("latest image is found again after a remount of the same flash file")
+    {
+        {
+            auto flash = makeFlash("flash.bin");
+            DataLayer::Storage::WearLevelingStore store{ flash };
+            for (uint32_t value = 1; value <= 20; ++value)
+            {
+                REQUIRE(counter.set(value) == DataLayer::Detail::RangeCheck::ok);
+                REQUIRE(ConfigGroup.serializeGroup(store).result);
+            }
+        }
+
+        std::ignore = counter.set(0U);
+        DataLayer::Storage::FileFlashSimulator flash{ "flash.bin", SectorSize, SectorCount };
+        DataLayer::Storage::WearLevelingStore store{ flash };
+        REQUIRE(store.mount() == DataLayer::Storage::Result::ok);
+        REQUIRE(store.sequence() == 20U);
+        REQUIRE(ConfigGroup.deserializeGroup(store).result);
+        REQUIRE(counter() == 20U);
+    }
+
+    SECTION("updates rotate evenly across all sectors")
+    {
+        auto flash = makeFlash("flash.bin");
+        DataLayer::Storage::WearLevelingStore store{ flash };
+        for (uint32_t value = 0; value < 200; ++value)
+        {
+            std::ignore = counter.set(value);
+            REQUIRE(ConfigGroup.serializeGroup(store).result);
+        }
+
+        uint32_t minimum = flash.eraseCount(0);
+        uint32_t maximum = minimum;
+        for (size_t sector = 0; sector < SectorCount; ++sector)
+        {
+            minimum = std::min(minimum, flash.eraseCount(sector));
+            maximum = std::max(maximum, flash.eraseCount(sector));
+        }
+        REQUIRE(minimum > 0U);
+        REQUIRE(maximum - minimum <= 1U);
+        REQUIRE(flash.totalEraseCount() < 200U);
+    }
+
+    SECTION("interrupted write keeps the previously committed image")
+    {
+        auto flash = makeFlash("flash.bin");
+        {
+            DataLayer::Storage::WearLevelingStore store{ flash };
+            std::ignore = counter.set(7U);
+            const auto committed = ConfigGroup.serializeGroup(store);
+            REQUIRE(committed.result);
+
+            for (size_t budget = 0; budget < DataLayer::Storage::slotSize(committed.size); budget += 8)
+            {
+                flash.setProgramBudget(budget);
+                std::ignore = counter.set(static_cast<uint32_t>(1000 + budget));
+                const auto status = ConfigGroup.serializeGroup(store);
+                REQUIRE_FALSE(status.result);
+                REQUIRE(status.errorCode == SerializationError::StorageFailure);
+            }
+            flash.clearProgramBudget();
+        }
+
+        DataLayer::Storage::WearLevelingStore store{ flash };
+        std::ignore = counter.set(0U);
+        REQUIRE(ConfigGroup.deserializeGroup(store).result);
+        REQUIRE(counter() == 7U);
+
+        std::ignore = counter.set(8U);
+        REQUIRE(ConfigGroup.serializeGroup(store).result);
+        std::ignore = counter.set(0U);
+        REQUIRE(ConfigGroup.deserializeGroup(store).result);
+        REQUIRE(counter() == 8U);
+    }
+
+    SECTION("erased flash has no image to restore")
+    {
+        auto flash = makeFlash("flash.bin");
+        DataLayer::Storage::WearLevelingStore store{ flash };
+        const auto [result, size, errorCode] = ConfigGroup.deserializeGroup(store);
+        REQUIRE_FALSE(result);
+        REQUIRE(size == 0);
+        REQUIRE(errorCode == SerializationError::StorageFailure);
+    }
+
+    SECTION("image larger than one sector is rejected")
+    {
+        auto flash = makeFlash("flash.bin", 64, SectorCount);
+        DataLayer::Storage::WearLevelingStore store{ flash };
+        const auto status = ConfigGroup.serializeGroup(store);
+        REQUIRE_FALSE(status.result);
+        REQUIRE(status.errorCode == SerializationError::StorageFailure);
+        REQUIRE(flash.totalEraseCount() == 0U);
+    }
+
+    SECTION("image of another group is rejected")
+    {
+        auto flash = makeFlash("flash.bin");
+        DataLayer::Storage::WearLevelingStore store{ flash };
+        REQUIRE(DiagnosticGroup.serializeGroup(store).result);
+        REQUIRE(ConfigGroup.deserializeGroup(store).errorCode == SerializationError::GroupIdMismatch);
+    }
+
+    SECTION("simulated flash refuses to program erased bits back to one")
+    {
+        auto flash = makeFlash("flash.bin");
+        REQUIRE(flash.erase(0));
+        constexpr std::array<std::byte, 8> zeros{};
+        std::array<std::byte, 8> ones{};
+        ones.fill(std::byte{ 0xFF });
+        REQUIRE(flash.program(0, zeros));
+        REQUIRE_FALSE(flash.program(0, ones));
+        REQUIRE_FALSE(flash.program(3, zeros));
+    }
+
+    setpoint = initialSetpoint;
+    counter = initialCounter;
+    calibration = initialCalibration;
+}
+
+TEST_CASE("Test record lookup while restoring", "[Persistence]")
+{
+    const auto initialSetpoint = setpoint();
+    const auto initialMode = mode();
+    const auto initialCounter = counter();
+    const auto &group = ConfigGroup.group;
+
+    SECTION("compile-time index resolves current and legacy IDs")
+    {
+        constexpr auto index = DataLayer::Persistence::makeRecordIndex<decltype(ConfigGroup.datapoints)>();
+        STATIC_REQUIRE(index.size() == 6);
+        STATIC_REQUIRE(std::ranges::is_sorted(index, {}, &DataLayer::Persistence::IndexEntry::dataPointId));
+        STATIC_REQUIRE(DataLayer::Persistence::findRecord(index, 0x1002)->position == 1);
+        STATIC_REQUIRE(DataLayer::Persistence::findRecord(index, 0x100C)->position == 1);
+        STATIC_REQUIRE(DataLayer::Persistence::findRecord(index, 0x100C)->legacy);
+        STATIC_REQUIRE(DataLayer::Persistence::findRecord(index, 0x1006) == nullptr);
+    }
+
+    SECTION("records are matched in any order, legacy IDs restore the renamed datapoint and unknown IDs are skipped")
+    {
+        std::vector<std::byte> records;
+        appendRecord(records, counter.getId(), counter.getVersion(), uint32_t{ 99 });
+        appendRecord(records, static_cast<uint16_t>(0x10FF), counter.getVersion(), uint64_t{ 0 });
+        appendRecord(records, static_cast<uint16_t>(0x100C), mode.getVersion(), uint8_t{ 4 });
+        appendRecord(records, setpoint.getId(), setpoint.getVersion(), 3.25F);
+        const auto image = makeImage(group.baseId, group.version, records);
+
+        const auto status = Deserialization(group.version, group.baseId, ConfigGroup.datapoints, group.allowUpgrade).decode(image);
+        REQUIRE(status.result);
+        REQUIRE(status.size == image.size());
+        REQUIRE(counter() == 99U);
+        REQUIRE(mode() == 4U);
+        REQUIRE(setpoint() == 3.25F);
+    }
+
+    SECTION("group file is restored from a memory mapping")
+    {
+        std::ignore = counter.set(1234U);
+        const auto written = ConfigGroup.serializeGroup(std::filesystem::path{ "config.bin" });
+        REQUIRE(written.result);
+        std::ignore = counter.set(0U);
+
+        const auto status = ConfigGroup.deserializeGroup(std::filesystem::path{ "config.bin" });
+        REQUIRE(status.result);
+        REQUIRE(status.size == written.size);
+        REQUIRE(counter() == 1234U);
+
+        std::filesystem::resize_file("config.bin", sizeof(DataLayer::Persistence::LegacyHeader) - 1U);
+        const auto truncated = ConfigGroup.deserializeGroup(std::filesystem::path{ "config.bin" });
+        REQUIRE_FALSE(truncated.result);
+        REQUIRE(truncated.size == sizeof(DataLayer::Persistence::LegacyHeader) - 1U);
+        REQUIRE(truncated.errorCode == SerializationError::InvalidFormat);
+
+        std::filesystem::remove("config.bin");
+        const auto missing = ConfigGroup.deserializeGroup(std::filesystem::path{ "config.bin" });
+        REQUIRE_FALSE(missing.result);
+        REQUIRE(missing.size == 0);
+    }
+
+    setpoint = initialSetpoint;
+    mode = initialMode;
+    counter = initialCounter;
+}
+
+TEST_CASE("Test dispatcher snapshot container", "[Persistence]")
+{
+    const auto initialCounter = counter();
+    const auto initialErrorCount = errorCount();
+    const auto initialValue = Large::value005();
+
+    std::ignore = counter.set(11U);
+    std::ignore = errorCount.set(22U);
+    std::ignore = Large::value005.set(33.0F);
+    const auto written = Dispatcher.serializeAll("snapshot.bin");
+    REQUIRE(written.result);
+    REQUIRE_FALSE(std::filesystem::exists("snapshot.bin.tmp"));
+    std::ignore = counter.set(0U);
+    std::ignore = errorCount.set(0U);
+    std::ignore = Large::value005.set(0.0F);
+
+    SECTION("all persisted groups are restored from one file")
+    {
+        const auto status = Dispatcher.deserializeAll("snapshot.bin");
+        REQUIRE(status.result);
+        REQUIRE(status.size == written.size);
+        REQUIRE(counter() == 11U);
+        REQUIRE(errorCount() == 22U);
+        REQUIRE(Large::value005() == 33.0F);
+    }
+
+    SECTION("a single group is restored through the index")
+    {
+        const auto status = Dispatcher.deserializeGroup("snapshot.bin", DiagnosticGroup.group.baseId);
+        REQUIRE(status.result);
+        REQUIRE(errorCount() == 22U);
+        REQUIRE(counter() == 0U);
+        REQUIRE(Dispatcher.deserializeGroup("snapshot.bin", 0x0F00).errorCode == SerializationError::GroupIdMismatch);
+    }
+
+    SECTION("a damaged group image does not prevent restoring the other groups")
+    {
+        const DataLayer::Persistence::InputFile snapshot("snapshot.bin");
+        std::vector<std::byte> image(snapshot.bytes().begin(), snapshot.bytes().end());
+        const DataLayer::Persistence::ContainerView container(image);
+        REQUIRE(container.groupCount() == 10);
+        DataLayer::Persistence::GroupIndexEntry entry{};
+        size_t position = 0;
+        while (container.entry(position, entry) && entry.groupId != ConfigGroup.group.baseId)
+        {
+            ++position;
+        }
+        REQUIRE(entry.groupId == ConfigGroup.group.baseId);
+        image[entry.offset + entry.size - 1U] ^= std::byte{ 0x01 };
+
+        const auto status = Dispatcher.decodeAll(image);
+        REQUIRE_FALSE(status.result);
+        REQUIRE(status.errorCode == SerializationError::ChecksumMismatch);
+        REQUIRE(errorCount() == 22U);
+        REQUIRE(Large::value005() == 33.0F);
+        REQUIRE(counter() == 0U);
+    }
+
+    SECTION("a damaged group index rejects the container")
+    {
+        std::vector<std::byte> image;
+        REQUIRE(Dispatcher.encodeAll(image).result);
+        image[sizeof(DataLayer::Persistence::ContainerHeader)] ^= std::byte{ 0x01 };
+        REQUIRE(Dispatcher.decodeAll(image).errorCode == SerializationError::InvalidFormat);
+        REQUIRE(Dispatcher.decodeAll(std::span{ image }.first(4)).errorCode == SerializationError::InvalidFormat);
+        REQUIRE(Dispatcher.deserializeAll("missing.bin").errorCode == SerializationError::InvalidFormat);
+    }
+
+    std::filesystem::remove("snapshot.bin");
+    counter = initialCounter;
+    errorCount = initialErrorCount;
+    Large::value005 = initialValue;
+}
+
+TEST_CASE("Test lazy group restore", "[Persistence]")
+{
+    const auto initialCounter = counter();
+    const auto initialErrorCount = errorCount();
+    const auto initialValue = Large::value005();
+
+    std::ignore = counter.set(11U);
+    std::ignore = errorCount.set(22U);
+    std::ignore = Large::value005.set(33.0F);
+    REQUIRE(Dispatcher.serializeAll("lazy.bin").result);
+    std::ignore = counter.set(0U);
+    std::ignore = errorCount.set(0U);
+    std::ignore = Large::value005.set(0.0F);
+
+    REQUIRE(Dispatcher.deserializeAllLazy("lazy.bin").result);
+    REQUIRE(Dispatcher.isRestorePending(ConfigGroup.group.baseId));
+    REQUIRE(Dispatcher.isRestorePending(DiagnosticGroup.group.baseId));
+    REQUIRE(counter() == 0U);
+
+    SECTION("first dispatcher access restores only the addressed group")
+    {
+        uint32_t value = 0;
+        REQUIRE(Dispatcher.getDatapoint(counter.getId(), value));
+        REQUIRE(value == 11U);
+        REQUIRE_FALSE(Dispatcher.isRestorePending(ConfigGroup.group.baseId));
+        REQUIRE(Dispatcher.isRestorePending(DiagnosticGroup.group.baseId));
+        REQUIRE(errorCount() == 0U);
+
+        // a write is applied on top of the restored group
+        REQUIRE(Dispatcher.setDatapoint(errorCount.getId(), uint32_t{ 99 }).success);
+        REQUIRE(errorCount() == 99U);
+        REQUIRE_FALSE(Dispatcher.isRestorePending(DiagnosticGroup.group.baseId));
+
+        REQUIRE(Dispatcher.restorePending().result);
+        REQUIRE(Large::value005() == 33.0F);
+        REQUIRE(Dispatcher.lazyRestoreStatus().result);
+    }
+
+    SECTION("explicit restore for direct datapoint access")
+    {
+        REQUIRE(Dispatcher.restoreGroup(LargeGroup.group.baseId).result);
+        REQUIRE(Large::value005() == 33.0F);
+        REQUIRE(counter() == 0U);
+        REQUIRE(Dispatcher.restorePending().result);
+        REQUIRE(counter() == 11U);
+    }
+
+    SECTION("restore on access by datapoint ID")
+    {
+        Dispatcher.restoreOnAccess(errorCount.getId());
+        REQUIRE_FALSE(Dispatcher.isRestorePending(DiagnosticGroup.group.baseId));
+        REQUIRE(Dispatcher.isRestorePending(ConfigGroup.group.baseId));
+        REQUIRE(errorCount() == 22U);
+        REQUIRE(Dispatcher.restorePending().result);
+    }
+
+    SECTION("a change callback may read another lazily restored group")
+    {
+        uint32_t seen = 0;
+        counter.setChangeCallback(
+          [](const uint32_t &, void *context) noexcept { std::ignore = Dispatcher.getDatapoint(errorCount.getId(), *static_cast<uint32_t *>(context)); }, &seen);
+        uint32_t value = 0;
+        REQUIRE(Dispatcher.getDatapoint(counter.getId(), value));
+        counter.clearChangeCallback();
+        REQUIRE(value == 11U);
+        REQUIRE(seen == 22U);
+        REQUIRE_FALSE(Dispatcher.isRestorePending(DiagnosticGroup.group.baseId));
+        REQUIRE(Dispatcher.lazyRestoreStatus().result);
+    }
+
+    SECTION("protocol table writes and reads restore the addressed group first")
+    {
+        std::array<std::byte, 64> request{};
+        std::array<std::byte, 64> response{};
+        DataLayer::Protocol::Request write{ request, DataLayer::Protocol::Operation::write, 1 };
+        REQUIRE(write.write(errorCount.getId(), uint32_t{ 99 }));
+        REQUIRE(ProtocolTable::Table.respond(write.message(), response) != 0U);
+        REQUIRE_FALSE(Dispatcher.isRestorePending(DiagnosticGroup.group.baseId));
+        REQUIRE(Dispatcher.isRestorePending(ConfigGroup.group.baseId));
+        REQUIRE(errorCount() == 99U);
+
+        // the server reads every served value when it is built
+        SocketServer server{ ProtocolTable::Table };
+        REQUIRE_FALSE(Dispatcher.isRestorePending(ConfigGroup.group.baseId));
+        REQUIRE(counter() == 11U);
+        REQUIRE(Dispatcher.restorePending().result);
+        REQUIRE(errorCount() == 99U);
+    }
+
+    SECTION("a replication follower restores the group of a record before it applies it")
+    {
+        DataLayer::Replication::Loopback link;
+        ReplicationFollower follower{ Dispatcher, link.follower() };
+        std::array<std::byte, sizeof(DataLayer::Replication::MessageHeader) + sizeof(DataLayer::Replication::RecordHeader) + sizeof(uint32_t)> message{};
+        const DataLayer::Replication::MessageHeader header{ .kind = DataLayer::Replication::Kind::snapshot, .flags = DataLayer::Replication::LastSnapshotFlag, .count = 1, .sequence = 1 };
+        const DataLayer::Replication::RecordHeader record{ .dataPointId = errorCount.getId(), .size = sizeof(uint32_t) };
+        const uint32_t value = 99;
+        std::memcpy(message.data(), &header, sizeof(header));
+        std::memcpy(&message[sizeof(header)], &record, sizeof(record));
+        std::memcpy(&message[sizeof(header) + sizeof(record)], &value, sizeof(value));
+        REQUIRE(link.leader().send(message));
+        REQUIRE(follower.pump() == 1U);
+        REQUIRE_FALSE(Dispatcher.isRestorePending(DiagnosticGroup.group.baseId));
+        REQUIRE(Dispatcher.restorePending().result);
+        REQUIRE(errorCount() == 99U);
+    }
+
+    SECTION("snapshot restores pending groups before it is written")
+    {
+        REQUIRE(Dispatcher.serializeAll("lazy.bin").result);
+        REQUIRE_FALSE(Dispatcher.isRestorePending(LargeGroup.group.baseId));
+        std::ignore = Large::value005.set(0.0F);
+        REQUIRE(Dispatcher.deserializeAll("lazy.bin").result);
+        REQUIRE(Large::value005() == 33.0F);
+    }
+
+    SECTION("an invalid file leaves nothing pending")
+    {
+        REQUIRE(Dispatcher.deserializeAllLazy("missing.bin").errorCode == SerializationError::InvalidFormat);
+        REQUIRE_FALSE(Dispatcher.isRestorePending(ConfigGroup.group.baseId));
+        uint32_t value = 0;
+        REQUIRE(Dispatcher.getDatapoint(counter.getId(), value));
+        REQUIRE(value == 0U);
+    }
+
+    REQUIRE(Dispatcher.restorePending().result);
+    std::filesystem::remove("lazy.bin");
+    counter = initialCounter;
+    errorCount = initialErrorCount;
+    Large::value005 = initialValue;
+}
+
+TEST_CASE("Test write-behind persistence worker", "[Persistence]")
+{
+    const auto initialCounter = counter();
+    const auto initialErrorCount = errorCount();
+    std::filesystem::create_directories("worker");
+
+    SECTION("group snapshot is taken at submit time and written durably")
+    {
+        DataLayer::Persistence::Worker worker;
+        std::ignore = counter.set(5U);
+        auto pending = worker.submit(ConfigGroup, "worker/config.bin");
+        std::ignore = counter.set(6U);
+
+        const auto status = pending.get();
+        REQUIRE(status.result);
+        REQUIRE(status.errorCode == SerializationError::None);
+        REQUIRE(ConfigGroup.deserializeGroup(std::filesystem::path{ "worker/config.bin" }).result);
+        REQUIRE(counter() == 5U);
+
+        const auto metrics = worker.metrics();
+        REQUIRE(metrics.queueDepth == 0U);
+        REQUIRE(metrics.completed == 1U);
+        REQUIRE(metrics.fileSyncs == 1U);
+        REQUIRE(metrics.directorySyncs == 1U);
+    }
+
+    SECTION("many submits are batched and coalesced per file")
+    {
+        DataLayer::Persistence::Worker worker;
+        std::vector<std::future<SerializationStatus>> pending;
+        for (uint32_t value = 1; value <= 50; ++value)
+        {
+            std::ignore = counter.set(value);
+            std::ignore = errorCount.set(value);
+            pending.push_back(worker.submit(ConfigGroup, "worker/config.bin"));
+            pending.push_back(worker.submit(DiagnosticGroup, "worker/diagnostic.bin"));
+        }
+        worker.flush();
+        for (auto &future : pending)
+        {
+            REQUIRE(future.get().result);
+        }
+
+        const auto metrics = worker.metrics();
+        REQUIRE(metrics.queueDepth == 0U);
+        REQUIRE(metrics.maxQueueDepth >= 1U);
+        REQUIRE(metrics.completed + metrics.coalesced == 100U);
+        REQUIRE(metrics.failed == 0U);
+        REQUIRE(metrics.directorySyncs <= metrics.batches);
+        REQUIRE(metrics.maxLatency >= metrics.lastLatency);
+
+        std::ignore = counter.set(0U);
+        std::ignore = errorCount.set(0U);
+        REQUIRE(ConfigGroup.deserializeGroup(std::filesystem::path{ "worker/config.bin" }).result);
+        REQUIRE(DiagnosticGroup.deserializeGroup(std::filesystem::path{ "worker/diagnostic.bin" }).result);
+        REQUIRE(counter() == 50U);
+        REQUIRE(errorCount() == 50U);
+    }
+
+    SECTION("dispatcher snapshot is written as container and pending writes finish on destruction")
+    {
+        std::ignore = errorCount.set(77U);
+        {
+            DataLayer::Persistence::Worker worker;
+            std::ignore = worker.submit(Dispatcher, "worker/snapshot.bin");
+        }
+        std::ignore = errorCount.set(0U);
+        REQUIRE(Dispatcher.deserializeAll("worker/snapshot.bin").result);
+        REQUIRE(errorCount() == 77U);
+    }
+
+    SECTION("failed writes are reported through the handle and the metrics")
+    {
+        DataLayer::Persistence::Worker worker;
+        const auto status = worker.submit(ConfigGroup, "worker/missing/config.bin").get();
+        REQUIRE_FALSE(status.result);
+        REQUIRE(status.errorCode == SerializationError::StorageFailure);
+        REQUIRE(worker.metrics().failed == 1U);
+    }
+
+    std::filesystem::remove_all("worker");
+    counter = initialCounter;
+    errorCount = initialErrorCount;
+}
+
+TEST_CASE("Test persistence checksums", "[Checksum]")
+{
+    constexpr std::string_view check{ "123456789" };
+    const auto checkBytes = std::as_bytes(std::span{ check });
+
+    SECTION("check values of both algorithms")
+    {
+        REQUIRE(DataLayer::Persistence::crc32(checkBytes) == 0xCBF43926U);
+        REQUIRE(DataLayer::Persistence::crc32c(checkBytes) == 0xE3069283U);
+        REQUIRE(DataLayer::Persistence::SoftwareCrc32c::compute(checkBytes) == 0xE3069283U);
+        if (DataLayer::Persistence::HardwareCrc32c::available())
+        {
+            REQUIRE(DataLayer::Persistence::HardwareCrc32c::compute(checkBytes) == 0xE3069283U);
+        }
+        REQUIRE(DataLayer::Persistence::crc32({}) == 0U);
+    }
+
+    SECTION("slicing variants agree for every length and alignment")
+    {
+        std::vector<std::byte> data(300);
+        for (size_t index = 0; index < data.size(); ++index)
+        {
+            data[index] = static_cast<std::byte>((index * 131U + 7U) & 0xFFU);
+        }
+        for (size_t offset = 0; offset < 8; ++offset)
+        {
+            for (size_t length = 0; length + offset <= 64; ++length)
+            {
+                const auto input = std::span<const std::byte>{ data }.subspan(offset, length);
+                const auto expected = DataLayer::Persistence::TableCrc<DataLayer::Persistence::Crc32Polynomial, 1>::compute(input);
+                REQUIRE((DataLayer::Persistence::TableCrc<DataLayer::Persistence::Crc32Polynomial, 4>::compute(input)) == expected);
+                REQUIRE((DataLayer::Persistence::TableCrc<DataLayer::Persistence::Crc32Polynomial, 8>::compute(input)) == expected);
+                REQUIRE((DataLayer::Persistence::TableCrc<DataLayer::Persistence::Crc32Polynomial, 16>::compute(input)) == expected);
+                REQUIRE(DataLayer::Persistence::crc32c(input) == DataLayer::Persistence::TableCrc<DataLayer::Persistence::Crc32cPolynomial, 1>::compute(input));
+            }
+        }
+    }
+
+    SECTION("format version 1 files checksummed with CRC32 still restore")
+    {
+        const auto &group = ConfigGroup.group;
+        const auto initialCounter = counter();
+        std::vector<std::byte> records;
+        appendRecord(records, counter.getId(), counter.getVersion(), uint32_t{ 4711 });
+        std::vector<std::byte> image;
+        DataLayer::Persistence::append(
+          image, DataLayer::Persistence::LegacyHeader{ .groupId = group.baseId, .groupVersion = group.version, .checksum = DataLayer::Persistence::crc32(records) });
+        image.insert(image.end(), records.begin(), records.end());
+
+        const auto status = Deserialization(group.version, group.baseId, ConfigGroup.datapoints, group.allowUpgrade).decode(image);
+        REQUIRE(status.result);
+        REQUIRE(counter() == 4711U);
+
+        image[sizeof(DataLayer::Persistence::LegacyHeader)] ^= std::byte{ 1 };
+        REQUIRE(Deserialization(group.version, group.baseId, ConfigGroup.datapoints, group.allowUpgrade).decode(image).errorCode == SerializationError::ChecksumMismatch);
+        counter = initialCounter;
+    }
+
+    SECTION("unknown checksum algorithm is rejected")
+    {
+        const auto &group = ConfigGroup.group;
+        std::vector<std::byte> image;
+        REQUIRE(Serialization(group.version, group.baseId, ConfigGroup.datapoints).encode(image).result);
+        DataLayer::Persistence::Header header{};
+        std::memcpy(&header, image.data(), sizeof(header));
+        REQUIRE(header.checksumAlgorithm == DataLayer::Persistence::ChecksumAlgorithm::Crc32c);
+        header.checksumAlgorithm = static_cast<DataLayer::Persistence::ChecksumAlgorithm>(7);
+        std::memcpy(image.data(), &header, sizeof(header));
+        REQUIRE(Deserialization(group.version, group.baseId, ConfigGroup.datapoints, group.allowUpgrade).decode(image).errorCode == SerializationError::InvalidFormat);
+    }
+}
+
+TEST_CASE("Test string datapoints", "[Persistence]")
+{
+    using Name = DataLayer::InlineString<32>;
+    const auto initialName = deviceName();
+    const auto &group = DiagnosticGroup.group;
+
+    SECTION("inline string is trivially copyable and keeps its content when a text does not fit")
+    {
+        STATIC_REQUIRE(std::is_trivially_copyable_v<Name>);
+        STATIC_REQUIRE(DataLayer::VariableSize<Name>);
+        STATIC_REQUIRE(Name{ "unnamed" }.size() == 7);
+        REQUIRE(deviceName() == "unnamed");
+
+        Name name{ "pump" };
+        REQUIRE(name.assign("pump-7"));
+        REQUIRE_FALSE(name.assign(std::string(Name::capacity() + 1U, 'x')));
+        REQUIRE(name == "pump-7");
+        REQUIRE(name.bytes().size() == 6);
+    }
+
+    SECTION("record holds only the used bytes and restores every length up to the capacity")
+    {
+        std::ignore = deviceName.set(Name{ "pump-7" });
+        std::vector<std::byte> image;
+        REQUIRE(Serialization(group.version, group.baseId, DiagnosticGroup.datapoints).encode(image).result);
+        const auto fixedRecords = 2U * sizeof(DataLayer::Persistence::RecordHeader) + sizeof(uint32_t) + sizeof(uint16_t);
+        REQUIRE(image.size() == sizeof(DataLayer::Persistence::Header) + fixedRecords + sizeof(DataLayer::Persistence::RecordHeader) + 6U);
+
+        std::ignore = deviceName.set(Name{});
+        REQUIRE(DiagnosticGroup.decodeGroup(image).result);
+        REQUIRE(deviceName() == "pump-7");
+
+        for (const auto *text : { "", "x", "a name that uses all of 32 bytes" })
+        {
+            Name name{};
+            REQUIRE(name.assign(text));
+            std::ignore = deviceName.set(name);
+            REQUIRE(DiagnosticGroup.encodeGroup(image).result);
+            std::ignore = deviceName.set(Name{ "other" });
+            REQUIRE(DiagnosticGroup.decodeGroup(image).result);
+            REQUIRE(deviceName() == name);
+        }
+    }
+
+    SECTION("record longer than the capacity is rejected")
+    {
+        std::vector<std::byte> records;
+        const std::vector<std::byte> text(Name::capacity() + 1U, std::byte{ 'x' });
+        DataLayer::Persistence::append(
+          records, DataLayer::Persistence::RecordHeader{ .dataPointId = deviceName.getId(), .version = deviceName.getVersion(), .payloadSize = static_cast<uint32_t>(text.size()) });
+        records.insert(records.end(), text.begin(), text.end());
+        const auto image = makeImage(group.baseId, group.version, records);
+
+        const auto status = Deserialization(group.version, group.baseId, DiagnosticGroup.datapoints, group.allowUpgrade).decode(image);
+        REQUIRE_FALSE(status.result);
+        REQUIRE(status.errorCode == SerializationError::InvalidFormat);
+        REQUIRE(deviceName() == initialName);
+    }
+
+    SECTION("transport sends the used bytes, the frame length is the string length")
+    {
+        RecordingBus bus;
+        DataLayer::Can::Adapter can{ bus, Dispatcher };
+        REQUIRE(can.publish(deviceName.getId(), Name{ "pump-7" }) == DataLayer::Can::Result::ok);
+        REQUIRE(bus.last.length == 6U);
+        REQUIRE(can.publish(deviceName.getId(), Name{ "longer than a classic frame" }) == DataLayer::Can::Result::payloadTooLarge);
+
+        bus.last.payload[0] = std::byte{ 'P' };
+        REQUIRE(can.applySet<Name>(bus.last) == DataLayer::Can::Result::ok);
+        REQUIRE(deviceName() == "Pump-7");
+
+        RecordingClient client;
+        DataLayer::Mqtt::Adapter mqtt{ client, Dispatcher };
+        REQUIRE(mqtt.publish("diagnostic/deviceName", deviceName()) == DataLayer::Mqtt::Result::ok);
+        REQUIRE(client.last.size() == 6U);
+        const std::vector<std::byte> tooLong(Name::capacity() + 1U, std::byte{ 'x' });
+        REQUIRE(mqtt.applySet<Name>(deviceName.getId(), tooLong) == DataLayer::Mqtt::Result::invalidPayload);
+        REQUIRE(mqtt.applySet<Name>(deviceName.getId(), std::span{ client.last }.first(4)) == DataLayer::Mqtt::Result::ok);
+        REQUIRE(deviceName() == "Pump");
+    }
+
+    deviceName = initialName;
+}
+
+TEST_CASE("Test group image delta", "[Persistence]")
+{
+    const auto initialSetpoint = setpoint();
+    const auto initialCounter = counter();
+    const auto &group = ConfigGroup.group;
+    std::vector<std::byte> base;
+    REQUIRE(ConfigGroup.encodeGroup(base).result);
+
+    SECTION("only changed records are shipped and patched in place")
+    {
+        std::ignore = counter.set(counter() + 1U);
+        std::ignore = setpoint.set(19.0F);
+        std::vector<std::byte> target;
+        REQUIRE(ConfigGroup.encodeGroup(target).result);
+
+        std::vector<std::byte> delta;
+        REQUIRE(DataLayer::Persistence::makeDelta(base, target, delta).result);
+        const auto changedRecords = 2U * sizeof(DataLayer::Persistence::RecordHeader) + sizeof(uint32_t) + sizeof(float);
+        REQUIRE(delta.size() == sizeof(DataLayer::Persistence::DeltaHeader) + changedRecords);
+
+        auto image = base;
+        const auto *storage = image.data();
+        REQUIRE(DataLayer::Persistence::applyDelta(image, delta).result);
+        REQUIRE(image == target);
+        REQUIRE(image.data() == storage);
+
+        std::vector<std::byte> unchanged;
+        REQUIRE(DataLayer::Persistence::makeDelta(target, target, unchanged).result);
+        REQUIRE(unchanged.size() == sizeof(DataLayer::Persistence::DeltaHeader));
+    }
+
+    SECTION("added, removed and resized records rebuild the image in target order")
+    {
+        std::vector<std::byte> records;
+        appendRecord(records, static_cast<uint16_t>(0x10F0), setpoint.getVersion(), uint64_t{ 7 });
+        appendRecord(records, counter.getId(), counter.getVersion(), uint64_t{ 99 });
+        appendRecord(records, setpoint.getId(), setpoint.getVersion(), initialSetpoint);
+        const auto target = makeImage(group.baseId, DataLayer::Version{ 1, 1, 0 }, records);
+
+        std::vector<std::byte> delta;
+        REQUIRE(DataLayer::Persistence::makeDelta(base, target, delta).result);
+        auto image = base;
+        REQUIRE(DataLayer::Persistence::applyDelta(image, delta).result);
+        REQUIRE(image == target);
+    }
+
+    SECTION("a delta is rejected for another base and when it is damaged")
+    {
+        std::ignore = counter.set(counter() + 5U);
+        std::vector<std::byte> target;
+        REQUIRE(ConfigGroup.encodeGroup(target).result);
+        std::vector<std::byte> delta;
+        REQUIRE(DataLayer::Persistence::makeDelta(base, target, delta).result);
+
+        auto other = target;
+        const auto status = DataLayer::Persistence::applyDelta(other, delta);
+        REQUIRE_FALSE(status.result);
+        REQUIRE(status.errorCode == SerializationError::ChecksumMismatch);
+        REQUIRE(other == target);
+
+        auto damaged = delta;
+        damaged.back() ^= std::byte{ 0x10 };
+        auto image = base;
+        REQUIRE(DataLayer::Persistence::applyDelta(image, damaged).errorCode == SerializationError::ChecksumMismatch);
+        REQUIRE(image == base);
+
+        std::vector<std::byte> diagnostic;
+        REQUIRE(DiagnosticGroup.encodeGroup(diagnostic).result);
+        REQUIRE(DataLayer::Persistence::makeDelta(base, diagnostic, delta).errorCode == SerializationError::GroupIdMismatch);
+    }
+
+    SECTION("files are diffed and patched through the file API")
+    {
+        REQUIRE(DataLayer::Persistence::writeFile("delta-base.bin", base));
+        std::ignore = counter.set(counter() + 9U);
+        REQUIRE(ConfigGroup.serializeGroup(std::filesystem::path{ "delta-target.bin" }).result);
+
+        REQUIRE(DataLayer::Persistence::makeDelta("delta-base.bin", "delta-target.bin", "config.delta").result);
+        REQUIRE(DataLayer::Persistence::applyDelta("delta-base.bin", "config.delta").result);
+        std::ignore = counter.set(initialCounter);
+        REQUIRE(ConfigGroup.deserializeGroup(std::filesystem::path{ "delta-base.bin" }).result);
+        REQUIRE(counter() == initialCounter + 9U);
+    }
+
+    setpoint = initialSetpoint;
+    counter = initialCounter;
+}
+
+TEST_CASE("Test packed flag datapoints", "[Persistence]")
+{
+    const auto &group = StatusGroup.group;
+    const auto initial = StatusGroupPacked();
+
+    SECTION("flags occupy single bits of one store and start with their defaults")
+    {
+        STATIC_REQUIRE(std::is_empty_v<std::remove_cvref_t<decltype(statusFlag00)>>);
+        STATIC_REQUIRE(sizeof(StatusGroupPacked) == 2U * sizeof(uint32_t) + sizeof(uint32_t));
+        STATIC_REQUIRE(sizeof(StatusGroupPacked) * 8U < 40U * sizeof(DataLayer::DataPoint<bool, StatusGroupInfo, 0x1, Helper::READ_WRITE>));
+        REQUIRE(statusFlag00());
+        REQUIRE_FALSE(statusFlag01());
+        REQUIRE(statusFlag03());
+        REQUIRE(statusFlag39());
+        REQUIRE(pumpState() == PumpState::Running);
+        REQUIRE(faultCode() == 0U);
+    }
+
+    SECTION("bits are set and cleared individually through the datapoint and the dispatcher")
+    {
+        REQUIRE(statusFlag01.set(true) == DataLayer::Detail::RangeCheck::ok);
+        REQUIRE(statusFlag01());
+        REQUIRE(statusFlag00());
+        REQUIRE_FALSE(statusFlag02());
+        statusFlag00 = false;
+        REQUIRE_FALSE(statusFlag00());
+        REQUIRE(statusFlag01());
+
+        REQUIRE(Dispatcher.setDatapoint(statusFlag33.getId(), false).success);
+        REQUIRE_FALSE(statusFlag33());
+        bool value = false;
+        REQUIRE(Dispatcher.getDatapoint(statusFlag01.getId(), value));
+        REQUIRE(value);
+        REQUIRE(Dispatcher.setDatapoint(0xA000U + 106U, true).success);
+        REQUIRE(statusFlag05());
+        REQUIRE_FALSE(Dispatcher.setDatapoint(statusFlag39.getId(), false).success);
+        REQUIRE(statusFlag39());
+    }
+
+    SECTION("enum fields keep their width and reject values that do not fit")
+    {
+        REQUIRE(pumpState.set(PumpState::Fault) == DataLayer::Detail::RangeCheck::ok);
+        REQUIRE(pumpState() == PumpState::Fault);
+        REQUIRE(statusFlag39());
+        REQUIRE(pumpState.set(static_cast<PumpState>(4)) == DataLayer::Detail::RangeCheck::overflow);
+        REQUIRE(pumpState() == PumpState::Fault);
+        REQUIRE(Dispatcher.setDatapoint(pumpState.getId(), PumpState::Off).success);
+        REQUIRE(pumpState() == PumpState::Off);
+    }
+
+    SECTION("the whole bitfield is one record")
+    {
+        using Image = std::remove_cvref_t<decltype(StatusGroupPacked)>::Image;
+        statusFlag00 = false;
+        statusFlag17 = true;
+        pumpState = PumpState::Starting;
+        std::ignore = faultCode.set(7);
+
+        std::vector<std::byte> image;
+        REQUIRE(StatusGroup.encodeGroup(image).result);
+        REQUIRE(image.size() == sizeof(DataLayer::Persistence::Header) + 2U * sizeof(DataLayer::Persistence::RecordHeader) + sizeof(Image) + sizeof(uint16_t));
+
+        statusFlag00 = true;
+        statusFlag17 = false;
+        pumpState = PumpState::Off;
+        std::ignore = faultCode.set(0);
+        REQUIRE(StatusGroup.decodeGroup(image).result);
+        REQUIRE_FALSE(statusFlag00());
+        REQUIRE(statusFlag17());
+        REQUIRE(pumpState() == PumpState::Starting);
+        REQUIRE(faultCode() == 7U);
+    }
+
+    SECTION("records of individual flags written before packing are still restored")
+    {
+        std::vector<std::byte> records;
+        appendRecord(records, statusFlag02.getId(), statusFlag02.getVersion(), true);
+        appendRecord(records, pumpState.getId(), pumpState.getVersion(), PumpState::Fault);
+        REQUIRE(StatusGroup.decodeGroup(makeImage(group.baseId, group.version, records)).result);
+        REQUIRE(statusFlag02());
+        REQUIRE(pumpState() == PumpState::Fault);
+    }
+
+    SECTION("a record of another field layout leaves the flags untouched")
+    {
+        std::vector<std::byte> image;
+        std::tuple<decltype(foreignStatus) &> foreign{ foreignStatus };
+        REQUIRE(Serialization(group.version, group.baseId, foreign).encode(image).result);
+        statusFlag02 = true;
+        const auto status = StatusGroup.decodeGroup(image);
+        REQUIRE_FALSE(status.result);
+        REQUIRE(status.errorCode == SerializationError::DatapointVersion);
+        REQUIRE(statusFlag02());
+        REQUIRE(statusFlag00());
+    }
+
+    SECTION("concurrent writers of neighbouring bits do not lose updates")
+    {
+        constexpr size_t Rounds = 10000;
+        {
+            std::jthread first([] {
+                for (size_t round = 0; round < Rounds; ++round)
+                {
+                    statusFlag08 = round % 2U == 0U;
+                }
+            });
+            std::jthread second([] {
+                for (size_t round = 0; round < Rounds; ++round)
+                {
+                    statusFlag09 = round % 2U == 0U;
+                    pumpState = round % 2U == 0U ? PumpState::Fault : PumpState::Starting;
+                }
+            });
+            for (size_t round = 0; round < Rounds; ++round)
+            {
+                statusFlag10 = round % 2U != 0U;
+            }
+        }
+        REQUIRE_FALSE(statusFlag08());
+        REQUIRE_FALSE(statusFlag09());
+        REQUIRE(statusFlag10());
+        REQUIRE(pumpState() == PumpState::Starting);
+    }
+
+    REQUIRE(StatusGroupPacked.restore(std::as_bytes(std::span{ &initial, 1 })));
+    std::ignore = faultCode.set(0);
+}
+
+TEST_CASE("Test CAN signal messages", "[Can]")
+{
+    using PumpStatus = CanMessages::PumpStatus;
+    using Result = DataLayer::Can::Result;
+    const auto initial = StatusGroupPacked();
+    RecordingBus bus;
+    DataLayer::Can::Adapter can{ bus, Dispatcher };
+
+    SECTION("flags, enum and fault code share one frame")
+    {
+        STATIC_REQUIRE(PumpStatus::signalCount == 11);
+        std::ignore = faultCode.set(0x1234);
+        REQUIRE(can.publishMessage<PumpStatus>() == Result::ok);
+        REQUIRE(bus.last.identifier == 0x180U);
+        REQUIRE(bus.last.length == 8);
+        // statusFlag00, 03 and 06 default to true, pumpState is Running and statusFlag39 true
+        const std::array expected{ std::byte{ 0x49 }, std::byte{ 0x02 }, std::byte{ 0x34 }, std::byte{ 0x12 }, std::byte{ 0x01 }, std::byte{ 0x00 }, std::byte{ 0x00 }, std::byte{ 0x00 } };
+        REQUIRE(std::ranges::equal(std::span{ bus.last.payload }.first(8), expected));
+    }
+
+    SECTION("a received frame updates every writable signal")
+    {
+        DataLayer::Can::Frame frame{ .identifier = 0x180, .length = 8 };
+        frame.payload[0] = std::byte{ 0xB6 };
+        frame.payload[1] = std::byte{ 0x03 };
+        frame.payload[2] = std::byte{ 0xEF };
+        frame.payload[3] = std::byte{ 0xBE };
+        REQUIRE(can.applyMessage<PumpStatus>(frame) == Result::ok);
+        REQUIRE_FALSE(statusFlag00());
+        REQUIRE(statusFlag01());
+        REQUIRE(statusFlag02());
+        REQUIRE_FALSE(statusFlag03());
+        REQUIRE(statusFlag07());
+        REQUIRE(pumpState() == PumpState::Fault);
+        REQUIRE(faultCode() == 0xBEEFU);
+        // read only datapoints are only sent
+        REQUIRE(statusFlag39());
+    }
+
+    SECTION("frames of another length or identifier are not applied")
+    {
+        DataLayer::Can::Frame frame{ .identifier = 0x180, .length = 4 };
+        REQUIRE(can.applyMessage<PumpStatus>(frame) == Result::invalidPayload);
+        frame = { .identifier = 0x181, .length = 8 };
+        REQUIRE(can.applyMessage<PumpStatus>(frame) == Result::invalidPayload);
+        REQUIRE(statusFlag00());
+    }
+
+    REQUIRE(StatusGroupPacked.restore(std::as_bytes(std::span{ &initial, 1 })));
+    std::ignore = faultCode.set(0);
+}
+
+TEST_CASE("Test CAN acceptance filters", "[Can]")
+{
+    SECTION("filters and bitmap admit writable datapoints, legacy IDs and messages only")
+    {
+        REQUIRE(CanFilter::Accepted.contains(statusFlag00.getId()));
+        REQUIRE(CanFilter::Accepted.contains(0xA000U + 106U));
+        REQUIRE(CanFilter::Accepted.contains(CanMessages::PumpStatus::identifier));
+        REQUIRE_FALSE(CanFilter::Accepted.contains(statusFlag39.getId()));
+        REQUIRE_FALSE(CanFilter::Accepted.contains(StatusGroupPacked.getId()));
+        REQUIRE_FALSE(CanFilter::Accepted.contains(0x181));
+        REQUIRE(DataLayer::Can::accepts(CanFilter::Filters, statusFlag00.getId()));
+        REQUIRE_FALSE(DataLayer::Can::accepts(CanFilter::Filters, statusFlag39.getId()));
+    }
+
+    SECTION("the generated filters are exact")
+    {
+        size_t admitted = 0;
+        size_t mismatches = 0;
+        for (uint32_t identifier = 0; identifier <= 0xFFFFU; ++identifier)
+        {
+            const bool accepted = CanFilter::Accepted.contains(identifier);
+            mismatches += DataLayer::Can::accepts(CanFilter::Filters, identifier) != accepted ? 1U : 0U;
+            admitted += accepted ? 1U : 0U;
+        }
+        REQUIRE(mismatches == 0U);
+        REQUIRE(admitted > 40U);
+        REQUIRE_FALSE(DataLayer::Can::accepts(CanFilter::Filters, 0x10000000U + statusFlag00.getId()));
+    }
+
+    SECTION("merged filters fit the controller banks and still admit every writable identifier")
+    {
+        constexpr auto banks = DataLayer::Can::mergeFilters<4>(CanFilter::Filters);
+        STATIC_REQUIRE(banks.size() == 4);
+        size_t missed = 0;
+        size_t extra = 0;
+        for (uint32_t identifier = 0; identifier <= 0xFFFFU; ++identifier)
+        {
+            const bool passes = DataLayer::Can::accepts(banks, identifier);
+            const bool accepted = CanFilter::Accepted.contains(identifier);
+            missed += (accepted && !passes) ? 1U : 0U;
+            extra += (passes && !accepted) ? 1U : 0U;
+        }
+        REQUIRE(missed == 0U);
+        REQUIRE(extra > 0U);
+    }
+}
+
+TEST_CASE("Test MQTT topic routing", "[Mqtt]")
+{
+    using Result = DataLayer::Mqtt::Result;
+    const auto initialSetpoint = setpoint();
+    const auto initialPump = pumpState();
+    RecordingClient client;
+    DataLayer::Mqtt::Adapter mqtt{ client, Dispatcher };
+
+    SECTION("topics are built from group, namespace and name")
+    {
+        STATIC_REQUIRE(DataLayer::Mqtt::Topic<setpoint> == "ConfigGroup/setpoint");
+        STATIC_REQUIRE(DataLayer::Mqtt::Topic<Archive::archive0_07> == "ArchiveGroup0/Archive/archive0_07");
+        STATIC_REQUIRE(DataLayer::Mqtt::Topic<pumpState> == "StatusGroup/pumpState");
+        // same values as in testGeneratorFunctions.py, the generator places the topics with this hash
+        STATIC_REQUIRE(DataLayer::Mqtt::topicHash("", 0) == 0xAB3E7C0BU);
+        STATIC_REQUIRE(DataLayer::Mqtt::topicHash("DefaultGroup/test", 7) == 0xB1EFB4EFU);
+    }
+
+    SECTION("every writable topic resolves to its own route")
+    {
+        size_t routes = 0;
+        size_t resolved = 0;
+        for (const auto &route : MqttTopics::Router.routes)
+        {
+            routes += route.apply != nullptr ? 1U : 0U;
+            resolved += route.apply != nullptr && MqttTopics::Router.find(route.topic) == &route ? 1U : 0U;
+        }
+        REQUIRE(routes > 500U);
+        REQUIRE(resolved == routes);
+        STATIC_REQUIRE(MqttTopics::Router.find("ConfigGroup/setpoint")->dataPointId == setpoint.getId());
+    }
+
+    SECTION("a routed payload is applied through the typed setter")
+    {
+        REQUIRE(mqtt.publish(DataLayer::Mqtt::Topic<setpoint>, initialSetpoint + 5U) == Result::ok);
+        setpoint = initialSetpoint;
+        REQUIRE(MqttTopics::Router.apply(mqtt, "ConfigGroup/setpoint", client.last) == Result::ok);
+        REQUIRE(setpoint() == initialSetpoint + 5U);
+
+        REQUIRE(mqtt.publish(DataLayer::Mqtt::Topic<pumpState>, PumpState::Starting) == Result::ok);
+        REQUIRE(MqttTopics::Router.apply(mqtt, DataLayer::Mqtt::Topic<pumpState>, client.last) == Result::ok);
+        REQUIRE(pumpState() == PumpState::Starting);
+        REQUIRE(MqttTopics::Router.apply(mqtt, DataLayer::Mqtt::Topic<setpoint>, std::span{ client.last }.first(0)) == Result::invalidPayload);
+    }
+
+    SECTION("unknown, partial and read-only topics are not routed")
+    {
+        REQUIRE(MqttTopics::Router.apply(mqtt, "ConfigGroup/unknown", client.last) == Result::unknownTopic);
+        REQUIRE(MqttTopics::Router.apply(mqtt, "ConfigGroup/setpoin", client.last) == Result::unknownTopic);
+        REQUIRE(MqttTopics::Router.apply(mqtt, "", client.last) == Result::unknownTopic);
+        REQUIRE(MqttTopics::Router.find(DataLayer::Mqtt::Topic<statusFlag39>) == nullptr);
+    }
+
+    setpoint = initialSetpoint;
+    pumpState = initialPump;
+}
+
+TEST_CASE("Test MQTT group batches", "[Mqtt]")
+{
+    using Result = DataLayer::Mqtt::Result;
+    const auto initialSetpoint = setpoint();
+    const auto initialCounter = counter();
+    const auto initialName = deviceName();
+    const auto initialFlags = StatusGroupPacked();
+    RecordingClient client;
+    DataLayer::Mqtt::Adapter mqtt{ client, Dispatcher };
+
+    SECTION("the first batch carries the group, later ones only changed datapoints")
+    {
+        DataLayer::Mqtt::GroupBatch batch{ ConfigGroup };
+        REQUIRE(mqtt.publishGroup("plant/config", batch) == Result::ok);
+        REQUIRE(client.messages == 1);
+        // header, five record headers, float, uint8_t, uint32_t, two floats and eight int16_t
+        REQUIRE(client.last.size() == 4U + 5U * 4U + 4U + 1U + 4U + 8U + 16U);
+
+        REQUIRE(mqtt.publishGroup("plant/config", batch) == Result::ok);
+        REQUIRE(client.messages == 1);
+
+        setpoint = initialSetpoint + 1.0F;
+        counter = initialCounter + 1U;
+        REQUIRE(mqtt.publishGroup("plant/config", batch) == Result::ok);
+        REQUIRE(client.messages == 2);
+        REQUIRE(client.last.size() == 4U + 2U * 4U + 4U + 4U);
+        REQUIRE(std::to_integer<uint8_t>(client.last[2]) == 2U);
+
+        batch.invalidate();
+        REQUIRE(mqtt.publishGroup("plant/config", batch) == Result::ok);
+        REQUIRE(client.last.size() == 4U + 5U * 4U + 33U);
+    }
+
+    SECTION("a failed publish is repeated by the next cycle")
+    {
+        DataLayer::Mqtt::GroupBatch batch{ DiagnosticGroup };
+        client.fail = true;
+        REQUIRE(mqtt.publishGroup("plant/diagnostic", batch) == Result::publishFailed);
+        client.fail = false;
+        REQUIRE(mqtt.publishGroup("plant/diagnostic", batch) == Result::ok);
+        REQUIRE(client.messages == 1);
+
+        // strings are sent with their used length
+        deviceName = DataLayer::InlineString<32>{ "pump-7" };
+        REQUIRE(mqtt.publishGroup("plant/diagnostic", batch) == Result::ok);
+        REQUIRE(client.last.size() == 4U + 4U + 6U);
+    }
+
+    SECTION("a received batch is applied through the typed setters")
+    {
+        DataLayer::Mqtt::GroupBatch batch{ ConfigGroup };
+        REQUIRE(mqtt.publishGroup("plant/config", batch) == Result::ok);
+        setpoint = 30.0F;
+        counter = 77U;
+        REQUIRE(mqtt.publishGroup("plant/config", batch) == Result::ok);
+        const auto message = client.last;
+        setpoint = initialSetpoint;
+        counter = initialCounter;
+
+        REQUIRE(mqtt.applyGroup(batch, message) == Result::ok);
+        REQUIRE(setpoint() == 30.0F);
+        REQUIRE(counter() == 77U);
+    }
+
+    SECTION("malformed batches are rejected before any write")
+    {
+        DataLayer::Mqtt::GroupBatch batch{ ConfigGroup };
+        setpoint = 30.0F;
+        REQUIRE(mqtt.publishGroup("plant/config", batch) == Result::ok);
+        auto message = client.last;
+        setpoint = initialSetpoint;
+
+        REQUIRE(mqtt.applyGroup(batch, std::span{ message }.first(message.size() - 1U)) == Result::invalidPayload);
+        message.push_back(std::byte{ 0 });
+        REQUIRE(mqtt.applyGroup(batch, message) == Result::invalidPayload);
+        message.pop_back();
+        message[0] = std::byte{ 0x42 };
+        REQUIRE(mqtt.applyGroup(batch, message) == Result::invalidPayload);
+        REQUIRE(mqtt.applyGroup(batch, std::span{ message }.first(3)) == Result::invalidPayload);
+        REQUIRE(setpoint() == initialSetpoint);
+    }
+
+    SECTION("packed stores are left out and read-only records are rejected")
+    {
+        DataLayer::Mqtt::GroupBatch batch{ StatusGroup };
+        REQUIRE(mqtt.publishGroup("plant/status", batch) == Result::ok);
+        // 40 flags, pumpState and faultCode without the store image
+        REQUIRE(std::to_integer<uint8_t>(client.last[2]) == 42U);
+        statusFlag01 = true;
+        REQUIRE(mqtt.applyGroup(batch, client.last) == Result::rejected);
+        REQUIRE_FALSE(statusFlag01());
+    }
+
+    setpoint = initialSetpoint;
+    counter = initialCounter;
+    deviceName = initialName;
+    REQUIRE(StatusGroupPacked.restore(std::as_bytes(std::span{ &initialFlags, 1 })));
+}
+
+TEST_CASE("Test datapoint write trace", "[Trace]")
+{
+    using Name = DataLayer::InlineString<32>;
+    const auto initialSetpoint = setpoint();
+    const auto initialCounter = counter();
+    const auto initialLimits = limits();
+    const auto initialName = deviceName();
+    const std::filesystem::path path{ "trace.bin" };
+    traceTime = 0;
+
+    SECTION("successful writes are recorded with ID, timestamp and stored bytes")
+    {
+        DataLayer::Trace::Recorder<16> recorder{ &traceClock };
+        {
+            TraceScope scope{ recorder };
+            counter = 42U;
+            std::ignore = deviceName.set(Name{ "pump" });
+        }
+        counter = 43U;
+
+        DataLayer::Trace::Entry entry{};
+        REQUIRE(recorder.pop(entry));
+        REQUIRE(entry.dataPointId == counter.getId());
+        REQUIRE(entry.timestamp == 0U);
+        REQUIRE(entry.payload.size() == sizeof(uint32_t));
+        uint32_t value = 0;
+        std::memcpy(&value, entry.payload.data(), sizeof(value));
+        REQUIRE(value == 42U);
+
+        REQUIRE(recorder.pop(entry));
+        REQUIRE(entry.dataPointId == deviceName.getId());
+        REQUIRE(entry.timestamp == 1000U);
+        REQUIRE(entry.payload.size() == 4U);
+        REQUIRE_FALSE(entry.truncated());
+        REQUIRE_FALSE(recorder.pop(entry));
+    }
+
+    SECTION("writes of packed flags are recorded and replayed")
+    {
+        const auto initialFlag = statusFlag02();
+        const auto initialPumpState = pumpState();
+        DataLayer::Trace::Recorder<16> recorder{ &traceClock };
+        {
+            TraceScope scope{ recorder };
+            statusFlag02 = !initialFlag;
+            REQUIRE(pumpState.set(PumpState::Fault) == DataLayer::Detail::RangeCheck::ok);
+        }
+
+        DataLayer::Trace::Entry entry{};
+        REQUIRE(recorder.pop(entry));
+        REQUIRE(entry.dataPointId == statusFlag02.getId());
+        REQUIRE(entry.payload.size() == sizeof(bool));
+        REQUIRE(recorder.pop(entry));
+        REQUIRE(entry.dataPointId == pumpState.getId());
+        REQUIRE(entry.payload.size() == sizeof(PumpState));
+        REQUIRE_FALSE(recorder.pop(entry));
+
+        {
+            DataLayer::Trace::FileWriter writer{ path };
+            DataLayer::Trace::Recorder<16> flagRecorder{ &traceClock };
+            TraceScope scope{ flagRecorder };
+            statusFlag02 = !initialFlag;
+            REQUIRE(writer.spill(flagRecorder) == 1U);
+        }
+        statusFlag02 = initialFlag;
+        DataLayer::Trace::Reader reader{ path };
+        const auto status = DataLayer::Trace::replay(Dispatcher, reader, 0.0);
+        REQUIRE(status.applied == 1U);
+        REQUIRE(statusFlag02() == !initialFlag);
+        statusFlag02 = initialFlag;
+        std::ignore = pumpState.set(initialPumpState);
+    }
+
+    SECTION("a full ring drops and counts writes, larger values are truncated")
+    {
+        DataLayer::Trace::Recorder<4, 8> recorder{ &traceClock };
+        {
+            TraceScope scope{ recorder };
+            limits = std::array<int16_t, 8>{ 1, 2, 3, 4, 5, 6, 7, 8 };
+            for (uint32_t value = 0; value < 5U; ++value)
+            {
+                counter = value;
+            }
+        }
+        REQUIRE(recorder.takeDropped() == 2U);
+        REQUIRE(recorder.takeDropped() == 0U);
+
+        DataLayer::Trace::Entry entry{};
+        REQUIRE(recorder.pop(entry));
+        REQUIRE(entry.truncated());
+        REQUIRE(entry.size == 16U);
+        REQUIRE(entry.payload.size() == 8U);
+        size_t entries = 1;
+        while (recorder.pop(entry))
+        {
+            ++entries;
+        }
+        REQUIRE(entries == 4U);
+    }
+
+    SECTION("writers of several threads share one recorder without losing entries")
+    {
+        constexpr uint32_t Writes = 2000;
+        static DataLayer::Trace::Recorder<8192> recorder{ &traceClock };
+        {
+            TraceScope scope{ recorder };
+            std::vector<std::jthread> writers;
+            for (uint32_t thread = 0; thread < 4U; ++thread)
+            {
+                writers.emplace_back([thread] {
+                    for (uint32_t index = 0; index < Writes; ++index)
+                    {
+                        DataLayer::Trace::record(static_cast<uint16_t>(thread), std::as_bytes(std::span{ &index, 1 }));
+                    }
+                });
+            }
+        }
+        std::array<uint32_t, 4> next{};
+        DataLayer::Trace::Entry entry{};
+        while (recorder.pop(entry))
+        {
+            uint32_t value = 0;
+            std::memcpy(&value, entry.payload.data(), sizeof(value));
+            // every thread's writes keep their order
+            REQUIRE(value == next.at(entry.dataPointId)++);
+        }
+        REQUIRE(next == std::array<uint32_t, 4>{ Writes, Writes, Writes, Writes });
+        REQUIRE(recorder.takeDropped() == 0U);
+    }
+
+    SECTION("trace file round trip, index seek and replay through the dispatcher")
+    {
+        DataLayer::Trace::Recorder<64> recorder{ &traceClock };
+        {
+            DataLayer::Trace::FileWriter writer{ path };
+            REQUIRE(writer.isOpen());
+            {
+                TraceScope scope{ recorder };
+                setpoint = 30.0F;
+                counter = 1U;
+                REQUIRE(writer.spill(recorder) == 2U);
+                traceTime = 10'000'000'000ULL;
+                counter = 2U;
+                std::ignore = deviceName.set(Name{ "replayed" });
+            }
+            REQUIRE(writer.spill(recorder) == 2U);
+            REQUIRE(writer.records() == 4U);
+            REQUIRE(writer.blocks() == 2U);
+        }
+
+        DataLayer::Trace::Reader reader{ path };
+        REQUIRE(reader.isOpen());
+        REQUIRE(reader.indexed());
+        REQUIRE(reader.blocks().size() == 2U);
+        REQUIRE(reader.blocks()[1].firstTimestamp == 10'000'000'000ULL);
+
+        reader.seek(10'000'000'500ULL);
+        DataLayer::Trace::Record record{};
+        REQUIRE(reader.next(record));
+        REQUIRE(record.dataPointId == deviceName.getId());
+        REQUIRE(record.timestamp == 10'000'001'000ULL);
+        REQUIRE_FALSE(reader.next(record));
+
+        setpoint = initialSetpoint;
+        counter = initialCounter;
+        deviceName = initialName;
+        reader.seek(0);
+        const auto status = DataLayer::Trace::replay(Dispatcher, reader, 0.0);
+        REQUIRE(status.applied == 4U);
+        REQUIRE(status.rejected == 0U);
+        REQUIRE(setpoint() == 30.0F);
+        REQUIRE(counter() == 2U);
+        REQUIRE(deviceName() == "replayed");
+        REQUIRE(reader.corruptBlocks() == 0U);
+    }
+
+    SECTION("unknown IDs, truncated and mis-sized records are rejected on replay")
+    {
+        DataLayer::Trace::Recorder<16, 8> recorder{ &traceClock };
+        {
+            TraceScope scope{ recorder };
+            DataLayer::Trace::record(0xFFFF, std::as_bytes(std::span{ &initialCounter, 1 }));
+            DataLayer::Trace::record(counter.getId(), std::as_bytes(std::span{ &initialCounter, 1 }).first(2));
+            limits = std::array<int16_t, 8>{};
+        }
+        {
+            DataLayer::Trace::FileWriter writer{ path };
+            std::ignore = writer.spill(recorder);
+        }
+        DataLayer::Trace::Reader reader{ path };
+        const auto status = DataLayer::Trace::replay(Dispatcher, reader, 0.0);
+        REQUIRE(status.applied == 0U);
+        REQUIRE(status.rejected == 3U);
+    }
+
+    SECTION("a file without index is walked and a corrupt block is skipped")
+    {
+        DataLayer::Trace::Recorder<16> recorder{ &traceClock };
+        {
+            DataLayer::Trace::FileWriter writer{ path };
+            TraceScope scope{ recorder };
+            for (uint32_t value = 0; value < 3U; ++value)
+            {
+                counter = value;
+                std::ignore = writer.spill(recorder);
+            }
+        }
+        auto bytes = std::vector<char>(std::filesystem::file_size(path));
+        std::ifstream{ path, std::ios::binary }.read(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        // drop the index and flip a payload byte of the second block
+        const auto blockSize = sizeof(DataLayer::Trace::BlockHeader) + sizeof(DataLayer::Trace::RecordHeader) + sizeof(uint32_t);
+        bytes.resize(sizeof(DataLayer::Trace::FileHeader) + 3U * blockSize);
+        bytes[sizeof(DataLayer::Trace::FileHeader) + 2U * blockSize - 1U] ^= 0x01;
+        std::ofstream{ path, std::ios::binary | std::ios::trunc }.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+
+        DataLayer::Trace::Reader reader{ path };
+        REQUIRE(reader.isOpen());
+        REQUIRE_FALSE(reader.indexed());
+        REQUIRE(reader.blocks().size() == 3U);
+        std::vector<uint32_t> values;
+        DataLayer::Trace::Record record{};
+        while (reader.next(record))
+        {
+            uint32_t value = 0;
+            std::memcpy(&value, record.payload.data(), sizeof(value));
+            values.push_back(value);
+        }
+        REQUIRE(values == std::vector<uint32_t>{ 0U, 2U });
+        REQUIRE(reader.corruptBlocks() == 1U);
+
+        REQUIRE_FALSE(DataLayer::Trace::Reader{ "missing-trace.bin" }.isOpen());
+    }
+
+    SECTION("an index offset inside the trailer is rejected and the blocks are walked")
+    {
+        DataLayer::Trace::Recorder<16> recorder{ &traceClock };
+        {
+            DataLayer::Trace::FileWriter writer{ path };
+            TraceScope scope{ recorder };
+            counter = 7U;
+            std::ignore = writer.spill(recorder);
+        }
+        auto bytes = std::vector<char>(std::filesystem::file_size(path));
+        std::ifstream{ path, std::ios::binary }.read(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        DataLayer::Trace::IndexTrailer trailer{};
+        std::memcpy(&trailer, &bytes[bytes.size() - sizeof(trailer)], sizeof(trailer));
+        trailer.indexOffset = bytes.size() - sizeof(trailer) / 2U;
+        trailer.blockCount = 0;
+        std::memcpy(&bytes[bytes.size() - sizeof(trailer)], &trailer, sizeof(trailer));
+        std::ofstream{ path, std::ios::binary | std::ios::trunc }.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+
+        DataLayer::Trace::Reader reader{ path };
+        REQUIRE(reader.isOpen());
+        REQUIRE_FALSE(reader.indexed());
+        REQUIRE(reader.blocks().size() == 1U);
+    }
+
+    setpoint = initialSetpoint;
+    counter = initialCounter;
+    limits = initialLimits;
+    deviceName = initialName;
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Test shared memory segment", "[Shared]")
+{
+    using Name = DataLayer::InlineString<32>;
+    using Status = DataLayer::Shared::Status;
+    const auto initialSetpoint = setpoint();
+    const auto initialLimits = limits();
+    const auto initialName = deviceName();
+    const auto initialFlag = statusFlag00();
+    const std::string name{ "/datalayer-test-shared" };
+
+    SECTION("readers see the values of the writer and every later set()")
+    {
+        setpoint = 12.5F;
+        SharedSegment writer{ name, Dispatcher, DataLayer::Shared::Mode::create };
+        REQUIRE(writer.status() == Status::ok);
+        PublishScope scope{ writer };
+
+        SharedSegment reader{ name, Dispatcher, DataLayer::Shared::Mode::open };
+        REQUIRE(reader.status() == Status::ok);
+        float value = 0.0F;
+        REQUIRE(reader.read<setpoint>(value));
+        REQUIRE(value == 12.5F);
+
+        const auto generation = reader.generation<setpoint>();
+        setpoint = 13.0F;
+        limits = std::array<int16_t, 8>{ 1, 2, 3, 4, 5, 6, 7, 8 };
+        std::ignore = deviceName.set(Name{ "shared" });
+        statusFlag00 = !initialFlag;
+        REQUIRE(reader.generation<setpoint>() == generation + 2U);
+
+        REQUIRE(reader.read<setpoint>(value));
+        REQUIRE(value == 13.0F);
+        std::array<int16_t, 8> values{};
+        REQUIRE(reader.read<limits>(values));
+        REQUIRE(values == std::array<int16_t, 8>{ 1, 2, 3, 4, 5, 6, 7, 8 });
+        Name text{};
+        REQUIRE(reader.read<deviceName>(text));
+        REQUIRE(text == "shared");
+        // a string keeps its used size in the slot, a shorter one does not read the rest of the longer one
+        std::ignore = deviceName.set(Name{ "sh" });
+        REQUIRE(reader.read<deviceName>(text));
+        REQUIRE(text == "sh");
+        bool flag = initialFlag;
+        REQUIRE(reader.read<statusFlag00>(flag));
+        REQUIRE(flag == !initialFlag);
+    }
+
+    SECTION("sync publishes values written without the hook, e.g. by a restore")
+    {
+        SharedSegment writer{ name, Dispatcher, DataLayer::Shared::Mode::create };
+        setpoint = 14.0F;
+        SharedSegment reader{ name, Dispatcher, DataLayer::Shared::Mode::open };
+        float value = 0.0F;
+        REQUIRE(reader.read<setpoint>(value));
+        REQUIRE(value == initialSetpoint);
+        writer.sync();
+        REQUIRE(reader.read<setpoint>(value));
+        REQUIRE(value == 14.0F);
+    }
+
+    SECTION("another model layout, format or a missing writer is refused")
+    {
+        STATIC_REQUIRE(DataLayer::Shared::Segment<std::remove_cvref_t<decltype(ConfigOnlyDispatcher)>>::LayoutHash != SharedSegment::LayoutHash);
+        // the generated type fingerprints tell values of the same size apart
+        STATIC_REQUIRE(DataLayer::TypeFingerprint<std::remove_cvref_t<decltype(counter)>> != 0U);
+        STATIC_REQUIRE(DataLayer::TypeFingerprint<std::remove_cvref_t<decltype(counter)>> != DataLayer::TypeFingerprint<std::remove_cvref_t<decltype(setpoint)>>);
+        REQUIRE(SharedSegment{ name, Dispatcher, DataLayer::Shared::Mode::open }.status() == Status::unavailable);
+        {
+            DataLayer::Shared::Segment writer{ name, ConfigOnlyDispatcher, DataLayer::Shared::Mode::create };
+            REQUIRE(writer.isOpen());
+            SharedSegment reader{ name, Dispatcher, DataLayer::Shared::Mode::open };
+            REQUIRE(reader.status() == Status::layoutMismatch);
+            float value = 0.0F;
+            REQUIRE_FALSE(reader.read<setpoint>(value));
+        }
+        REQUIRE(SharedSegment{ name, Dispatcher, DataLayer::Shared::Mode::open }.status() == Status::unavailable);
+
+        const int descriptor = ::shm_open(name.c_str(), O_CREAT | O_RDWR, 0600);
+        REQUIRE(descriptor >= 0);
+        REQUIRE(::ftruncate(descriptor, static_cast<off_t>(SharedSegment::Size)) == 0);
+        ::close(descriptor);
+        REQUIRE(SharedSegment{ name, Dispatcher, DataLayer::Shared::Mode::open }.status() == Status::formatMismatch);
+        ::shm_unlink(name.c_str());
+    }
+
+    SECTION("a reader thread never sees a half written value")
+    {
+        SharedSegment writer{ name, Dispatcher, DataLayer::Shared::Mode::create };
+        PublishScope scope{ writer };
+        SharedSegment reader{ name, Dispatcher, DataLayer::Shared::Mode::open };
+        std::atomic<bool> done{ false };
+        std::atomic<size_t> reads{ 0 };
+        size_t torn = 0;
+        std::jthread readerThread([&] {
+            std::array<int16_t, 8> values{};
+            while (!done.load(std::memory_order_acquire))
+            {
+                if (reader.read<limits>(values))
+                {
+                    torn += std::ranges::count(values, values[0]) == 8 ? 0U : 1U;
+                    reads.fetch_add(1U, std::memory_order_relaxed);
+                }
+            }
+        });
+        // the writer keeps changing the value until the reader had its share of the CPU
+        for (int16_t value = 0; reads.load(std::memory_order_relaxed) < 20000U; ++value)
+        {
+            limits = std::array<int16_t, 8>{ value, value, value, value, value, value, value, value };
+            if (value % 64 == 0)
+            {
+                std::this_thread::yield();
+            }
+        }
+        done = true;
+        readerThread.join();
+        REQUIRE(torn == 0U);
+    }
+
+    SECTION("another process maps the segment read-only")
+    {
+        SharedSegment writer{ name, Dispatcher, DataLayer::Shared::Mode::create };
+        PublishScope scope{ writer };
+        setpoint = 1.0F;
+        const pid_t child = ::fork();
+        if (child == 0)
+        {
+            // the child only reads, it reports through its exit code
+            SharedSegment reader{ name, Dispatcher, DataLayer::Shared::Mode::open };
+            float value = 0.0F;
+            int result = reader.isOpen() ? 0 : 1;
+            for (size_t attempt = 0; result == 0 && attempt < 1000000U && value != 2.0F; ++attempt)
+            {
+                result = reader.read<setpoint>(value) ? 0 : 2;
+                std::this_thread::yield();
+            }
+            ::_exit(value == 2.0F ? result : 3);
+        }
+        REQUIRE(child > 0);
+        setpoint = 2.0F;
+        int status = 0;
+        REQUIRE(::waitpid(child, &status, 0) == child);
+        REQUIRE(WIFEXITED(status));
+        REQUIRE(WEXITSTATUS(status) == 0);
+    }
+
+    setpoint = initialSetpoint;
+    limits = initialLimits;
+    deviceName = initialName;
+    statusFlag00 = initialFlag;
+}
+
+TEST_CASE("Test socket server", "[Server]")
+{
+    using Name = DataLayer::InlineString<32>;
+    using DataLayer::Protocol::Operation;
+    using DataLayer::Protocol::Status;
+    const auto initialSetpoint = setpoint();
+    const auto initialCounter = counter();
+    const auto initialName = deviceName();
+    const auto initialFlag = statusFlag00();
+    SocketServer server{ ProtocolTable::Table };
+    std::array<std::byte, 4096> request{};
+    std::array<std::byte, 4096> response{};
+
+    // collects the items of an answer
+    struct Item
+    {
+        uint16_t dataPointId{};
+        Status status{};
+        std::vector<std::byte> payload{};
+    };
+    const auto items = [](std::span<const std::byte> message) {
+        std::vector<Item> result;
+        REQUIRE(DataLayer::Protocol::forEachItem(message, [&result](uint16_t dataPointId, Status status, std::span<const std::byte> payload) {
+            result.push_back(Item{ dataPointId, status, { payload.begin(), payload.end() } });
+        }));
+        return result;
+    };
+
+    SECTION("batched reads answer the value or the status of every ID")
+    {
+        setpoint = 7.5F;
+        DataLayer::Protocol::Request builder{ request, Operation::read, 42 };
+        REQUIRE(builder.read(setpoint.getId()));
+        REQUIRE(builder.read(0x7000));
+        REQUIRE(builder.read(deviceName.getId()));
+        const auto size = server.respond(builder.message(), response);
+
+        DataLayer::Protocol::Header header{};
+        REQUIRE(DataLayer::Protocol::parseHeader(std::span{ response }.first(size), header));
+        REQUIRE(header.operation == (static_cast<uint8_t>(Operation::read) | DataLayer::Protocol::ResponseFlag));
+        REQUIRE(header.sequence == 42);
+        const auto answer = items(std::span{ response }.first(size));
+        REQUIRE(answer.size() == 3);
+        REQUIRE(answer[0].status == Status::ok);
+        REQUIRE(DataLayer::Wire::decode<float>(std::span<const std::byte, 4>{ answer[0].payload.data(), 4 }) == 7.5F);
+        REQUIRE(answer[1].dataPointId == 0x7000);
+        REQUIRE(answer[1].status == Status::unknownId);
+        REQUIRE(answer[2].payload.size() == initialName.bytes().size());
+    }
+
+    SECTION("batched writes go through the typed setters")
+    {
+        DataLayer::Protocol::Request builder{ request, Operation::write, 1 };
+        REQUIRE(builder.write(setpoint.getId(), 3.5F));
+        REQUIRE(builder.write(deviceName.getId(), Name{ "socket" }));
+        REQUIRE(builder.write(statusFlag39.getId(), true));
+        REQUIRE(builder.write(counter.getId(), uint16_t{ 1 }));
+        REQUIRE(builder.write(statusFlag00.getId(), !initialFlag));
+        const auto size = server.respond(builder.message(), response);
+        const auto answer = items(std::span{ response }.first(size));
+        REQUIRE(answer.size() == 5);
+        REQUIRE(answer[0].status == Status::ok);
+        REQUIRE(answer[1].status == Status::ok);
+        REQUIRE(answer[2].status == Status::accessDenied);
+        REQUIRE(answer[3].status == Status::invalidPayload);
+        REQUIRE(answer[4].status == Status::ok);
+        REQUIRE(setpoint() == 3.5F);
+        REQUIRE(deviceName() == "socket");
+        REQUIRE(counter() == initialCounter);
+        REQUIRE(statusFlag00() == !initialFlag);
+    }
+
+    SECTION("a malformed request changes nothing and is answered with an error")
+    {
+        DataLayer::Protocol::Request builder{ request, Operation::write, 9 };
+        REQUIRE(builder.write(setpoint.getId(), 4.5F));
+        REQUIRE(builder.write(counter.getId(), uint32_t{ 5 }));
+        const auto message = builder.message();
+        const auto size = server.respond(message.first(message.size() - 1U), response);
+        REQUIRE(size == DataLayer::Protocol::HeaderSize + 1U);
+        REQUIRE(response[1] == std::byte{ static_cast<uint8_t>(Operation::error) | DataLayer::Protocol::ResponseFlag });
+        REQUIRE(response[DataLayer::Protocol::HeaderSize] == std::byte{ static_cast<uint8_t>(Status::invalidRequest) });
+        REQUIRE(setpoint() == initialSetpoint);
+
+        REQUIRE(server.respond(std::span{ request }.first(3), response) == DataLayer::Protocol::HeaderSize + 1U);
+        REQUIRE(server.respond(message, std::span{ response }.first(2)) == 0U);
+    }
+
+    SECTION("an answer larger than the buffer carries the leading items")
+    {
+        DataLayer::Protocol::Request builder{ request, Operation::read, 2 };
+        for (size_t item = 0; item < 8; ++item)
+        {
+            REQUIRE(builder.read(limits.getId()));
+        }
+        const auto size = server.respond(builder.message(), std::span{ response }.first(DataLayer::Protocol::HeaderSize + 3U * (5U + 16U)));
+        REQUIRE(items(std::span{ response }.first(size)).size() == 3);
+    }
+
+    SECTION("Unix and UDP clients are answered by the event loop")
+    {
+        const std::string path{ "/tmp/datalayer-test-server" };
+        for (const bool udp : { false, true })
+        {
+            SocketServer loop{ ProtocolTable::Table };
+            DataLayer::Server::Client client;
+            if (udp)
+            {
+                REQUIRE(loop.bindUdp(0));
+                REQUIRE(loop.port() != 0);
+                REQUIRE(client.connectUdp(loop.port()));
+            }
+            else
+            {
+                REQUIRE(loop.bindUnix(path));
+                REQUIRE(client.connectUnix(path));
+            }
+            DataLayer::Protocol::Request builder{ request, Operation::write, 5 };
+            REQUIRE(builder.write(counter.getId(), uint32_t{ udp ? 11U : 10U }));
+            REQUIRE(client.send(builder.message()));
+            REQUIRE(loop.poll(1000) == 1U);
+            const auto size = client.receive(response, 1000);
+            REQUIRE(items(std::span{ response }.first(size)).at(0).status == Status::ok);
+            REQUIRE(counter() == (udp ? 11U : 10U));
+            REQUIRE(loop.requests() == 1U);
+        }
+        REQUIRE_FALSE(std::filesystem::exists(path));
+    }
+
+    SECTION("subscribers get a snapshot, then the changed values only")
+    {
+        const std::string path{ "/tmp/datalayer-test-server" };
+        REQUIRE(server.bindUnix(path));
+        DataLayer::Server::Client client;
+        REQUIRE(client.connectUnix(path));
+        DataLayer::Protocol::Request builder{ request, Operation::subscribe, 3 };
+        REQUIRE(builder.subscribe(setpoint.getId(), counter.getId()));
+        REQUIRE(builder.subscribe(5, 1));
+        REQUIRE(client.send(builder.message()));
+        REQUIRE(server.poll(1000) == 1U);
+        REQUIRE(server.clients() == 1U);
+
+        auto answer = items(std::span{ response }.first(client.receive(response, 1000)));
+        REQUIRE(answer.size() == 2);
+        REQUIRE(answer[0].status == Status::ok);
+        REQUIRE(answer[1].status == Status::invalidRequest);
+        const auto snapshot = items(std::span{ response }.first(client.receive(response, 1000)));
+        REQUIRE(std::ranges::count_if(snapshot, [](const Item &item) { return item.dataPointId == setpoint.getId() || item.dataPointId == counter.getId(); }) == 2);
+
+        server.notifyChanges();
+        REQUIRE(client.receive(response, 0) == 0U);
+        setpoint = 8.5F;
+        limits = std::array<int16_t, 8>{};
+        server.notifyChanges();
+        answer = items(std::span{ response }.first(client.receive(response, 1000)));
+        REQUIRE(answer.size() == 1);
+        REQUIRE(answer[0].dataPointId == setpoint.getId());
+        REQUIRE(server.notifications() == 2U);
+
+        // an unsubscribe of another protocol version is answered with an error and keeps the subscription
+        DataLayer::Protocol::Request unsubscribe{ request, Operation::unsubscribe, 4 };
+        std::vector<std::byte> otherVersion{ unsubscribe.message().begin(), unsubscribe.message().end() };
+        otherVersion[0] = std::byte{ DataLayer::Protocol::ProtocolVersion + 1U };
+        REQUIRE(client.send(otherVersion));
+        REQUIRE(server.poll(1000) == 1U);
+        REQUIRE(server.clients() == 1U);
+        DataLayer::Protocol::Header header{};
+        REQUIRE(DataLayer::Protocol::parseHeader(std::span{ response }.first(client.receive(response, 1000)), header));
+        REQUIRE(header.operation == (static_cast<uint8_t>(Operation::error) | DataLayer::Protocol::ResponseFlag));
+
+        REQUIRE(client.send(unsubscribe.message()));
+        REQUIRE(server.poll(1000) == 1U);
+        REQUIRE(server.clients() == 0U);
+    }
+
+    SECTION("a closed subscriber is removed and the others are still notified")
+    {
+        const std::string path{ "/tmp/datalayer-test-server" };
+        REQUIRE(server.bindUnix(path));
+        const auto subscribe = [&](const DataLayer::Server::Client &client) {
+            DataLayer::Protocol::Request builder{ request, Operation::subscribe, 6 };
+            REQUIRE(builder.subscribe(setpoint.getId(), setpoint.getId()));
+            REQUIRE(client.send(builder.message()));
+            REQUIRE(server.poll(1000) == 1U);
+            REQUIRE(client.receive(response, 1000) != 0U);
+            REQUIRE(client.receive(response, 1000) != 0U);
+        };
+        DataLayer::Server::Client live;
+        {
+            // the closed client takes the first slot, its removal moves the live one
+            DataLayer::Server::Client closed;
+            REQUIRE(closed.connectUnix(path));
+            REQUIRE(live.connectUnix(path));
+            subscribe(closed);
+            subscribe(live);
+            REQUIRE(server.clients() == 2U);
+        }
+        setpoint = 9.5F;
+        server.notifyChanges();
+        REQUIRE(server.clients() == 1U);
+        const auto answer = items(std::span{ response }.first(live.receive(response, 1000)));
+        REQUIRE(answer.size() == 1);
+        REQUIRE(answer[0].dataPointId == setpoint.getId());
+
+        setpoint = 10.5F;
+        server.notifyChanges();
+        REQUIRE(server.clients() == 1U);
+        REQUIRE(items(std::span{ response }.first(live.receive(response, 1000))).size() == 1);
+    }
+
+    SECTION("run serves requests until stop")
+    {
+        const std::string path{ "/tmp/datalayer-test-server" };
+        REQUIRE(server.bindUnix(path));
+        std::jthread loop([&server] { server.run(); });
+        DataLayer::Server::Client client;
+        REQUIRE(client.connectUnix(path));
+        for (uint16_t sequence = 0; sequence < 100; ++sequence)
+        {
+            DataLayer::Protocol::Request builder{ request, Operation::read, sequence };
+            REQUIRE(builder.read(counter.getId()));
+            REQUIRE(client.request(builder.message(), response) == DataLayer::Protocol::HeaderSize + 5U + 4U);
+        }
+        server.stop();
+        loop.join();
+        REQUIRE(server.requests() == 100U);
+    }
+
+    setpoint = initialSetpoint;
+    counter = initialCounter;
+    deviceName = initialName;
+    statusFlag00 = initialFlag;
+}
+
+TEST_CASE("Test protocol table", "[Protocol]")
+{
+    using DataLayer::Protocol::Operation;
+    using DataLayer::Protocol::Status;
+    const auto initialSetpoint = setpoint();
+    const auto initialPump = pumpState();
+    std::array<std::byte, 512> request{};
+    std::array<std::byte, 512> response{};
+
+    const auto statuses = [](std::span<const std::byte> message) {
+        std::vector<Status> result;
+        REQUIRE(DataLayer::Protocol::forEachItem(message, [&result](uint16_t, Status status, std::span<const std::byte>) { result.push_back(status); }));
+        return result;
+    };
+
+    SECTION("the generated table holds every datapoint but the packed stores")
+    {
+        constexpr auto &Table = ProtocolTable::Table;
+        STATIC_REQUIRE(Table.sorted());
+        STATIC_REQUIRE(Table.find(setpoint.getId()) != nullptr);
+        STATIC_REQUIRE(Table.find(StatusGroupPacked.getId()) == nullptr);
+        STATIC_REQUIRE(Table.find(setpoint.getId())->maximumPayload == sizeof(float));
+        STATIC_REQUIRE(Table.find(deviceName.getId())->maximumPayload == 32U);
+        STATIC_REQUIRE(Table.find(statusFlag39.getId())->write == nullptr);
+        STATIC_REQUIRE(Table.find(statusFlag00.getId())->write != nullptr);
+        STATIC_REQUIRE(DataLayer::Protocol::statusOf(DataLayer::Detail::RangeCheck::notChecked) == Status::ok);
+    }
+
+    SECTION("rejected writes answer the RangeCheck code")
+    {
+        DataLayer::Protocol::Request builder{ request, Operation::write, 3 };
+        REQUIRE(builder.write(pumpState.getId(), static_cast<PumpState>(4)));
+        REQUIRE(builder.write(setpoint.getId(), 2.5F));
+        const auto size = ProtocolTable::Table.respond(builder.message(), response);
+        REQUIRE(statuses(std::span{ response }.first(size)) == std::vector{ Status::overflow, Status::ok });
+        REQUIRE(pumpState() == initialPump);
+        REQUIRE(setpoint() == 2.5F);
+    }
+
+    SECTION("operations that need a peer are answered with an error")
+    {
+        DataLayer::Protocol::Request builder{ request, Operation::subscribe, 8 };
+        REQUIRE(builder.subscribe(setpoint.getId(), counter.getId()));
+        REQUIRE(ProtocolTable::Table.respond(builder.message(), response) == DataLayer::Protocol::HeaderSize + 1U);
+        REQUIRE(response[1] == std::byte{ static_cast<uint8_t>(Operation::error) | DataLayer::Protocol::ResponseFlag });
+    }
+
+    SECTION("MQTT answers on the response topic")
+    {
+        RecordingClient client;
+        DataLayer::Mqtt::Adapter mqtt{ client, Dispatcher };
+        DataLayer::Protocol::Request builder{ request, Operation::write, 4 };
+        REQUIRE(builder.write(setpoint.getId(), 6.5F));
+        REQUIRE(mqtt.serve(ProtocolTable::Table, "datalayer/response", builder.message(), response) == DataLayer::Mqtt::Result::ok);
+        REQUIRE(statuses(client.last) == std::vector{ Status::ok });
+        REQUIRE(setpoint() == 6.5F);
+        REQUIRE(mqtt.serve(ProtocolTable::Table, "datalayer/response", builder.message(), std::span{ response }.first(2)) == DataLayer::Mqtt::Result::invalidPayload);
+    }
+
+    SECTION("CAN FD answers in a single frame")
+    {
+        RecordingBus bus;
+        DataLayer::Can::Adapter<decltype(Dispatcher), 64> can{ bus, Dispatcher };
+        DataLayer::Protocol::Request builder{ request, Operation::read, 5 };
+        REQUIRE(builder.read(setpoint.getId()));
+        DataLayer::Can::Frame frame{ .identifier = 0x600 };
+        const auto message = builder.message();
+        std::ranges::copy(message, frame.payload.begin());
+        frame.length = static_cast<uint8_t>(message.size());
+        REQUIRE(can.serve(ProtocolTable::Table, 0x680, frame) == DataLayer::Can::Result::ok);
+        REQUIRE(bus.last.identifier == 0x680U);
+        REQUIRE(statuses(std::span<const std::byte>{ bus.last.payload }.first(bus.last.length)) == std::vector{ Status::ok });
+    }
+
+    SECTION("classic CAN segments requests and answers")
+    {
+        DataLayer::Can::LoopbackBus<64> serverBus;
+        DataLayer::Can::LoopbackBus<64> clientBus;
+        serverBus.connect(clientBus);
+        DataLayer::Can::Adapter<decltype(Dispatcher), 8, 256> can{ serverBus, Dispatcher };
+        DataLayer::Can::IsoTp::Sender<8, 256, 1> sender;
+        DataLayer::Can::IsoTp::Receiver<8, 256, 1> receiver;
+        DataLayer::Protocol::Request builder{ request, Operation::read, 6 };
+        REQUIRE(builder.read(setpoint.getId()));
+        REQUIRE(builder.read(deviceName.getId()));
+        REQUIRE(builder.read(limits.getId()));
+        REQUIRE(sender.start(clientBus, 0x600, builder.message(), 0x680) == DataLayer::Can::IsoTp::Status::pending);
+
+        std::vector<std::byte> answer;
+        DataLayer::Can::Frame frame{};
+        for (size_t step = 0; step < 64 && answer.empty(); ++step)
+        {
+            while (serverBus.receive(frame))
+            {
+                std::ignore = can.serve(ProtocolTable::Table, 0x680, frame);
+            }
+            while (clientBus.receive(frame))
+            {
+                if (DataLayer::Can::IsoTp::typeOf(frame) == DataLayer::Can::IsoTp::FrameType::flowControl)
+                {
+                    std::ignore = sender.onFlowControl(clientBus, frame);
+                    continue;
+                }
+                const auto outcome = receiver.receive(clientBus, frame, 0x600);
+                if (outcome.status == DataLayer::Can::IsoTp::Status::complete)
+                {
+                    answer.assign(outcome.message.begin(), outcome.message.end());
+                }
+            }
+        }
+        REQUIRE(statuses(answer) == std::vector{ Status::ok, Status::ok, Status::ok });
+    }
+
+    setpoint = initialSetpoint;
+    pumpState = initialPump;
+}
+
+TEST_CASE("Test leader/follower replication", "[Replication]")
+{
+    using Name = DataLayer::InlineString<32>;
+    const auto initialSetpoint = setpoint();
+    const auto initialCounter = counter();
+    const auto initialName = deviceName();
+    const auto initialFlag = statusFlag00();
+    DataLayer::Replication::Loopback link;
+    ReplicationFollower follower{ Dispatcher, link.follower() };
+
+    // Leader and follower share the datapoints of this process. Values overwritten while no leader is
+    // attached stand for the state of another process, the follower has to bring them back.
+    const auto synchronize = [&follower](auto &leader) {
+        std::ignore = follower.pump();
+        std::ignore = leader.pump();
+        std::ignore = follower.pump();
+        REQUIRE(follower.statistics().sequence == leader.statistics().sequence);
+    };
+
+    SECTION("a new follower catches up from a snapshot, then follows the tail")
+    {
+        ReplicationLeader<256> leader{ Dispatcher, link.leader() };
+        setpoint = 4.5F;
+        statusFlag00 = !initialFlag;
+        std::ignore = deviceName.set(Name{ "leader" });
+        REQUIRE(follower.pump() == 0U);
+        REQUIRE(leader.pump() >= 1U);
+        setpoint = 0.0F;
+        statusFlag00 = initialFlag;
+        std::ignore = deviceName.set(Name{ "other" });
+        REQUIRE(follower.pump() > 0U);
+        REQUIRE(setpoint() == 4.5F);
+        REQUIRE(statusFlag00() == !initialFlag);
+        REQUIRE(deviceName() == "leader");
+        REQUIRE(follower.statistics().snapshots == 1U);
+        REQUIRE(follower.statistics().sequence == 1U);
+
+        {
+            ReplicationScope scope{ leader };
+            setpoint = 5.5F;
+            counter = 77U;
+        }
+        REQUIRE(leader.statistics().sequence == 3U);
+        REQUIRE(leader.pump() == 1U);
+        setpoint = 0.0F;
+        counter = 0U;
+        {
+            // applied records are not recorded again
+            ReplicationScope scope{ leader };
+            REQUIRE(follower.pump() == 2U);
+        }
+        REQUIRE(setpoint() == 5.5F);
+        REQUIRE(counter() == 77U);
+        REQUIRE(leader.statistics().sequence == 3U);
+        REQUIRE(leader.lag() == 2U);
+        REQUIRE(leader.pump() == 0U);
+        REQUIRE(leader.lag() == 0U);
+        REQUIRE(leader.statistics().acknowledged == 2U);
+    }
+
+    SECTION("records are batched and applied in write order")
+    {
+        ReplicationLeader<2048> leader{ Dispatcher, link.leader() };
+        synchronize(leader);
+        {
+            ReplicationScope scope{ leader };
+            for (uint32_t value = 1; value <= 1000U; ++value)
+            {
+                counter = value;
+            }
+        }
+        const auto before = leader.statistics().messages;
+        REQUIRE(leader.pump() <= 1000U * 8U / (1400U - sizeof(DataLayer::Replication::MessageHeader)) + 1U);
+        REQUIRE(leader.statistics().messages - before <= 7U);
+
+        std::vector<uint32_t> applied;
+        counter.setChangeCallback([](const uint32_t &value, void *context) noexcept { static_cast<std::vector<uint32_t> *>(context)->push_back(value); }, &applied);
+        REQUIRE(follower.pump() == 1000U);
+        counter.clearChangeCallback();
+        REQUIRE(applied.size() == 1000U);
+        REQUIRE(std::ranges::is_sorted(applied));
+        REQUIRE(applied.back() == 1000U);
+    }
+
+    SECTION("a lost message is sent again from the history")
+    {
+        ReplicationLeader<256> leader{ Dispatcher, link.leader() };
+        synchronize(leader);
+        link.dropLeaderMessages(1);
+        {
+            ReplicationScope scope{ leader };
+            counter = 1U;
+            REQUIRE(leader.pump() == 1U);
+            counter = 2U;
+            REQUIRE(leader.pump() == 1U);
+        }
+        counter = 0U;
+        REQUIRE(follower.pump() == 0U);
+        REQUIRE(follower.statistics().gaps == 1U);
+        REQUIRE(counter() == 0U);
+        REQUIRE(leader.pump() == 1U);
+        REQUIRE(follower.pump() == 2U);
+        REQUIRE(counter() == 2U);
+        REQUIRE(follower.statistics().snapshots == 1U);
+    }
+
+    SECTION("a lost first snapshot fragment is asked for again")
+    {
+        ReplicationLeader<256, 128> leader{ Dispatcher, link.leader() };
+        setpoint = 4.5F;
+        REQUIRE(follower.pump() == 0U);
+        link.dropLeaderMessages(1);
+        REQUIRE(leader.pump() > 1U);
+        setpoint = 0.0F;
+        // the later fragments alone are not taken for a snapshot
+        REQUIRE(follower.pump() == 0U);
+        REQUIRE(follower.statistics().sequence == 0U);
+        REQUIRE(setpoint() == 0.0F);
+
+        // the resume request is repeated after the retry count of discarded messages
+        uint32_t writes = 0;
+        while (follower.statistics().snapshots == 0U && writes < 1000U)
+        {
+            {
+                ReplicationScope scope{ leader };
+                counter = ++writes;
+            }
+            setpoint = 4.5F;
+            std::ignore = leader.pump();
+            setpoint = 0.0F;
+            std::ignore = follower.pump();
+        }
+        REQUIRE(follower.statistics().snapshots == 1U);
+        REQUIRE(leader.statistics().snapshots == 2U);
+        std::ignore = leader.pump();
+        std::ignore = follower.pump();
+        REQUIRE(follower.statistics().sequence == leader.statistics().sequence);
+        REQUIRE(setpoint() == 4.5F);
+        REQUIRE(counter() == writes);
+    }
+
+    SECTION("a lost last snapshot fragment is asked for again on the next records")
+    {
+        const auto fragments = [] {
+            DataLayer::Replication::Loopback probe;
+            ReplicationFollower probeFollower{ Dispatcher, probe.follower() };
+            ReplicationLeader<256, 128> probeLeader{ Dispatcher, probe.leader() };
+            std::ignore = probeFollower.pump();
+            return probeLeader.pump();
+        }();
+        REQUIRE(fragments > 1U);
+
+        ReplicationLeader<256, 128> leader{ Dispatcher, link.leader() };
+        setpoint = 4.5F;
+        REQUIRE(follower.pump() == 0U);
+        link.dropLeaderMessages(1, fragments - 1U);
+        REQUIRE(leader.pump() == fragments);
+        REQUIRE(follower.pump() > 0U);
+        REQUIRE(follower.statistics().sequence == 0U);
+        REQUIRE(follower.statistics().snapshots == 0U);
+
+        {
+            ReplicationScope scope{ leader };
+            counter = 5U;
+        }
+        REQUIRE(leader.pump() == 1U);
+        REQUIRE(follower.pump() == 0U);
+        REQUIRE(follower.statistics().gaps == 1U);
+        REQUIRE(leader.pump() == fragments);
+        setpoint = 0.0F;
+        REQUIRE(follower.pump() > 0U);
+        REQUIRE(follower.statistics().snapshots == 1U);
+        REQUIRE(follower.statistics().sequence == leader.statistics().sequence);
+        REQUIRE(setpoint() == 4.5F);
+        REQUIRE(counter() == 5U);
+    }
+
+    SECTION("the lag is measured on the leader clock")
+    {
+        ReplicationLeader<256> leader{ Dispatcher, link.leader(), &traceClock };
+        traceTime = 0;
+        synchronize(leader);
+        {
+            ReplicationScope scope{ leader };
+            counter = 1U;
+        }
+        REQUIRE(leader.pump() == 1U);
+        REQUIRE(follower.pump() == 1U);
+        std::ignore = leader.pump();
+        const auto statistics = leader.statistics();
+        REQUIRE(statistics.lastLag > 0U);
+        REQUIRE(statistics.maximumLag >= statistics.lastLag);
+    }
+
+    SECTION("a follower behind the leader history gets a new snapshot")
+    {
+        ReplicationLeader<16> leader{ Dispatcher, link.leader() };
+        synchronize(leader);
+        {
+            ReplicationScope scope{ leader };
+            for (uint32_t value = 1; value <= 100U; ++value)
+            {
+                counter = value;
+            }
+        }
+        std::ignore = leader.pump();
+        counter = 0U;
+        std::ignore = follower.pump();
+        REQUIRE(counter() == 100U);
+        REQUIRE(follower.statistics().snapshots == 2U);
+        REQUIRE(follower.statistics().sequence == leader.statistics().sequence);
+    }
+
+    SECTION("a writer thread and the pumps run concurrently")
+    {
+        auto leader = std::make_unique<ReplicationLeader<4096>>(Dispatcher, link.leader());
+        synchronize(*leader);
+        const auto snapshotRecords = follower.statistics().records;
+        std::atomic<bool> done{ false };
+        std::jthread writer([&] {
+            ReplicationScope scope{ *leader };
+            for (uint32_t value = 1; value <= 20000U; ++value)
+            {
+                counter = value;
+                if (value % 64U == 0U)
+                {
+                    std::this_thread::yield();
+                }
+            }
+            done = true;
+        });
+        while (!done.load() || leader->lag() != 0U)
+        {
+            std::ignore = leader->pump();
+            std::ignore = follower.pump();
+            std::this_thread::yield();
+        }
+        writer.join();
+        const auto statistics = follower.statistics();
+        REQUIRE(statistics.records - snapshotRecords == 20000U);
+        REQUIRE(statistics.gaps == 0U);
+        REQUIRE(statistics.rejected == 0U);
+        REQUIRE(statistics.snapshots == 1U);
+    }
+
+    setpoint = initialSetpoint;
+    counter = initialCounter;
+    deviceName = initialName;
+    statusFlag00 = initialFlag;
+}
+
+TEST_CASE("Storage backend benchmarks", "[.][benchmark]")
+{
+    constexpr uint32_t Updates = 10000;
+    auto flash = makeFlash("flash-benchmark.bin", 4096, 8);
+    DataLayer::Storage::WearLevelingStore store{ flash };
+    for (uint32_t value = 0; value < Updates; ++value)
+    {
+        std::ignore = counter.set(value);
+        REQUIRE(ConfigGroup.serializeGroup(store).result);
+    }
+    fmt::print("erase cycles per update: {:.4f} ({} erases for {} updates)\n", static_cast<double>(flash.totalEraseCount()) / Updates, flash.totalEraseCount(), Updates);
+
+    BENCHMARK("mount and restore ConfigGroup")
+    {
+        DataLayer::Storage::WearLevelingStore restoreStore{ flash };
+        return ConfigGroup.deserializeGroup(restoreStore);
+    };
+
+    BENCHMARK("update ConfigGroup")
+    {
+        return ConfigGroup.serializeGroup(store);
+    };
+}
+
+TEST_CASE("Restore benchmarks", "[.][benchmark]")
+{
+    REQUIRE(LargeGroup.serializeGroup(std::filesystem::path{ "large.bin" }).result);
+    std::vector<std::byte> image;
+    const auto &group = LargeGroup.group;
+    REQUIRE(Serialization(group.version, group.baseId, LargeGroup.datapoints).encode(image).result);
+    fmt::print("LargeGroup image: {} bytes, {} records\n", image.size(), std::tuple_size_v<std::remove_cvref_t<decltype(LargeGroup.datapoints)>>);
+
+    BENCHMARK("decode LargeGroup image")
+    {
+        return Deserialization(group.version, group.baseId, LargeGroup.datapoints, group.allowUpgrade).decode(image);
+    };
+
+    BENCHMARK("restore LargeGroup from file")
+    {
+        return LargeGroup.deserializeGroup(std::filesystem::path{ "large.bin" });
+    };
+}
+
+TEST_CASE("Group delta benchmarks", "[.][benchmark]")
+{
+    const auto initialValue = Large::value001();
+    std::vector<std::byte> base;
+    REQUIRE(LargeGroup.encodeGroup(base).result);
+    std::ignore = Large::value001.set(initialValue + 1.0F);
+    std::vector<std::byte> target;
+    REQUIRE(LargeGroup.encodeGroup(target).result);
+    Large::value001 = initialValue;
+
+    std::vector<std::byte> delta;
+    REQUIRE(DataLayer::Persistence::makeDelta(base, target, delta).result);
+    fmt::print("LargeGroup image: {} bytes, delta for one changed datapoint: {} bytes\n", target.size(), delta.size());
+
+    BENCHMARK("make delta of LargeGroup")
+    {
+        return DataLayer::Persistence::makeDelta(base, target, delta);
+    };
+
+    BENCHMARK_ADVANCED("apply delta to LargeGroup")(Catch::Benchmark::Chronometer meter)
+    {
+        std::vector<std::vector<std::byte>> images(static_cast<size_t>(meter.runs()), base);
+        meter.measure([&](int run) { return DataLayer::Persistence::applyDelta(images[static_cast<size_t>(run)], delta); });
+    };
+}
+
+TEST_CASE("Checksum benchmarks", "[.][benchmark]")
+{
+    constexpr size_t Size = 4 * 1024 * 1024;
+    std::vector<std::byte> data(Size);
+    for (size_t index = 0; index < data.size(); ++index)
+    {
+        data[index] = static_cast<std::byte>((index * 131U + 7U) & 0xFFU);
+    }
+
+    const auto throughput = [&](std::string_view name, auto &&checksum) {
+        constexpr int Rounds = 20;
+        uint32_t result = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (int round = 0; round < Rounds; ++round)
+        {
+            result += checksum(std::span<const std::byte>{ data });
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        fmt::print("{:<24} {:6.2f} GB/s ({:#010x})\n", name, static_cast<double>(Size) * Rounds / elapsed.count() / 1e9, result);
+    };
+
+    throughput("crc32 bitwise", [](std::span<const std::byte> input) {
+        uint32_t crc = 0xFFFFFFFFU;
+        for (const auto byte : input)
+        {
+            crc ^= std::to_integer<uint8_t>(byte);
+            for (uint8_t bit = 0; bit < 8; ++bit)
+            {
+                crc = (crc >> 1U) ^ (DataLayer::Persistence::Crc32Polynomial & (0U - (crc & 1U)));
+            }
+        }
+        return ~crc;
+    });
+    throughput("crc32 slicing-by-8", DataLayer::Persistence::TableCrc<DataLayer::Persistence::Crc32Polynomial, 8>::compute);
+    throughput("crc32 slicing-by-16", DataLayer::Persistence::TableCrc<DataLayer::Persistence::Crc32Polynomial, 16>::compute);
+    throughput("crc32c slicing-by-8", DataLayer::Persistence::SoftwareCrc32c::compute);
+    if (DataLayer::Persistence::HardwareCrc32c::available())
+    {
+        throughput("crc32c hardware", DataLayer::Persistence::HardwareCrc32c::compute);
+    }
+
+    BENCHMARK("crc32c of 4 MiB")
+    {
+        return DataLayer::Persistence::crc32c(data);
+    };
+}
+
+TEST_CASE("Snapshot container benchmarks", "[.][benchmark]")
+{
+    BENCHMARK("save every group to its own file")
+    {
+        return LargeGroup.serializeGroup(std::filesystem::path{ "large.bin" }).result && ConfigGroup.serializeGroup(std::filesystem::path{ "config.bin" }).result
+               && DiagnosticGroup.serializeGroup(std::filesystem::path{ "diagnostic.bin" }).result;
+    };
+
+    BENCHMARK("save all groups to one container")
+    {
+        return Dispatcher.serializeAll("snapshot.bin");
+    };
+
+    BENCHMARK("restore every group from its own file")
+    {
+        return LargeGroup.deserializeGroup(std::filesystem::path{ "large.bin" }).result && ConfigGroup.deserializeGroup(std::filesystem::path{ "config.bin" }).result
+               && DiagnosticGroup.deserializeGroup(std::filesystem::path{ "diagnostic.bin" }).result;
+    };
+
+    BENCHMARK("restore all groups from one container")
+    {
+        return Dispatcher.deserializeAll("snapshot.bin");
+    };
+}
+
+TEST_CASE("Persistence worker benchmarks", "[.][benchmark]")
+{
+    std::filesystem::create_directories("worker");
+    DataLayer::Persistence::Worker worker;
+
+    BENCHMARK("blocking serializeGroup (no fsync)")
+    {
+        return LargeGroup.serializeGroup(std::filesystem::path{ "worker/large.bin" });
+    };
+
+    BENCHMARK("blocking durable write (file and directory fsync)")
+    {
+        std::vector<std::byte> image;
+        std::ignore = LargeGroup.encodeGroup(image);
+        return DataLayer::Persistence::writeFile("worker/large.bin", image, true);
+    };
+
+    BENCHMARK("caller side of worker submit")
+    {
+        return worker.submit(LargeGroup, "worker/large.bin");
+    };
+    worker.flush();
+
+    DataLayer::Persistence::Worker batched;
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::future<SerializationStatus>> pending;
+    for (int round = 0; round < 100; ++round)
+    {
+        pending.push_back(batched.submit(LargeGroup, "worker/large.bin"));
+        pending.push_back(batched.submit(ConfigGroup, "worker/config.bin"));
+        pending.push_back(batched.submit(DiagnosticGroup, "worker/diagnostic.bin"));
+    }
+    batched.flush();
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    const auto metrics = batched.metrics();
+    fmt::print("300 durable submits: {:.2f} ms, {} batches, {} writes, {} coalesced, max queue depth {}, mean latency {} us\n",
+               elapsed.count(),
+               metrics.batches,
+               metrics.completed,
+               metrics.coalesced,
+               metrics.maxQueueDepth,
+               metrics.totalLatency.count() / static_cast<int64_t>(std::max<uint64_t>(metrics.completed, 1U)));
+    std::filesystem::remove_all("worker");
+}
+
+TEST_CASE("Boot restore benchmarks", "[.][benchmark]")
+{
+    REQUIRE(Dispatcher.serializeAll("boot.bin").result);
+    fmt::print("model: {} groups, {} byte snapshot\n", std::tuple_size_v<decltype(Dispatcher.groups)>, std::filesystem::file_size("boot.bin"));
+
+    BENCHMARK("eager boot: restore every group")
+    {
+        return Dispatcher.deserializeAll("boot.bin");
+    };
+
+    BENCHMARK("lazy boot: open and validate index")
+    {
+        return Dispatcher.deserializeAllLazy("boot.bin");
+    };
+
+    BENCHMARK("lazy boot: first access to ConfigGroup")
+    {
+        const auto status = Dispatcher.deserializeAllLazy("boot.bin");
+        uint32_t value = 0;
+        std::ignore = Dispatcher.getDatapoint(counter.getId(), value);
+        return status.result && value == counter();
+    };
+    std::ignore = Dispatcher.restorePending();
+    std::filesystem::remove("boot.bin");
+}
+
+TEST_CASE("Packed flag benchmarks", "[.][benchmark]")
+{
+    std::vector<std::byte> image;
+    REQUIRE(StatusGroup.encodeGroup(image).result);
+    fmt::print("StatusGroup image with 41 packed datapoints: {} bytes\n", image.size());
+
+    BENCHMARK("set and clear a packed flag")
+    {
+        statusFlag20 = true;
+        statusFlag20 = false;
+        return statusFlag20();
+    };
+
+    BENCHMARK("encode StatusGroup")
+    {
+        return StatusGroup.encodeGroup(image);
+    };
+
+    BENCHMARK("decode StatusGroup")
+    {
+        return StatusGroup.decodeGroup(image);
+    };
+}
+
+TEST_CASE("Trace recorder benchmarks", "[.][benchmark]")
+{
+    static DataLayer::Trace::Recorder<1024> recorder;
+    uint32_t value = 0;
+
+    BENCHMARK("set uint32_t without a recorder")
+    {
+        return counter.set(++value);
+    };
+
+    {
+        TraceScope scope{ recorder };
+        BENCHMARK("set uint32_t into the recorder")
+        {
+            DataLayer::Trace::Entry entry{};
+            // keeps the ring from filling, pop releases the previous slot
+            std::ignore = recorder.pop(entry);
+            return counter.set(++value);
+        };
+    }
+
+    const std::filesystem::path path{ "trace-benchmark.bin" };
+    DataLayer::Trace::FileWriter writer{ path };
+    BENCHMARK("record and spill 512 writes")
+    {
+        TraceScope scope{ recorder };
+        for (uint32_t index = 0; index < 512U; ++index)
+        {
+            counter = index;
+        }
+        return writer.spill(recorder);
+    };
+    std::ignore = writer.close();
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Shared memory benchmarks", "[.][benchmark]")
+{
+    const std::string name{ "/datalayer-benchmark-shared" };
+    SharedSegment writer{ name, Dispatcher, DataLayer::Shared::Mode::create };
+    SharedSegment reader{ name, Dispatcher, DataLayer::Shared::Mode::open };
+    fmt::print("segment of {} bytes\n", SharedSegment::Size);
+    float value = 0.0F;
+
+    BENCHMARK("set float without a segment")
+    {
+        value += 1.0F;
+        return setpoint.set(value);
+    };
+
+    {
+        PublishScope scope{ writer };
+        BENCHMARK("set float published to the segment")
+        {
+            value += 1.0F;
+            return setpoint.set(value);
+        };
+    }
+
+    BENCHMARK("seqlock read of a float")
+    {
+        float result = 0.0F;
+        std::ignore = reader.read<setpoint>(result);
+        return result;
+    };
+
+    BENCHMARK("seqlock read of a 16 byte array")
+    {
+        std::array<int16_t, 8> result{};
+        std::ignore = reader.read<limits>(result);
+        return result;
+    };
+
+    BENCHMARK("sync every datapoint")
+    {
+        writer.sync();
+    };
+}
+
+TEST_CASE("Socket server benchmarks", "[.][benchmark]")
+{
+    SocketServer server{ ProtocolTable::Table };
+    const std::string path{ "/tmp/datalayer-benchmark-server" };
+    REQUIRE(server.bindUnix(path));
+    DataLayer::Server::Client client;
+    REQUIRE(client.connectUnix(path));
+    std::array<std::byte, 4096> request{};
+    std::array<std::byte, 4096> response{};
+    DataLayer::Protocol::Request reads{ request, DataLayer::Protocol::Operation::read, 1 };
+    for (size_t item = 0; item < 16; ++item)
+    {
+        std::ignore = reads.read(item % 2 == 0 ? setpoint.getId() : limits.getId());
+    }
+    const auto message = reads.message();
+
+    BENCHMARK("respond to 16 reads without a socket")
+    {
+        return server.respond(message, response);
+    };
+
+    BENCHMARK("round trip of 16 reads over a Unix socket")
+    {
+        std::ignore = client.send(message);
+        std::ignore = server.poll(-1);
+        return client.receive(response, -1);
+    };
+}
+
+TEST_CASE("Protocol codec benchmarks", "[.][benchmark]")
+{
+    const auto initialSetpoint = setpoint();
+    std::array<std::byte, 4096> request{};
+    std::array<std::byte, 4096> response{};
+    DataLayer::Protocol::Request reads{ request, DataLayer::Protocol::Operation::read, 1 };
+    for (size_t item = 0; item < 64; ++item)
+    {
+        std::ignore = reads.read(item % 2 == 0 ? setpoint.getId() : counter.getId());
+    }
+    const auto readMessage = reads.message();
+    std::array<std::byte, 4096> writeRequest{};
+    DataLayer::Protocol::Request writes{ writeRequest, DataLayer::Protocol::Operation::write, 2 };
+    for (size_t item = 0; item < 64; ++item)
+    {
+        std::ignore = writes.write(setpoint.getId(), static_cast<float>(item));
+    }
+    const auto writeMessage = writes.message();
+
+    BENCHMARK("respond to 64 reads")
+    {
+        return ProtocolTable::Table.respond(readMessage, response);
+    };
+
+    BENCHMARK("respond to 64 writes")
+    {
+        return ProtocolTable::Table.respond(writeMessage, response);
+    };
+
+    BENCHMARK("decode a 64 item answer")
+    {
+        size_t items = 0;
+        std::ignore = DataLayer::Protocol::forEachItem(std::span{ response }.first(ProtocolTable::Table.respond(readMessage, response)), [&items](uint16_t, DataLayer::Protocol::Status, std::span<const std::byte>) { ++items; });
+        return items;
+    };
+
+    constexpr size_t Requests = 100000;
+    const auto start = std::chrono::steady_clock::now();
+    size_t bytes = 0;
+    for (size_t index = 0; index < Requests; ++index)
+    {
+        bytes += ProtocolTable::Table.respond(readMessage, response);
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    fmt::print("{:.1f} M items/s read, {:.0f} MB/s answered\n", static_cast<double>(Requests * 64U) / elapsed.count() / 1e6, static_cast<double>(bytes) / elapsed.count() / 1e6);
+    setpoint = initialSetpoint;
+}
+
+TEST_CASE("Replication benchmarks", "[.][benchmark]")
+{
+    static DataLayer::Replication::Loopback link{ 4096 };
+    static ReplicationLeader<4096> leader{ Dispatcher, link.leader() };
+    ReplicationFollower follower{ Dispatcher, link.follower() };
+    std::ignore = follower.pump();
+    std::ignore = leader.pump();
+    std::ignore = follower.pump();
+    uint32_t value = 0;
+
+    {
+        ReplicationScope scope{ leader };
+        BENCHMARK("set uint32_t recorded by a leader")
+        {
+            return counter.set(++value);
+        };
+        // the records of the benchmark are left behind, a snapshot resynchronizes the follower
+        while (leader.pump() != 0U || follower.pump() != 0U)
+        {
+        }
+
+        BENCHMARK("replicate 256 writes through the loopback")
+        {
+            for (uint32_t index = 0; index < 256U; ++index)
+            {
+                counter = ++value;
+            }
+            std::ignore = leader.pump();
+            return follower.pump();
+        };
+    }
+
+    // sustained load: one writer thread, the pumps on this thread
+    constexpr uint32_t Writes = 200000;
+    std::atomic<bool> done{ false };
+    const auto messages = leader.statistics().messages;
+    const auto start = std::chrono::steady_clock::now();
+    std::jthread writer([&] {
+        ReplicationScope scope{ leader };
+        for (uint32_t index = 0; index < Writes; ++index)
+        {
+            counter = index;
+            if (index % 64U == 0U)
+            {
+                std::this_thread::yield();
+            }
+        }
+        done = true;
+    });
+    uint64_t maximumLag = 0;
+    while (!done.load() || leader.lag() != 0U)
+    {
+        std::ignore = leader.pump();
+        std::ignore = follower.pump();
+        maximumLag = std::max(maximumLag, leader.lag());
+        std::this_thread::yield();
+    }
+    writer.join();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    const auto sent = leader.statistics().messages - messages;
+    fmt::print("{} writes in {:.1f} ms, {:.0f} writes/s, {:.1f} records per message\n", Writes, elapsed.count() * 1000.0, Writes / elapsed.count(),
+      static_cast<double>(Writes) / static_cast<double>(sent));
+    fmt::print("lag: at most {} records, {:.1f} us from leader write to follower acknowledge\n", maximumLag, static_cast<double>(leader.statistics().maximumLag) / 1000.0);
+}
+
+TEST_CASE("CAN signal benchmarks", "[.][benchmark]")
+{
+    using PumpStatus = CanMessages::PumpStatus;
+    RecordingBus bus;
+    DataLayer::Can::Adapter can{ bus, Dispatcher };
+    const auto frame = PumpStatus::pack();
+    fmt::print("PumpStatus carries {} datapoints in one frame\n", PumpStatus::signalCount);
+
+    BENCHMARK("publish PumpStatus as one message")
+    {
+        return can.publishMessage<PumpStatus>();
+    };
+
+    BENCHMARK("publish the same datapoints as 11 frames")
+    {
+        std::ignore = can.publish(statusFlag00.getId(), statusFlag00());
+        std::ignore = can.publish(statusFlag01.getId(), statusFlag01());
+        std::ignore = can.publish(statusFlag02.getId(), statusFlag02());
+        std::ignore = can.publish(statusFlag03.getId(), statusFlag03());
+        std::ignore = can.publish(statusFlag04.getId(), statusFlag04());
+        std::ignore = can.publish(statusFlag05.getId(), statusFlag05());
+        std::ignore = can.publish(statusFlag06.getId(), statusFlag06());
+        std::ignore = can.publish(statusFlag07.getId(), statusFlag07());
+        std::ignore = can.publish(pumpState.getId(), pumpState());
+        std::ignore = can.publish(faultCode.getId(), faultCode());
+        return can.publish(statusFlag39.getId(), statusFlag39());
+    };
+
+    BENCHMARK("apply PumpStatus")
+    {
+        return can.applyMessage<PumpStatus>(frame);
+    };
+}
+
+TEST_CASE("CAN acceptance filter benchmarks", "[.][benchmark]")
+{
+    constexpr auto banks = DataLayer::Can::mergeFilters<14>(CanFilter::Filters);
+    fmt::print("{} exact filters, {} bitmap words\n", CanFilter::Filters.size(), CanFilter::Accepted.bits.size());
+
+    BENCHMARK("bitmap lookup of 4096 identifiers")
+    {
+        size_t accepted = 0;
+        for (uint32_t identifier = 0x9800; identifier < 0xA800; ++identifier)
+        {
+            accepted += CanFilter::Accepted.contains(identifier) ? 1U : 0U;
+        }
+        return accepted;
+    };
+
+    BENCHMARK("14 filter banks for 4096 identifiers")
+    {
+        size_t accepted = 0;
+        for (uint32_t identifier = 0x9800; identifier < 0xA800; ++identifier)
+        {
+            accepted += DataLayer::Can::accepts(banks, identifier) ? 1U : 0U;
+        }
+        return accepted;
+    };
+
+    BENCHMARK("dispatcher write attempt for 4096 identifiers")
+    {
+        size_t accepted = 0;
+        for (uint32_t identifier = 0x9800; identifier < 0xA800; ++identifier)
+        {
+            accepted += Dispatcher.setDatapoint(identifier, uint64_t{ 0 }).success ? 1U : 0U;
+        }
+        return accepted;
+    };
+}
+
+TEST_CASE("MQTT routing benchmarks", "[.][benchmark]")
+{
+    std::vector<std::string_view> topics;
+    for (const auto &route : MqttTopics::Router.routes)
+    {
+        if (route.apply != nullptr)
+        {
+            topics.push_back(route.topic);
+        }
+    }
+    size_t next = 0;
+
+    BENCHMARK("perfect hash lookup")
+    {
+        next = (next + 97U) % topics.size();
+        return MqttTopics::Router.find(topics[next]);
+    };
+
+    BENCHMARK("linear topic comparison")
+    {
+        next = (next + 97U) % topics.size();
+        return std::ranges::find(topics, topics[next]) - topics.begin();
+    };
+}
+
+TEST_CASE("MQTT group batch benchmarks", "[.][benchmark]")
+{
+    CountingClient client;
+    DataLayer::Mqtt::Adapter mqtt{ client, Dispatcher };
+    DataLayer::Mqtt::GroupBatch batch{ LargeGroup };
+    // the readable datapoints, as in the batch
+    const auto publishEach = [&mqtt] {
+        const auto publishOne = [&mqtt](const auto &dataPoint) {
+            if constexpr (DataLayer::Mqtt::BatchDetail::Batched<std::remove_cvref_t<decltype(dataPoint)>>)
+            {
+                std::ignore = mqtt.publish("LargeGroup/value", dataPoint());
+            }
+        };
+        std::apply([&publishOne](const auto &...dataPoints) { (publishOne(dataPoints), ...); }, LargeGroup.datapoints);
+    };
+    const auto publishBatch = [&mqtt, &batch] {
+        batch.invalidate();
+        std::ignore = mqtt.publishGroup("LargeGroup", batch);
+    };
+
+    BENCHMARK("one message per readable datapoint of the large group")
+    {
+        publishEach();
+        return client.messages;
+    };
+
+    BENCHMARK("one batch message of the large group")
+    {
+        publishBatch();
+        return client.messages;
+    };
+
+    BENCHMARK("batch of one changed datapoint")
+    {
+        Large::value001 = Large::value001() + 1.0F;
+        std::ignore = mqtt.publishGroup("LargeGroup", batch);
+        return client.messages;
+    };
+
+    BENCHMARK("apply a batch of the large group")
+    {
+        batch.invalidate();
+        return mqtt.applyGroup(batch, batch.collect());
+    };
+
+    // throughput of the in-process client, messages and payload bytes per second
+    const auto measure = [&client](const char *name, const auto &cycle) {
+        client = CountingClient{};
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t round = 0; round < 200; ++round)
+        {
+            cycle();
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        WARN(fmt::format("{}: {:.0f} messages/s, {:.0f} bytes/s, {} messages and {} bytes per cycle", name, static_cast<double>(client.messages) / elapsed.count(),
+          static_cast<double>(client.bytes) / elapsed.count(), client.messages / 200U, client.bytes / 200U));
+    };
+    measure("per datapoint", publishEach);
+    measure("group batch", publishBatch);
+}
@@ -0,0 +1,59 @@
+// Feeds arbitrary messages to the protocol table of the persistence model. Every answer has to be well
+// formed, fit the response buffer and repeat the request sequence.
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <include/datalayer.h>
+#include <protocol.h>
+#include <span>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    const std::span<const std::byte> request{ reinterpret_cast<const std::byte *>(data), size };
+    // the first byte picks a response buffer size, so truncated answers are covered as well
+    std::array<std::byte, 1024> buffer{};
+    const auto capacity = size == 0 ? buffer.size() : static_cast<size_t>(data[0]) * 4U;
+    const auto response = std::span{ buffer }.first(capacity);
+
+    const auto answered = ProtocolTable::Table.respond(request, response);
+    if (answered == 0)
+    {
+        if (capacity >= DataLayer::Protocol::HeaderSize + 1U)
+        {
+            std::abort();
+        }
+        return 0;
+    }
+    if (answered > capacity)
+    {
+        std::abort();
+    }
+
+    const auto answer = response.first(answered);
+    DataLayer::Protocol::Header header{};
+    if (!DataLayer::Protocol::parseHeader(answer, header) || (header.operation & DataLayer::Protocol::ResponseFlag) == 0U)
+    {
+        std::abort();
+    }
+    DataLayer::Protocol::Header sent{};
+    if (DataLayer::Protocol::parseHeader(request, sent) && header.sequence != sent.sequence)
+    {
+        std::abort();
+    }
+    if (header.operation == (static_cast<uint8_t>(DataLayer::Protocol::Operation::error) | DataLayer::Protocol::ResponseFlag))
+    {
+        if (answered != DataLayer::Protocol::HeaderSize + 1U)
+        {
+            std::abort();
+        }
+        return 0;
+    }
+    size_t items = 0;
+    if (!DataLayer::Protocol::forEachItem(answer, [&items](uint16_t, DataLayer::Protocol::Status, std::span<const std::byte>) { ++items; }) || items != header.count
+        || header.count > sent.count)
+    {
+        std::abort();
+    }
+    return 0;
+}
@@ -0,0 +1,103 @@
+"""Test suite to test the CAN message validator."""
+import sys
+import os
+import unittest
+sys.path.insert(0, os.path.abspath(os.path.join(os.path.dirname(__file__), '../../src/')))
+import generator
+
+
+def make_model():
+    """Return validated groups, datapoints, enums and types for the message tests."""
+    groups = generator.group_validator([{'name': 'Status', 'baseId': '0x100', 'version': '1.0.0', 'persistence': 'None'}])
+    enums = generator.enum_validator([{'name': 'Mode', 'type': 'uint8_t', 'values': ['Off', 'On', 'Auto'], 'autoId': True}])
+    types = generator.type_validator([{'name': 'Temp', 'type': 'float', 'scale': 0.5, 'offset': -40, 'bits': 8},
+                                      {'name': 'Ratio', 'type': 'float'}])
+    data_points = generator.data_point_validator([
+        {'name': 'flag', 'group': 'Status', 'id': 1, 'type': 'bool', 'access': 'READ_WRITE'},
+        {'name': 'mode', 'group': 'Status', 'id': 2, 'type': 'Mode', 'access': 'READ_WRITE'},
+        {'name': 'level', 'group': 'Status', 'id': 3, 'type': 'int16_t', 'access': 'READ_WRITE', 'namespace': 'pump'},
+        {'name': 'temp', 'group': 'Status', 'id': 4, 'type': 'Temp', 'access': 'READ_WRITE'},
+        {'name': 'ratio', 'group': 'Status', 'id': 5, 'type': 'Ratio', 'access': 'READ_WRITE'},
+        {'name': 'samples', 'group': 'Status', 'id': 6, 'type': 'uint8_t', 'access': 'READ_WRITE', 'arraySize': 4},
+    ], [], enums, types)
+    return groups, data_points, enums, types
+
+
+def validate(messages):
+    """Validate the given messages against the test model."""
+    groups, data_points, enums, types = make_model()
+    return generator.can_message_validator(messages, groups, data_points, enums, types)
+
+
+class TestCanMessageValidator(unittest.TestCase):
+    """Test suite to test the CAN message validator."""
+
+    def test_correct_message(self):
+        """Test that widths, signedness and scaling are resolved from the datapoint types."""
+        result = validate([{'name': 'Status', 'identifier': '0x200', 'length': 8, 'signals': [
+            {'datapoint': 'flag', 'startBit': 0}, {'datapoint': 'mode', 'startBit': 1},
+            {'datapoint': 'pump::level', 'startBit': 8}, {'datapoint': 'temp', 'startBit': 24}]}])
+        flag, mode, level, temp = result[0]['signals']
+        self.assertEqual(result[0]['identifier'], 0x200)
+        self.assertFalse(result[0]['extended'])
+        self.assertEqual((flag['length'], flag['maximum']), (1, 1))
+        self.assertEqual(mode['length'], 2)
+        self.assertEqual(mode['values'], [(0, 'Off'), (1, 'On'), (2, 'Auto')])
+        self.assertEqual((level['length'], level['signed'], level['minimum']), (16, True, -32768))
+        self.assertEqual(level['name'], 'level')
+        self.assertEqual((temp['factor'], temp['offset'], temp['maximum']), (0.5, -40, 87.5))
+
+    def test_extended_identifier(self):
+        """Test that identifiers above 11 bits are marked extended."""
+        result = validate([{'name': 'Status', 'identifier': '0x18FF0010', 'length': 1, 'signals': [{'datapoint': 'flag', 'startBit': 0}]}])
+        self.assertTrue(result[0]['extended'])
+
+    def test_identifier_out_of_range(self):
+        """Test that identifiers above 29 bits are rejected."""
+        messages = [{'name': 'Status', 'identifier': '0x20000000', 'length': 1, 'signals': [{'datapoint': 'flag', 'startBit': 0}]}]
+        self.assertRaises(generator.CanMessageException, validate, messages)
+
+    def test_identifier_of_datapoint(self):
+        """Test that a message can not reuse the frame identifier of a datapoint."""
+        messages = [{'name': 'Status', 'identifier': '0x101', 'length': 1, 'signals': [{'datapoint': 'flag', 'startBit': 0}]}]
+        self.assertRaises(generator.CanMessageException, validate, messages)
+
+    def test_duplicate_identifier(self):
+        """Test that two messages can not share an identifier."""
+        signals = [{'datapoint': 'flag', 'startBit': 0}]
+        messages = [{'name': 'A', 'identifier': '0x200', 'length': 1, 'signals': signals},
+                    {'name': 'B', 'identifier': '0x200', 'length': 1, 'signals': [dict(signals[0])]}]
+        self.assertRaises(generator.CanMessageException, validate, messages)
+
+    def test_invalid_length(self):
+        """Test that only CAN and CAN FD payload lengths are accepted."""
+        messages = [{'name': 'Status', 'identifier': '0x200', 'length': 10, 'signals': [{'datapoint': 'flag', 'startBit': 0}]}]
+        self.assertRaises(generator.CanMessageException, validate, messages)
+
+    def test_signal_exceeds_message(self):
+        """Test that a signal must fit the message payload."""
+        messages = [{'name': 'Status', 'identifier': '0x200', 'length': 1, 'signals': [{'datapoint': 'pump::level', 'startBit': 0}]}]
+        self.assertRaises(generator.CanMessageException, validate, messages)
+
+    def test_overlapping_signals(self):
+        """Test that signals of one message can not share bits."""
+        messages = [{'name': 'Status', 'identifier': '0x200', 'length': 8, 'signals': [
+            {'datapoint': 'mode', 'startBit': 0}, {'datapoint': 'flag', 'startBit': 1}]}]
+        self.assertRaises(generator.CanMessageException, validate, messages)
+
+    def test_shorter_signal(self):
+        """Test that a signal can be shorter than its type but not longer."""
+        result = validate([{'name': 'Status', 'identifier': '0x200', 'length': 8, 'signals': [{'datapoint': 'pump::level', 'startBit': 0, 'length': 10}]}])
+        self.assertEqual(result[0]['signals'][0]['minimum'], -512)
+        messages = [{'name': 'Status', 'identifier': '0x200', 'length': 8, 'signals': [{'datapoint': 'flag', 'startBit': 0, 'length': 2}]}]
+        self.assertRaises(generator.CanMessageException, validate, messages)
+
+    def test_unsupported_datapoints(self):
+        """Test that unknown, floating point and array datapoints can not be signals."""
+        for name in ('missing', 'ratio', 'samples'):
+            messages = [{'name': 'Status', 'identifier': '0x200', 'length': 8, 'signals': [{'datapoint': name, 'startBit': 0}]}]
+            self.assertRaises(generator.CanMessageException, validate, messages)
+
+
+if __name__ == '__main__':
+    unittest.main()
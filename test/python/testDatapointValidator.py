@@ -234,5 +234,68 @@ class TestDatapointValidator(unittest.TestCase):
         self.assertEqual(str(result[0]['version']), '2.1.3')
 
 
+    def test_string_type_maps_to_inline_string(self):
+        """Test that a string datapoint becomes an inline string of the given capacity."""
+        test_data = [{'name': 'dp1', 'group': 'G', 'id': 1, 'type': 'string', 'capacity': 16,
+                      'access': 'READ_WRITE', 'version': '1.0.0', 'default': 'pump'}]
+        result = generator.data_point_validator(test_data, struct_list={}, enum_list={}, custom_type={})
+        self.assertEqual(result[0]['type'], 'DataLayer::InlineString<16>')
+        self.assertEqual(result[0]['capacity'], 16)
+
+    def test_missing_capacity_defaults_zero(self):
+        """Test that non string datapoints get a capacity of 0."""
+        test_data = [{'name': 'dp1', 'group': 'G', 'id': 1, 'type': 'int32_t',
+                      'access': 'READ_WRITE', 'version': '1.0.0'}]
+        result = generator.data_point_validator(test_data, struct_list={}, enum_list={}, custom_type={})
+        self.assertEqual(result[0]['capacity'], 0)
+
+    def test_string_without_valid_capacity_raises(self):
+        """Test that a string datapoint needs a capacity within the supported range."""
+        for capacity in [None, 0, 65536, '8']:
+            test_data = [{'name': 'dp1', 'group': 'G', 'id': 1, 'type': 'string',
+                          'access': 'READ_WRITE', 'version': '1.0.0'}]
+            if capacity is not None:
+                test_data[0]['capacity'] = capacity
+            self.assertRaises(generator.DatapointException, generator.data_point_validator, test_data,
+                              struct_list={}, enum_list={}, custom_type={})
+
+    def test_string_default_exceeding_capacity_raises(self):
+        """Test that the UTF-8 encoded default must fit the capacity."""
+        test_data = [{'name': 'dp1', 'group': 'G', 'id': 1, 'type': 'string', 'capacity': 4,
+                      'access': 'READ_WRITE', 'version': '1.0.0', 'default': 'pümp'}]
+        self.assertRaises(generator.DatapointException, generator.data_point_validator, test_data,
+                          struct_list={}, enum_list={}, custom_type={})
+
+    def test_publish_policy_defaults(self):
+        """Test that missing scheduling fields give no policy and partial ones default to 0."""
+        test_data = [{'name': 'dp1', 'group': 'G', 'id': 1, 'type': 'float', 'access': 'READ_WRITE', 'version': '1.0.0'},
+                     {'name': 'dp2', 'group': 'G', 'id': 2, 'type': 'float', 'access': 'READ_WRITE', 'version': '1.0.0',
+                      'maxInterval': 1000, 'deadband': 0.5}]
+        result = generator.data_point_validator(test_data, struct_list={}, enum_list={}, custom_type={})
+        self.assertIsNone(result[0]['publish'])
+        self.assertEqual(result[1]['publish'], {'minInterval': 0, 'maxInterval': 1000, 'deadband': 0.5, 'relativeDeadband': 0})
+
+    def test_publish_policy_invalid_values_raise(self):
+        """Test negative, fractional and inverted intervals as well as negative deadbands."""
+        for fields in [{'minInterval': -1}, {'minInterval': 1.5}, {'maxInterval': 10, 'minInterval': 20},
+                       {'deadband': -0.1}, {'relativeDeadband': True}]:
+            test_data = [dict({'name': 'dp1', 'group': 'G', 'id': 1, 'type': 'float', 'access': 'READ_WRITE',
+                               'version': '1.0.0'}, **fields)]
+            self.assertRaises(generator.DatapointException, generator.data_point_validator, test_data,
+                              struct_list={}, enum_list={}, custom_type={})
+
+    def test_deadband_needs_numeric_scalar(self):
+        """Test that deadbands are rejected for bool, arrays and structs but accepted for custom types."""
+        for fields in [{'type': 'bool'}, {'type': 'int32_t', 'arraySize': 4}, {'type': 'Temperature'}]:
+            test_data = [dict({'name': 'dp1', 'group': 'G', 'id': 1, 'access': 'READ_WRITE', 'version': '1.0.0',
+                               'deadband': 1}, **fields)]
+            self.assertRaises(generator.DatapointException, generator.data_point_validator, test_data,
+                              struct_list={'Temperature': None}, enum_list={}, custom_type={})
+        test_data = [{'name': 'dp1', 'group': 'G', 'id': 1, 'type': 'Current', 'access': 'READ_WRITE',
+                      'version': '1.0.0', 'relativeDeadband': 0.1}]
+        result = generator.data_point_validator(test_data, struct_list={}, enum_list={}, custom_type=[{'name': 'Current'}])
+        self.assertEqual(result[0]['publish']['relativeDeadband'], 0.1)
+
+
 if __name__ == '__main__':
     unittest.main()
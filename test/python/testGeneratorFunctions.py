@@ -7,6 +7,14 @@ sys.path.insert(0, os.path.abspath(os.path.join(os.path.dirname(__file__), '../.
 import generator  # noqa: F401 — ensures src/generator/ is appended to sys.path
 import generator.generator as _gen_module  # loads generator.py submodule explicitly
 create_group_data_point_dict = _gen_module.create_group_data_point_dict
+acceptance_filters = _gen_module.acceptance_filters
+create_can_filters = _gen_module.create_can_filters
+topic_hash = _gen_module.topic_hash
+perfect_hash = _gen_module.perfect_hash
+create_mqtt_topics = _gen_module.create_mqtt_topics
+create_protocol_table = _gen_module.create_protocol_table
+create_type_fingerprints = _gen_module.create_type_fingerprints
+Parameter = sys.modules['validators'].Parameter
 
 
 class TestCreateGroupDataPointDict(unittest.TestCase):
@@ -95,6 +103,158 @@ class TestCreateGroupDataPointDict(unittest.TestCase):
         result = create_group_data_point_dict(dps)
         self.assertEqual(result['G'], ['first', 'second', 'third'])
 
+    def test_packed_store_appended_to_its_group(self):
+        """Test that the packed store of a group is the last member of its mapping."""
+        dps = [
+            {'name': 'flag', 'group': 'G', 'namespace': ''},
+            {'name': 'other', 'group': 'H', 'namespace': ''}
+        ]
+        groups = [{'name': 'G', 'packed': {'name': 'GPacked'}}, {'name': 'H', 'packed': None}]
+        result = create_group_data_point_dict(dps, groups)
+        self.assertEqual(result['G'], ['flag', 'GPacked'])
+        self.assertEqual(result['H'], ['other'])
+
+
+def admitted(filters, width=16):
+    """Return every identifier below 2**width that passes one of the filters."""
+    return {identifier for identifier in range(1 << width) if any((identifier ^ value) & mask == 0 for value, mask in filters)}
+
+
+class TestCanFilters(unittest.TestCase):
+    """Tests for the generated CAN acceptance filters and bitmap."""
+
+    def test_aligned_block_is_one_filter(self):
+        """Test that an aligned power of two block collapses into a single filter."""
+        self.assertEqual(acceptance_filters(list(range(0x1010, 0x1020))), [(0x1010, 0x1FFFFFF0)])
+
+    def test_filters_admit_exactly_the_identifiers(self):
+        """Test that the cover has no false positives or misses."""
+        identifiers = [0x1000, 0x1001, 0x1002, 0x1003, 0x1005, 0x2004, 0x2007, 0x20FF]
+        filters = acceptance_filters(identifiers)
+        self.assertEqual(admitted(filters), set(identifiers))
+        self.assertEqual(len(filters), 5)
+
+    def test_empty_identifiers(self):
+        """Test that no identifiers produce no filters."""
+        self.assertEqual(acceptance_filters([]), [])
+
+    def test_writable_current_and_legacy_ids(self):
+        """Test that read only datapoints are excluded and legacy IDs are admitted."""
+        groups = [{'name': 'G', 'baseId': '0x100'}, {'name': 'H', 'baseId': '0x4000'}]
+        data_points = [
+            {'name': 'a', 'namespace': '', 'group': 'G', 'id': 1, 'access': 'READ_WRITE', 'renamedFrom': [9], 'type': 'float'},
+            {'name': 'b', 'namespace': '', 'group': 'G', 'id': 2, 'access': 'READ_ONLY', 'renamedFrom': [], 'type': 'float'},
+            {'name': 'c', 'namespace': 'n', 'group': 'H', 'id': 3, 'access': 'WRITE_ONLY', 'renamedFrom': [], 'type': 'float'},
+        ]
+        messages = [{'identifier': 0x180, 'signals': [{'datapoint': 'n::c'}]},
+                    {'identifier': 0x181, 'signals': [{'datapoint': 'b'}]}]
+        result = create_can_filters(data_points, groups, messages, [], [], [])
+        self.assertEqual(admitted(result['filters']), {0x101, 0x109, 0x4003, 0x180})
+        self.assertEqual(result['messages'], [0x180])
+        self.assertEqual([segment['first'] for segment in result['segments']], [0x100, 0x4000])
+        self.assertEqual(result['words'], [(1 << 1) | (1 << 9), 1 << 3])
+
+    def test_flow_control_of_segmented_publishes(self):
+        """Test that readable datapoints larger than a classic frame admit their flow control identifier."""
+        groups = [{'name': 'G', 'baseId': '0x100'}]
+        structs = [{'name': 'S', 'parameter': [Parameter({'x': 'double'}), Parameter({'y': 'uint8_t'})]}]
+        data_points = [
+            {'name': 'a', 'namespace': '', 'group': 'G', 'id': 1, 'access': 'READ_ONLY', 'renamedFrom': [], 'type': 'int32_t', 'arraySize': 3},
+            {'name': 'b', 'namespace': '', 'group': 'G', 'id': 2, 'access': 'READ_ONLY', 'renamedFrom': [], 'type': 'double', 'arraySize': 0},
+            {'name': 'c', 'namespace': '', 'group': 'G', 'id': 3, 'access': 'WRITE_ONLY', 'renamedFrom': [], 'type': 'S', 'arraySize': 0},
+            {'name': 'd', 'namespace': '', 'group': 'G', 'id': 4, 'access': 'READ_WRITE', 'renamedFrom': [], 'type': 'S', 'arraySize': 0},
+            {'name': 'e', 'namespace': '', 'group': 'G', 'id': 5, 'access': 'READ_ONLY', 'renamedFrom': [], 'type': 'x', 'capacity': 9},
+        ]
+        result = create_can_filters(data_points, groups, [], structs, [], [])
+        self.assertEqual(result['filters'], acceptance_filters([0x103, 0x104, 0x10000101, 0x10000104, 0x10000105]))
+        self.assertEqual([segment['first'] for segment in result['segments']], [0x100, 0x10000100])
+
+
+class TestMqttTopics(unittest.TestCase):
+    """Tests for the generated MQTT topics and the perfect hash router."""
+
+    def test_topic_hash_matches_the_cpp_router(self):
+        """Test the hash against the values checked by the C++ persistence suite."""
+        self.assertEqual(topic_hash('', 0), 0xAB3E7C0B)
+        self.assertEqual(topic_hash('DefaultGroup/test', 7), 0xB1EFB4EF)
+
+    def test_perfect_hash_places_every_topic(self):
+        """Test that the bucket seeds map all topics to distinct slots."""
+        topics = [f'Group{index % 7}/ns/value{index}' for index in range(500)]
+        seeds, slot_count, slots = perfect_hash(topics)
+        for topic in topics:
+            self.assertEqual(topic_hash(topic, seeds[topic_hash(topic, 0) % len(seeds)]) % slot_count, slots[topic])
+        self.assertEqual(len(set(slots.values())), len(topics))
+
+    def test_duplicate_topics_are_rejected(self):
+        """Test that a duplicate topic raises instead of searching forever."""
+        with self.assertRaises(ValueError):
+            perfect_hash(['a/b', 'a/b'])
+
+    def test_topics_and_routes(self):
+        """Test topic names, value types and that read only datapoints get no route."""
+        data_points = [
+            {'name': 'a', 'namespace': '', 'group': 'G', 'type': 'float', 'access': 'READ_WRITE'},
+            {'name': 'b', 'namespace': 'n::m', 'group': 'G', 'type': 'int32_t', 'arraySize': 4, 'access': 'WRITE_ONLY'},
+            {'name': 'c', 'namespace': '', 'group': 'H', 'type': 'bool', 'access': 'READ_ONLY'},
+        ]
+        result = create_mqtt_topics(data_points)
+        self.assertEqual([topic['topic'] for topic in result['topics']], ['G/a', 'G/n/m/b', 'H/c'])
+        self.assertEqual(result['topics'][1]['datapoint'], 'n::m::b')
+        self.assertEqual(result['topics'][1]['type'], 'std::array<int32_t, 4>')
+        self.assertEqual(sorted(route['topic'] for route in result['routes'] if route), ['G/a', 'G/n/m/b'])
+
+    def test_empty_model_has_one_empty_slot(self):
+        """Test that a model without writable datapoints still yields a valid router."""
+        result = create_mqtt_topics([])
+        self.assertEqual(result['seeds'], [0])
+        self.assertEqual(result['routes'], [None])
+
+
+class TestProtocolTable(unittest.TestCase):
+    """Tests for the generated protocol ID table."""
+
+    def test_sorted_by_full_id(self):
+        """Test that the group base ID orders the entries and every access is included."""
+        groups = [{'name': 'G', 'baseId': '0x2000'}, {'name': 'H', 'baseId': '0x100'}]
+        data_points = [
+            {'name': 'a', 'namespace': '', 'group': 'G', 'id': 1},
+            {'name': 'b', 'namespace': 'n::m', 'group': 'H', 'id': 7},
+            {'name': 'c', 'namespace': '', 'group': 'H', 'id': 2},
+        ]
+        self.assertEqual(create_protocol_table(data_points, groups), ['c', 'n::m::b', 'a'])
+
+
+class TestTypeFingerprints(unittest.TestCase):
+    """Tests for the value type fingerprints of the shared memory layout hash."""
+
+    def fingerprint(self, data_point, structs=(), enums=(), types=()):
+        """Return the fingerprint of a single datapoint."""
+        data_point = {'name': 'a', 'namespace': '', 'arraySize': 0, **data_point}
+        return create_type_fingerprints([data_point], list(structs), list(enums), list(types))[0]['fingerprint']
+
+    def test_fnv1a_of_a_base_type(self):
+        """Test that a base type hashes its name with 32 bit FNV-1a."""
+        self.assertEqual(self.fingerprint({'type': 'a'}), 0xE40C292C)
+
+    def test_struct_fields_change_the_fingerprint(self):
+        """Test that a changed field type of a struct gives another fingerprint under the same name."""
+        first = [{'name': 'S', 'parameter': [Parameter({'x': 'uint16_t'}), Parameter({'y': 'float'})]}]
+        second = [{'name': 'S', 'parameter': [Parameter({'x': 'uint32_t'}), Parameter({'y': 'float'})]}]
+        self.assertNotEqual(self.fingerprint({'type': 'S'}, structs=first), self.fingerprint({'type': 'S'}, structs=second))
+
+    def test_enum_values_and_array_size_change_the_fingerprint(self):
+        """Test that the enum values and the array size are part of the fingerprint."""
+        first = [{'name': 'E', 'type': 'uint8_t', 'values': ['Off', 'On']}]
+        second = [{'name': 'E', 'type': 'uint8_t', 'values': ['Off', 'On', 'Fault']}]
+        self.assertNotEqual(self.fingerprint({'type': 'E'}, enums=first), self.fingerprint({'type': 'E'}, enums=second))
+        self.assertNotEqual(self.fingerprint({'type': 'E'}, enums=first), self.fingerprint({'type': 'E', 'arraySize': 2}, enums=first))
+
+    def test_qualified_names(self):
+        """Test that a namespace qualifies the datapoint name."""
+        result = create_type_fingerprints([{'name': 'a', 'namespace': 'n', 'type': 'float', 'arraySize': 0}], [], [], [])
+        self.assertEqual(result[0]['datapoint'], 'n::a')
+
 
 if __name__ == '__main__':
     unittest.main()
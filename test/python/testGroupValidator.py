@@ -86,5 +86,51 @@ class TestGroupValidator(unittest.TestCase):
         self.assertRaises(ValueError, generator.group_validator, test_data)
 
 
+    def _packed_model(self, data_points, packed_id=100):
+        """Validate a group with packedId together with its data points and the State enum."""
+        groups = generator.group_validator([{'name': 'G', 'persistence': 'None', 'baseId': '0x1000',
+                                             'version': '1.0.0', 'packedId': packed_id}])
+        enums = generator.enum_validator([{'name': 'State', 'type': 'uint8_t', 'autoId': True,
+                                           'values': ['Off', 'On', 'Fault']}])
+        data_points = generator.data_point_validator(data_points, struct_list={}, enum_list=enums, custom_type=[])
+        return generator.packed_validator(groups, data_points, enums), data_points
+
+    def test_packed_group_places_bool_and_enum_fields(self):
+        """Test that bool and small enum data points of a packed group get consecutive bits."""
+        groups, data_points = self._packed_model([
+            {'name': 'b', 'group': 'G', 'id': 2, 'type': 'bool', 'access': 'READ_WRITE', 'version': '1.0.0',
+             'default': True},
+            {'name': 'a', 'group': 'G', 'id': 1, 'type': 'State', 'access': 'READ_WRITE', 'version': '1.0.0',
+             'default': 'Fault'},
+            {'name': 'c', 'group': 'G', 'id': 3, 'type': 'uint32_t', 'access': 'READ_WRITE', 'version': '1.0.0'}])
+        packed = groups[0]['packed']
+        self.assertEqual(packed['bits'], 3)
+        self.assertEqual([(f['id'], f['offset'], f['width']) for f in packed['fields']], [(1, 0, 2), (2, 2, 1)])
+        self.assertEqual(packed['fields'][0]['initial'], 'static_cast<uint32_t>(State::Fault)')
+        self.assertEqual(packed['fields'][1]['initial'], '1')
+        self.assertIsNone(data_points[2]['packed'])
+
+    def test_packed_fields_do_not_cross_words(self):
+        """Test that a field which does not fit into the current word starts the next one."""
+        data_points = [{'name': f'f{i}', 'group': 'G', 'id': i, 'type': 'bool', 'access': 'READ_WRITE',
+                        'version': '1.0.0'} for i in range(31)]
+        data_points.append({'name': 'state', 'group': 'G', 'id': 31, 'type': 'State', 'access': 'READ_WRITE',
+                            'version': '1.0.0'})
+        groups, _ = self._packed_model(data_points)
+        self.assertEqual(groups[0]['packed']['fields'][-1]['offset'], 32)
+        self.assertEqual(groups[0]['packed']['bits'], 34)
+
+    def test_packed_id_collision_raises(self):
+        """Test that a packedId used by a data point of the group raises."""
+        data_points = [{'name': 'b', 'group': 'G', 'id': 100, 'type': 'bool', 'access': 'READ_WRITE',
+                        'version': '1.0.0'}]
+        self.assertRaises(generator.GroupException, self._packed_model, data_points)
+
+    def test_packed_group_without_flags_raises(self):
+        """Test that a packed group without bool or small enum data points raises."""
+        data_points = [{'name': 'c', 'group': 'G', 'id': 1, 'type': 'uint32_t', 'access': 'READ_WRITE',
+                        'version': '1.0.0'}]
+        self.assertRaises(generator.GroupException, self._packed_model, data_points)
+
 if __name__ == '__main__':
     unittest.main()
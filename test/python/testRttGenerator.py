@@ -1,5 +1,9 @@
 """Tests for the generated SEGGER RTT reader."""
+import importlib
 import importlib.util
+import mmap
+import os
+import struct
 import subprocess
 import sys
 import tempfile
@@ -37,6 +41,156 @@ class TestRttGenerator(unittest.TestCase):
             self.assertEqual(reader.read(), [])
             self.assertEqual(reader.read(), [('Testify::test', 4211)])
 
+    def test_generated_reader_drains_channel_and_counts_lost_frames(self):
+        """The channel reader follows the ring offsets and the overflow flag adds up lost frames."""
+        with tempfile.TemporaryDirectory() as temporary_directory:
+            output_directory = Path(temporary_directory)
+            subprocess.run([
+                sys.executable, str(ROOT / 'src/generator/generator.py'),
+                '--model_dir', str(ROOT / 'src/model'),
+                '--out_dir', str(output_directory),
+                '--template_dir', str(ROOT / 'src/template'),
+                '--schema_dir', str(ROOT / 'src/generator'),
+            ], check=True)
+            module_path = output_directory / 'generated/datalayer_example/rtt.py'
+            specification = importlib.util.spec_from_file_location('generated_rtt_channel', module_path)
+            module = importlib.util.module_from_spec(specification)
+            sys.modules[specification.name] = module
+            specification.loader.exec_module(module)
+
+            frame = module.FRAME_HEADER.pack(module.FRAME_MAGIC, module.PROTOCOL_VERSION, module.OVERFLOW_FLAG | 3, 0x4001, 4)
+            frame += (-7).to_bytes(4, 'little', signed=True)
+            capacity = 16
+            # the frame wraps: it starts 4 bytes before the end of the ring
+            ring = bytearray(capacity)
+            ring[12:] = frame[:4]
+            ring[:len(frame) - 4] = frame[4:]
+            channel_path = output_directory / 'channel'
+            channel_path.write_bytes(module.CHANNEL_HEADER.pack(module.CHANNEL_IDENTIFIER, capacity, len(frame) - 4, 12, 0) + ring)
+            with open(channel_path, 'r+b') as file:
+                memory = mmap.mmap(file.fileno(), 0)
+            reader = module.RttReader.channel(memory)
+
+            self.assertEqual(reader.read(), [('Testify::test', -7)])
+            self.assertEqual(reader.lost_frames, 3)
+            self.assertEqual(struct.unpack_from('<I', memory, 16)[0], len(frame) - 4)
+            self.assertEqual(reader.read(), [])
+            memory.close()
+
+            with self.assertRaises(ValueError):
+                module.RttReader.channel(bytearray(module.CHANNEL_HEADER.size))
+
+
+def generate_reader(output_directory, module_name):
+    """Generate the example model and import its rtt.py under module_name."""
+    subprocess.run([
+        sys.executable, str(ROOT / 'src/generator/generator.py'),
+        '--model_dir', str(ROOT / 'src/model'),
+        '--out_dir', str(output_directory),
+        '--template_dir', str(ROOT / 'src/template'),
+        '--schema_dir', str(ROOT / 'src/generator'),
+    ], check=True)
+    module_path = Path(output_directory) / 'generated/datalayer_example/rtt.py'
+    specification = importlib.util.spec_from_file_location(module_name, module_path)
+    module = importlib.util.module_from_spec(specification)
+    sys.modules[specification.name] = module
+    specification.loader.exec_module(module)
+    return module
+
+
+class TestRttDecoder(unittest.TestCase):
+    """Verify the frame splitting shared by the compiled and the Python decoder."""
+
+    @classmethod
+    def setUpClass(cls):
+        cls.temporary_directory = tempfile.TemporaryDirectory()
+        cls.module = generate_reader(cls.temporary_directory.name, 'generated_rtt_decoder')
+
+    @classmethod
+    def tearDownClass(cls):
+        cls.temporary_directory.cleanup()
+
+    def frame(self, data_point_id, payload, version=1, flags=0):
+        """Return one encoded frame."""
+        return self.module.FRAME_HEADER.pack(self.module.FRAME_MAGIC, version, flags, data_point_id, len(payload)) + payload
+
+    def test_noise_is_skipped_and_frames_split_across_feeds(self):
+        """Garbage, a lone magic byte, a wrong version and an oversized header are skipped as noise."""
+        decoder = self.module.PythonDecoder(maximum_payload=64)
+        stream = (b'xDD' + self.frame(7, b'\x01\x02') + b'D' + self.frame(7, b'', version=2)
+                  + self.frame(9, bytes(100)) + self.frame(8, b'\x03', flags=0x82) + self.frame(7, b'\x04\x05') + b'DL\x01')
+        columns = {}
+        for offset in range(0, len(stream), 5):
+            for data_point_id, (payloads, ends, _) in decoder.feed(stream[offset:offset + 5]).items():
+                column = columns.setdefault(data_point_id, [])
+                starts = [0, *ends[:-1]]
+                column += [payloads[start:end] for start, end in zip(starts, ends)]
+
+        self.assertEqual(columns, {7: [b'\x01\x02', b'\x04\x05'], 8: [b'\x03']})
+        self.assertEqual(decoder.frames, 3)
+        self.assertEqual(decoder.lost_frames, 2)
+        self.assertEqual(decoder.skipped_bytes, 3 + 1 + 8 + 8 + 100)
+
+    def test_reader_keeps_stream_order_across_datapoints(self):
+        """Values of different datapoints come back in the order they were sent."""
+        stream = (self.frame(0x4001, (1).to_bytes(4, 'little')) + self.frame(0x9999, b'\x00')
+                  + self.frame(0x4001, (2).to_bytes(4, 'little')))
+        chunks = iter((stream,))
+        reader = self.module.RttReader(lambda: next(chunks, b''), self.module.PythonDecoder())
+        self.assertEqual(reader.read(), [('Testify::test', 1), ('Testify::test', 2)])
+
+    def test_repeated_magic_bytes_are_linear(self):
+        """A stream of magic lookalikes is consumed in one pass, a trailing magic byte waits for the next feed."""
+        decoder = self.module.PythonDecoder()
+        self.assertEqual(decoder.feed(b'D' * 200000 + b'DL\x07' * 50000 + b'D'), {})
+        self.assertEqual(decoder.feed(self.frame(5, b'\x01')[1:]), {5: (b'\x01', [1], [0])})
+        self.assertEqual(decoder.skipped_bytes, 200000 + 150000)
+
+    def test_read_batch_returns_numpy_columns(self):
+        """Scalars become one array per datapoint, unknown IDs are ignored."""
+        try:
+            import numpy
+        except ImportError:
+            self.skipTest('NumPy is not installed.')
+        stream = b''.join(self.frame(0x4001, value.to_bytes(4, 'little', signed=True)) for value in range(-3, 1000))
+        chunks = iter((stream[:1001], stream[1001:]))
+        reader = self.module.RttReader(lambda: next(chunks, b''), self.module.PythonDecoder())
+        first = reader.read_batch()
+        second = reader.read_batch()
+        values = numpy.concatenate((first['Testify::test'], second['Testify::test']))
+        self.assertEqual(values.dtype, numpy.dtype('<i4'))
+        self.assertTrue(numpy.array_equal(values, numpy.arange(-3, 1000, dtype=numpy.int32)))
+
+
+
+class TestCompiledRttDecoder(unittest.TestCase):
+    """Verify the RttDecoder of the pybind11 module, built by CMake with -DENABLE_PYBIND11=ON."""
+
+    @classmethod
+    def setUpClass(cls):
+        binding_directory = os.environ.get('DATALAYER_BINDING_DIR')
+        if not binding_directory:
+            raise unittest.SkipTest('The pybind11 module is only built with -DENABLE_PYBIND11=ON.')
+        sys.path.insert(0, binding_directory)
+        cls.decoder_type = importlib.import_module(os.environ.get('DATALAYER_BINDING_MODULE', 'datalayer_example')).RttDecoder
+
+    def frame(self, data_point_id, payload):
+        """Return one encoded frame."""
+        return b'DL\x01\x00' + struct.pack('<HH', data_point_id, len(payload)) + payload
+
+    def test_bytes_and_buffers_give_the_same_columns(self):
+        """bytes, bytearray and a strided memoryview are decoded from their logical bytes."""
+        stream = b'xx' + self.frame(7, b'\x01\x02') + self.frame(8, b'\x03') + self.frame(7, b'\x04')
+        interleaved = bytearray(2 * len(stream))
+        interleaved[::2] = stream
+        for data in (stream, bytearray(stream), memoryview(interleaved)[::2]):
+            columns = self.decoder_type(64).feed(data)
+            self.assertEqual(sorted(columns), [7, 8])
+            payloads, ends, indices = columns[7]
+            self.assertEqual(bytes(payloads), b'\x01\x02\x04')
+            self.assertEqual(list(ends), [2, 3])
+            self.assertEqual(list(indices), [0, 2])
+
 
 if __name__ == '__main__':
     unittest.main()
@@ -91,5 +91,41 @@ class TestTypesValidator(unittest.TestCase):
         self.assertIsNone(result[0]['max'])
 
 
+    def test_quantized_range_derived(self):
+        """Test that a quantized type without bounds gets the representable range."""
+        test_data = [{'name': 'Q', 'type': 'float', 'scale': 0.5, 'offset': -10, 'bits': 8}]
+        result = generator.type_validator(test_data)
+        self.assertEqual(result[0]['min'], -10)
+        self.assertEqual(result[0]['max'], 117.5)
+        self.assertEqual(result[0]['bits'], 8)
+
+    def test_quantized_offset_defaults_to_zero(self):
+        """Test that a missing offset is set to zero."""
+        test_data = [{'name': 'Q', 'type': 'uint16_t', 'scale': 1, 'bits': 4}]
+        result = generator.type_validator(test_data)
+        self.assertEqual(result[0]['offset'], 0)
+        self.assertEqual(result[0]['max'], 15)
+
+    def test_quantized_missing_bits_raises(self):
+        """Test that scale without bits raises TypeException."""
+        test_data = [{'name': 'Q', 'type': 'float', 'scale': 0.1}]
+        self.assertRaises(generator.TypeException, generator.type_validator, test_data)
+
+    def test_quantized_too_wide_raises(self):
+        """Test that a raw value that needs as many bytes as the base type raises TypeException."""
+        test_data = [{'name': 'Q', 'type': 'float', 'scale': 0.1, 'bits': 25}]
+        self.assertRaises(generator.TypeException, generator.type_validator, test_data)
+
+    def test_quantized_range_outside_raw_raises(self):
+        """Test that bounds outside the representable range raise TypeException."""
+        test_data = [{'name': 'Q', 'type': 'float', 'scale': 0.1, 'offset': 0, 'bits': 8, 'min': -1, 'max': 10}]
+        self.assertRaises(generator.TypeException, generator.type_validator, test_data)
+
+    def test_plain_type_has_no_bits(self):
+        """Test that a type without quantization is marked with bits None."""
+        test_data = [{'name': 'T', 'type': 'uint32_t'}]
+        result = generator.type_validator(test_data)
+        self.assertIsNone(result[0]['bits'])
+
 if __name__ == '__main__':
     unittest.main()